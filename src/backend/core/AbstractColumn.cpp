@@ -244,6 +244,15 @@ QList< Interval<int> > AbstractColumn::maskedIntervals() const {
 	return m_abstract_column_private->m_masking.intervals();
 }
 
+/**
+ * \brief Return the intervals of not masked rows within \c range
+ *
+ * Loops over the rows can skip the masked rows blockwise with this instead of calling isMasked() for every row.
+ */
+QList< Interval<int> > AbstractColumn::unmaskedIntervals(Interval<int> range) const {
+	return m_abstract_column_private->m_masking.unsetIntervals(range);
+}
+
 /**
  * \brief Clear all masking information
  */
@@ -270,6 +279,14 @@ void AbstractColumn::setMasked(int row, bool mask) {
 	setMasked(Interval<int>(row,row), mask);
 }
 
+/**
+ * \brief Reorder the masking of the rows, row i gets the masking of the row \c permutation[i]
+ */
+void AbstractColumn::permuteMasks(const QVector<int>& permutation) {
+	exec(new AbstractColumnPermuteMasksCmd(m_abstract_column_private, permutation),
+			"maskingAboutToChange", "maskingChanged", Q_ARG(const AbstractColumn*,this));
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 //@}
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -436,6 +453,63 @@ double AbstractColumn::valueAt(int row) const {
 	return NAN;
 }
 
+/**
+ * \brief Return a pointer to the double values in the rows 'first',...,'first'+'count'-1
+ *
+ * Returns 0 if the values are not stored contiguously, e.g. for non-numeric columns or filters.
+ * The pointer is valid until the data of the column is changed. Use SpanReader to read the values
+ * of any column in spans.
+ */
+const double* AbstractColumn::valueData(int first, int count) const {
+	Q_UNUSED(first) Q_UNUSED(count)
+	return 0;
+}
+
+/**
+ * \class AbstractColumn::SpanReader
+ * \brief Reads the double values in the rows 'first',...,'last' of a column in spans of up to chunkSize rows.
+ *
+ * The spans point directly to the data of the column if it provides contiguous values (valueData()),
+ * otherwise the values are copied into an internal buffer via valueAt(). The spans of two readers
+ * for the same rows cover the same rows, so several columns can be processed in lockstep:
+ * \code
+ * AbstractColumn::SpanReader xReader(xColumn, first, last);
+ * AbstractColumn::SpanReader yReader(yColumn, first, last);
+ * while (xReader.next() && yReader.next()) {
+ * 	const double* x = xReader.values();
+ * 	const double* y = yReader.values();
+ * 	for (int i = 0; i < xReader.count(); ++i)
+ * 		...
+ * }
+ * \endcode
+ */
+AbstractColumn::SpanReader::SpanReader(const AbstractColumn* column, int first, int last)
+	: m_column(column), m_next(first), m_last(last), m_values(0), m_first(first), m_count(0) {
+}
+
+/**
+ * \brief Advance to the next span, returns false if all rows were read
+ */
+bool AbstractColumn::SpanReader::next() {
+	if (m_next > m_last)
+		return false;
+
+	m_first = m_next;
+	m_count = qMin(chunkSize, m_last - m_next + 1);
+	m_next += m_count;
+
+	m_values = m_column->valueData(m_first, m_count);
+	if (!m_values) {
+		m_buffer.resize(m_count);
+		double* buffer = m_buffer.data();
+		for (int i = 0; i < m_count; ++i)
+			buffer[i] = m_column->valueAt(m_first + i);
+		m_values = buffer;
+	}
+
+	return true;
+}
+
 /**
  * \brief Set the content of row 'row'
  *
@@ -455,29 +529,28 @@ void AbstractColumn::replaceValues(int first, const QVector<double>& new_values)
 }
 
 double AbstractColumn::minimum() const{
-	double val;
 	double min = INFINITY;
-	for (int row = 0; row < rowCount(); row++) {
-		val = valueAt(row);
-		if (std::isnan(val))
-			continue;
-
-		if (val < min)
-			min = val;
+	SpanReader reader(this, 0, rowCount() - 1);
+	while (reader.next()) {
+		const double* values = reader.values();
+		for (int i = 0; i < reader.count(); ++i) {
+			//NaNs fail the comparison and are skipped
+			if (values[i] < min)
+				min = values[i];
+		}
 	}
 	return min;
 }
 
 double AbstractColumn::maximum() const{
-	double val;
 	double max = -INFINITY;
-	for (int row = 0; row < rowCount(); row++) {
-		val = valueAt(row);
-		if (std::isnan(val))
-			continue;
-
-		if (val > max)
-			max = val;
+	SpanReader reader(this, 0, rowCount() - 1);
+	while (reader.next()) {
+		const double* values = reader.values();
+		for (int i = 0; i < reader.count(); ++i) {
+			if (values[i] > max)
+				max = values[i];
+		}
 	}
 	return max;
 }
@@ -31,6 +31,7 @@
 #define ABSTRACTCOLUMN_H
 
 #include "backend/core/AbstractAspect.h"
+#include <QVector>
 #include <cmath>
 
 class AbstractColumnPrivate;
@@ -82,6 +83,7 @@ class AbstractColumn : public AbstractAspect
 		bool isMasked(int row) const;
 		bool isMasked(Interval<int> i) const;
 		QList< Interval<int> > maskedIntervals() const;
+		QList< Interval<int> > unmaskedIntervals(Interval<int> range) const;
 		void clearMasks();
 		void setMasked(Interval<int> i, bool mask = true);
 		void setMasked(int row, bool mask = true);
@@ -92,8 +94,8 @@ class AbstractColumn : public AbstractAspect
 		virtual void setFormula(int row, QString formula);
 		virtual void clearFormulas();
 
-		double minimum() const;
-		double maximum() const;
+		virtual double minimum() const;
+		virtual double maximum() const;
 
 		virtual QString textAt(int row) const;
 		virtual void setTextAt(int row, const QString& new_value);
@@ -108,6 +110,28 @@ class AbstractColumn : public AbstractAspect
 		virtual double valueAt(int row) const;
 		virtual void setValueAt(int row, double new_value);
 		virtual void replaceValues(int first, const QVector<double>& new_values);
+		virtual const double* valueData(int first, int count) const;
+
+		//! reads the numeric values of consecutive rows in contiguous spans
+		class SpanReader {
+			public:
+				static const int chunkSize = 4096;
+
+				SpanReader(const AbstractColumn* column, int first, int last);
+				bool next();
+				const double* values() const { return m_values; }
+				int first() const { return m_first; }
+				int count() const { return m_count; }
+
+			private:
+				const AbstractColumn* m_column;
+				int m_next;
+				int m_last;
+				const double* m_values;
+				int m_first;
+				int m_count;
+				QVector<double> m_buffer;
+		};
 
 	signals:
 		void plotDesignationAboutToChange(const AbstractColumn * source);
@@ -130,6 +154,7 @@ class AbstractColumn : public AbstractAspect
 
 		virtual void handleRowInsertion(int before, int count);
 		virtual void handleRowRemoval(int first, int count);
+		void permuteMasks(const QVector<int>& permutation);
 
 	private:
 		AbstractColumnPrivate* m_abstract_column_private;
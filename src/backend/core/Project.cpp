@@ -28,6 +28,7 @@
  ***************************************************************************/
 #include "backend/core/Project.h"
 #include "backend/lib/XmlStreamReader.h"
+#include "backend/lib/UndoMemoryBudget.h"
 #include "backend/spreadsheet/Spreadsheet.h"
 #include "backend/worksheet/Worksheet.h"
 #include "backend/worksheet/plots/cartesian/XYEquationCurve.h"
@@ -85,7 +86,8 @@ class Project::Private {
 			author(QString(qgetenv("USER"))),
 			modificationTime(QDateTime::currentDateTime()),
 			changed(false),
-			loading(false)
+			loading(false),
+			undoBudget(new UndoMemoryBudget(&undo_stack))
 			{}
 
 		QUndoStack undo_stack;
@@ -97,6 +99,7 @@ class Project::Private {
 		QDateTime modificationTime;
 		bool changed;
 		bool loading;
+		UndoMemoryBudget* undoBudget;
 };
 
 Project::Project() : Folder(i18n("Project")), d(new Private()) {
@@ -106,6 +109,10 @@ Project::Project() : Folder(i18n("Project")), d(new Private()) {
 
 	d->author = group.readEntry("Author", QString());
 
+	//limit for the memory kept by the undo commands in MiB
+	const KConfigGroup generalGroup = config.group("Settings_General");
+	d->undoBudget->setLimit(generalGroup.readEntry("UndoMemoryLimit", 1024)*(qint64)1024*1024);
+
 	//we don't have direct access to the members name and comment
 	//->temporaly disable the undo stack and call the setters
 	setUndoAware(false);
@@ -139,6 +146,13 @@ QUndoStack* Project::undoStack() const {
 	return &d->undo_stack;
 }
 
+/*!
+	returns the object limiting the memory kept by the commands on the undo stack.
+*/
+UndoMemoryBudget* Project::undoMemoryBudget() const {
+	return d->undoBudget;
+}
+
 QMenu* Project::createContextMenu() {
 	QMenu* menu = new QMenu(); // no remove action from AbstractAspect in the project context menu
 	emit requestProjectContextMenu(menu);
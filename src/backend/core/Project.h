@@ -35,6 +35,7 @@
 
 class QString;
 class AbstractScriptingEngine;
+class UndoMemoryBudget;
 
 class Project : public Folder {
 	Q_OBJECT
@@ -54,6 +55,7 @@ class Project : public Folder {
 		virtual const Project* project() const { return this; }
 		virtual Project* project() { return this; }
 		virtual QUndoStack* undoStack() const;
+		UndoMemoryBudget* undoMemoryBudget() const;
 		virtual QString path() const { return name(); }
 		virtual QMenu* createContextMenu();
 		virtual QMenu* createFolderContextMenu(const Folder*);
@@ -163,6 +163,53 @@ void AbstractColumnSetMaskedCmd::undo()
 	emit m_col->owner()->dataChanged(m_col->owner());
 }
 
+/** ***************************************************************************
+ * \class AbstractColumnPermuteMasksCmd
+ * \brief Reorder the masked rows
+ *
+ * Row i gets the masking of the row permutation[i], the rows behind the permutation are not changed.
+ ** ***************************************************************************/
+
+AbstractColumnPermuteMasksCmd::AbstractColumnPermuteMasksCmd(AbstractColumnPrivate* col, const QVector<int>& permutation, QUndoCommand* parent)
+	: QUndoCommand(parent), m_col(col), m_permutation(permutation), m_copied(false) {
+	setText(i18n("%1: reorder masked cells", col->name()));
+}
+
+void AbstractColumnPermuteMasksCmd::redo() {
+	if (!m_copied) {
+		m_masking = m_col->m_masking;
+		m_copied = true;
+	}
+
+	const int count = m_permutation.size();
+	IntervalAttribute<bool> masking;
+	int start = -1;
+	for (int row = 0; row < count; ++row) {
+		const bool masked = m_masking.isSet(m_permutation.at(row));
+		if (masked && start == -1)
+			start = row;
+		else if (!masked && start != -1) {
+			masking.setValue(Interval<int>(start, row - 1));
+			start = -1;
+		}
+	}
+	if (start != -1)
+		masking.setValue(Interval<int>(start, count - 1));
+
+	foreach (const Interval<int>& interval, m_masking.intervals()) {
+		if (interval.end() >= count)
+			masking.setValue(Interval<int>(qMax(interval.start(), count), interval.end()));
+	}
+
+	m_col->m_masking = masking;
+	emit m_col->owner()->dataChanged(m_col->owner());
+}
+
+void AbstractColumnPermuteMasksCmd::undo() {
+	m_col->m_masking = m_masking;
+	emit m_col->owner()->dataChanged(m_col->owner());
+}
+
 /** ***************************************************************************
  * \class AbstractColumnInsertRowsCmd
  * \brief Insert empty rows into a column
@@ -66,6 +66,20 @@ private:
 
 };
 
+class AbstractColumnPermuteMasksCmd : public QUndoCommand {
+public:
+	explicit AbstractColumnPermuteMasksCmd(AbstractColumnPrivate* col, const QVector<int>& permutation, QUndoCommand* parent = 0);
+
+	virtual void redo();
+	virtual void undo();
+
+private:
+	AbstractColumnPrivate* m_col;
+	QVector<int> m_permutation;
+	IntervalAttribute<bool> m_masking;
+	bool m_copied;
+};
+
 class AbstractColumnInsertRowsCmd : public QUndoCommand
 {
 public:
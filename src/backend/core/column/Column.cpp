@@ -32,6 +32,7 @@
 #include "backend/core/column/columncommands.h"
 #include "backend/core/Project.h"
 #include "backend/lib/XmlStreamReader.h"
+#include "backend/lib/BinaryProjectFile.h"
 #include "backend/core/datatypes/String2DateTimeFilter.h"
 #include "backend/core/datatypes/DateTime2StringFilter.h"
 #include "backend/worksheet/plots/cartesian/XYCurve.h"
@@ -50,6 +51,7 @@ extern "C" {
 #endif
 
 #include <KLocale>
+#include <cmath>
 
 /**
  * \class Column
@@ -235,6 +237,24 @@ bool Column::copy(const AbstractColumn * source, int source_start, int dest_star
 	return true;
 }
 
+/**
+ * \brief Reorder the rows, row i gets the value and the masking of row \c permutation[i]
+ *
+ * The column is extended to the size of the permutation if it has less rows.
+ */
+void Column::permuteRows(const QVector<int>& permutation) {
+	if (permutation.isEmpty())
+		return;
+
+	beginMacro(i18n("%1: reorder rows", name()));
+	exec(new ColumnPermuteRowsCmd(m_column_private, permutation));
+	if (!maskedIntervals().isEmpty())
+		permuteMasks(permutation);
+	endMacro();
+
+	setStatisticsAvailable(false);
+}
+
 /**
  * \brief Insert some empty (or initialized with zero) rows
  */
@@ -467,25 +487,28 @@ void Column::calculateStatistics() {
 	QMap<double, int> frequencyOfValues;
 	QVector<double> rowData;
 	rowData.reserve(rowValues->size());
-	for (int row = 0; row < rowValues->size(); ++row) {
-		val = rowValues->value(row);
-		if (std::isnan(val) || isMasked(row))
-			continue;
-
-		if (val < statistics.minimum)
-			statistics.minimum = val;
-		if (val > statistics.maximum)
-			statistics.maximum = val;
-		columnSum+= val;
-		columnSumNeg += (1.0 / val);
-		columnSumSquare += pow(val, 2.0);
-		columnProduct *= val;
-		if (frequencyOfValues.contains(val))
-			frequencyOfValues.operator [](val)++;
-		else
-			frequencyOfValues.insert(val, 1);
-		++notNanCount;
-		rowData.push_back(val);
+	const QList< Interval<int> > unmasked = unmaskedIntervals(Interval<int>(0, rowValues->size()-1));
+	foreach (const Interval<int>& interval, unmasked) {
+		for (int row = interval.start(); row <= interval.end(); ++row) {
+			val = rowValues->at(row);
+			if (std::isnan(val))
+				continue;
+
+			if (val < statistics.minimum)
+				statistics.minimum = val;
+			if (val > statistics.maximum)
+				statistics.maximum = val;
+			columnSum+= val;
+			columnSumNeg += (1.0 / val);
+			columnSumSquare += pow(val, 2.0);
+			columnProduct *= val;
+			if (frequencyOfValues.contains(val))
+				frequencyOfValues.operator [](val)++;
+			else
+				frequencyOfValues.insert(val, 1);
+			++notNanCount;
+			rowData.push_back(val);
+		}
 	}
 
 	if (notNanCount == 0) {
@@ -515,19 +538,21 @@ void Column::calculateStatistics() {
 	absoluteMedianList.resize(notNanCount);
 
 	int idx = 0;
-	for(int row = 0; row < rowValues->size(); ++row) {
-		val = rowValues->value(row);
-		if ( std::isnan(val) || isMasked(row) )
-			continue;
-		columnSumVariance+= pow(val - statistics.arithmeticMean, 2.0);
-
-		sumForCentralMoment_r3 += pow(val - statistics.arithmeticMean, 3.0);
-		sumForCentralMoment_r4 += pow(val - statistics.arithmeticMean, 4.0);
-		columnSumMeanDeviation += fabs( val - statistics.arithmeticMean );
-
-		absoluteMedianList[idx] = fabs(val - statistics.median);
-		columnSumMedianDeviation += absoluteMedianList[idx];
-		idx++;
+	foreach (const Interval<int>& interval, unmasked) {
+		for (int row = interval.start(); row <= interval.end(); ++row) {
+			val = rowValues->at(row);
+			if (std::isnan(val))
+				continue;
+			columnSumVariance+= pow(val - statistics.arithmeticMean, 2.0);
+
+			sumForCentralMoment_r3 += pow(val - statistics.arithmeticMean, 3.0);
+			sumForCentralMoment_r4 += pow(val - statistics.arithmeticMean, 4.0);
+			columnSumMeanDeviation += fabs( val - statistics.arithmeticMean );
+
+			absoluteMedianList[idx] = fabs(val - statistics.median);
+			columnSumMedianDeviation += absoluteMedianList[idx];
+			idx++;
+		}
 	}
 
 	statistics.meanDeviationAroundMedian = columnSumMedianDeviation / notNanCount;
@@ -600,16 +625,69 @@ double Column::valueAt(int row) const {
 	return m_column_private->valueAt(row);
 }
 
+/**
+ * \brief Return a pointer to the values in the rows 'first',...,'first'+'count'-1
+ *
+ * Returns 0 if the column is not numeric or if the rows are not available.
+ */
+const double* Column::valueData(int first, int count) const {
+	if (columnMode() != AbstractColumn::Numeric || first < 0 || count < 0 || first + count > rowCount())
+		return 0;
+
+	return static_cast<QVector<double>*>(m_column_private->dataPointer())->constData() + first;
+}
+
 /*
  * call this function if the data of the column was changed directly via the data()-pointer
  * and not via the setValueAt() in order to emit the dataChanged-signal.
  * This is used e.g. in \c XYFitCurvePrivate::recalculate()
  */
 void Column::setChanged() {
+	invalidateProperties();
 	if (!m_suppressDataChangedSignal)
 		emit dataChanged(this);
+}
 
+/*!
+ * call this function if rows were appended directly via the data()-pointer starting at row \c first
+ * while the rows before \c first were not changed.
+ * The cached properties are updated for the new rows only and the rowsInserted-signal is emitted,
+ * so the dependent objects (spreadsheet view, curves) can process the appended rows only.
+ * This is used e.g. in \c FileDataSource when following a growing file.
+ */
+void Column::setRowsAppended(int first) {
+	m_column_private->addToAggregates(first, rowCount() - first);
 	setStatisticsAvailable(false);
+	if (!m_suppressDataChangedSignal)
+		emit rowsInserted(this, first, rowCount() - first);
+}
+
+/*!
+ * invalidates the cached properties (minimum, maximum, etc.) of the column.
+ * Call this function if the data was changed directly via the data()-pointer
+ * and the dataChanged-signal is emitted by the owner of the column.
+ */
+void Column::invalidateProperties() {
+	m_column_private->invalidateAggregates();
+	setStatisticsAvailable(false);
+}
+
+/**
+ * \brief Return the smallest value in the column
+ *
+ * The value is cached and updated incrementally on changes of the column data.
+ */
+double Column::minimum() const {
+	return m_column_private->minimum();
+}
+
+/**
+ * \brief Return the largest value in the column
+ *
+ * The value is cached and updated incrementally on changes of the column data.
+ */
+double Column::maximum() const {
+	return m_column_private->maximum();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -695,7 +773,15 @@ void Column::save(QXmlStreamWriter* writer) const {
 			const char* data = reinterpret_cast<const char*>(
 			                       static_cast< QVector<double>* >(m_column_private->dataPointer())->constData());
 			int size = m_column_private->rowCount()*sizeof(double);
-			writer->writeCharacters(QByteArray::fromRawData(data,size).toBase64());
+
+			//in binary project files the values are saved in a separate binary section
+			BinaryProjectFile* binaryFile = dynamic_cast<BinaryProjectFile*>(writer->device());
+			if (binaryFile) {
+				writer->writeStartElement("binaryData");
+				writer->writeAttribute("section", QString::number(binaryFile->addSection(data, size)));
+				writer->writeEndElement();
+			} else
+				writer->writeCharacters(QByteArray::fromRawData(data,size).toBase64());
 			break;
 		}
 	case AbstractColumn::Text:
@@ -740,6 +826,26 @@ private:
 	QString m_content;
 };
 
+class ReadBinaryDataTask : public QRunnable {
+public:
+	ReadBinaryDataTask(ColumnPrivate* priv, const BinaryProjectFile* file, int section) {
+		m_private = priv;
+		m_file = file;
+		m_section = section;
+	};
+	void run() {
+		QVector<double>* data = new QVector<double>(m_file->sectionSize(m_section)/sizeof(double));
+		if (!m_file->readSection(m_section, reinterpret_cast<char*>(data->data())))
+			data->fill(NAN);
+		m_private->replaceData(data);
+	}
+
+private:
+	ColumnPrivate* m_private;
+	const BinaryProjectFile* m_file;
+	int m_section;
+};
+
 /**
  * \brief Load the column from XML
  */
@@ -789,6 +895,8 @@ bool Column::load(XmlStreamReader* reader) {
 					ret_val = XmlReadFormula(reader);
 				else if(reader->name() == "row")
 					ret_val = XmlReadRow(reader);
+				else if(reader->name() == "binaryData")
+					ret_val = XmlReadBinaryData(reader);
 				else { // unknown element
 					reader->raiseWarning(i18n("unknown element '%1'", reader->name().toString()));
 					if (!reader->skipToEndElement()) return false;
@@ -808,6 +916,31 @@ bool Column::load(XmlStreamReader* reader) {
 	return !reader->error();
 }
 
+/**
+ * \brief Read the values of a numeric column from a section of a binary project file
+ *
+ * The values are copied from the memory-mapped file in a separate thread.
+ * The project file has to be available until all threads of the global thread pool are finished.
+ */
+bool Column::XmlReadBinaryData(XmlStreamReader* reader) {
+	Q_ASSERT(reader->isStartElement() && reader->name() == "binaryData");
+
+	const BinaryProjectFile* binaryFile = dynamic_cast<const BinaryProjectFile*>(reader->device());
+	bool ok;
+	const int section = reader->readAttributeInt("section", &ok);
+	if (!binaryFile || !ok || binaryFile->sectionSize(section) < 0) {
+		reader->raiseError(i18n("invalid binary data section"));
+		return false;
+	}
+
+	if (columnMode() == AbstractColumn::Numeric) {
+		ReadBinaryDataTask* task = new ReadBinaryDataTask(m_column_private, binaryFile, section);
+		QThreadPool::globalInstance()->start(task);
+	}
+
+	return reader->skipToEndElement();
+}
+
 /**
  * \brief Read XML input filter element
  */
@@ -93,6 +93,7 @@ class Column : public AbstractColumn {
 		void setColumnMode(AbstractColumn::ColumnMode mode);
 		bool copy(const AbstractColumn * other);
 		bool copy(const AbstractColumn * source, int source_start, int dest_start, int num_rows);
+		void permuteRows(const QVector<int>& permutation);
 		int rowCount() const;
 		AbstractColumn::PlotDesignation plotDesignation() const;
 		void setPlotDesignation(AbstractColumn::PlotDesignation pd);
@@ -128,7 +129,12 @@ class Column : public AbstractColumn {
 		double valueAt(int row) const;
 		void setValueAt(int row, double new_value);
 		virtual void replaceValues(int first, const QVector<double>& new_values);
+		virtual const double* valueData(int first, int count) const;
+		virtual double minimum() const;
+		virtual double maximum() const;
 		void setChanged();
+		void setRowsAppended(int first);
+		void invalidateProperties();
 		void setSuppressDataChangedSignal(bool);
 
 		void save(QXmlStreamWriter*) const;
@@ -139,6 +145,7 @@ class Column : public AbstractColumn {
 		bool XmlReadOutputFilter(XmlStreamReader * reader);
 		bool XmlReadFormula(XmlStreamReader * reader);
 		bool XmlReadRow(XmlStreamReader * reader);
+		bool XmlReadBinaryData(XmlStreamReader * reader);
 
 		void handleRowInsertion(int before, int count);
 		void handleRowRemoval(int first, int count);
@@ -42,6 +42,8 @@
 #include "backend/core/datatypes/DayOfWeek2DoubleFilter.h"
 #include "backend/core/datatypes/Month2DoubleFilter.h"
 
+#include <cmath>
+
 
 /**
  * \class ColumnPrivate
@@ -95,7 +97,8 @@
  * \brief Ctor
  */
 ColumnPrivate::ColumnPrivate(Column* owner, AbstractColumn::ColumnMode mode)
-	: statisticsAvailable(false), m_column_mode(mode), m_plot_designation(AbstractColumn::NoDesignation), m_width(0), m_owner(owner) {
+	: statisticsAvailable(false), m_column_mode(mode), m_plot_designation(AbstractColumn::NoDesignation), m_width(0), m_owner(owner),
+	m_aggregatesAvailable(false), m_minimum(INFINITY), m_maximum(-INFINITY) {
 	Q_ASSERT(owner != 0); // a ColumnPrivate without owner is not allowed
 	// because the owner must become the parent aspect of the input and output filters
 	switch(mode) {
@@ -138,7 +141,8 @@ ColumnPrivate::ColumnPrivate(Column* owner, AbstractColumn::ColumnMode mode)
  * \brief Special ctor (to be called from Column only!)
  */
 ColumnPrivate::ColumnPrivate(Column* owner, AbstractColumn::ColumnMode mode, void* data)
-	: statisticsAvailable(false), m_column_mode(mode), m_data(data), m_plot_designation(AbstractColumn::NoDesignation), m_width(0), m_owner(owner) {
+	: statisticsAvailable(false), m_column_mode(mode), m_data(data), m_plot_designation(AbstractColumn::NoDesignation), m_width(0), m_owner(owner),
+	m_aggregatesAvailable(false), m_minimum(INFINITY), m_maximum(-INFINITY) {
 
 	switch(mode) {
 	case AbstractColumn::Numeric:
@@ -386,6 +390,7 @@ void ColumnPrivate::setColumnMode(AbstractColumn::ColumnMode mode) {
 
 	if (filter_is_temporary) delete filter;
 
+	invalidateAggregates();
 	emit m_owner->modeChanged(m_owner);
 }
 
@@ -415,6 +420,7 @@ void ColumnPrivate::replaceModeData(AbstractColumn::ColumnMode mode, void * data
 
 	m_column_mode = mode;
 	m_data = data;
+	invalidateAggregates();
 
 	in_filter->setName("InputFilter");
 	out_filter->setName("OutputFilter");
@@ -447,6 +453,9 @@ void ColumnPrivate::replaceModeData(AbstractColumn::ColumnMode mode, void * data
  */
 void ColumnPrivate::replaceData(void * data) {
 	emit m_owner->dataAboutToChange(m_owner);
+	//the commands call this function with the current data pointer to only notify about changes
+	if (data != m_data)
+		invalidateAggregates();
 	m_data = data;
 	if (!m_owner->m_suppressDataChangedSignal)
 		emit m_owner->dataChanged(m_owner);
@@ -465,6 +474,7 @@ bool ColumnPrivate::copy(const AbstractColumn * other) {
 
 	emit m_owner->dataAboutToChange(m_owner);
 	resizeTo(num_rows);
+	invalidateAggregates();
 
 	// copy the data
 	switch(m_column_mode) {
@@ -515,9 +525,11 @@ bool ColumnPrivate::copy(const AbstractColumn * source, int source_start, int de
 	// copy the data
 	switch(m_column_mode) {
 	case AbstractColumn::Numeric: {
+			removeFromAggregates(dest_start, num_rows);
 			double * ptr = static_cast< QVector<double>* >(m_data)->data();
 			for(int i=0; i<num_rows; i++)
 				ptr[dest_start+i] = source->valueAt(source_start + i);
+			addToAggregates(dest_start, num_rows);
 			break;
 		}
 	case AbstractColumn::Text:
@@ -551,6 +563,7 @@ bool ColumnPrivate::copy(const ColumnPrivate * other) {
 
 	emit m_owner->dataAboutToChange(m_owner);
 	resizeTo(num_rows);
+	invalidateAggregates();
 
 	// copy the data
 	switch(m_column_mode) {
@@ -601,9 +614,11 @@ bool ColumnPrivate::copy(const ColumnPrivate * source, int source_start, int des
 	// copy the data
 	switch(m_column_mode) {
 	case AbstractColumn::Numeric: {
+			removeFromAggregates(dest_start, num_rows);
 			double * ptr = static_cast< QVector<double>* >(m_data)->data();
 			for(int i=0; i<num_rows; i++)
 				ptr[dest_start+i] = source->valueAt(source_start + i);
+			addToAggregates(dest_start, num_rows);
 			break;
 		}
 	case AbstractColumn::Text:
@@ -663,7 +678,12 @@ void ColumnPrivate::resizeTo(int new_size) {
 	switch(m_column_mode) {
 	case AbstractColumn::Numeric: {
 			QVector<double> *numeric_data = static_cast< QVector<double>* >(m_data);
-			numeric_data->insert(numeric_data->end(), new_size-old_size, NAN);
+			if (new_size > old_size) {
+				numeric_data->insert(numeric_data->end(), new_size-old_size, NAN);
+			} else {
+				removeFromAggregates(new_size, old_size - new_size);
+				numeric_data->resize(new_size);
+			}
 			break;
 		}
 	case AbstractColumn::DateTime:
@@ -735,6 +755,7 @@ void ColumnPrivate::removeRows(int first, int count) {
 
 		switch(m_column_mode) {
 		case AbstractColumn::Numeric:
+			removeFromAggregates(first, corrected_count);
 			static_cast< QVector<double>* >(m_data)->remove(first, corrected_count);
 			break;
 		case AbstractColumn::DateTime:
@@ -751,6 +772,59 @@ void ColumnPrivate::removeRows(int first, int count) {
 	}
 }
 
+/**
+ * \brief Reorder the first permutation.size() rows, row i gets the value of row permutation[i]
+ *
+ * With \c inverse, row permutation[i] gets the value of row i. The column needs to have at least permutation.size() rows.
+ * The aggregates don't change.
+ */
+void ColumnPrivate::permuteRows(const QVector<int>& permutation, bool inverse) {
+	const int count = permutation.size();
+	emit m_owner->dataAboutToChange(m_owner);
+
+	switch(m_column_mode) {
+	case AbstractColumn::Numeric: {
+			QVector<double>* data = static_cast< QVector<double>* >(m_data);
+			const QVector<double> old_values = *data;
+			double* ptr = data->data();
+			for (int i = 0; i < count; ++i) {
+				if (inverse)
+					ptr[permutation.at(i)] = old_values.at(i);
+				else
+					ptr[i] = old_values.at(permutation.at(i));
+			}
+			break;
+		}
+	case AbstractColumn::Text: {
+			QStringList* data = static_cast< QStringList* >(m_data);
+			const QStringList old_values = *data;
+			for (int i = 0; i < count; ++i) {
+				if (inverse)
+					(*data)[permutation.at(i)] = old_values.at(i);
+				else
+					(*data)[i] = old_values.at(permutation.at(i));
+			}
+			break;
+		}
+	case AbstractColumn::DateTime:
+	case AbstractColumn::Month:
+	case AbstractColumn::Day: {
+			QList<QDateTime>* data = static_cast< QList<QDateTime>* >(m_data);
+			const QList<QDateTime> old_values = *data;
+			for (int i = 0; i < count; ++i) {
+				if (inverse)
+					(*data)[permutation.at(i)] = old_values.at(i);
+				else
+					(*data)[i] = old_values.at(permutation.at(i));
+			}
+			break;
+		}
+	}
+
+	if (!m_owner->m_suppressDataChangedSignal)
+		emit m_owner->dataChanged(m_owner);
+}
+
 //! Return the column name
 QString ColumnPrivate::name() const {
 	return m_owner->name();
@@ -1060,7 +1134,9 @@ void ColumnPrivate::setValueAt(int row, double new_value) {
 	if (row >= rowCount())
 		resizeTo(row+1);
 
+	removeFromAggregates(row, 1);
 	static_cast< QVector<double>* >(m_data)->replace(row, new_value);
+	addToAggregates(row, 1);
 	if (!m_owner->m_suppressDataChangedSignal)
 		emit m_owner->dataChanged(m_owner);
 }
@@ -1078,9 +1154,11 @@ void ColumnPrivate::replaceValues(int first, const QVector<double>& new_values)
 	if (first + num_rows > rowCount())
 		resizeTo(first + num_rows);
 
+	removeFromAggregates(first, num_rows);
 	double * ptr = static_cast< QVector<double>* >(m_data)->data();
 	for(int i=0; i<num_rows; i++)
 		ptr[first+i] = new_values.at(i);
+	addToAggregates(first, num_rows);
 
 	if (!m_owner->m_suppressDataChangedSignal)
 		emit m_owner->dataChanged(m_owner);
@@ -1090,6 +1168,119 @@ void ColumnPrivate::replaceValues(int first, const QVector<double>& new_values)
 //@}
 ////////////////////////////////////////////////////////////////////////////////
 
+////////////////////////////////////////////////////////////////////////////////
+//! \name cached aggregates
+//@{
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Return the smallest value in the column (NaNs are ignored)
+ *
+ * Returns INFINITY if the column doesn't contain any numeric values.
+ */
+double ColumnPrivate::minimum() const {
+	if (!m_aggregatesAvailable)
+		calculateAggregates();
+	return m_minimum;
+}
+
+/**
+ * \brief Return the largest value in the column (NaNs are ignored)
+ *
+ * Returns -INFINITY if the column doesn't contain any numeric values.
+ */
+double ColumnPrivate::maximum() const {
+	if (!m_aggregatesAvailable)
+		calculateAggregates();
+	return m_maximum;
+}
+
+/**
+ * \brief Discard the cached aggregates
+ *
+ * Has to be called when the data was modified directly via the data pointer.
+ * The aggregates are recalculated on the next access.
+ */
+void ColumnPrivate::invalidateAggregates() {
+	m_aggregatesAvailable = false;
+}
+
+/**
+ * \brief Recalculate the aggregates in one pass over all rows
+ */
+void ColumnPrivate::calculateAggregates() const {
+	m_minimum = INFINITY;
+	m_maximum = -INFINITY;
+
+	if (m_column_mode != AbstractColumn::Numeric) {
+		m_aggregatesAvailable = true;
+		return;
+	}
+
+	const QVector<double>* data = static_cast< QVector<double>* >(m_data);
+	const double* ptr = data->constData();
+	const int size = data->size();
+	for (int i = 0; i < size; ++i) {
+		//NaNs fail both comparisons
+		const double val = ptr[i];
+		if (val < m_minimum)
+			m_minimum = val;
+		if (val > m_maximum)
+			m_maximum = val;
+	}
+
+	m_aggregatesAvailable = true;
+}
+
+/**
+ * \brief Add the values in the rows first,...,first+count-1 to the cached aggregates
+ *
+ * To be called after new values were written to these rows.
+ */
+void ColumnPrivate::addToAggregates(int first, int count) {
+	if (!m_aggregatesAvailable || m_column_mode != AbstractColumn::Numeric)
+		return;
+
+	const QVector<double>* data = static_cast< QVector<double>* >(m_data);
+	const int last = qMin(first + count, data->size());
+	const double* ptr = data->constData();
+	for (int i = first; i < last; ++i) {
+		//NaNs fail both comparisons
+		const double val = ptr[i];
+		if (val < m_minimum)
+			m_minimum = val;
+		if (val > m_maximum)
+			m_maximum = val;
+	}
+}
+
+/**
+ * \brief Remove the values in the rows first,...,first+count-1 from the cached aggregates
+ *
+ * To be called before these rows are overwritten or removed.
+ * If one of the values is the current minimum or maximum,
+ * the aggregates are invalidated and recalculated on the next access.
+ */
+void ColumnPrivate::removeFromAggregates(int first, int count) {
+	if (!m_aggregatesAvailable || m_column_mode != AbstractColumn::Numeric)
+		return;
+
+	const QVector<double>* data = static_cast< QVector<double>* >(m_data);
+	const int last = qMin(first + count, data->size());
+	const double* ptr = data->constData();
+	for (int i = first; i < last; ++i) {
+		const double val = ptr[i];
+		if (val <= m_minimum || val >= m_maximum) {
+			m_aggregatesAvailable = false;
+			return;
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//@}
+////////////////////////////////////////////////////////////////////////////////
+
 /**
  * \brief Return the interval attribute representing the formula strings
  */
@@ -54,6 +54,7 @@ class ColumnPrivate: QObject {
 		void resizeTo(int new_size);
 		void insertRows(int before, int count);
 		void removeRows(int first, int count);
+		void permuteRows(const QVector<int>& permutation, bool inverse);
 		QString name() const;
 		AbstractColumn::PlotDesignation plotDesignation() const;
 		void setPlotDesignation(AbstractColumn::PlotDesignation);
@@ -93,10 +94,18 @@ class ColumnPrivate: QObject {
 		void setValueAt(int row, double new_value);
 		void replaceValues(int first, const QVector<double>& new_values);
 
+		double minimum() const;
+		double maximum() const;
+		void invalidateAggregates();
+		void addToAggregates(int first, int count);
+
 		Column::ColumnStatistics statistics;
 		bool statisticsAvailable;
 
 	private:
+		void calculateAggregates() const;
+		void removeFromAggregates(int first, int count);
+
 		AbstractColumn::ColumnMode m_column_mode;
 		void* m_data;
 		AbstractSimpleFilter* m_input_filter;
@@ -108,6 +117,11 @@ class ColumnPrivate: QObject {
 		AbstractColumn::PlotDesignation m_plot_designation;
 		int m_width;
 		Column* m_owner;
+
+		//cached extrema of the numeric values, updated on changes of single rows and ranges
+		mutable bool m_aggregatesAvailable;
+		mutable double m_minimum;
+		mutable double m_maximum;
 };
 
 #endif
@@ -0,0 +1,104 @@
+/***************************************************************************
+    File                 : column_perf_test.cpp
+    Project              : LabPlot
+    Description          : performance test of the row-wise and the spanwise access to the column data
+    --------------------------------------------------------------------
+    Copyright            : (C) 2017 LabPlot developers
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "backend/core/column/Column.h"
+
+#include <QElapsedTimer>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+
+/* number of rows: 10^MINEXP .. 10^MAXEXP (can be limited with the first argument) */
+#define MINEXP 4
+#define MAXEXP 7
+
+/* sum of the valid and non masked values, read row by row */
+static double sumRows(const AbstractColumn* column) {
+	double sum = 0;
+	for (int row = 0; row < column->rowCount(); ++row) {
+		if (column->isMasked(row) || !column->isValid(row))
+			continue;
+		sum += column->valueAt(row);
+	}
+	return sum;
+}
+
+/* sum of the valid and non masked values, read spanwise */
+static double sumSpans(const AbstractColumn* column) {
+	double sum = 0;
+	const Interval<int> range(0, column->rowCount() - 1);
+	foreach (const Interval<int>& interval, column->unmaskedIntervals(range)) {
+		AbstractColumn::SpanReader reader(column, interval.start(), interval.end());
+		while (reader.next()) {
+			const double* values = reader.values();
+			for (int i = 0; i < reader.count(); ++i) {
+				if (!std::isnan(values[i]))
+					sum += values[i];
+			}
+		}
+	}
+	return sum;
+}
+
+int main(int argc, char *argv[]) {
+	int maxexp = MAXEXP;
+	if (argc > 1)
+		maxexp = atoi(argv[1]);
+
+	printf("%10s %12s %12s %12s %12s\n", "n", "rows (ms)", "spans (ms)", "min (ms)", "max (ms)");
+	int n = 1;
+	for (int exp = 0; exp < MINEXP; exp++)
+		n *= 10;
+	for (int exp = MINEXP; exp <= maxexp; exp++, n *= 10) {
+		/* noisy signal with some invalid values and a masked block */
+		QVector<double> data(n);
+		srand(1);
+		for (int i = 0; i < n; i++)
+			data[i] = (i % 1000 == 0) ? NAN : 100.*sin(20.*M_PI*i/n) + (double)rand()/RAND_MAX;
+
+		Column column("x", data);
+		column.setMasked(Interval<int>(n/4, n/4 + n/10));
+
+		QElapsedTimer timer;
+		timer.start();
+		const double rowSum = sumRows(&column);
+		const qint64 rows = timer.restart();
+		const double spanSum = sumSpans(&column);
+		const qint64 spans = timer.restart();
+		column.AbstractColumn::minimum();
+		const qint64 min = timer.restart();
+		column.AbstractColumn::maximum();
+		const qint64 max = timer.restart();
+
+		if (rowSum != spanSum)
+			printf("%10d sums differ: %g != %g\n", n, rowSum, spanSum);
+		printf("%10d %12lld %12lld %12lld %12lld\n", n, rows, spans, min, max);
+	}
+
+	return 0;
+}
@@ -32,6 +32,40 @@
 #include <KLocale>
 #include <cmath>
 
+/*!
+ * replaces all values of the numeric column \c col by \c values.
+ */
+static void replaceAllValues(ColumnPrivate* col, const QVector<double>& values) {
+	col->replaceValues(0, values);
+	col->resizeTo(values.size());
+	col->replaceData(col->dataPointer());
+}
+
+/*!
+ * estimates the memory used by the data of the backup column \c col.
+ */
+static qint64 dataCost(const ColumnPrivate* col) {
+	if (!col)
+		return 0;
+
+	qint64 cost = 0;
+	switch (col->columnMode()) {
+	case AbstractColumn::Numeric:
+		cost = col->rowCount()*(qint64)sizeof(double);
+		break;
+	case AbstractColumn::Text:
+		for (int i = 0; i < col->rowCount(); ++i)
+			cost += sizeof(QString) + col->textAt(i).size()*(qint64)sizeof(QChar);
+		break;
+	case AbstractColumn::DateTime:
+	case AbstractColumn::Month:
+	case AbstractColumn::Day:
+		cost = col->rowCount()*(qint64)(sizeof(QDateTime) + 16);
+		break;
+	}
+	return cost;
+}
+
 /** ***************************************************************************
  * \class ColumnSetModeCmd
  * \brief Set the column mode
@@ -204,11 +238,16 @@ void ColumnSetModeCmd::undo() {
  * replacement without too much copying.
  */
 
+/**
+ * \var ColumnFullCopyCmd::m_delta
+ * \brief Difference between the old and the new values of a numeric column, used instead of the backup column
+ */
+
 /**
  * \brief Ctor
  */
 ColumnFullCopyCmd::ColumnFullCopyCmd(ColumnPrivate * col, const AbstractColumn * src, QUndoCommand * parent )
-	: QUndoCommand( parent ), m_col(col), m_src(src), m_backup(0), m_backup_owner(0) {
+	: BudgetedUndoCommand( parent ), m_col(col), m_src(src), m_backup(0), m_backup_owner(0) {
 	setText(i18n("%1: change cell values", col->name()));
 }
 
@@ -224,6 +263,20 @@ ColumnFullCopyCmd::~ColumnFullCopyCmd() {
  * \brief Execute the command
  */
 void ColumnFullCopyCmd::redo() {
+	Q_ASSERT(!m_released);
+
+	if (m_col->columnMode() == AbstractColumn::Numeric) {
+		QVector<double>* data = static_cast< QVector<double>* >(m_col->dataPointer());
+		if (m_delta.isEmpty()) {
+			//the copy shares the old values until copy() detaches the column data
+			const QVector<double> old_values = *data;
+			m_col->copy(m_src);
+			m_delta.encode(old_values.constData(), old_values.size(), data->constData(), data->size());
+		} else
+			replaceAllValues(m_col, m_delta.apply(data->constData(), true));
+		return;
+	}
+
 	if(m_backup == 0) {
 		m_backup_owner = new Column("temp", m_src->columnMode());
 		m_backup = new ColumnPrivate(m_backup_owner, m_src->columnMode());
@@ -241,12 +294,32 @@ void ColumnFullCopyCmd::redo() {
  * \brief Undo the command
  */
 void ColumnFullCopyCmd::undo() {
+	Q_ASSERT(!m_released);
+
+	if (m_col->columnMode() == AbstractColumn::Numeric) {
+		const QVector<double>* data = static_cast< QVector<double>* >(m_col->dataPointer());
+		replaceAllValues(m_col, m_delta.apply(data->constData(), false));
+		return;
+	}
+
 	// swap data of orig. column and backup
 	void * data_temp = m_col->dataPointer();
 	m_col->replaceData(m_backup->dataPointer());
 	m_backup->replaceData(data_temp);
 }
 
+qint64 ColumnFullCopyCmd::memoryCost() const {
+	return m_delta.memoryCost() + dataCost(m_backup);
+}
+
+void ColumnFullCopyCmd::releaseMemory() {
+	m_delta.clear();
+	delete m_backup;
+	delete m_backup_owner;
+	m_backup = 0;
+	m_backup_owner = 0;
+}
+
 /** ***************************************************************************
  * \class ColumnPartialCopyCmd
  * \brief Copy parts of a column
@@ -419,6 +492,11 @@ void ColumnInsertRowsCmd::undo() {
  * replacement without too much copying.
  */
 
+/**
+ * \var ColumnRemoveRowsCmd::m_values
+ * \brief The compressed removed values of a numeric column, used instead of the backup column
+ */
+
 /**
  * \var ColumnRemoveRowsCmd::m_formulas
  * \brief Backup of the formula attribute
@@ -428,7 +506,7 @@ void ColumnInsertRowsCmd::undo() {
  * \brief Ctor
  */
 ColumnRemoveRowsCmd::ColumnRemoveRowsCmd(ColumnPrivate * col, int first, int count, QUndoCommand * parent )
-	: QUndoCommand(parent), m_col(col), m_first(first), m_count(count), m_backup(0) {
+	: BudgetedUndoCommand(parent), m_col(col), m_first(first), m_count(count), m_backup(0), m_backup_owner(0), m_copied(false) {
 }
 
 /**
@@ -443,7 +521,9 @@ ColumnRemoveRowsCmd::~ColumnRemoveRowsCmd() {
  * \brief Execute the command
  */
 void ColumnRemoveRowsCmd::redo() {
-	if(m_backup == 0) {
+	Q_ASSERT(!m_released);
+
+	if(!m_copied) {
 		if(m_first >= m_col->rowCount())
 			m_data_row_count = 0;
 		else if(m_first + m_count > m_col->rowCount())
@@ -452,10 +532,16 @@ void ColumnRemoveRowsCmd::redo() {
 			m_data_row_count = m_count;
 
 		m_old_size = m_col->rowCount();
-		m_backup_owner = new Column("temp", m_col->columnMode());
-		m_backup = new ColumnPrivate(m_backup_owner, m_col->columnMode());
-		m_backup->copy(m_col, m_first, 0, m_data_row_count);
+		if (m_col->columnMode() == AbstractColumn::Numeric) {
+			const QVector<double>* data = static_cast< QVector<double>* >(m_col->dataPointer());
+			m_values.encode(data->constData() + m_first, m_data_row_count, 0, 0);
+		} else {
+			m_backup_owner = new Column("temp", m_col->columnMode());
+			m_backup = new ColumnPrivate(m_backup_owner, m_col->columnMode());
+			m_backup->copy(m_col, m_first, 0, m_data_row_count);
+		}
 		m_formulas = m_col->formulaAttribute();
+		m_copied = true;
 	}
 	m_col->removeRows(m_first, m_count);
 }
@@ -464,12 +550,70 @@ void ColumnRemoveRowsCmd::redo() {
  * \brief Undo the command
  */
 void ColumnRemoveRowsCmd::undo() {
+	Q_ASSERT(!m_released);
+
 	m_col->insertRows(m_first, m_count);
-	m_col->copy(m_backup, 0, m_first, m_data_row_count);
+	if (m_backup)
+		m_col->copy(m_backup, 0, m_first, m_data_row_count);
+	else if (m_data_row_count > 0)
+		m_col->replaceValues(m_first, m_values.apply(0, false));
 	m_col->resizeTo(m_old_size);
 	m_col->replaceFormulas(m_formulas);
 }
 
+qint64 ColumnRemoveRowsCmd::memoryCost() const {
+	return m_values.memoryCost() + dataCost(m_backup);
+}
+
+void ColumnRemoveRowsCmd::releaseMemory() {
+	m_values.clear();
+	delete m_backup;
+	delete m_backup_owner;
+	m_backup = 0;
+	m_backup_owner = 0;
+	m_formulas.clear();
+}
+
+/** ***************************************************************************
+ * \class ColumnPermuteRowsCmd
+ * \brief Reorder the rows of a column
+ *
+ * Row i gets the value of the row permutation[i]. Only the permutation is stored,
+ * it is shared with the commands for the other columns sorted in the same way.
+ ** ***************************************************************************/
+
+/**
+ * \var ColumnPermuteRowsCmd::m_row_count
+ * \brief The number of rows before the command, the column is extended to the size of the permutation
+ */
+
+/**
+ * \brief Ctor
+ */
+ColumnPermuteRowsCmd::ColumnPermuteRowsCmd(ColumnPrivate* col, const QVector<int>& permutation, QUndoCommand* parent)
+	: QUndoCommand(parent), m_col(col), m_permutation(permutation), m_row_count(0) {
+	setText(i18n("%1: reorder rows", col->name()));
+}
+
+/**
+ * \brief Execute the command
+ */
+void ColumnPermuteRowsCmd::redo() {
+	m_row_count = m_col->rowCount();
+	if (m_row_count < m_permutation.size())
+		m_col->resizeTo(m_permutation.size());
+	m_col->permuteRows(m_permutation, false);
+}
+
+/**
+ * \brief Undo the command
+ */
+void ColumnPermuteRowsCmd::undo() {
+	m_col->permuteRows(m_permutation, true);
+	m_col->resizeTo(m_row_count);
+	m_col->replaceData(m_col->dataPointer());
+}
+
 /** ***************************************************************************
  * \class ColumnSetPlotDesignationCmd
  * \brief Sets a column's plot designation
@@ -1007,8 +1151,8 @@ void ColumnReplaceTextsCmd::undo() {
  */
 
 /**
- * \var ColumnReplaceValuesCmd::m_old_values
- * \brief The old values
+ * \var ColumnReplaceValuesCmd::m_delta
+ * \brief Difference between the old and the new values, the new values are only kept until the first redo
  */
 
 /**
@@ -1025,7 +1169,7 @@ void ColumnReplaceTextsCmd::undo() {
  * \brief Ctor
  */
 ColumnReplaceValuesCmd::ColumnReplaceValuesCmd(ColumnPrivate * col, int first, const QVector<double>& new_values, QUndoCommand * parent )
-	: QUndoCommand( parent ), m_col(col), m_first(first), m_new_values(new_values) {
+	: BudgetedUndoCommand( parent ), m_col(col), m_first(first), m_new_values(new_values) {
 	setText(i18n("%1: replace the values for rows %2 to %3", col->name(), first, first + new_values.count() -1));
 	m_copied = false;
 }
@@ -1034,23 +1178,41 @@ ColumnReplaceValuesCmd::ColumnReplaceValuesCmd(ColumnPrivate * col, int first, c
  * \brief Execute the command
  */
 void ColumnReplaceValuesCmd::redo() {
+	Q_ASSERT(!m_released);
+
+	const QVector<double>* data = static_cast< QVector<double>* >(m_col->dataPointer());
 	if(!m_copied) {
-		m_old_values = static_cast< QVector<double>* >(m_col->dataPointer())->mid(m_first, m_new_values.count());
 		m_row_count = m_col->rowCount();
+		const int old_count = qBound(0, m_row_count - m_first, m_new_values.count());
+		m_delta.encode(data->constData() + qMin(m_first, m_row_count), old_count, m_new_values.constData(), m_new_values.count());
+		m_col->replaceValues(m_first, m_new_values);
+		m_new_values.clear();
 		m_copied = true;
-	}
-	m_col->replaceValues(m_first, m_new_values);
+	} else
+		m_col->replaceValues(m_first, m_delta.apply(data->constData() + qMin(m_first, data->size()), true));
 }
 
 /**
  * \brief Undo the command
  */
 void ColumnReplaceValuesCmd::undo() {
-	m_col->replaceValues(m_first, m_old_values);
+	Q_ASSERT(!m_released);
+
+	const QVector<double>* data = static_cast< QVector<double>* >(m_col->dataPointer());
+	m_col->replaceValues(m_first, m_delta.apply(data->constData() + m_first, false));
 	m_col->resizeTo(m_row_count);
 	m_col->replaceData(m_col->dataPointer());
 }
 
+qint64 ColumnReplaceValuesCmd::memoryCost() const {
+	return m_delta.memoryCost() + m_new_values.count()*(qint64)sizeof(double);
+}
+
+void ColumnReplaceValuesCmd::releaseMemory() {
+	m_delta.clear();
+	m_new_values.clear();
+}
+
 /** ***************************************************************************
  * \class ColumnReplaceDateTimesCmd
  * \brief Replace a range of date-times in a date-time column
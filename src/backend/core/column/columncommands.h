@@ -32,6 +32,8 @@
 #define COLUMNCOMMANDS_H
 
 #include "backend/lib/IntervalAttribute.h"
+#include "backend/lib/UndoMemoryBudget.h"
+#include "backend/lib/ValuesDelta.h"
 #include "backend/core/column/Column.h"
 
 #include <QUndoCommand>
@@ -62,19 +64,22 @@ private:
 	bool m_executed;
 };
 
-class ColumnFullCopyCmd : public QUndoCommand {
+class ColumnFullCopyCmd : public BudgetedUndoCommand {
 public:
 	explicit ColumnFullCopyCmd(ColumnPrivate* col, const AbstractColumn* src, QUndoCommand* parent = 0);
 	~ColumnFullCopyCmd();
 
 	virtual void redo();
 	virtual void undo();
+	virtual qint64 memoryCost() const;
+	virtual void releaseMemory();
 
 private:
 	ColumnPrivate* m_col;
 	const AbstractColumn* m_src;
 	ColumnPrivate* m_backup;
 	Column* m_backup_owner;
+	ValuesDelta m_delta;
 };
 
 class ColumnPartialCopyCmd : public QUndoCommand {
@@ -110,13 +115,15 @@ private:
 	int m_before, m_count;
 };
 
-class ColumnRemoveRowsCmd : public QUndoCommand {
+class ColumnRemoveRowsCmd : public BudgetedUndoCommand {
 public:
 	explicit ColumnRemoveRowsCmd(ColumnPrivate* col, int first, int count, QUndoCommand* parent = 0);
 	~ColumnRemoveRowsCmd();
 
 	virtual void redo();
 	virtual void undo();
+	virtual qint64 memoryCost() const;
+	virtual void releaseMemory();
 
 private:
 	ColumnPrivate* m_col;
@@ -125,9 +132,24 @@ private:
 	int m_old_size;
 	ColumnPrivate* m_backup;
 	Column* m_backup_owner;
+	ValuesDelta m_values;
+	bool m_copied;
 	IntervalAttribute<QString> m_formulas;
 };
 
+class ColumnPermuteRowsCmd : public QUndoCommand {
+public:
+	explicit ColumnPermuteRowsCmd(ColumnPrivate* col, const QVector<int>& permutation, QUndoCommand* parent = 0);
+
+	virtual void redo();
+	virtual void undo();
+
+private:
+	ColumnPrivate* m_col;
+	QVector<int> m_permutation;
+	int m_row_count;
+};
+
 class ColumnSetPlotDesignationCmd : public QUndoCommand {
 public:
 	explicit ColumnSetPlotDesignationCmd(ColumnPrivate* col, AbstractColumn::PlotDesignation pd, QUndoCommand* parent = 0);
@@ -265,18 +287,20 @@ private:
 	int m_row_count;
 };
 
-class ColumnReplaceValuesCmd : public QUndoCommand {
+class ColumnReplaceValuesCmd : public BudgetedUndoCommand {
 public:
 	explicit ColumnReplaceValuesCmd(ColumnPrivate* col, int first, const QVector<double>& new_values, QUndoCommand* parent = 0);
 
 	virtual void redo();
 	virtual void undo();
+	virtual qint64 memoryCost() const;
+	virtual void releaseMemory();
 
 private:
 	ColumnPrivate* m_col;
 	int m_first;
 	QVector<double> m_new_values;
-	QVector<double> m_old_values;
+	ValuesDelta m_delta;
 	bool m_copied;
 	int m_row_count;
 };
@@ -38,6 +38,7 @@ Copyright	: (C) 2009-2017 Alexander Semke (alexander.semke@web.de)
 #include <QDir>
 #include <QMenu>
 #include <QFileSystemWatcher>
+#include <QTimer>
 
 #include <QIcon>
 #include <QAction>
@@ -51,7 +52,14 @@ Copyright	: (C) 2009-2017 Alexander Semke (alexander.semke@web.de)
 */
 
 FileDataSource::FileDataSource(AbstractScriptingEngine* engine, const QString& name, bool loading)
-	: Spreadsheet(engine, name, loading),m_fileType(Ascii),m_fileWatched(false),m_fileLinked(false),m_filter(0),m_fileSystemWatcher(0) {
+	: Spreadsheet(engine, name, loading),m_fileType(Ascii),m_fileWatched(false),m_fileLinked(false),
+	m_fileFollowed(false),m_keepLastValues(0),m_updateInterval(1000),m_filter(0),m_fileSystemWatcher(0) {
+
+	//the notifications of the file system watcher arriving within the update interval are handled at once
+	m_updateTimer = new QTimer(this);
+	m_updateTimer->setSingleShot(true);
+	connect(m_updateTimer, SIGNAL(timeout()), this, SLOT(update()));
+
 	initActions();
 }
 
@@ -71,6 +79,10 @@ void FileDataSource::initActions() {
 	m_toggleWatchAction->setCheckable(true);
 	connect(m_toggleWatchAction, SIGNAL(triggered()), this, SLOT(watchToggled()));
 
+	m_toggleFollowAction = new QAction(i18n("Follow the file"), this);
+	m_toggleFollowAction->setCheckable(true);
+	connect(m_toggleFollowAction, SIGNAL(triggered()), this, SLOT(followToggled()));
+
 	m_toggleLinkAction = new QAction(i18n("Link the file"), this);
 	m_toggleLinkAction->setCheckable(true);
 	connect(m_toggleLinkAction, SIGNAL(triggered()), this, SLOT(linkToggled()));
@@ -151,6 +163,41 @@ bool FileDataSource::isFileLinked() const {
 	return m_fileLinked;
 }
 
+/*!
+  sets whether only the lines appended to a watched file should be read on file changes (\c b=true)
+  or the whole file (\c b=false). Only available for ASCII files, for other files the whole file is read.
+*/
+void FileDataSource::setFileFollowed(const bool b) {
+	m_fileFollowed=b;
+}
+
+bool FileDataSource::isFileFollowed() const {
+	return m_fileFollowed;
+}
+
+/*!
+  sets the number of the last values to be kept in the columns when the file is followed.
+  \c 0 keeps all values.
+*/
+void FileDataSource::setKeepLastValues(const int n) {
+	m_keepLastValues=n;
+}
+
+int FileDataSource::keepLastValues() const {
+	return m_keepLastValues;
+}
+
+/*!
+  sets the minimal interval (in ms) between two updates of the data source on file changes.
+*/
+void FileDataSource::setUpdateInterval(const int interval) {
+	m_updateInterval=interval;
+}
+
+int FileDataSource::updateInterval() const {
+	return m_updateInterval;
+}
+
 
 QIcon FileDataSource::icon() const {
 	QIcon icon;
@@ -181,6 +228,12 @@ QMenu* FileDataSource::createContextMenu() {
 	m_toggleWatchAction->setChecked(m_fileWatched);
 	menu->insertAction(firstAction, m_toggleWatchAction);
 
+	if (m_fileType == FileDataSource::Ascii) {
+		m_toggleFollowAction->setChecked(m_fileFollowed);
+		m_toggleFollowAction->setEnabled(m_fileWatched);
+		menu->insertAction(firstAction, m_toggleFollowAction);
+	}
+
 	m_toggleLinkAction->setChecked(m_fileLinked);
 	menu->insertAction(firstAction, m_toggleLinkAction);
 
@@ -198,10 +251,38 @@ void FileDataSource::read() {
 		return;
 
 	m_filter->read(m_fileName, this);
+
+	//apply the limit for the number of values
+	if (m_fileFollowed && m_keepLastValues > 0) {
+		AsciiFilter* filter = dynamic_cast<AsciiFilter*>(m_filter);
+		if (filter)
+			filter->readAppended(m_fileName, this, m_keepLastValues);
+	}
+
 	watch();
 }
 
 void FileDataSource::fileChanged() {
+	if (!m_updateTimer->isActive())
+		m_updateTimer->start(m_updateInterval);
+}
+
+/*!
+  updates the data source after file changes. If the file is followed, only the appended lines are read.
+*/
+void FileDataSource::update() {
+	if (m_fileName.isEmpty() || m_filter == 0)
+		return;
+
+	AsciiFilter* filter = dynamic_cast<AsciiFilter*>(m_filter);
+	if (m_fileFollowed && filter) {
+		if (filter->readAppended(m_fileName, this, m_keepLastValues) != -1) {
+			//the path is removed from the watcher if the file was replaced, add it again
+			watch();
+			return;
+		}
+	}
+
 	this->read();
 }
 
@@ -211,6 +292,11 @@ void FileDataSource::watchToggled() {
 	project()->setChanged(true);
 }
 
+void FileDataSource::followToggled() {
+	m_fileFollowed = !m_fileFollowed;
+	project()->setChanged(true);
+}
+
 void FileDataSource::linkToggled() {
 	m_fileLinked = !m_fileLinked;
 	project()->setChanged(true);
@@ -336,6 +422,9 @@ void FileDataSource::save(QXmlStreamWriter* writer) const {
 	writer->writeAttribute( "fileType", QString::number(m_fileType) );
 	writer->writeAttribute( "fileWatched", QString::number(m_fileWatched) );
 	writer->writeAttribute( "fileLinked", QString::number(m_fileLinked) );
+	writer->writeAttribute( "fileFollowed", QString::number(m_fileFollowed) );
+	writer->writeAttribute( "keepLastValues", QString::number(m_keepLastValues) );
+	writer->writeAttribute( "updateInterval", QString::number(m_updateInterval) );
 	writer->writeEndElement();
 
 	//filter
@@ -403,6 +492,19 @@ bool FileDataSource::load(XmlStreamReader* reader) {
 				reader->raiseWarning(attributeWarning.arg("'fileLinked'"));
 			else
 				m_fileLinked = str.toInt();
+
+			//the attributes for following the file are optional
+			str = attribs.value("fileFollowed").toString();
+			if(!str.isEmpty())
+				m_fileFollowed = str.toInt();
+
+			str = attribs.value("keepLastValues").toString();
+			if(!str.isEmpty())
+				m_keepLastValues = str.toInt();
+
+			str = attribs.value("updateInterval").toString();
+			if(!str.isEmpty())
+				m_updateInterval = str.toInt();
 		} else if (reader->name() == "asciiFilter") {
 			m_filter = new AsciiFilter();
 			if (!m_filter->load(reader))
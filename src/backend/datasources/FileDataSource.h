@@ -35,6 +35,7 @@
 class AbstractFileFilter;
 class QFileSystemWatcher;
 class QAction;
+class QTimer;
 
 class FileDataSource : public Spreadsheet {
 	Q_OBJECT
@@ -57,6 +58,15 @@ class FileDataSource : public Spreadsheet {
 		void setFileLinked(const bool);
 		bool isFileLinked() const;
 
+		void setFileFollowed(const bool);
+		bool isFileFollowed() const;
+
+		void setKeepLastValues(const int);
+		int keepLastValues() const;
+
+		void setUpdateInterval(const int);
+		int updateInterval() const;
+
 		void setFileName(const QString&);
 		QString fileName() const;
 
@@ -78,12 +88,17 @@ class FileDataSource : public Spreadsheet {
 		FileType m_fileType;
 		bool m_fileWatched;
 		bool m_fileLinked;
+		bool m_fileFollowed;
+		int m_keepLastValues;
+		int m_updateInterval;
 		AbstractFileFilter* m_filter;
 		QFileSystemWatcher* m_fileSystemWatcher;
+		QTimer* m_updateTimer;
 
 		QAction* m_reloadAction;
 		QAction* m_toggleLinkAction;
 		QAction* m_toggleWatchAction;
+		QAction* m_toggleFollowAction;
 		QAction* m_showEditorAction;
 		QAction* m_showSpreadsheetAction;
 
@@ -92,7 +107,9 @@ class FileDataSource : public Spreadsheet {
 
 	private slots:
 		void fileChanged();
+		void update();
 		void watchToggled();
+		void followToggled();
 		void linkToggled();
 
 	signals:
@@ -36,7 +36,133 @@ Copyright            : (C) 2009-2015 Alexander Semke (alexander.semke@web.de)
 #include <KLocale>
 #include <KFilterDev>
 
+#include <QAtomicInt>
+#include <QFile>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
 #include <cmath>
+#include <cstring>
+#include <limits>
+
+//size of the blocks read from compressed files and of the ranges of a memory-mapped file
+//that are parsed between two progress notifications
+static const int blockSize = 4*1024*1024;
+
+static inline bool isSpace(char c) {
+	return (c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f');
+}
+
+/*!
+	returns \c true if the file \c fileName is compressed with gzip, bzip2 or xz.
+*/
+static bool isCompressed(const QString& fileName) {
+	QFile file(fileName);
+	if (!file.open(QIODevice::ReadOnly))
+		return false;
+
+	const QByteArray magic = file.read(6);
+	return (magic.startsWith("\x1f\x8b") || magic.startsWith("BZh") || magic.startsWith("\xfd" "7zXZ"));
+}
+
+/*!
+	locale independent conversion of the characters in [begin, end) to a double.
+	Leading and trailing whitespaces are ignored.
+
+	Numbers with up to 19 significant digits and a decimal exponent in [-22, 22] are converted
+	directly (exact, since only one rounding operation is involved). All other strings
+	("nan", "inf", long mantissas, large exponents) are converted by QByteArray::toDouble().
+	Returns \c false, if the string is not a number.
+*/
+static bool parseDouble(const char* begin, const char* end, double& value) {
+	static const double powersOf10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+	while (begin < end && isSpace(*begin))
+		++begin;
+	while (end > begin && isSpace(*(end - 1)))
+		--end;
+	if (begin == end)
+		return false;
+
+	const char* p = begin;
+	bool negative = false;
+	if (*p == '+' || *p == '-') {
+		negative = (*p == '-');
+		++p;
+	}
+
+	quint64 mantissa = 0;
+	int digits = 0;
+	int exponent = 0;
+	bool anyDigit = false;
+	bool exact = true;
+
+	//integer part
+	for (; p < end && *p >= '0' && *p <= '9'; ++p) {
+		anyDigit = true;
+		if (digits < 19) {
+			mantissa = 10*mantissa + (*p - '0');
+			if (mantissa)
+				++digits;
+		} else {
+			++exponent;
+			if (*p != '0')
+				exact = false;
+		}
+	}
+
+	//fractional part
+	if (p < end && *p == '.') {
+		for (++p; p < end && *p >= '0' && *p <= '9'; ++p) {
+			anyDigit = true;
+			if (digits < 19) {
+				mantissa = 10*mantissa + (*p - '0');
+				if (mantissa)
+					++digits;
+				--exponent;
+			} else if (*p != '0')
+				exact = false;
+		}
+	}
+
+	//exponent
+	if (anyDigit && p < end && (*p == 'e' || *p == 'E')) {
+		++p;
+		bool negativeExponent = false;
+		if (p < end && (*p == '+' || *p == '-')) {
+			negativeExponent = (*p == '-');
+			++p;
+		}
+		if (p == end || *p < '0' || *p > '9')
+			anyDigit = false;
+		int e = 0;
+		for (; p < end && *p >= '0' && *p <= '9'; ++p) {
+			if (e < 100000)
+				e = 10*e + (*p - '0');
+		}
+		exponent += negativeExponent ? -e : e;
+	}
+
+	if (anyDigit && p == end && exact) {
+		if (mantissa == 0) {
+			value = negative ? -0.0 : 0.0;
+			return true;
+		}
+		if (mantissa <= (Q_UINT64_C(1) << 53) && exponent >= -22 && exponent <= 22) {
+			value = (double)mantissa;
+			value = (exponent < 0) ? value/powersOf10[-exponent] : value*powersOf10[exponent];
+			if (negative)
+				value = -value;
+			return true;
+		}
+	}
+
+	//everything else is handled by Qt's (locale independent) conversion
+	bool ok;
+	value = QByteArray::fromRawData(begin, end - begin).toDouble(&ok);
+	return ok;
+}
 
  /*!
 	\class AsciiFilter
@@ -67,6 +193,18 @@ void AsciiFilter::read(const QString & fileName, AbstractDataSource* dataSource,
 	d->read(fileName, dataSource, importMode);
 }
 
+/*!
+  appends the lines added to the file \c fileName since the last call of read() or readAppended()
+  to the columns of \c dataSource created in read(). An incomplete last line is read again once it's completed.
+  If \c keepLastRows is positive, only the last \c keepLastRows rows are kept in the columns.
+
+  Returns the number of parsed rows or -1 if the file has to be read completely again
+  (compressed or truncated file, changed columns in the data source).
+*/
+int AsciiFilter::readAppended(const QString & fileName, AbstractDataSource* dataSource, int keepLastRows) {
+	return d->readAppended(fileName, dataSource, keepLastRows);
+}
+
 
 /*!
 writes the content of the data source \c dataSource to the file \c fileName.
@@ -135,16 +273,26 @@ int AsciiFilter::columnNumber(const QString & fileName) {
   returns the number of lines in the file \c fileName.
 */
 size_t AsciiFilter::lineNumber(const QString & fileName) {
-	//TODO: compare the speed of this function with the speed of wc from GNU-coreutils.
 	KFilterDev device(fileName);
 	if (!device.open(QIODevice::ReadOnly))
 		return 0;
 
+	//count the line breaks blockwise, a last line without line break is counted too
 	size_t rows = 0;
-	while (!device.atEnd()) {
-		device.readLine();
-		rows++;
+	char last = '\n';
+	QByteArray block(blockSize, Qt::Uninitialized);
+	qint64 size;
+	while ((size = device.read(block.data(), blockSize)) > 0) {
+		const char* p = block.constData();
+		const char* end = p + size;
+		while ((p = static_cast<const char*>(memchr(p, '\n', end - p)))) {
+			++rows;
+			++p;
+		}
+		last = block.at(size - 1);
 	}
+	if (last != '\n')
+		++rows;
 
 	return rows;
 }
@@ -245,9 +393,66 @@ int AsciiFilter::endColumn() const{
 	return d->endColumn;
 }
 
+/*!
+  sets the number of threads used to parse the file. 0 (default) uses one thread per processor core.
+*/
+void AsciiFilter::setThreadCount(const int count) {
+	d->threadCount = count;
+}
+
+int AsciiFilter::threadCount() const{
+	return d->threadCount;
+}
+
 //#####################################################################
 //################### Private implementation ##########################
 //#####################################################################
+/* task class counting the lines in a range of a memory-mapped file */
+class CountLinesTask : public QRunnable {
+public:
+	CountLinesTask(const char* begin, const char* end, size_t& lines)
+		: m_begin(begin), m_end(end), m_lines(lines) {
+	};
+
+	void run() {
+		m_lines = 0;
+		const char* p = m_begin;
+		while ((p = static_cast<const char*>(memchr(p, '\n', m_end - p)))) {
+			++m_lines;
+			++p;
+		}
+	}
+
+private:
+	const char* m_begin;
+	const char* m_end;
+	size_t& m_lines;
+};
+
+/* task class parsing a range of a memory-mapped file into its own columns */
+class ParseLinesTask : public QRunnable {
+public:
+	ParseLinesTask(const AsciiFilterPrivate* filter, const char* begin, const char* end, size_t maxLines,
+			QVector<QVector<double> >& columns, int& rows, QAtomicInt& finished)
+		: m_filter(filter), m_begin(begin), m_end(end), m_maxLines(maxLines),
+		m_columns(columns), m_rows(rows), m_finished(finished) {
+	};
+
+	void run() {
+		m_filter->parseLines(m_begin, m_end, m_maxLines, m_columns, m_rows);
+		m_finished.ref();
+	}
+
+private:
+	const AsciiFilterPrivate* m_filter;
+	const char* m_begin;
+	const char* m_end;
+	size_t m_maxLines;
+	QVector<QVector<double> >& m_columns;
+	int& m_rows;
+	QAtomicInt& m_finished;
+};
+
 AsciiFilterPrivate::AsciiFilterPrivate(AsciiFilter* owner) : q(owner),
 	commentCharacter("#"),
 	separatingCharacter("auto"),
@@ -259,17 +464,62 @@ AsciiFilterPrivate::AsciiFilterPrivate(AsciiFilter* owner) : q(owner),
 	startRow(1),
 	endRow(-1),
 	startColumn(1),
-	endColumn(-1) {
+	endColumn(-1),
+	threadCount(0),
+	m_splitMode(SplitAtWhitespaces),
+	m_firstField(0),
+	m_readPosition(-1),
+	m_readSize(0),
+	m_partialRows(0),
+	m_columnOffset(0),
+	m_columnCount(0) {
+}
+
+/*!
+    determines the separator in the line \c line and splits it accordingly.
+    The result of the split is returned in \c lineStringList.
+*/
+QString AsciiFilterPrivate::determineSeparator(const QString& line, QStringList& lineStringList) {
+	QString separator;
+	if (separatingCharacter == "auto") {
+		QRegExp regExp("(\\s+)|(,\\s+)|(;\\s+)|(:\\s+)");
+		lineStringList = line.split(regExp, QString::SplitBehavior(skipEmptyParts));
+
+		//determine the separator
+		DEBUG("auto columns =" << lineStringList.size());
+		if (!lineStringList.isEmpty()) {
+			int length1 = lineStringList.at(0).length();
+			if (lineStringList.size() > 1) {
+				int pos2 = line.indexOf(lineStringList.at(1), length1);
+				separator = line.mid(length1, pos2 - length1);
+			} else {
+				//old: separator = line.right(line.length() - length1);
+				separator = ' ';
+			}
+		}
+	} else {
+		separator = separatingCharacter.replace(QLatin1String("TAB"), QLatin1String(" "), Qt::CaseInsensitive);
+		separator = separator.replace(QLatin1String("SPACE"), QLatin1String(" "), Qt::CaseInsensitive);
+		lineStringList = line.split(separator, QString::SplitBehavior(skipEmptyParts));
+	}
+ 	QDEBUG("separator: " << separator);
+
+	return separator;
 }
 
 /*!
-    reads the content of the file \c fileName to the data source \c dataSource or return as string for preview.
-    Uses the settings defined in the data source.
+    reads the content of the file \c fileName and returns it as strings for the preview.
+    At most \c lines lines are read (all lines, if \c lines is -1).
+    If \c dataSource is not \c NULL, the data is imported into the data source instead (\sa read()).
 */
 QList<QStringList> AsciiFilterPrivate::readData(const QString & fileName, AbstractDataSource* dataSource, AbstractFileFilter::ImportMode mode, int lines) {
+	QList<QStringList> dataStrings;
+	if (dataSource != NULL) {
+		read(fileName, dataSource, mode);
+		return dataStrings;
+	}
 
 	KFilterDev device(fileName);
-	QList<QStringList> dataStrings;
 	if (!device.open(QIODevice::ReadOnly))
 		return dataStrings << (QStringList() << QString());
 
@@ -280,175 +530,586 @@ QList<QStringList> AsciiFilterPrivate::readData(const QString & fileName, Abstra
 	//skip rows, if required
 	for (int i = 0; i < startRow - 1; i++) {
 		//if the number of rows to skip is bigger then the actual number of the rows in the file, then quit the function.
-		if( device.atEnd() ) {
-			if (mode == AbstractFileFilter::Replace) {
-				//file with no data to be imported. In replace-mode clear the data source
-				if (dataSource != NULL)
-					dataSource->clear();
-			}
+		if( device.atEnd() )
 			return dataStrings << (QStringList() << QString());
-		}
 
 		device.readLine();
 	}
 
 	//parse the first row:
-	//use the first row to determine the number of columns,
-	//create the columns and use (optionaly) the first row to name them
-	if( device.atEnd() ) {
-		if (mode == AbstractFileFilter::Replace) {
-			//file with no data to be imported. In replace-mode clear the data source
-			if (dataSource != NULL)
-				dataSource->clear();
-		}
+	//use the first row to determine the number of columns and (optionaly) the names of the columns
+	if( device.atEnd() )
 		return dataStrings << (QStringList() << QString());
-	}
 
 	QString line = device.readLine();
 	if (simplifyWhitespacesEnabled)
 		line = line.simplified();
 
-	// determine separator
-	QString separator;
 	QStringList lineStringList;
-	if (separatingCharacter == "auto") {
-		QRegExp regExp("(\\s+)|(,\\s+)|(;\\s+)|(:\\s+)");
-		lineStringList = line.split(regExp, QString::SplitBehavior(skipEmptyParts));
+	const QString separator = determineSeparator(line, lineStringList);
+ 	DEBUG("headerEnabled =" << headerEnabled);
 
-		//determine the separator
-		DEBUG("auto columns =" << lineStringList.size());
-		if (!lineStringList.isEmpty()) {
-			int length1 = lineStringList.at(0).length();
-			if (lineStringList.size() > 1) {
-				int pos2 = line.indexOf(lineStringList.at(1), length1);
-				separator = line.mid(length1, pos2 - length1);
-			} else {
-				//old: separator = line.right(line.length() - length1);
-				separator = ' ';
-			}
+	if (endColumn == -1)
+		endColumn = lineStringList.size(); //use the last available column index
+	const int actualCols = endColumn - startColumn + 1;
+
+	//number of the last line (in the file) to be read
+	const int lastLine = (endRow == -1) ? std::numeric_limits<int>::max() : endRow;
+	int lineNumber = startRow;
+	if (lines == -1)
+		lines = std::numeric_limits<int>::max();
+
+	DEBUG("start/end column: " << startColumn << endColumn);
+	DEBUG("start/end row: " << startRow << endRow);
+	DEBUG("lines:" << lines);
+
+	int currentRow = 0;
+	bool isNumber;
+
+	//header: show the values in the first line, if they were not used as the header (as the names for the columns)
+	if (!headerEnabled) {
+		QStringList lineString;
+		for (int n = 0; n < actualCols; n++) {
+			const int field = startColumn - 1 + n;
+			if (field < lineStringList.size()) {
+				const double value = lineStringList.at(field).toDouble(&isNumber);
+				isNumber ? lineString << QString::number(value) : lineString << QLatin1String("NAN");
+			} else
+				lineString << QLatin1String("NAN");
 		}
-	} else {
-		separator = separatingCharacter.replace(QLatin1String("TAB"), QLatin1String(" "), Qt::CaseInsensitive);
-		separator = separator.replace(QLatin1String("SPACE"), QLatin1String(" "), Qt::CaseInsensitive);
+		dataStrings << lineString;
+		currentRow++;
+	}
+
+	//Read the remainder of the file.
+	while (currentRow < lines && lineNumber < lastLine && !device.atEnd()) {
+		line = device.readLine();
+		lineNumber++;
+
+		if (simplifyWhitespacesEnabled)
+			line = line.simplified();
+
+		//skip empty lines and comments
+		if (line.trimmed().isEmpty())
+			continue;
+
+		if (!commentCharacter.isEmpty() && line.startsWith(commentCharacter))
+			continue;
+
 		lineStringList = line.split(separator, QString::SplitBehavior(skipEmptyParts));
+
+		// TODO : read strings (comments) or datetime too
+		QStringList lineString;
+		for (int n = 0; n < actualCols; n++) {
+			const int field = startColumn - 1 + n;
+			if (field < lineStringList.size()) {
+				const double value = lineStringList.at(field).toDouble(&isNumber);
+				isNumber ? lineString += QString::number(value) : lineString += QString("NAN");
+			} else
+				lineString += QLatin1String("NAN");
+		}
+
+		dataStrings << lineString;
+		currentRow++;
 	}
- 	QDEBUG("separator: " << separator);
+
+	return dataStrings;
+}
+
+/*!
+    reads the content of the file \c fileName to the data source \c dataSource.
+
+    Uncompressed files are memory-mapped, compressed files are decompressed blockwise.
+    The lines are tokenized in place and the numbers are converted locale independently
+    into column buffers that grow geometrically, so the file is read only once.
+*/
+void AsciiFilterPrivate::read(const QString & fileName, AbstractDataSource* dataSource, AbstractFileFilter::ImportMode mode) {
+	m_readPosition = -1;
+	m_partialRows = 0;
+
+	KFilterDev device(fileName);
+	if (!device.open(QIODevice::ReadOnly))
+		return;
+
+	//skip rows, if required
+	for (int i = 0; i < startRow - 1; i++) {
+		//if the number of rows to skip is bigger then the actual number of the rows in the file, then quit the function.
+		if( device.atEnd() ) {
+			//file with no data to be imported. In replace-mode clear the data source
+			if (mode == AbstractFileFilter::Replace)
+				dataSource->clear();
+			return;
+		}
+
+		device.readLine();
+	}
+
+	//parse the first row:
+	//use the first row to determine the number of columns,
+	//create the columns and use (optionaly) the first row to name them
+	if( device.atEnd() ) {
+		if (mode == AbstractFileFilter::Replace)
+			dataSource->clear();
+		return;
+	}
+
+	const qint64 firstLinePos = device.pos();
+	const QByteArray firstLine = device.readLine();
+	QString line = QString::fromUtf8(firstLine);
+	if (simplifyWhitespacesEnabled)
+		line = line.simplified();
+
+	QStringList lineStringList;
+	const QString separator = determineSeparator(line, lineStringList);
  	DEBUG("headerEnabled =" << headerEnabled);
 
 	if (endColumn == -1)
 		endColumn = lineStringList.size(); //use the last available column index
+	const int actualCols = endColumn - startColumn + 1;
+	if (actualCols < 1)
+		return;
 
 	QStringList vectorNameList;
 	if (headerEnabled) {
-		vectorNameList = lineStringList;
+		vectorNameList = lineStringList.mid(startColumn - 1);
 	} else {
 		//create vector names out of the space separated vectorNames-string, if not empty
 		if (!vectorNames.isEmpty())
 			vectorNameList = vectorNames.split(' ');
 	}
 
-	//qDebug()<<"	vector names ="<<vectorNameList;
-
-	int actualRows = AsciiFilter::lineNumber(fileName);	// data rows
-	int actualEndRow;
-	if (endRow == -1)
-		actualEndRow = actualRows;
-	else if (endRow > actualRows - 1)
-		actualEndRow = actualRows-1;
+	//settings for the tokenizer
+	m_separator = separator.toUtf8();
+	if (simplifyWhitespacesEnabled && separator == QLatin1String(" "))
+		m_splitMode = SplitAtWhitespaces;
+	else if (simplifyWhitespacesEnabled && separator.contains(QRegExp("\\s")))
+		m_splitMode = SplitAtSeparatorSimplified;
 	else
-		actualEndRow = endRow;
-	int actualCols = endColumn - startColumn+1;
+		m_splitMode = SplitAtSeparator;
+	m_comment = commentCharacter.toUtf8();
+	m_firstField = startColumn - 1;
 
-	if (headerEnabled)
-		actualRows = actualEndRow-startRow;
-	else
-		actualRows = actualEndRow-startRow+1;
-	if (lines == -1)
-		lines = actualRows;
+	//the data starts in the first line, if the line is not used as the header
+	const int firstDataLine = headerEnabled ? startRow + 1 : startRow;
+	size_t maxLines = std::numeric_limits<size_t>::max();
+	if (endRow != -1)
+		maxLines = (endRow >= firstDataLine) ? endRow - firstDataLine + 1 : 0;
 
 	DEBUG("start/end column: " << startColumn << endColumn);
-	DEBUG("start/end row: " << startRow << actualEndRow);
-	DEBUG("actual cols/rows: " << actualCols << actualRows);
-	DEBUG("lines:" << lines);
+	DEBUG("start/end row: " << startRow << endRow);
+	DEBUG("split mode: " << m_splitMode);
+
+	QVector<QVector<double> > columns(actualCols);
+	int rows = 0;
+	int progress = 0;
+
+	//memory-map uncompressed files, the data starts at the current position of the device
+	QFile file(fileName);
+	const uchar* map = 0;
+	qint64 fileSize = 0;
+	if (!isCompressed(fileName) && file.open(QIODevice::ReadOnly)) {
+		fileSize = file.size();
+		if (fileSize > 0)
+			map = file.map(0, fileSize);
+	}
 
-	int currentRow = 0; // indexes the position in the vector(column)
-	int columnOffset = 0; // indexes the "start column" in the spreadsheet. Starting from this column the data will be imported.
-	QVector<QVector<double>*> dataPointers;	// pointers to the actual data containers
+	const int threads = (threadCount > 0) ? threadCount : QThread::idealThreadCount();
+	if (map) {
+		const char* begin = reinterpret_cast<const char*>(map);
+		const char* end = begin + fileSize;
+		const char* p = begin + (headerEnabled ? device.pos() : firstLinePos);
+		device.close();
+
+		//if all lines are read, an incomplete last line is parsed separately,
+		//readAppended() continues after the last complete line and parses the incomplete line again
+		const char* lastLine = end;
+		if (endRow == -1) {
+			while (lastLine > p && *(lastLine - 1) != '\n')
+				--lastLine;
+		}
 
-	if (dataSource != NULL)
-		columnOffset = dataSource->create(dataPointers, mode, actualRows, actualCols, vectorNameList);
+		if (threads > 1 && fileSize > 2*blockSize) {
+			readParallel(p, lastLine, maxLines, threads, columns, rows);
+		} else {
+			while (p < lastLine && maxLines > 0) {
+				//parse the next block of complete lines
+				const char* blockEnd = lastLine;
+				if (lastLine - p > blockSize) {
+					blockEnd = static_cast<const char*>(memchr(p + blockSize, '\n', lastLine - p - blockSize));
+					blockEnd = blockEnd ? blockEnd + 1 : lastLine;
+				}
+				maxLines -= parseLines(p, blockEnd, maxLines, columns, rows);
+				p = blockEnd;
+
+				const int newProgress = 100*(p - begin)/fileSize;
+				if (newProgress != progress) {
+					progress = newProgress;
+					emit q->completed(progress);
+				}
+			}
+		}
 
-	//header: import the values in the first line, if they were not used as the header (as the names for the columns)
-	bool isNumber;
-	if (!headerEnabled) {
-		QStringList lineString;
-		for (int n=0; n < actualCols; n++) {
-			if (n < lineStringList.size()) {
-				const double value = lineStringList.at(n).toDouble(&isNumber);
-				if (dataSource != NULL)
-					isNumber ? dataPointers[n]->operator[](0) = value : dataPointers[n]->operator[](0) = NAN;
-				else
-					isNumber ? lineString << QString::number(value) : lineString << QLatin1String("NAN");
-			} else {
-				if (dataSource != NULL)
-					dataPointers[n]->operator[](0) = NAN;
-				else
-					lineString << QLatin1String("NAN");
+		if (endRow == -1) {
+			const int completeRows = rows;
+			parseLines(lastLine, end, maxLines, columns, rows);
+			m_partialRows = rows - completeRows;
+			m_readPosition = lastLine - begin;
+			m_readSize = fileSize;
+		}
+		file.unmap(const_cast<uchar*>(map));
+	} else {
+		//compressed file: decompress and parse blockwise,
+		//the incomplete last line of a block is moved to the beginning of the next one.
+		//the size of the uncompressed data is not known, the progress is only reported at the end.
+		QByteArray buffer;
+		if (!headerEnabled)
+			buffer = firstLine;
+		while (maxLines > 0) {
+			const int oldSize = buffer.size();
+			buffer.resize(oldSize + blockSize);
+			const qint64 bytesRead = device.read(buffer.data() + oldSize, blockSize);
+			buffer.resize(oldSize + qMax(bytesRead, qint64(0)));
+			const bool atEnd = (bytesRead <= 0);
+
+			const char* begin = buffer.constData();
+			const char* end = buffer.constData() + buffer.size();
+			const char* blockEnd = end;
+			if (!atEnd) {
+				//parse up to the last complete line
+				blockEnd = end;
+				while (blockEnd > begin && *(blockEnd - 1) != '\n')
+					--blockEnd;
 			}
+			maxLines -= parseLines(begin, blockEnd, maxLines, columns, rows);
+			if (atEnd)
+				break;
+
+			buffer.remove(0, blockEnd - begin);
 		}
-		dataStrings << lineString;
-		currentRow++;
 	}
+	emit q->completed(100);
 
-	//Read the remainder of the file.
-	for (int i=currentRow; i < qMin(lines,actualRows); i++) {
-		line = device.readLine();
+	DEBUG("imported rows: " << rows);
 
-		if (simplifyWhitespacesEnabled)
-			line = line.simplified();
+	//create the columns in the data source and move the parsed data into them
+	QVector<QVector<double>*> dataPointers;	// pointers to the actual data containers
+	const int columnOffset = dataSource->create(dataPointers, mode, rows, actualCols, vectorNameList);
+	for (int n = 0; n < actualCols; n++) {
+		columns[n].resize(rows);
+		columns[n].squeeze();
+		dataPointers[n]->swap(columns[n]);
+	}
+	m_columnOffset = columnOffset;
+	m_columnCount = actualCols;
 
-		//skip empty lines
-		if (line.isEmpty())
-			continue;
+	finalizeImport(dataSource, mode, columnOffset, rows);
+}
+
+/*!
+    parses the bytes appended to the file \c fileName since the last import and appends the rows
+    to the columns of the spreadsheet \c dataSource (\sa AsciiFilter::readAppended()).
+    The data is written directly into the columns, the undo stack is not used.
+*/
+int AsciiFilterPrivate::readAppended(const QString & fileName, AbstractDataSource* dataSource, int keepLastRows) {
+	Spreadsheet* spreadsheet = dynamic_cast<Spreadsheet*>(dataSource);
+	if (!spreadsheet || m_readPosition < 0 || m_columnCount < 1
+			|| m_columnOffset + m_columnCount > spreadsheet->columnCount())
+		return -1;
+
+	QFile file(fileName);
+	if (!file.open(QIODevice::ReadOnly))
+		return -1;
+
+	//the file was truncated or replaced
+	const qint64 fileSize = file.size();
+	if (fileSize < m_readSize)
+		return -1;
+	if (fileSize == m_readSize && keepLastRows <= 0)
+		return 0;
+
+	//the columns must not have been changed in the meantime
+	QVector<Column*> targetColumns;
+	QVector<QVector<double>*> dataPointers;
+	for (int n = 0; n < m_columnCount; ++n) {
+		Column* column = spreadsheet->column(m_columnOffset + n);
+		if (column->columnMode() != AbstractColumn::Numeric)
+			return -1;
+		targetColumns << column;
+		dataPointers << static_cast<QVector<double>*>(column->data());
+		if (dataPointers[n]->size() != dataPointers[0]->size())
+			return -1;
+	}
+	const int oldRows = dataPointers[0]->size();
+	if (oldRows < m_partialRows)
+		return -1;
+
+	QByteArray buffer;
+	if (fileSize > m_readPosition) {
+		if (!file.seek(m_readPosition))
+			return -1;
+		buffer = file.read(fileSize - m_readPosition);
+		if (buffer.size() != fileSize - m_readPosition)
+			return -1;
+	}
+
+	const char* begin = buffer.constData();
+	const char* end = begin + buffer.size();
+	const char* lastLine = end;
+	while (lastLine > begin && *(lastLine - 1) != '\n')
+		--lastLine;
+
+	QVector<QVector<double> > columns(m_columnCount);
+	int rows = 0;
+	parseLines(begin, lastLine, std::numeric_limits<size_t>::max(), columns, rows);
+	const int completeRows = rows;
+	parseLines(lastLine, end, std::numeric_limits<size_t>::max(), columns, rows);
+
+	//the rows of the previously parsed incomplete line are replaced.
+	//with a limit, only the last keepLastRows rows of the old and the new rows are kept.
+	const int first = oldRows - m_partialRows;
+	const int newRows = (keepLastRows > 0) ? qMin(rows, keepLastRows) : rows;
+	const int keptRows = (keepLastRows > 0) ? qMin(first, keepLastRows - newRows) : first;
+	for (int n = 0; n < m_columnCount; ++n) {
+		QVector<double>* data = dataPointers[n];
+		data->resize(first);
+		if (keptRows < first)
+			data->remove(0, first - keptRows);
+		data->resize(keptRows + newRows);
+		if (newRows > 0)
+			memcpy(data->data() + keptRows, columns[n].constData() + rows - newRows, newRows*sizeof(double));
+	}
+
+	//notify about the new data. If only rows were appended, the dependent objects process the new rows only.
+	const bool appendedOnly = (m_partialRows == 0 && keptRows == first && newRows == rows);
+	if (!appendedOnly || rows > 0) {
+		for (int n = 0; n < m_columnCount; ++n) {
+			if (appendedOnly)
+				targetColumns[n]->setRowsAppended(first);
+			else
+				targetColumns[n]->setChanged();
+		}
+	}
+
+	m_partialRows = rows - completeRows;
+	m_readPosition += lastLine - begin;
+	m_readSize = fileSize;
+
+	return rows;
+}
+
+/*!
+    parses the data in the byte range [\c begin, \c end) of a memory-mapped file with \c threads threads.
+
+    The range is split into one part per thread at line boundaries. Every part is parsed into separate
+    vectors that are concatenated in the order of the file into \c columns at the end.
+    If only \c maxLines lines are to be read, the lines in the parts are counted first in order to
+    determine the number of lines to be read in every part. The result is the same as for the serial parsing.
+*/
+void AsciiFilterPrivate::readParallel(const char* begin, const char* end, size_t maxLines, int threads,
+		QVector<QVector<double> >& columns, int& rows) const {
+	//split the range at line boundaries
+	QVector<const char*> bounds;
+	bounds << begin;
+	const qint64 partSize = (end - begin)/threads;
+	for (int i = 1; i < threads; ++i) {
+		const char* pos = qMax(begin + i*partSize, bounds.last());
+		const char* lineEnd = static_cast<const char*>(memchr(pos, '\n', end - pos));
+		bounds << (lineEnd ? lineEnd + 1 : end);
+	}
+	bounds << end;
+	const int parts = bounds.size() - 1;
+
+	QThreadPool pool;
+	pool.setMaxThreadCount(threads);
+
+	//number of lines to be read in every part
+	QVector<size_t> partLines(parts, std::numeric_limits<size_t>::max());
+	if (maxLines != std::numeric_limits<size_t>::max()) {
+		QVector<size_t> lineCounts(parts);
+		for (int i = 0; i < parts; ++i)
+			pool.start(new CountLinesTask(bounds.at(i), bounds.at(i+1), lineCounts[i]));
+		pool.waitForDone();
+
+		size_t remaining = maxLines;
+		for (int i = 0; i < parts; ++i) {
+			partLines[i] = remaining;
+			remaining -= qMin(remaining, lineCounts.at(i));
+		}
+	}
+
+	//parse the parts
+	const int cols = columns.size();
+	QVector<QVector<QVector<double> > > partColumns(parts, QVector<QVector<double> >(cols));
+	QVector<int> partRows(parts, 0);
+	QAtomicInt finished(0);
+	for (int i = 0; i < parts; ++i) {
+		if (partLines.at(i) > 0)
+			pool.start(new ParseLinesTask(this, bounds.at(i), bounds.at(i+1), partLines.at(i), partColumns[i], partRows[i], finished));
+		else
+			finished.ref();
+	}
+
+	int progress = 0;
+	while (!pool.waitForDone(100)) {
+		const int newProgress = 100*finished.load()/parts;
+		if (newProgress != progress) {
+			progress = newProgress;
+			emit q->completed(progress);
+		}
+	}
+
+	//concatenate the parts in the order of the file
+	rows = 0;
+	for (int i = 0; i < parts; ++i)
+		rows += partRows.at(i);
+	for (int n = 0; n < cols; ++n) {
+		columns[n].resize(rows);
+		double* data = columns[n].data();
+		for (int i = 0; i < parts; ++i) {
+			memcpy(data, partColumns.at(i).at(n).constData(), partRows.at(i)*sizeof(double));
+			data += partRows.at(i);
+		}
+	}
+}
+
+/*!
+    parses at most \c maxLines lines in the byte range [\c begin, \c end) and appends the values
+    of the data lines to the vectors in \c columns. \c rows is the number of rows already
+    available in \c columns and is incremented for every data line. The vectors are resized
+    geometrically when more space is required, the caller has to resize them to \c rows at the end.
 
-		if (line.startsWith(commentCharacter) == true) {
-			currentRow++;
+    Empty lines and comment lines are skipped.
+    Returns the number of processed lines, including empty lines and comments.
+*/
+size_t AsciiFilterPrivate::parseLines(const char* begin, const char* end, size_t maxLines, QVector<QVector<double> >& columns, int& rows) const {
+	const int cols = columns.size();
+	const int separatorLength = m_separator.size();
+	const char* separator = m_separator.constData();
+	QByteArray simplifiedLine;
+	QVector<double*> data(cols);
+	int capacity = cols ? columns.at(0).size() : 0;
+	for (int n = 0; n < cols; ++n)
+		data[n] = columns[n].data();
+
+	size_t lineCount = 0;
+	const char* lineStart = begin;
+	while (lineStart < end && lineCount < maxLines) {
+		const char* b = lineStart;
+		const char* e = static_cast<const char*>(memchr(lineStart, '\n', end - lineStart));
+		if (e) {
+			lineStart = e + 1;
+		} else {
+			e = end;
+			lineStart = end;
+		}
+		++lineCount;
+
+		if (e > b && *(e - 1) == '\r')
+			--e;
+		if (simplifyWhitespacesEnabled) {
+			while (b < e && isSpace(*b))
+				++b;
+			while (e > b && isSpace(*(e - 1)))
+				--e;
+		}
+
+		//skip empty lines and comments
+		if (b == e)
 			continue;
+		if (!m_comment.isEmpty() && e - b >= m_comment.size() && memcmp(b, m_comment.constData(), m_comment.size()) == 0)
+			continue;
+
+		//grow the columns geometrically
+		if (rows == capacity) {
+			capacity = qMax(1024, 2*capacity);
+			for (int n = 0; n < cols; ++n) {
+				columns[n].resize(capacity);
+				data[n] = columns[n].data();
+			}
 		}
 
-		lineStringList = line.split(separator, QString::SplitBehavior(skipEmptyParts));
+		if (m_splitMode == SplitAtSeparatorSimplified) {
+			//collapse all whitespace sequences to one space, as done by QString::simplified()
+			simplifiedLine.resize(e - b);
+			char* out = simplifiedLine.data();
+			bool space = false;
+			for (const char* p = b; p < e; ++p) {
+				if (isSpace(*p)) {
+					if (!space)
+						*out++ = ' ';
+					space = true;
+				} else {
+					*out++ = *p;
+					space = false;
+				}
+			}
+			b = simplifiedLine.constData();
+			e = out;
+		}
 
-		// TODO : read strings (comments) or datetime too
-		QStringList lineString;
-		for (int n = 0; n < actualCols; n++) {
-			if (n < lineStringList.size()) {
-				const double value = lineStringList.at(n).toDouble(&isNumber);
-				if (dataSource != NULL)
-					isNumber ? dataPointers[n]->operator[](currentRow) = value : dataPointers[n]->operator[](currentRow) = NAN;
-				else
-					isNumber ? lineString += QString::number(value) : lineString += QString("NAN");
+		//split the line and convert the fields
+		int field = 0;
+		int n = 0;
+		const char* fieldStart = b;
+		while (n < cols && fieldStart <= e) {
+			const char* fieldEnd;
+			const char* next;
+			if (m_splitMode == SplitAtWhitespaces) {
+				fieldEnd = fieldStart;
+				while (fieldEnd < e && !isSpace(*fieldEnd))
+					++fieldEnd;
+				next = fieldEnd;
+				while (next < e && isSpace(*next))
+					++next;
+				if (next == e)
+					++next;
 			} else {
-				if (dataSource != NULL)
-					dataPointers[n]->operator[](currentRow) = NAN;
-				else
-					lineString += QLatin1String("NAN");
+				if (separatorLength == 1)
+					fieldEnd = static_cast<const char*>(memchr(fieldStart, *separator, e - fieldStart));
+				else {
+					fieldEnd = fieldStart;
+					while (fieldEnd + separatorLength <= e && memcmp(fieldEnd, separator, separatorLength) != 0)
+						++fieldEnd;
+					if (fieldEnd + separatorLength > e)
+						fieldEnd = 0;
+				}
+				if (!fieldEnd)
+					fieldEnd = e;
+				next = fieldEnd + separatorLength;
+				if (fieldEnd == e)
+					next = e + 1;
+			}
+
+			if (!(skipEmptyParts && fieldEnd == fieldStart)) {
+				if (field >= m_firstField) {
+					double value;
+					data[n][rows] = parseDouble(fieldStart, fieldEnd, value) ? value : NAN;
+					++n;
+				}
+				++field;
 			}
+			fieldStart = next;
 		}
 
-		dataStrings << lineString;
-		currentRow++;
-		emit q->completed(100*currentRow/actualRows);
+		//not available fields
+		for (; n < cols; ++n)
+			data[n][rows] = NAN;
+
+		++rows;
 	}
 
-	if (!dataSource)
-		return dataStrings;
+	return lineCount;
+}
 
+/*!
+    makes the data source undo aware again after the import and notifies about the new data.
+*/
+void AsciiFilterPrivate::finalizeImport(AbstractDataSource* dataSource, AbstractFileFilter::ImportMode mode, int columnOffset, int rows) const {
 	//make everything undo/redo-able again
 	//set the comments for each of the columns
 	Spreadsheet* spreadsheet = dynamic_cast<Spreadsheet*>(dataSource);
 	if (spreadsheet) {
 		//TODO: generalize to different data types
-		const int rows = headerEnabled ? currentRow : currentRow+1;
 		QString comment = i18np("numerical data, %1 element", "numerical data, %1 elements", rows);
 		for (int n=startColumn; n <= endColumn; n++) {
 			Column* column = spreadsheet->column(columnOffset+n-startColumn);
@@ -471,15 +1132,6 @@ QList<QStringList> AsciiFilterPrivate::readData(const QString & fileName, Abstra
 			matrix->setUndoAware(true);
 		}
 	}
-
-	return dataStrings;
-}
-
-/*!
-    reads the content of the file \c fileName to the data source \c dataSource.
-*/
-void AsciiFilterPrivate::read(const QString & fileName, AbstractDataSource* dataSource, AbstractFileFilter::ImportMode mode) {
-	readData(fileName, dataSource, mode);
 }
 
 /*!
@@ -511,6 +1163,7 @@ void AsciiFilter::save(QXmlStreamWriter* writer) const {
 	writer->writeAttribute( "endRow", QString::number(d->endRow) );
 	writer->writeAttribute( "startColumn", QString::number(d->startColumn) );
 	writer->writeAttribute( "endColumn", QString::number(d->endColumn) );
+	writer->writeAttribute( "threadCount", QString::number(d->threadCount) );
 	writer->writeEndElement();
 }
 
@@ -595,5 +1248,8 @@ bool AsciiFilter::load(XmlStreamReader* reader) {
 	else
 		d->endColumn = str.toInt();
 
+	str = attribs.value("threadCount").toString();
+	d->threadCount = str.toInt(); //may be empty
+
 	return true;
 }
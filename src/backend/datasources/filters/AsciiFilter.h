@@ -50,6 +50,7 @@ class AsciiFilter : public AbstractFileFilter{
 			AbstractFileFilter::ImportMode importMode = AbstractFileFilter::Replace);
 	QList<QStringList> readData(const QString & fileName, AbstractDataSource* dataSource,
 			AbstractFileFilter::ImportMode importMode = AbstractFileFilter::Replace, int lines = -1);
+	int readAppended(const QString & fileName, AbstractDataSource* dataSource, int keepLastRows = 0);
 	void write(const QString & fileName, AbstractDataSource* dataSource);
 
 	void loadFilterSettings(const QString&);
@@ -88,6 +89,9 @@ class AsciiFilter : public AbstractFileFilter{
 	void setEndColumn(const int);
 	int endColumn() const;
 
+	void setThreadCount(const int);
+	int threadCount() const;
+
 	virtual void save(QXmlStreamWriter*) const;
 	virtual bool load(XmlStreamReader*);
 
@@ -29,6 +29,8 @@
 #ifndef ASCIIFILTERPRIVATE_H
 #define ASCIIFILTERPRIVATE_H
 
+#include <QVector>
+
 class AbstractDataSource;
 
 class AsciiFilterPrivate {
@@ -38,6 +40,7 @@ class AsciiFilterPrivate {
 
 		void read(const QString & fileName, AbstractDataSource* dataSource, AbstractFileFilter::ImportMode importMode = AbstractFileFilter::Replace);
 		QList <QStringList> readData(const QString & fileName, AbstractDataSource* dataSource, AbstractFileFilter::ImportMode importMode=AbstractFileFilter::Replace, int lines=-1);
+		int readAppended(const QString & fileName, AbstractDataSource* dataSource, int keepLastRows);
 		void write(const QString & fileName, AbstractDataSource* dataSource);
 
 		const AsciiFilter* q;
@@ -55,9 +58,29 @@ class AsciiFilterPrivate {
 		int endRow;
 		int startColumn;
 		int endColumn;
+		int threadCount;
+
+		size_t parseLines(const char* begin, const char* end, size_t maxLines, QVector<QVector<double> >& columns, int& rows) const;
+		void readParallel(const char* begin, const char* end, size_t maxLines, int threads, QVector<QVector<double> >& columns, int& rows) const;
 
 	private:
 		void clearDataSource(AbstractDataSource*) const;
+		QString determineSeparator(const QString& line, QStringList& lineStringList);
+		void finalizeImport(AbstractDataSource*, AbstractFileFilter::ImportMode, int columnOffset, int rows) const;
+
+		//settings of the current import used in parseLines()
+		enum SplitMode {SplitAtWhitespaces, SplitAtSeparator, SplitAtSeparatorSimplified};
+		SplitMode m_splitMode;
+		QByteArray m_separator;
+		QByteArray m_comment;
+		int m_firstField;
+
+		//state of the last import used in readAppended()
+		qint64 m_readPosition;	//offset of the first byte after the last complete line, -1 if not available
+		qint64 m_readSize;	//size of the file when it was read the last time
+		int m_partialRows;	//number of rows parsed from the incomplete last line
+		int m_columnOffset;
+		int m_columnCount;
 };
 
 #endif
@@ -29,11 +29,70 @@ Copyright            : (C) 2015-2017 by Stefan Gerlach (stefan.gerlach@uni.kn)
 #include "backend/datasources/FileDataSource.h"
 #include "backend/core/column/Column.h"
 
-#include <QDataStream>
 #include <QDebug>
+#include <QFile>
+#include <QFileInfo>
 #include <KLocale>
 #include <KFilterDev>
 #include <cmath>
+#include <cstring>
+
+//size of the blocks read from compressed files and converted between two progress notifications
+static const int blockSize = 4*1024*1024;
+
+/*!
+    converts \c rows rows of \c vectors interleaved values of type \c T starting at \c src
+    and stores them in the columns \c columns starting at row \c first.
+    If \c swap is \c true, the byte order of the values is reversed.
+*/
+template <typename T, bool swap>
+static void convertRows(const char* src, int rows, int vectors, double* const* columns, int first) {
+	const size_t rowSize = vectors*sizeof(T);
+	for (int n = 0; n < vectors; ++n) {
+		const char* p = src + n*sizeof(T);
+		double* out = columns[n] + first;
+		for (int i = 0; i < rows; ++i, p += rowSize) {
+			T value;
+			if (swap) {
+				char* bytes = reinterpret_cast<char*>(&value);
+				for (size_t k = 0; k < sizeof(T); ++k)
+					bytes[k] = p[sizeof(T) - 1 - k];
+			} else
+				memcpy(&value, p, sizeof(T));
+			out[i] = value;
+		}
+	}
+}
+
+typedef void (*ConvertFunction)(const char*, int, int, double* const*, int);
+
+template <bool swap>
+static ConvertFunction convertFunction(BinaryFilter::DataType type) {
+	switch (type) {
+	case BinaryFilter::INT8:
+		return convertRows<qint8, swap>;
+	case BinaryFilter::INT16:
+		return convertRows<qint16, swap>;
+	case BinaryFilter::INT32:
+		return convertRows<qint32, swap>;
+	case BinaryFilter::INT64:
+		return convertRows<qint64, swap>;
+	case BinaryFilter::UINT8:
+		return convertRows<quint8, swap>;
+	case BinaryFilter::UINT16:
+		return convertRows<quint16, swap>;
+	case BinaryFilter::UINT32:
+		return convertRows<quint32, swap>;
+	case BinaryFilter::UINT64:
+		return convertRows<quint64, swap>;
+	case BinaryFilter::REAL32:
+		return convertRows<float, swap>;
+	case BinaryFilter::REAL64:
+		return convertRows<double, swap>;
+	}
+
+	return 0;
+}
 
  /*!
 	\class BinaryFilter
@@ -97,23 +156,29 @@ int BinaryFilter::dataSize(BinaryFilter::DataType type) {
 
 /*!
   returns the number of rows (length of vectors) in the file \c fileName.
+  An incomplete last row is counted as a row.
 */
 long BinaryFilter::rowNumber(const QString & fileName, const int vectors, const BinaryFilter::DataType type) {
 	KFilterDev device(fileName);
 	if (!device.open(QIODevice::ReadOnly))
 		return 0;
 
-	long rows=0;
-	while (!device.atEnd()) {
-		// one row
-		for (int i=0; i < vectors; ++i){
-			for (int j=0; j < BinaryFilter::dataSize(type); ++j)
-				device.read(1);
-		}
-		rows++;
+	const qint64 rowSize = (qint64)vectors*BinaryFilter::dataSize(type);
+	if (rowSize <= 0)
+		return 0;
+
+	//the size of uncompressed files is known, compressed files are decompressed blockwise
+	qint64 bytes = 0;
+	if (device.compressionType() == KCompressionDevice::None)
+		bytes = QFileInfo(fileName).size();
+	else {
+		QByteArray buffer(blockSize, 0);
+		qint64 size;
+		while ((size = device.read(buffer.data(), blockSize)) > 0)
+			bytes += size;
 	}
 
-	return rows;
+	return (bytes + rowSize - 1)/rowSize;
 }
 
 ///////////////////////////////////////////////////////////////////////
@@ -216,36 +281,17 @@ QList<QStringList> BinaryFilterPrivate::readData(const QString & fileName, Abstr
 	if (! device.open(QIODevice::ReadOnly))
 		return dataStrings << (QStringList() << i18n("could not open device"));
 
-	QDataStream in(&device);
-
-	if (byteOrder == BinaryFilter::BigEndian)
-		in.setByteOrder(QDataStream::BigEndian);
-	else if (byteOrder == BinaryFilter::LittleEndian)
-		in.setByteOrder(QDataStream::LittleEndian);
-
 	int numRows=BinaryFilter::rowNumber(fileName,vectors,dataType);
+	const int valueSize = BinaryFilter::dataSize(dataType);
+	const qint64 rowSize = (qint64)valueSize*vectors;
 
 	// catch case that skipStartBytes or startRow is bigger than file
-	if (skipStartBytes >= BinaryFilter::dataSize(dataType)*vectors*numRows || startRow > numRows) {
+	if (skipStartBytes >= rowSize*numRows || startRow > numRows) {
 		if (dataSource != NULL)
 			dataSource->clear();
 		return dataStrings << (QStringList() << i18n("data selection empty"));
 	}
 
-	// skip bytes at start
-	for (int i = 0; i < skipStartBytes; i++) {
-		qint8 tmp;
-		in >> tmp;
-	}
-
-	// skip until start row
-	for (int i = 0; i < (startRow-1)*vectors; ++i) {
-		for (int j = 0; j < BinaryFilter::dataSize(dataType); ++j) {
-			qint8 tmp;
-			in >> tmp;
-		}
-	}
-
 	// set range of rows
 	int actualRows;
 	if (endRow == -1)
@@ -257,6 +303,7 @@ QList<QStringList> BinaryFilterPrivate::readData(const QString & fileName, Abstr
 	int actualCols = vectors;
 	if (lines == -1)
 		lines = actualRows;
+	const int readRows = qMin(actualRows, lines);
 #ifndef NDEBUG
 	qDebug()<<"	numRows ="<<numRows;
 	qDebug()<<"	startRow ="<<startRow;
@@ -271,105 +318,72 @@ QList<QStringList> BinaryFilterPrivate::readData(const QString & fileName, Abstr
 	if (dataSource != NULL)
 		columnOffset = dataSource->create(dataPointers, mode, actualRows, actualCols);
 
-	// read data
-	for (int i = 0; i < qMin(actualRows, lines); i++) {
-		QStringList lineString;
-		for (int n = 0; n < actualCols; n++) {
-			switch (dataType) {
-			case BinaryFilter::INT8: {
-				qint8 value;
-				in >> value;
-				if (dataSource != NULL)
-					dataPointers[n]->operator[](i) = value;
-				else
-					lineString << QString::number(value);
-				break;
-			}
-			case BinaryFilter::INT16: {
-				qint16 value;
-				in >> value;
-				if (dataSource != NULL)
-					dataPointers[n]->operator[](i) = value;
-				else
-					lineString << QString::number(value);
-				break;
-			}
-			case BinaryFilter::INT32: {
-				qint32 value;
-				in >> value;
-				if (dataSource != NULL)
-					dataPointers[n]->operator[](i) = value;
-				else
-					lineString << QString::number(value);
-				break;
-			}
-			case BinaryFilter::INT64: {
-				qint64 value;
-				in >> value;
-				if (dataSource != NULL)
-					dataPointers[n]->operator[](i) = value;
-				else
-					lineString << QString::number(value);
-				break;
-			}
-			case BinaryFilter::UINT8: {
-				quint8 value;
-				in >> value;
-				if (dataSource != NULL)
-					dataPointers[n]->operator[](i) = value;
-				else
-					lineString << QString::number(value);
-				break;
-			}
-			case BinaryFilter::UINT16: {
-				quint16 value;
-				in >> value;
-				if (dataSource != NULL)
-					dataPointers[n]->operator[](i) = value;
-				else
-					lineString << QString::number(value);
-				break;
-			}
-			case BinaryFilter::UINT32: {
-				quint32 value;
-				in >> value;
-				if (dataSource != NULL)
-					dataPointers[n]->operator[](i) = value;
-				else
-					lineString << QString::number(value);
-				break;
-			}
-			case BinaryFilter::UINT64: {
-				quint64 value;
-				in >> value;
-				if (dataSource != NULL)
-					dataPointers[n]->operator[](i) = value;
-				else
-					lineString << QString::number(value);
-				break;
-			}
-			case BinaryFilter::REAL32: {
-				float value;
-				in >> value;
-				if (dataSource != NULL)
-					dataPointers[n]->operator[](i) = value;
-				else
-					lineString << QString::number(value);
-				break;
-			}
-			case BinaryFilter::REAL64: {
-				double value;
-				in >> value;
-				if (dataSource != NULL)
-					dataPointers[n]->operator[](i) = value;
-				else
-					lineString << QString::number(value);
+	// the values are converted directly into the columns of the data source (or into temporary columns for the preview)
+	QVector<QVector<double> > previewColumns;
+	QVector<double*> columns(actualCols);
+	for (int n = 0; n < actualCols; n++) {
+		if (dataSource != NULL)
+			columns[n] = dataPointers[n]->data();
+		else {
+			previewColumns << QVector<double>(readRows);
+			columns[n] = previewColumns[n].data();
+		}
+	}
+
+	const bool swap = (byteOrder == BinaryFilter::BigEndian) != (Q_BYTE_ORDER == Q_BIG_ENDIAN);
+	const ConvertFunction convert = swap ? convertFunction<true>(dataType) : convertFunction<false>(dataType);
+
+	// skip bytes at start and until start row
+	const qint64 offset = skipStartBytes + (startRow-1)*rowSize;
+	const int blockRows = qMax(1, (int)(blockSize/rowSize));
+	int row = 0;
+
+	// uncompressed files are memory-mapped, compressed files are decompressed blockwise
+	QFile file(fileName);
+	const uchar* map = 0;
+	if (device.compressionType() == KCompressionDevice::None && file.open(QIODevice::ReadOnly) && file.size() > 0)
+		map = file.map(0, file.size());
+
+	if (map) {
+		device.close();
+		const int availableRows = (int)qMin((qint64)readRows, qMax((file.size() - offset)/rowSize, (qint64)0));
+		const char* src = reinterpret_cast<const char*>(map) + offset;
+		while (row < availableRows) {
+			const int rows = qMin(blockRows, availableRows - row);
+			convert(src + row*rowSize, rows, vectors, columns.constData(), row);
+			row += rows;
+			emit q->completed(100*row/actualRows);
+		}
+		file.unmap(const_cast<uchar*>(map));
+	} else if (device.seek(offset)) {
+		QByteArray buffer(blockRows*rowSize, 0);
+		while (row < readRows) {
+			const int rows = qMin(blockRows, readRows - row);
+			const qint64 bytes = device.read(buffer.data(), rows*rowSize);
+			const int completeRows = (int)(qMax(bytes, (qint64)0)/rowSize);
+			if (completeRows == 0)
 				break;
-			}
-			}
+			convert(buffer.constData(), completeRows, vectors, columns.constData(), row);
+			row += completeRows;
+			emit q->completed(100*row/actualRows);
+		}
+	}
+
+	// values behind the end of the file (incomplete last row) are set to zero
+	for (int n = 0; n < actualCols; n++) {
+		for (int i = row; i < readRows; i++)
+			columns[n][i] = 0;
+	}
+
+	if (dataSource == NULL) {
+		// integers are shown without exponent
+		const bool isInteger = (dataType != BinaryFilter::REAL32 && dataType != BinaryFilter::REAL64);
+		for (int i = 0; i < readRows; i++) {
+			QStringList lineString;
+			for (int n = 0; n < actualCols; n++)
+				lineString << (isInteger ? QString::number(columns[n][i], 'f', 0) : QString::number(columns[n][i]));
+			dataStrings << lineString;
 		}
-		dataStrings << lineString;
-		emit q->completed(100*i/actualRows);
 	}
 
 	if (!dataSource)
@@ -293,24 +293,79 @@ QStringList HDFFilterPrivate::readHDFCompound(hid_t tid) {
 	return dataString;
 }
 
+/*!
+    returns the number of rows of a data set with \c rows rows to be read:
+    starting at \c startRow, up to \c endRow and at most \c lines rows (all rows, if \c lines is -1).
+*/
+int HDFFilterPrivate::selectedRows(int rows, int lines) const {
+	int last = rows;
+	if (endRow != -1)
+		last = qMin(last, endRow);
+	if (lines != -1)
+		last = qMin(last, lines + startRow - 1);
+	return qMax(last - startRow + 1, 0);
+}
+
+/*!
+    returns the number of columns of a data set with \c cols columns to be read (\c startColumn to \c endColumn).
+*/
+int HDFFilterPrivate::selectedColumns(int cols) const {
+	int last = cols;
+	if (endColumn != -1)
+		last = qMin(last, endColumn);
+	return qMax(last - startColumn + 1, 0);
+}
+
+/*!
+    reads the selected rows of the one-dimensional data set \c dataset to \c dataPointer
+    or to a string list (for preview), if \c dataPointer is \c NULL.
+    Only the selected rows are read (hyperslab selection) in chunks of at most MAXCHUNKSIZE values.
+*/
 template <typename T>
 QStringList HDFFilterPrivate::readHDFData1D(hid_t dataset, hid_t type, int rows, int lines, QVector<double> *dataPointer) {
 	DEBUG("readHDFData1D() rows =" << rows << "lines =" << lines);
 	QStringList dataString;
 
-	// we read all rows of data
-	T* data = (T*) malloc(rows*sizeof(T));
-
-	status = H5Dread(dataset, type, H5S_ALL, H5S_ALL, H5P_DEFAULT, data);
-	handleError(status, "H5Dread");
-	DEBUG(" startRow =" << startRow << "endRow =" << endRow);
+	const hsize_t first = startRow - 1;
+	const hsize_t count = selectedRows(rows, lines);
+	DEBUG(" startRow =" << startRow << "endRow =" << endRow << "count =" << count);
 	DEBUG("dataPointer =" << dataPointer);
-	for (int i = startRow-1; i < qMin(endRow, lines+startRow-1); i++) {
-		if (dataPointer != NULL)	// read to data source
-			dataPointer->operator[](i-startRow+1) = data[i];
-		else				// for preview
-			dataString << QString::number(static_cast<double>(data[i]));
+	if (count == 0)
+		return dataString;
+
+	// non-compound values are converted by the library and read directly into the data source
+	const bool direct = (dataPointer != NULL && H5Tget_class(type) != H5T_COMPOUND);
+	const hsize_t chunkSize = qMin(count, (hsize_t)MAXCHUNKSIZE);
+	T* data = direct ? NULL : (T*) malloc(chunkSize*sizeof(T));
+	if (dataPointer == NULL)
+		dataString.reserve(count);
+
+	hid_t dataspace = H5Dget_space(dataset);
+	handleError((int)dataspace, "H5Dget_space");
+	for (hsize_t offset = 0; offset < count; offset += chunkSize) {
+		hsize_t start = first + offset;
+		hsize_t chunk = qMin(chunkSize, count - offset);
+		status = H5Sselect_hyperslab(dataspace, H5S_SELECT_SET, &start, NULL, &chunk, NULL);
+		handleError(status, "H5Sselect_hyperslab");
+		hid_t memspace = H5Screate_simple(1, &chunk, NULL);
+		handleError((int)memspace, "H5Screate_simple");
+
+		if (direct) {
+			status = H5Dread(dataset, H5T_NATIVE_DOUBLE, memspace, dataspace, H5P_DEFAULT, dataPointer->data() + offset);
+			handleError(status, "H5Dread");
+		} else {
+			status = H5Dread(dataset, type, memspace, dataspace, H5P_DEFAULT, data);
+			handleError(status, "H5Dread");
+			for (hsize_t i = 0; i < chunk; i++) {
+				if (dataPointer != NULL)	// read to data source
+					dataPointer->operator[](offset + i) = data[i];
+				else				// for preview
+					dataString << QString::number(static_cast<double>(data[i]));
+			}
+		}
+		H5Sclose(memspace);
 	}
+	H5Sclose(dataspace);
 	free(data);
 
 	return dataString;
@@ -320,9 +375,10 @@ QStringList HDFFilterPrivate::readHDFCompoundData1D(hid_t dataset, hid_t tid, in
 	int members = H5Tget_nmembers(tid);
 	handleError(members, "H5Tget_nmembers");
 
+	const int count = selectedRows(rows, lines);
 	QStringList dataString;
 	if (dataPointer[0] == NULL) {
-		for (int i = 0; i < qMin(rows, lines); i++)
+		for (int i = 0; i < count; i++)
 			dataString <<  QLatin1String("(");
 	}
 
@@ -399,10 +455,10 @@ QStringList HDFFilterPrivate::readHDFCompoundData1D(hid_t dataset, hid_t tid, in
 			mdataString = readHDFData1D<long double>(dataset, ctype, rows, lines, dataP);
 		else {
 			if (dataP != NULL) {
-				for (int i = startRow-1; i < qMin(endRow, lines+startRow-1); i++)
-					dataP->operator[](i-startRow+1) = 0;
+				for (int i = 0; i < count; i++)
+					dataP->operator[](i) = 0;
 			} else {
-				for (int i = 0; i < qMin(rows, lines); i++)
+				for (int i = 0; i < count; i++)
 					mdataString << QLatin1String("_");
 			}
 			H5T_class_t mclass = H5Tget_member_class(tid, m);
@@ -411,7 +467,7 @@ QStringList HDFFilterPrivate::readHDFCompoundData1D(hid_t dataset, hid_t tid, in
 		}
 
 		if (dataPointer[0] == NULL) {
-			for (int i = 0; i < qMin(rows, lines); i++) {
+			for (int i = 0; i < count; i++) {
 				dataString[i] +=  mdataString[i];
 				if (m < members-1)
 					dataString[i] += QLatin1String(",");
@@ -422,39 +478,60 @@ QStringList HDFFilterPrivate::readHDFCompoundData1D(hid_t dataset, hid_t tid, in
 	}
 
 	if (dataPointer[0] == NULL) {
-		for (int i = 0; i < qMin(rows, lines); i++)
+		for (int i = 0; i < count; i++)
 			dataString[i] +=  QLatin1String(")");
 	}
 
 	return dataString;
 }
 
+/*!
+    reads the selected rows and columns of the two-dimensional data set \c dataset to \c dataPointer
+    or to a list of string lists (for preview), if \c dataPointer[0] is \c NULL.
+    Only the selected block is read (hyperslab selection) in chunks of rows with at most MAXCHUNKSIZE values.
+*/
 template <typename T>
 QList<QStringList> HDFFilterPrivate::readHDFData2D(hid_t dataset, hid_t type, int rows, int cols, int lines, QVector< QVector<double>* >& dataPointer) {
 	DEBUG("readHDFData2D() rows =" << rows << "cols =" << cols << "lines =" << lines);
 	QList<QStringList> dataStrings;
 
-	T** data = (T**) malloc(rows*sizeof(T*));
-	data[0] = (T*) malloc(cols*rows*sizeof(T));
-	for (int i = 1; i < rows; i++)
-		data[i] = data[0]+i*cols;
-
-	status = H5Dread(dataset, type, H5S_ALL, H5S_ALL, H5P_DEFAULT, &data[0][0]);
-	handleError(status,"H5Dread");
-
-	for (int i = 0; i < qMin(rows, lines); i++) {
-		QStringList line;
-		line.reserve(cols);
-		for (int j = 0; j < cols; j++) {
-			if (dataPointer[0] != NULL)
-				dataPointer[j-startColumn+1]->operator[](i-startRow+1) = data[i][j];
-			else {
-				line << QString::number(static_cast<double>(data[i][j]));
+	const hsize_t actualRows = selectedRows(rows, lines);
+	const hsize_t actualCols = selectedColumns(cols);
+	if (actualRows == 0 || actualCols == 0)
+		return dataStrings;
+
+	const hsize_t chunkRows = qMax((hsize_t)1, qMin(actualRows, (hsize_t)MAXCHUNKSIZE/actualCols));
+	T* data = (T*) malloc(chunkRows*actualCols*sizeof(T));
+
+	hid_t dataspace = H5Dget_space(dataset);
+	handleError((int)dataspace, "H5Dget_space");
+	for (hsize_t offset = 0; offset < actualRows; offset += chunkRows) {
+		hsize_t start[2] = {startRow - 1 + offset, (hsize_t)startColumn - 1};
+		hsize_t count[2] = {qMin(chunkRows, actualRows - offset), actualCols};
+		status = H5Sselect_hyperslab(dataspace, H5S_SELECT_SET, start, NULL, count, NULL);
+		handleError(status, "H5Sselect_hyperslab");
+		hid_t memspace = H5Screate_simple(2, count, NULL);
+		handleError((int)memspace, "H5Screate_simple");
+
+		status = H5Dread(dataset, type, memspace, dataspace, H5P_DEFAULT, data);
+		handleError(status, "H5Dread");
+		H5Sclose(memspace);
+
+		for (hsize_t i = 0; i < count[0]; i++) {
+			const T* row = data + i*actualCols;
+			if (dataPointer[0] != NULL) {
+				for (hsize_t j = 0; j < actualCols; j++)
+					dataPointer[j]->operator[](offset + i) = row[j];
+			} else {
+				QStringList line;
+				line.reserve(actualCols);
+				for (hsize_t j = 0; j < actualCols; j++)
+					line << QString::number(static_cast<double>(row[j]));
+				dataStrings << line;
 			}
 		}
-		dataStrings << line;
 	}
-	free(data[0]);
+	H5Sclose(dataspace);
 	free(data);
 
 	QDEBUG(dataStrings);
@@ -468,10 +545,12 @@ QList<QStringList> HDFFilterPrivate::readHDFCompoundData2D(hid_t dataset, hid_t
 	handleError(members, "H5Tget_nmembers");
 	DEBUG("members =" << members);
 
+	const int actualRows = selectedRows(rows, lines);
+	const int actualCols = selectedColumns(cols);
 	QList<QStringList> dataStrings;
-	for (int i = 0; i < qMin(rows, lines); i++) {
+	for (int i = 0; i < actualRows; i++) {
 		QStringList lineStrings;
-		for (int j = 0; j < cols; j++)
+		for (int j = 0; j < actualCols; j++)
 			lineStrings << QLatin1String("(");
 		dataStrings << lineStrings;
 	}
@@ -548,9 +627,9 @@ QList<QStringList> HDFFilterPrivate::readHDFCompoundData2D(hid_t dataset, hid_t
 		else if (H5Tequal(mtype, H5T_NATIVE_LDOUBLE))
 			mdataStrings = readHDFData2D<long double>(dataset, ctype, rows, cols, lines, dummy);
 		else {
-			for (int i = 0; i < qMin(rows, lines); i++) {
+			for (int i = 0; i < actualRows; i++) {
 				QStringList lineString;
-				for (int j = 0; j < cols; j++)
+				for (int j = 0; j < actualCols; j++)
 					lineString << QLatin1String("_");
 				mdataStrings << lineString;
 			}
@@ -561,8 +640,8 @@ QList<QStringList> HDFFilterPrivate::readHDFCompoundData2D(hid_t dataset, hid_t
 		status = H5Tclose(ctype);
 		handleError(status, "H5Tclose");
 
-		for (int i = 0; i < qMin(rows, lines); i++) {
-			for (int j = 0; j < cols; j++) {
+		for (int i = 0; i < actualRows; i++) {
+			for (int j = 0; j < actualCols; j++) {
 				dataStrings[i][j] += mdataStrings[i][j];
 				if (m < members-1)
 					dataStrings[i][j] += QLatin1String(",");
@@ -570,8 +649,8 @@ QList<QStringList> HDFFilterPrivate::readHDFCompoundData2D(hid_t dataset, hid_t
 		}
 	}
 
-	for (int i = 0; i < qMin(rows, lines); i++) {
-		for (int j = 0; j < cols; j++)
+	for (int i = 0; i < actualRows; i++) {
+		for (int j = 0; j < actualCols; j++)
 			dataStrings[i][j] += QLatin1String(")");
 	}
 
@@ -1459,7 +1538,7 @@ QList<QStringList> HDFFilterPrivate::readCurrentDataSet(const QString & fileName
 
 			if (dataSource == NULL) {
 				QDEBUG("dataString =" << dataString);
-				for (int i = 0; i < qMin(rows, lines); i++)
+				for (int i = 0; i < dataString.size(); i++)
 					dataStrings << (QStringList() << dataString[i]);
 			}
 
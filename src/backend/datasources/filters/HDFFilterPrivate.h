@@ -57,12 +57,15 @@ class HDFFilterPrivate {
 		int status;
 		const static int MAXNAMELENGTH=1024;
 		const static int MAXSTRINGLENGTH=1024*1024;
+		const static int MAXCHUNKSIZE=1024*1024;	// maximal number of values read at once
 		QList<unsigned long> multiLinkList;	// used to find hard links
 #ifdef HAVE_HDF5
 		void handleError(int err, QString function, QString arg=QString());
 		QString translateHDFOrder(H5T_order_t);
 		QString translateHDFType(hid_t);
 		QString translateHDFClass(H5T_class_t);
+		int selectedRows(int rows, int lines) const;
+		int selectedColumns(int cols) const;
 		QStringList readHDFCompound(hid_t tid);
 		template <typename T> QStringList readHDFData1D(hid_t dataset, hid_t type, int rows, int lines, QVector<double> *dataPointer=NULL);
 		QStringList readHDFCompoundData1D(hid_t dataset, hid_t tid, int rows, int lines,QVector< QVector<double>* >& dataPointer);
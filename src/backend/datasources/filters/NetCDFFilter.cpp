@@ -547,18 +547,20 @@ QList<QStringList> NetCDFFilterPrivate::readCurrentVar(const QString & fileName,
 			if (dataSource != NULL)
 				columnOffset = dataSource->create(dataPointers, mode, actualRows, actualCols);
 
+			// read only the rows to be shown in the preview
+			const int readRows = dataSource ? actualRows : qMax(qMin(actualRows, lines), 0);
 			double* data = 0;
 			if (dataSource)
 				data = dataPointers[0]->data();
 			else
-				data = (double *)malloc(actualRows * sizeof(double));
+				data = (double *)malloc(readRows * sizeof(double));
 
-			size_t start = startRow-1, count = actualRows;
+			size_t start = startRow-1, count = readRows;
 			status = nc_get_vara_double(ncid, varid, &start, &count, data);
 			handleError(status, "nc_get_vara_double");
 
 			if (!dataSource) {
-				for (int i = 0; i < qMin(actualRows, lines); i++)
+				for (int i = 0; i < readRows; i++)
 					dataStrings << (QStringList() << QString::number(data[i]));
 				free(data);
 			}
@@ -589,25 +591,34 @@ QList<QStringList> NetCDFFilterPrivate::readCurrentVar(const QString & fileName,
 			if (dataSource != NULL)
 				columnOffset = dataSource->create(dataPointers, mode, actualRows, actualCols);
 
-			double** data = (double**) malloc(rows * sizeof(double*));
-			data[0] = (double*)malloc( cols * rows * sizeof(double) );
-			for (unsigned int i = 1; i < rows; i++) data[i] = data[0] + i*cols;
-
-			status = nc_get_var_double(ncid, varid, &data[0][0]);
-			handleError(status, "nc_get_var_double");
-			for (int i = 0; i < qMin((int)rows, lines); i++) {
-				QStringList line;
-				for (unsigned int j = 0; j < cols; j++) {
-					if (!dataPointers.isEmpty())
-						dataPointers[j-startColumn+1]->operator[](i-startRow+1) = data[i][j];
-					else {
-						line << QString::number(static_cast<double>(data[i][j]));
+			// read only the selected block (and only the rows to be shown in the preview)
+			// in chunks of rows with at most MAXCHUNKSIZE values
+			const int readRows = dataSource ? actualRows : qMax(qMin(actualRows, lines), 0);
+			if (readRows <= 0 || actualCols <= 0)
+				break;
+			const int chunkRows = qMax(1, qMin(readRows, MAXCHUNKSIZE/actualCols));
+			double* data = (double*) malloc(chunkRows * actualCols * sizeof(double));
+
+			for (int offset = 0; offset < readRows; offset += chunkRows) {
+				size_t start[2] = {(size_t)(startRow - 1 + offset), (size_t)(startColumn - 1)};
+				size_t count[2] = {(size_t)qMin(chunkRows, readRows - offset), (size_t)actualCols};
+				status = nc_get_vara_double(ncid, varid, start, count, data);
+				handleError(status, "nc_get_vara_double");
+
+				for (unsigned int i = 0; i < count[0]; i++) {
+					const double* row = data + i*actualCols;
+					if (!dataPointers.isEmpty()) {
+						for (int j = 0; j < actualCols; j++)
+							dataPointers[j]->operator[](offset + i) = row[j];
+					} else {
+						QStringList line;
+						for (int j = 0; j < actualCols; j++)
+							line << QString::number(row[j]);
+						dataStrings << line;
 					}
 				}
-				dataStrings << line;
-				emit q->completed(100*i/actualRows);
+				emit q->completed(100*(offset + count[0])/readRows);
 			}
-			free(data[0]);
 			free(data);
 
 			break;
@@ -618,6 +629,8 @@ QList<QStringList> NetCDFFilterPrivate::readCurrentVar(const QString & fileName,
 	}
 
 	free(dimids);
+	status = nc_close(ncid);
+	handleError(status, "nc_close");
 
 	if (!dataSource)
 		return dataStrings;
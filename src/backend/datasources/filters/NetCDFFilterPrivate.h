@@ -55,6 +55,7 @@ class NetCDFFilterPrivate {
 
 	private:
 		int status;
+		const static int MAXCHUNKSIZE=1024*1024;	// maximal number of values read at once
 #ifdef HAVE_NETCDF
 		void handleError(int status, QString function);
 		QString translateDataType(nc_type type);
@@ -32,6 +32,11 @@
 
 #include <klocale.h>
 #include <QDebug>
+#include <QAtomicInt>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QSharedPointer>
+#include <QThreadPool>
 
 #include <cmath>
 extern "C" {
@@ -1131,109 +1136,58 @@ QStringList ExpressionParser::getParameter(const QString& expr, const QStringLis
         return parameters;
 }
 
+/*!
+	sets all non-finite values in \c data to NAN.
+ */
+static void setNonFiniteToNAN(double* data, int count) {
+	for (int i = 0; i < count; i++) {
+		if (!std::isfinite(data[i]))
+			data[i] = NAN;
+	}
+}
+
 bool ExpressionParser::evaluateCartesian(const QString& expr, const QString& min, const QString& max,
 										 int count, QVector<double>* xVector, QVector<double>* yVector,
 										 const QStringList& paramNames, const QVector<double>& paramValues) {
 	double xMin = parse(min.toLocal8Bit().data());
 	double xMax = parse(max.toLocal8Bit().data());
 	double step = (xMax - xMin)/(double)(count - 1);
-	const char* func = expr.toLocal8Bit().data();
-	double x, y;
-	gsl_set_error_handler_off();
 
-	for (int i = 0; i < paramNames.size(); ++i)
-		assign_variable(paramNames.at(i).toLocal8Bit().data(), paramValues.at(i));
-
-	for (int i = 0; i < count; i++) {
-		x = xMin + step * i;
-		assign_variable("x", x);
-		y = parse(func);
-
-		if (parse_errors() > 0)
-			return false;
-
-		(*xVector)[i] = x;
-		if (std::isfinite(y))
-			(*yVector)[i] = y;
-		else
-			(*yVector)[i] = NAN;
-	}
+	for (int i = 0; i < count; i++)
+		(*xVector)[i] = xMin + step * i;
 
-	return true;
+	return evaluateCartesian(expr, xVector, yVector, paramNames, paramValues);
 }
 
 bool ExpressionParser::evaluateCartesian(const QString& expr, const QString& min, const QString& max,
 										 int count, QVector<double>* xVector, QVector<double>* yVector) {
-	double xMin = parse(min.toLocal8Bit().data());
-	double xMax = parse(max.toLocal8Bit().data());
-	double step = (xMax - xMin)/(double)(count - 1);
-	const char* func = expr.toLocal8Bit().data();
-	double x, y;
-	gsl_set_error_handler_off();
-
-	for (int i = 0; i < count; i++) {
-		x = xMin + step*i;
-		assign_variable("x", x);
-		y = parse(func);
-
-		if (parse_errors() > 0)
-			return false;
-
-		(*xVector)[i] = x;
-		if (std::isfinite(y))
-			(*yVector)[i] = y;
-		else
-			(*yVector)[i] = NAN;
-	}
-
-	return true;
+	return evaluateCartesian(expr, min, max, count, xVector, yVector, QStringList(), QVector<double>());
 }
 
 bool ExpressionParser::evaluateCartesian(const QString& expr, QVector<double>* xVector, QVector<double>* yVector) {
-	const char* func = expr.toLocal8Bit().data();
-	double x, y;
-	gsl_set_error_handler_off();
-
-	for (int i = 0; i < xVector->count(); i++) {
-		x = xVector->at(i);
-		assign_variable("x", x);
-		y = parse(func);
-
-		if (parse_errors() > 0)
-			return false;
-
-		if (std::isfinite(y))
-			(*yVector)[i] = y;
-		else
-			(*yVector)[i] = NAN;
-	}
-
-	return true;
+	return evaluateCartesian(expr, xVector, yVector, QStringList(), QVector<double>());
 }
 
 bool ExpressionParser::evaluateCartesian(const QString& expr, QVector<double>* xVector, QVector<double>* yVector,
 		const QStringList& paramNames, const QVector<double>& paramValues) {
-	const char* func = expr.toLocal8Bit().data();
-	double x, y;
-	gsl_set_error_handler_off();
-
-	for (int i = 0; i < paramNames.size(); ++i)
-		assign_variable(paramNames.at(i).toLocal8Bit().data(), paramValues.at(i));
-
-	for (int i = 0; i < xVector->count(); i++) {
-		x = xVector->at(i);
-		assign_variable("x", x);
-		y = parse(func);
-
-		if (parse_errors() > 0)
-			return false;
-
-		if (std::isfinite(y))
-			(*yVector)[i] = y;
-		else
-			(*yVector)[i] = NAN;
+	const CompiledExpression program(expr, QStringList() << "x" << paramNames);
+	if (!program.isValid())
+		return false;
+
+	//x-values are different for every point, the parameter values are the same for all points
+	QVector<const double*> values;
+	QVector<int> strides;
+	values << xVector->constData();
+	strides << 1;
+	for (int i = 0; i < paramNames.size(); ++i) {
+		values << &paramValues.at(i);
+		strides << 0;
 	}
 
+	const int count = xVector->count();
+	program.evaluate(values, strides, yVector->data(), count);
+	setNonFiniteToNAN(yVector->data(), count);
+
 	return true;
 }
 
@@ -1244,41 +1198,21 @@ bool ExpressionParser::evaluateCartesian(const QString& expr, QVector<double>* x
  */
 bool ExpressionParser::evaluateCartesian(const QString& expr, const QStringList& vars, const QVector<QVector<double>*>& xVectors, QVector<double>* yVector) {
 	Q_ASSERT(vars.size() == xVectors.size());
-	const char* func = expr.toLocal8Bit().data();
-	double y, varValue;
-	QString varName;
-
-	gsl_set_error_handler_off();
-
-	bool stop = false;
-	for (int i = 0; i < yVector->size(); i++) {
-		//stop iterating over i if one of the x-vectors has no elements anymore.
-		for (int n = 0; n < xVectors.size(); ++n) {
-			if (i == xVectors.at(n)->size()) {
-				stop = true;
-				break;
-			}
-		}
-		if (stop)
-			break;
-
-		for (int n = 0; n < vars.size(); ++n) {
-			varName = vars.at(n);
-			varValue = xVectors.at(n)->at(i);
-			assign_variable(varName.toLocal8Bit().data(), varValue);
-		}
-
-		y = parse(func);
-
-		if (parse_errors() > 0)
-			return false;
-
-		if (std::isfinite(y))
-			(*yVector)[i] = y;
-		else
-			(*yVector)[i] = NAN;
+	const CompiledExpression program(expr, vars);
+	if (!program.isValid())
+		return false;
+
+	//stop at the end of the shortest x-vector
+	int count = yVector->size();
+	QVector<const double*> values;
+	for (int n = 0; n < xVectors.size(); ++n) {
+		values << xVectors.at(n)->constData();
+		count = qMin(count, xVectors.at(n)->size());
 	}
 
+	program.evaluate(values, yVector->data(), count);
+	setNonFiniteToNAN(yVector->data(), count);
+
 	return true;
 }
 
@@ -1287,21 +1221,22 @@ bool ExpressionParser::evaluatePolar(const QString& expr, const QString& min, co
 	double minValue = parse(min.toLocal8Bit().data());
 	double maxValue = parse(max.toLocal8Bit().data());
 	double step = (maxValue - minValue)/(double)(count - 1);
-	QByteArray funcba = expr.toLocal8Bit();
-	const char* func = funcba.data();
-	double r, phi;
-	gsl_set_error_handler_off();
+
+	const CompiledExpression program(expr, QStringList() << "phi");
+	if (!program.isValid())
+		return false;
+
+	QVector<double> phi(count);
+	QVector<double> r(count);
+	for (int i = 0; i < count; i++)
+		phi[i] = minValue + step * i;
+
+	program.evaluate(QVector<const double*>() << phi.constData(), r.data(), count);
 
 	for (int i = 0; i < count; i++) {
-		phi = minValue + step * i;
-		assign_variable("phi", phi);
-		r = parse(func);
-		if (parse_errors() > 0)
-			return false;
-
-		if (std::isfinite(r)) {
-			(*xVector)[i] = r*cos(phi);
-			(*yVector)[i] = r*sin(phi);
+		if (std::isfinite(r[i])) {
+			(*xVector)[i] = r[i]*cos(phi[i]);
+			(*yVector)[i] = r[i]*sin(phi[i]);
 		} else {
 			(*xVector)[i] = NAN;
 			(*yVector)[i] = NAN;
@@ -1316,34 +1251,156 @@ bool ExpressionParser::evaluateParametric(const QString& expr1, const QString& e
 	double minValue = parse(min.toLocal8Bit().data());
 	double maxValue = parse(max.toLocal8Bit().data());
 	double step = (maxValue - minValue)/(double)(count - 1);
-	QByteArray xfuncba = expr1.toLocal8Bit();
-	const char* xFunc = xfuncba.data();
-	QByteArray yfuncba = expr2.toLocal8Bit();
-	const char* yFunc = yfuncba.data();
-	double x, y, t;
+
+	const CompiledExpression xProgram(expr1, QStringList() << "t");
+	const CompiledExpression yProgram(expr2, QStringList() << "t");
+	if (!xProgram.isValid() || !yProgram.isValid())
+		return false;
+
+	QVector<double> t(count);
+	for (int i = 0; i < count; i++)
+		t[i] = minValue + step*i;
+
+	const QVector<const double*> values = QVector<const double*>() << t.constData();
+	xProgram.evaluate(values, xVector->data(), count);
+	setNonFiniteToNAN(xVector->data(), count);
+	yProgram.evaluate(values, yVector->data(), count);
+	setNonFiniteToNAN(yVector->data(), count);
+
+	return true;
+}
+
+//##############################################################################
+//############################  CompiledExpression  ############################
+//##############################################################################
+//minimal number of values evaluated in one task when splitting the evaluation across threads
+static const int evaluationChunkSize = 16384;
+
+/*!
+	state of an evaluation split into chunks. Chunks are taken by the tasks in the thread pool
+	and by the calling thread until all chunks are processed, the caller never waits for a task that didn't start yet.
+ */
+class ParallelEvaluation {
+public:
+	ParallelEvaluation(const parser_program* program, const QVector<const double*>& values, const QVector<size_t>& strides,
+		double* result, int count) : m_program(program), m_values(values), m_strides(strides), m_result(result),
+		m_count(count), m_chunks((count + evaluationChunkSize - 1)/evaluationChunkSize), m_nextChunk(0) {
+	}
+
+	int chunks() const {
+		return m_chunks;
+	}
+
+	void process() {
+		QVector<const double*> values(m_values.size());
+		int chunk;
+		while ((chunk = m_nextChunk.fetchAndAddOrdered(1)) < m_chunks) {
+			const int start = chunk*evaluationChunkSize;
+			const int count = qMin(evaluationChunkSize, m_count - start);
+			for (int i = 0; i < values.size(); ++i)
+				values[i] = m_values.at(i) + start*m_strides.at(i);
+			evaluate_program(m_program, values.constData(), m_strides.constData(), m_result + start, count);
+			m_finished.release();
+		}
+	}
+
+	void waitForDone() {
+		m_finished.acquire(m_chunks);
+	}
+
+private:
+	const parser_program* m_program;
+	const QVector<const double*> m_values;
+	const QVector<size_t> m_strides;
+	double* m_result;
+	const int m_count;
+	const int m_chunks;
+	QAtomicInt m_nextChunk;
+	QSemaphore m_finished;
+};
+
+class EvaluateTask : public QRunnable {
+public:
+	explicit EvaluateTask(const QSharedPointer<ParallelEvaluation>& evaluation) : m_evaluation(evaluation) {}
+
+	void run() {
+		m_evaluation->process();
+	}
+
+private:
+	QSharedPointer<ParallelEvaluation> m_evaluation;
+};
+
+/*!
+	\class CompiledExpression
+	\brief Mathematical expression parsed once and evaluated for whole vectors of variable values.
+
+	The expression is compiled for the variables \c vars. All other symbols used in the expression
+	(constants and previously assigned parameters) are replaced by their current values and constant
+	sub-expressions are calculated once. The compiled expression is not modified by evaluate(),
+	it can be evaluated in several threads at the same time.
+	Large numbers of values are evaluated in parallel in the global thread pool.
+ */
+CompiledExpression::CompiledExpression(const QString& expr, const QStringList& vars) : m_variables(vars) {
+	QVector<QByteArray> names;
+	QVector<const char*> namesData;
+	for (int i = 0; i < vars.size(); ++i)
+		names << vars.at(i).toLocal8Bit();
+	for (int i = 0; i < names.size(); ++i)
+		namesData << names.at(i).constData();
+
 	gsl_set_error_handler_off();
+	m_program = compile_expression(expr.toLocal8Bit().constData(), namesData.constData(), vars.size());
+}
 
-	for (int i = 0; i < count; i++) {
-		t = minValue + step*i;
-		assign_variable("t", t);
-		x = parse(xFunc);
-		if (parse_errors() > 0)
-			return false;
-
-		if (std::isfinite(x))
-			(*xVector)[i] = x;
-		else
-			(*xVector)[i] = NAN;
+CompiledExpression::~CompiledExpression() {
+	free_program(m_program);
+}
 
-		y = parse(yFunc);
-		if (parse_errors() > 0)
-			return false;
+/*!
+	returns \c false if the expression couldn't be parsed.
+ */
+bool CompiledExpression::isValid() const {
+	return (m_program != NULL);
+}
 
-		if (std::isfinite(y))
-			(*yVector)[i] = y;
-		else
-			(*yVector)[i] = NAN;
+const QStringList& CompiledExpression::variables() const {
+	return m_variables;
+}
+
+/*!
+	evaluates the expression \c count times. \c values contains for every variable a pointer to \c count values,
+	the results are written to \c result.
+ */
+void CompiledExpression::evaluate(const QVector<const double*>& values, double* result, int count) const {
+	evaluate(values, QVector<int>(values.size(), 1), result, count);
+}
+
+/*!
+	evaluates the expression \c count times. For the i-th evaluation the value values[n][i*strides[n]]
+	is used for the n-th variable. A stride of 0 uses the same value for all evaluations (e.g. for parameters).
+	The results are written to \c result.
+ */
+void CompiledExpression::evaluate(const QVector<const double*>& values, const QVector<int>& strides, double* result, int count) const {
+	Q_ASSERT(values.size() == m_variables.size());
+	Q_ASSERT(strides.size() == m_variables.size());
+	if (!m_program) {
+		for (int i = 0; i < count; i++)
+			result[i] = NAN;
+		return;
 	}
 
-	return true;
+	QVector<size_t> st(strides.size());
+	for (int i = 0; i < strides.size(); ++i)
+		st[i] = strides.at(i);
+
+	//split large evaluations into chunks processed in the thread pool and in the calling thread
+	QThreadPool* pool = QThreadPool::globalInstance();
+	QSharedPointer<ParallelEvaluation> evaluation(new ParallelEvaluation(m_program, values, st, result, count));
+	const int tasks = qMin(evaluation->chunks(), pool->maxThreadCount()) - 1;
+	for (int i = 0; i < tasks; ++i)
+		pool->start(new EvaluateTask(evaluation));
+
+	evaluation->process();
+	evaluation->waitForDone();
 }
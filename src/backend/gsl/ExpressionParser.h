@@ -32,6 +32,26 @@
 #include <QVector>
 #include <QStringList>
 
+struct parser_program;
+
+class CompiledExpression {
+
+public:
+	CompiledExpression(const QString& expr, const QStringList& vars);
+	~CompiledExpression();
+
+	bool isValid() const;
+	const QStringList& variables() const;
+	void evaluate(const QVector<const double*>& values, double* result, int count) const;
+	void evaluate(const QVector<const double*>& values, const QVector<int>& strides, double* result, int count) const;
+
+private:
+	Q_DISABLE_COPY(CompiledExpression)
+
+	QStringList m_variables;
+	parser_program* m_program;
+};
+
 class ExpressionParser {
 
 public:
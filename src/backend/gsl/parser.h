@@ -30,6 +30,8 @@
 #ifndef PARSER_H
 #define PARSER_H
 
+#include <stddef.h>
+
 /* #define PDEBUG 1 */
 
 struct con {
@@ -71,6 +73,12 @@ symrec* assign_variable(const char* symb_name, double value);
 double parse(const char *str);
 double parse_with_vars(const char[], const parser_var[], int nvars);
 
+/* compiled expressions: parsed once and evaluated for many values of the variables */
+typedef struct parser_program parser_program;
+parser_program* compile_expression(const char *str, const char *const vars[], int nvars);
+void free_program(parser_program *prog);
+void evaluate_program(const parser_program *prog, const double *const vars[], const size_t strides[], double *result, size_t n);
+
 extern struct con _constants[];
 extern struct func _functions[];
 
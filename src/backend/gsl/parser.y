@@ -31,6 +31,7 @@
 #include <string.h>
 #include <ctype.h>
 #include <stdlib.h>
+#include <math.h>
 #include <locale.h>
 #ifndef HAVE_WINDOWS
 #include <xlocale.h>
@@ -47,30 +48,56 @@
 
 #define YYERROR_VERBOSE 1
 
+/* types of the nodes in the syntax tree */
+enum {PN_NUM, PN_VAR, PN_ASSIGN, PN_FNCT, PN_ADD, PN_SUB, PN_MUL, PN_DIV, PN_NEG, PN_POW};
+
+/* node of the syntax tree */
+typedef struct pnode {
+	int type;		/* type of node (PN_*) */
+	double value;		/* value of a PN_NUM */
+	symrec *sym;		/* symbol of a PN_VAR, PN_ASSIGN or PN_FNCT */
+	int nargs;		/* number of arguments/operands */
+	struct pnode *args[4];	/* arguments/operands */
+	struct pnode *next;	/* next allocated node (used for freeing) */
+} pnode;
+
 /* params passed to yylex (and yyerror) */
 typedef struct param {
 	unsigned int pos;	/* current position in string */
 	char *string;		/* the string to parse */
+	pnode *nodes;		/* all nodes allocated while parsing */
+	pnode *tree;		/* the syntax tree of the parsed string */
+	symrec *vars;		/* variables of a compiled expression (not in the symbol table) */
+	int nvars;		/* number of variables of a compiled expression */
+	int errors;		/* number of parse errors */
+	char *symbuf;		/* buffer for reading symbol names */
+	int symlength;		/* size of symbuf */
 /*	symrec *sym_table;	the symbol table (not used) */
 } param;
 
-int yyerror(param *p, const char *err);
-int yylex(param *p);
-
-double res;
+static pnode* new_node(param *p, int type, symrec *sym, int nargs, pnode *a, pnode *b, pnode *c, pnode *d);
+static pnode* new_num(param *p, double value);
 %}
 
+/* reentrant parser: no global state, all state is in yyparse() and param */
+%define api.pure
 %lex-param {param *p}
 %parse-param {param *p}
 
 %union {
 double dval;	/* For returning numbers */
 symrec *tptr;   /* For returning symbol-table pointers */
+struct pnode *node;	/* For returning nodes of the syntax tree */
 }
 
+%{
+int yyerror(param *p, const char *err);
+int yylex(YYSTYPE *lvalp, param *p);
+%}
+
 %token <dval>  NUM 	/* Simple double precision number */
 %token <tptr> VAR FNCT	/* VARiable and FuNCTion */
-%type  <dval>  expr
+%type  <node>  expr
 
 %right '='
 %left '-' '+'
@@ -84,26 +111,26 @@ input:   /* empty */
 ;
 
 line:	'\n'
-	| expr '\n'   { res=$1; }
+	| expr '\n'   { p->tree = $1; }
 	| error '\n' { yyerrok; }
 ;
 
-expr:      NUM       { $$ = $1;                         }
-| VAR                { $$ = $1->value.var;              }
-| VAR '=' expr       { $$ = $3; $1->value.var = $3;     }
-| FNCT '(' ')'       { $$ = (*($1->value.fnctptr))();   }
-| FNCT '(' expr ')'  { $$ = (*($1->value.fnctptr))($3); }
-| FNCT '(' expr ',' expr ')'  { $$ = (*($1->value.fnctptr))($3,$5); }
-| FNCT '(' expr ',' expr ','expr ')'  { $$ = (*($1->value.fnctptr))($3,$5,$7); }
-| FNCT '(' expr ',' expr ',' expr ','expr ')'  { $$ = (*($1->value.fnctptr))($3,$5,$7,$9); }
-| expr '+' expr      { $$ = $1 + $3;                    }
-| expr '-' expr      { $$ = $1 - $3;                    }
-| expr '*' expr      { $$ = $1 * $3;                    }
-| expr '/' expr      { $$ = $1 / $3;                    }
-| '-' expr  %prec NEG{ $$ = -$2;                        }
-| expr '^' expr      { $$ = pow ($1, $3);               }
-| expr '*' '*' expr  { $$ = pow ($1, $4);               }
-| '(' expr ')'       { $$ = $2;                         }
+expr:      NUM       { $$ = new_num(p, $1);                                  }
+| VAR                { $$ = new_node(p, PN_VAR, $1, 0, 0, 0, 0, 0);          }
+| VAR '=' expr       { $$ = new_node(p, PN_ASSIGN, $1, 1, $3, 0, 0, 0);      }
+| FNCT '(' ')'       { $$ = new_node(p, PN_FNCT, $1, 0, 0, 0, 0, 0);         }
+| FNCT '(' expr ')'  { $$ = new_node(p, PN_FNCT, $1, 1, $3, 0, 0, 0);        }
+| FNCT '(' expr ',' expr ')'  { $$ = new_node(p, PN_FNCT, $1, 2, $3, $5, 0, 0); }
+| FNCT '(' expr ',' expr ','expr ')'  { $$ = new_node(p, PN_FNCT, $1, 3, $3, $5, $7, 0); }
+| FNCT '(' expr ',' expr ',' expr ','expr ')'  { $$ = new_node(p, PN_FNCT, $1, 4, $3, $5, $7, $9); }
+| expr '+' expr      { $$ = new_node(p, PN_ADD, 0, 2, $1, $3, 0, 0);         }
+| expr '-' expr      { $$ = new_node(p, PN_SUB, 0, 2, $1, $3, 0, 0);         }
+| expr '*' expr      { $$ = new_node(p, PN_MUL, 0, 2, $1, $3, 0, 0);         }
+| expr '/' expr      { $$ = new_node(p, PN_DIV, 0, 2, $1, $3, 0, 0);         }
+| '-' expr  %prec NEG{ $$ = new_node(p, PN_NEG, 0, 1, $2, 0, 0, 0);          }
+| expr '^' expr      { $$ = new_node(p, PN_POW, 0, 2, $1, $3, 0, 0);         }
+| expr '*' '*' expr  { $$ = new_node(p, PN_POW, 0, 2, $1, $4, 0, 0);         }
+| '(' expr ')'       { $$ = $2;                                              }
 ;
 
 %%
@@ -111,11 +138,15 @@ expr:      NUM       { $$ = $1;                         }
 /* global symbol table */
 symrec *sym_table = 0;
 
+/* number of errors of the last call of parse() */
+static int nerrors = 0;
+
 int parse_errors() {
-	return yynerrs;
+	return nerrors;
 }
 
 int yyerror(param *p, const char *s) {
+	p->errors++;
 	/* remove trailing newline */
 	p->string[strcspn(p->string, "\n")] = 0;
 	printf("PARSER ERROR: %s @ position %d of string \'%s\'\n", s, p->pos, p->string);
@@ -201,6 +232,101 @@ symrec* assign_variable(const char* symb_name, double value) {
 	return ptr;
 };
 
+/* create a new node of the syntax tree. All nodes are freed in free_nodes().
+ * Returns 0 and counts a parse error if no memory is available, the tree is not evaluated then. */
+static pnode* new_node(param *p, int type, symrec *sym, int nargs, pnode *a, pnode *b, pnode *c, pnode *d) {
+	pnode *node = (pnode *) malloc(sizeof(pnode));
+	if (node == NULL) {
+		yyerror(p, "out of memory");
+		return 0;
+	}
+	node->type = type;
+	node->value = 0;
+	node->sym = sym;
+	node->nargs = nargs;
+	node->args[0] = a;
+	node->args[1] = b;
+	node->args[2] = c;
+	node->args[3] = d;
+	node->next = p->nodes;
+	p->nodes = node;
+
+	return node;
+}
+
+static pnode* new_num(param *p, double value) {
+	pnode *node = new_node(p, PN_NUM, 0, 0, 0, 0, 0, 0);
+	if (node)
+		node->value = value;
+	return node;
+}
+
+static void free_nodes(param *p) {
+	while (p->nodes) {
+		pnode *tmp = p->nodes;
+		p->nodes = p->nodes->next;
+		free(tmp);
+	}
+	p->tree = 0;
+}
+
+/* evaluate the syntax tree with the current values of the variables in the symbol table */
+static double eval_tree(const pnode *n) {
+	double a, b, c, d;
+
+	switch (n->type) {
+	case PN_NUM:
+		return n->value;
+	case PN_VAR:
+		return n->sym->value.var;
+	case PN_ASSIGN:
+		n->sym->value.var = eval_tree(n->args[0]);
+		return n->sym->value.var;
+	case PN_FNCT:
+		switch (n->nargs) {
+		case 0:
+			return (*(n->sym->value.fnctptr))();
+		case 1:
+			a = eval_tree(n->args[0]);
+			return (*(n->sym->value.fnctptr))(a);
+		case 2:
+			a = eval_tree(n->args[0]);
+			b = eval_tree(n->args[1]);
+			return (*(n->sym->value.fnctptr))(a, b);
+		case 3:
+			a = eval_tree(n->args[0]);
+			b = eval_tree(n->args[1]);
+			c = eval_tree(n->args[2]);
+			return (*(n->sym->value.fnctptr))(a, b, c);
+		default:
+			a = eval_tree(n->args[0]);
+			b = eval_tree(n->args[1]);
+			c = eval_tree(n->args[2]);
+			d = eval_tree(n->args[3]);
+			return (*(n->sym->value.fnctptr))(a, b, c, d);
+		}
+	case PN_ADD:
+		a = eval_tree(n->args[0]);
+		return a + eval_tree(n->args[1]);
+	case PN_SUB:
+		a = eval_tree(n->args[0]);
+		return a - eval_tree(n->args[1]);
+	case PN_MUL:
+		a = eval_tree(n->args[0]);
+		return a * eval_tree(n->args[1]);
+	case PN_DIV:
+		a = eval_tree(n->args[0]);
+		return a / eval_tree(n->args[1]);
+	case PN_NEG:
+		return -eval_tree(n->args[0]);
+	case PN_POW:
+		a = eval_tree(n->args[0]);
+		return pow(a, eval_tree(n->args[1]));
+	}
+
+	return NAN;
+}
+
 static int getcharstr(param *p) {
 	pdebug("PARSER: getcharstr() pos = %d\n", p->pos);
 
@@ -215,30 +341,54 @@ static void ungetcstr(unsigned int *pos) {
         (*pos)--;
 }
 
-double parse(const char *str) {
-	pdebug("\nPARSER: parse(\"%s\") len=%zu\n", str, strlen(str));
-
+/* parse the string str into the syntax tree p->tree */
+static void parse_tree(param *p, const char *str) {
 	/* be sure that the symbol table has been initialized */
 	if (!sym_table)
 		init_table();
 
-	param p;
-	p.pos = 0;
+	p->pos = 0;
+	p->nodes = 0;
+	p->tree = 0;
+	p->errors = 0;
+	p->symbuf = 0;
+	p->symlength = 0;
 	/* leave space to terminate string by "\n\0" */
 	size_t slen = strlen(str) + 2;
-	p.string = (char *) malloc(slen * sizeof(char));
+	p->string = (char *) malloc(slen * sizeof(char));
+	if (p->string == NULL) {
+		printf("PARSER ERROR: out of memory while parsing \'%s\'\n", str);
+		p->errors++;
+		return;
+	}
+
+	strncpy(p->string, str, slen);
+	p->string[strlen(p->string)] = '\n';
+	pdebug("\nPARSER: yyparse(\"%s\") len=%zu\n", p->string, strlen(p->string));
+
+	yyparse(p);
 
-	strncpy(p.string, str, slen);
-	p.string[strlen(p.string)] = '\n';
-	pdebug("\nPARSER: yyparse(\"%s\") len=%zu\n", p.string, strlen(p.string));
+	free(p->symbuf);
+	p->symbuf = 0;
+	free(p->string);
+	p->string = 0;
+}
+
+double parse(const char *str) {
+	pdebug("\nPARSER: parse(\"%s\") len=%zu\n", str, strlen(str));
 
-	/* parameter for yylex */
-	yyparse(&p);
+	param p;
+	p.vars = 0;
+	p.nvars = 0;
+	parse_tree(&p, str);
 
-	pdebug("PARSER: parse() DONE (res = %g, parse errors = %d)\n", res, parse_errors());
-	free(p.string);
-	p.string = 0;
+	nerrors = p.errors;
+	double res = NAN;
+	if (p.tree && p.errors == 0)
+		res = eval_tree(p.tree);
+	free_nodes(&p);
 
+	pdebug("PARSER: parse() DONE (res = %g, parse errors = %d)\n", res, p.errors);
 	return res;
 }
 
@@ -253,7 +403,383 @@ double parse_with_vars(const char *str, const parser_var *vars, int nvars) {
 	return parse(str);
 }
 
-int yylex(param *p) {
+/******************************************************************************/
+/*                           compiled expressions                             */
+/******************************************************************************/
+
+/* number of values evaluated by one instruction of a program */
+#define PROGRAM_BLOCK_SIZE 256
+
+/* instruction of a compiled program.
+ * The program operates on a stack of blocks of PROGRAM_BLOCK_SIZE values each.
+ * op is the type of the node the instruction was created from:
+ * PN_NUM pushes value, PN_VAR pushes the values of slot, PN_ASSIGN stores the top of the stack in slot,
+ * PN_FNCT replaces the top nargs blocks by the function values and all other ops work on the top one or two blocks. */
+typedef struct pinstr {
+	int op;
+	int nargs;
+	int slot;
+	double value;
+	func_t fnct;
+} pinstr;
+
+struct parser_program {
+	pinstr *code;		/* the instructions */
+	int ncode;		/* number of instructions */
+	int ninputs;		/* number of variables, slots 0..ninputs-1 */
+	int nslots;		/* number of slots (variables and assigned symbols) */
+	double *init;		/* initial values of the slots ninputs..nslots-1 */
+	int stack_size;		/* maximal number of blocks on the stack */
+};
+
+/* functions with results not only depending on the arguments (not folded) */
+static int is_deterministic(const symrec *sym) {
+	return strcmp(sym->name, "rand") != 0 && strcmp(sym->name, "random") != 0 && strcmp(sym->name, "drand") != 0;
+}
+
+/* returns the slot of the symbol sym in the program or -1 if it's not a variable or an assigned symbol */
+static int symbol_slot(const param *p, const symrec *sym, symrec *const assigned[], int nassigned) {
+	int i;
+	if (p->vars && sym >= p->vars && sym < p->vars + p->nvars)
+		return (int)(sym - p->vars);
+	for (i = 0; i < nassigned; i++)
+		if (assigned[i] == sym)
+			return p->nvars + i;
+	return -1;
+}
+
+static int count_nodes(const pnode *n) {
+	int i, count = 1;
+	for (i = 0; i < n->nargs; i++)
+		count += count_nodes(n->args[i]);
+	return count;
+}
+
+/* collect all symbols of the symbol table that are assigned in the tree */
+static void collect_assigned(const param *p, const pnode *n, symrec *assigned[], int *nassigned) {
+	int i;
+	if (n->type == PN_ASSIGN && symbol_slot(p, n->sym, assigned, *nassigned) == -1)
+		assigned[(*nassigned)++] = n->sym;
+	for (i = 0; i < n->nargs; i++)
+		collect_assigned(p, n->args[i], assigned, nassigned);
+}
+
+/* replace constant symbols and all constant sub expressions by their values */
+static void fold_tree(const param *p, pnode *n, symrec *const assigned[], int nassigned) {
+	int i, constant = 1;
+
+	for (i = 0; i < n->nargs; i++) {
+		fold_tree(p, n->args[i], assigned, nassigned);
+		if (n->args[i]->type != PN_NUM)
+			constant = 0;
+	}
+
+	switch (n->type) {
+	case PN_NUM:
+		break;
+	case PN_VAR:
+		if (symbol_slot(p, n->sym, assigned, nassigned) == -1) {
+			n->type = PN_NUM;
+			n->value = n->sym->value.var;
+		}
+		break;
+	case PN_ASSIGN:
+		break;
+	case PN_FNCT:
+		if (constant && is_deterministic(n->sym)) {
+			n->value = eval_tree(n);
+			n->type = PN_NUM;
+			n->nargs = 0;
+		}
+		break;
+	case PN_ADD:
+	case PN_SUB:
+	case PN_MUL:
+	case PN_DIV:
+	case PN_NEG:
+	case PN_POW:
+		if (constant) {
+			n->value = eval_tree(n);
+			n->type = PN_NUM;
+			n->nargs = 0;
+		}
+		break;
+	}
+}
+
+/* append the instructions for the tree in postfix order */
+static void emit_tree(const param *p, const pnode *n, parser_program *prog, int *depth, symrec *const assigned[], int nassigned) {
+	int i;
+	for (i = 0; i < n->nargs; i++)
+		emit_tree(p, n->args[i], prog, depth, assigned, nassigned);
+
+	pinstr *instr = &prog->code[prog->ncode++];
+	instr->op = n->type;
+	instr->nargs = n->nargs;
+	instr->slot = -1;
+	instr->value = n->value;
+	instr->fnct = 0;
+
+	switch (n->type) {
+	case PN_NUM:
+		(*depth)++;
+		break;
+	case PN_VAR:
+		instr->slot = symbol_slot(p, n->sym, assigned, nassigned);
+		(*depth)++;
+		break;
+	case PN_ASSIGN:
+		instr->slot = symbol_slot(p, n->sym, assigned, nassigned);
+		break;
+	case PN_FNCT:
+		instr->fnct = n->sym->value.fnctptr;
+		*depth += 1 - n->nargs;
+		break;
+	case PN_ADD:
+	case PN_SUB:
+	case PN_MUL:
+	case PN_DIV:
+	case PN_POW:
+		(*depth)--;
+		break;
+	case PN_NEG:
+		break;
+	}
+
+	if (*depth > prog->stack_size)
+		prog->stack_size = *depth;
+}
+
+/*
+ * compile the expression str depending on the variables vars into a program.
+ * Symbols of the symbol table used in the expression are replaced by their current values
+ * and constant sub expressions are evaluated once.
+ * Returns 0 if the expression can't be parsed. The program has to be freed with free_program().
+ * The parser is reentrant and the symbol table is only read, expressions can be compiled in several threads
+ * at the same time as long as the symbol table is not modified (init_table(), assign_variable(), parse()).
+ */
+parser_program* compile_expression(const char *str, const char *const vars[], int nvars) {
+	pdebug("\nPARSER: compile_expression(\"%s\") nvars=%d\n", str, nvars);
+	int i;
+
+	param p;
+	p.nvars = nvars;
+	p.vars = (symrec *) calloc(nvars > 0 ? nvars : 1, sizeof(symrec));
+	if (p.vars == NULL) {
+		printf("PARSER ERROR: out of memory while compiling \'%s\'\n", str);
+		return 0;
+	}
+	for (i = 0; i < nvars; i++) {
+		p.vars[i].name = (char *) vars[i];
+		p.vars[i].type = VAR;
+	}
+	parse_tree(&p, str);
+
+	parser_program *prog = 0;
+	if (p.tree && p.errors == 0) {
+		/* the number of assigned symbols is limited by the number of nodes */
+		const int nnodes = count_nodes(p.tree);
+		int nassigned = 0;
+		symrec **assigned = (symrec **) malloc(nnodes * sizeof(symrec *));
+		prog = (parser_program *) calloc(1, sizeof(parser_program));
+		if (assigned && prog) {
+			collect_assigned(&p, p.tree, assigned, &nassigned);
+			prog->code = (pinstr *) malloc(nnodes * sizeof(pinstr));
+			prog->init = (double *) malloc((nassigned > 0 ? nassigned : 1) * sizeof(double));
+		}
+
+		if (assigned == NULL || prog == NULL || prog->code == NULL || prog->init == NULL) {
+			printf("PARSER ERROR: out of memory while compiling \'%s\'\n", str);
+			p.errors++;
+			free_program(prog);
+			prog = 0;
+		} else {
+			fold_tree(&p, p.tree, assigned, nassigned);
+			prog->ncode = 0;
+			prog->ninputs = nvars;
+			prog->nslots = nvars + nassigned;
+			for (i = 0; i < nassigned; i++)
+				prog->init[i] = assigned[i]->value.var;
+			prog->stack_size = 0;
+
+			int depth = 0;
+			emit_tree(&p, p.tree, prog, &depth, assigned, nassigned);
+		}
+		free(assigned);
+	}
+
+	free_nodes(&p);
+	free(p.vars);
+
+	pdebug("PARSER: compile_expression() DONE (prog = %p, parse errors = %d)\n", prog, p.errors);
+	return prog;
+}
+
+void free_program(parser_program *prog) {
+	if (!prog)
+		return;
+	free(prog->code);
+	free(prog->init);
+	free(prog);
+}
+
+/*
+ * evaluate the program for n values of the variables.
+ * vars[i] points to the values of the i-th variable used when compiling the program,
+ * the j-th value is read from vars[i][j*strides[i]]. A stride of 0 uses the same value for all j
+ * and if strides is 0, all variables have a stride of 1.
+ * The n results are written to result.
+ * The program is not modified, it can be evaluated in several threads at the same time.
+ */
+void evaluate_program(const parser_program *prog, const double *const vars[], const size_t strides[], double *result, size_t n) {
+	const size_t bs = PROGRAM_BLOCK_SIZE;
+	const int nslots = prog->nslots > 0 ? prog->nslots : 1;
+	double *stack = (double *) malloc(prog->stack_size * bs * sizeof(double));
+	double *locals = (double *) malloc(nslots * bs * sizeof(double));
+	const double **base = (const double **) malloc(nslots * sizeof(double *));
+	size_t *stride = (size_t *) malloc(nslots * sizeof(size_t));
+	size_t offset, j;
+	int i, s;
+
+	if (stack == NULL || locals == NULL || base == NULL || stride == NULL) {
+		printf("PARSER ERROR: out of memory while evaluating %zu values\n", n);
+		for (j = 0; j < n; j++)
+			result[j] = NAN;
+		n = 0;
+	}
+
+	for (offset = 0; offset < n; offset += bs) {
+		const size_t len = (n - offset < bs) ? n - offset : bs;
+
+		for (s = 0; s < prog->nslots; s++) {
+			if (s < prog->ninputs) {
+				stride[s] = strides ? strides[s] : 1;
+				base[s] = vars[s] + offset * stride[s];
+			} else {
+				stride[s] = 0;
+				base[s] = &prog->init[s - prog->ninputs];
+			}
+		}
+
+		/* number of blocks on the stack, the block k starts at stack + k*bs */
+		size_t sp = 0;
+		for (i = 0; i < prog->ncode; i++) {
+			const pinstr *instr = &prog->code[i];
+			double *t, *u, *a, *b;
+			switch (instr->op) {
+			case PN_NUM:
+				t = stack + sp++ * bs;
+				for (j = 0; j < len; j++)
+					t[j] = instr->value;
+				break;
+			case PN_VAR: {
+				const double *v = base[instr->slot];
+				const size_t st = stride[instr->slot];
+				t = stack + sp++ * bs;
+				if (st == 1)
+					memcpy(t, v, len * sizeof(double));
+				else
+					for (j = 0; j < len; j++)
+						t[j] = v[j * st];
+				break;
+			}
+			case PN_ASSIGN: {
+				double *l = locals + instr->slot * bs;
+				memcpy(l, stack + (sp - 1) * bs, len * sizeof(double));
+				base[instr->slot] = l;
+				stride[instr->slot] = 1;
+				break;
+			}
+			case PN_FNCT:
+				switch (instr->nargs) {
+				case 0:
+					t = stack + sp++ * bs;
+					for (j = 0; j < len; j++)
+						t[j] = (*(instr->fnct))();
+					break;
+				case 1:
+					t = stack + (sp - 1) * bs;
+					for (j = 0; j < len; j++)
+						t[j] = (*(instr->fnct))(t[j]);
+					break;
+				case 2:
+					u = stack + (sp - 2) * bs;
+					t = u + bs;
+					for (j = 0; j < len; j++)
+						u[j] = (*(instr->fnct))(u[j], t[j]);
+					sp--;
+					break;
+				case 3:
+					a = stack + (sp - 3) * bs;
+					u = a + bs;
+					t = u + bs;
+					for (j = 0; j < len; j++)
+						a[j] = (*(instr->fnct))(a[j], u[j], t[j]);
+					sp -= 2;
+					break;
+				default:
+					a = stack + (sp - 4) * bs;
+					b = a + bs;
+					u = b + bs;
+					t = u + bs;
+					for (j = 0; j < len; j++)
+						a[j] = (*(instr->fnct))(a[j], b[j], u[j], t[j]);
+					sp -= 3;
+				}
+				break;
+			case PN_ADD:
+				u = stack + (sp - 2) * bs;
+				t = u + bs;
+				for (j = 0; j < len; j++)
+					u[j] += t[j];
+				sp--;
+				break;
+			case PN_SUB:
+				u = stack + (sp - 2) * bs;
+				t = u + bs;
+				for (j = 0; j < len; j++)
+					u[j] -= t[j];
+				sp--;
+				break;
+			case PN_MUL:
+				u = stack + (sp - 2) * bs;
+				t = u + bs;
+				for (j = 0; j < len; j++)
+					u[j] *= t[j];
+				sp--;
+				break;
+			case PN_DIV:
+				u = stack + (sp - 2) * bs;
+				t = u + bs;
+				for (j = 0; j < len; j++)
+					u[j] /= t[j];
+				sp--;
+				break;
+			case PN_NEG:
+				t = stack + (sp - 1) * bs;
+				for (j = 0; j < len; j++)
+					t[j] = -t[j];
+				break;
+			case PN_POW:
+				u = stack + (sp - 2) * bs;
+				t = u + bs;
+				for (j = 0; j < len; j++)
+					u[j] = pow(u[j], t[j]);
+				sp--;
+				break;
+			}
+		}
+
+		memcpy(result + offset, stack, len * sizeof(double));
+	}
+
+	free(stride);
+	free(base);
+	free(locals);
+	free(stack);
+}
+
+int yylex(YYSTYPE *lvalp, param *p) {
 	pdebug("PARSER: yylex()\n");
 	int c;
 
@@ -268,7 +794,7 @@ int yylex(param *p) {
 	/* check for non-ASCII chars */
 	if (!isascii(c)) {
 		pdebug("non-ASCII character found. Giving up\n");
-		yynerrs++;
+		p->errors++;
 		return 0;
 	}
 
@@ -300,7 +826,7 @@ int yylex(param *p) {
 
 		pdebug("PARSER: result = %g\n", result);
 
-		yylval.dval = result;
+		lvalp->dval = result;
 
                 p->pos += strlen(s) - strlen(remain);
 
@@ -309,20 +835,30 @@ int yylex(param *p) {
 
 	if (isalpha (c) || c == '.') {
 		pdebug("PARSER: reading identifier (starts with alpha: %c)\n", c);
-		static char *symbuf = 0;
-		static int length = 0;
+		char *symbuf = p->symbuf;
 		int i = 0;
 
 		/* Initially make the buffer long enough for a 10-character symbol name */
-		if (length == 0)
-			length = 10, symbuf = (char *) malloc(length + 1);
+		if (p->symlength == 0) {
+			symbuf = p->symbuf = (char *) malloc(10 + 1);
+			if (symbuf == NULL) {
+				yyerror(p, "out of memory");
+				return 0;
+			}
+			p->symlength = 10;
+		}
 
 		do {
 			pdebug("reading symbol .. ");
 			/* If buffer is full, make it bigger */
-			if (i == length) {
-				length *= 2;
-				symbuf = (char *) realloc(symbuf, length + 1);
+			if (i == p->symlength) {
+				char *newbuf = (char *) realloc(symbuf, 2 * p->symlength + 1);
+				if (newbuf == NULL) {
+					yyerror(p, "out of memory");
+					return 0;
+				}
+				p->symlength *= 2;
+				symbuf = p->symbuf = newbuf;
 			}
 			symbuf[i++] = c;
 			c = getcharstr(p);
@@ -335,17 +871,26 @@ int yylex(param *p) {
 			ungetcstr(&(p->pos));
 		symbuf[i] = '\0';
 
-		symrec *s = getsym(symbuf);
+		/* variables of a compiled expression are not in the symbol table */
+		symrec *s = 0;
+		for (i = 0; i < p->nvars; i++) {
+			if (strcmp(p->vars[i].name, symbuf) == 0) {
+				s = &p->vars[i];
+				break;
+			}
+		}
+		if (s == 0)
+			s = getsym(symbuf);
 		if(s == 0) {	/* symbol unknown */
 			pdebug("PARSER: ERROR: symbol \"%s\" UNKNOWN\n", symbuf);
-			yynerrs++;
+			p->errors++;
 			return 0;
 		}
 		/* old behavior */
 		/* if (s == 0)
 			 s = putsym (symbuf, VAR);
 		*/
-		yylval.tptr = s;
+		lvalp->tptr = s;
 		return s->type;
 	}
 
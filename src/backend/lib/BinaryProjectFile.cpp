@@ -0,0 +1,285 @@
+/***************************************************************************
+    File                 : BinaryProjectFile.cpp
+    Project              : LabPlot
+    Description          : Project file with the column data in binary sections
+    --------------------------------------------------------------------
+    Copyright            : (C) 2017 LabPlot developers
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "backend/lib/BinaryProjectFile.h"
+#include <QtEndian>
+#include <KLocale>
+#include <cstring>
+
+//layout of the file:
+//header (64 bytes), XML document, sections (each aligned to 64 bytes), section table
+static const char magic[8] = {'L', 'a', 'b', 'P', 'l', 'o', 't', 'B'};
+static const quint32 version = 1;
+static const int headerSize = 64;
+static const int alignment = 64;
+static const int tableEntrySize = 32;
+
+//flags in the header
+static const quint32 bigEndianFlag = 1;
+
+//compression of the sections
+enum {NoCompression = 0, ZlibCompression = 1};
+
+//size of the blocks compressed independently
+static const qint64 compressionBlockSize = 1024*1024;
+
+static qint64 aligned(qint64 pos) {
+	return (pos + alignment - 1)/alignment*alignment;
+}
+
+/*!
+	\class BinaryProjectFile
+	\brief Project file containing the XML document describing the project and the data of the columns
+	in raw binary sections.
+
+	On saving, the XML document is written into this device and the columns register their data
+	as sections (\sa addSection()) instead of writing it base64-encoded into the document.
+	On loading, the file is memory-mapped, the device provides the XML document and
+	the columns read their data from the mapped sections (\sa readSection()).
+	The sections are aligned to 64 bytes and are optionally compressed blockwise with zlib.
+
+	\ingroup backend
+*/
+BinaryProjectFile::BinaryProjectFile() : m_compressionEnabled(false), m_map(0) {
+}
+
+BinaryProjectFile::~BinaryProjectFile() {
+	close();
+	if (m_map)
+		m_file.unmap(const_cast<uchar*>(m_map));
+}
+
+/*!
+	returns \c true if the file \c fileName starts with the identifier of the binary project files.
+*/
+bool BinaryProjectFile::isBinaryProjectFile(const QString& fileName) {
+	QFile file(fileName);
+	if (!file.open(QIODevice::ReadOnly))
+		return false;
+
+	return file.read(sizeof(magic)) == QByteArray::fromRawData(magic, sizeof(magic));
+}
+
+/*!
+	enables the compression of the sections. Compressed sections are not memory-mapped on loading
+	but decompressed into the columns.
+*/
+void BinaryProjectFile::setCompressionEnabled(bool enabled) {
+	m_compressionEnabled = enabled;
+}
+
+bool BinaryProjectFile::isCompressionEnabled() const {
+	return m_compressionEnabled;
+}
+
+/*!
+	adds the \c size bytes at \c data as a new section and returns the index of the section.
+	The data is only referenced and has to be valid until save() was called.
+*/
+int BinaryProjectFile::addSection(const char* data, qint64 size) {
+	Section section;
+	section.data = data;
+	section.offset = 0;
+	section.size = size;
+	section.storedSize = 0;
+	section.compression = m_compressionEnabled ? ZlibCompression : NoCompression;
+	m_sections << section;
+	return m_sections.size() - 1;
+}
+
+/*!
+	writes the XML document written into this device and all sections into the file \c fileName.
+*/
+bool BinaryProjectFile::save(const QString& fileName) {
+	QFile file(fileName);
+	if (!file.open(QIODevice::WriteOnly)) {
+		m_error = i18n("Could not open file %1 for writing.", fileName);
+		return false;
+	}
+
+	const QByteArray& xml = buffer();
+	const QByteArray padding(alignment, 0);
+
+	//header, the position of the section table is written at the end
+	char header[headerSize];
+	memset(header, 0, headerSize);
+	memcpy(header, magic, sizeof(magic));
+	qToLittleEndian<quint32>(version, reinterpret_cast<uchar*>(header + 8));
+	qToLittleEndian<quint32>(Q_BYTE_ORDER == Q_BIG_ENDIAN ? bigEndianFlag : 0, reinterpret_cast<uchar*>(header + 12));
+	qToLittleEndian<quint64>(xml.size(), reinterpret_cast<uchar*>(header + 16));
+	qToLittleEndian<quint64>(m_sections.size(), reinterpret_cast<uchar*>(header + 24));
+	bool ok = (file.write(header, headerSize) == headerSize);
+	ok = ok && (file.write(xml) == xml.size());
+
+	//sections
+	for (int i = 0; ok && i < m_sections.size(); ++i) {
+		Section& section = m_sections[i];
+		const qint64 pos = file.pos();
+		ok = (file.write(padding.constData(), aligned(pos) - pos) == aligned(pos) - pos);
+		section.offset = file.pos();
+
+		if (section.compression == NoCompression) {
+			ok = ok && (file.write(section.data, section.size) == (qint64)section.size);
+		} else {
+			//every block is stored with its compressed size in front of it
+			for (qint64 start = 0; ok && start < (qint64)section.size; start += compressionBlockSize) {
+				const int size = (int)qMin(compressionBlockSize, (qint64)section.size - start);
+				const QByteArray block = qCompress(reinterpret_cast<const uchar*>(section.data + start), size, 1);
+				uchar blockSize[4];
+				qToLittleEndian<quint32>(block.size(), blockSize);
+				ok = (file.write(reinterpret_cast<const char*>(blockSize), 4) == 4);
+				ok = ok && (file.write(block) == block.size());
+			}
+		}
+		section.storedSize = file.pos() - section.offset;
+	}
+
+	//section table
+	const qint64 tableOffset = aligned(file.pos());
+	ok = ok && (file.write(padding.constData(), tableOffset - file.pos()) >= 0);
+	foreach (const Section& section, m_sections) {
+		uchar entry[tableEntrySize];
+		memset(entry, 0, tableEntrySize);
+		qToLittleEndian<quint64>(section.offset, entry);
+		qToLittleEndian<quint64>(section.size, entry + 8);
+		qToLittleEndian<quint64>(section.storedSize, entry + 16);
+		qToLittleEndian<quint32>(section.compression, entry + 24);
+		ok = ok && (file.write(reinterpret_cast<const char*>(entry), tableEntrySize) == tableEntrySize);
+	}
+
+	uchar offset[8];
+	qToLittleEndian<quint64>(tableOffset, offset);
+	ok = ok && file.seek(32) && (file.write(reinterpret_cast<const char*>(offset), 8) == 8);
+	file.close();
+
+	if (!ok)
+		m_error = i18n("Could not write the project file %1.", fileName);
+	return ok;
+}
+
+/*!
+	memory-maps the file \c fileName and provides the contained XML document as the content of this device.
+*/
+bool BinaryProjectFile::load(const QString& fileName) {
+	m_file.setFileName(fileName);
+	if (!m_file.open(QIODevice::ReadOnly)) {
+		m_error = i18n("Could not open file %1 for reading.", fileName);
+		return false;
+	}
+
+	const qint64 fileSize = m_file.size();
+	if (fileSize >= headerSize)
+		m_map = m_file.map(0, fileSize);
+	if (!m_map || memcmp(m_map, magic, sizeof(magic)) != 0) {
+		m_error = i18n("%1 is not a binary LabPlot project file.", fileName);
+		return false;
+	}
+
+	const quint32 flags = qFromLittleEndian<quint32>(m_map + 12);
+	if (((flags & bigEndianFlag) != 0) != (Q_BYTE_ORDER == Q_BIG_ENDIAN)) {
+		m_error = i18n("The project file %1 was saved on a machine with a different byte order.", fileName);
+		return false;
+	}
+
+	const quint64 xmlSize = qFromLittleEndian<quint64>(m_map + 16);
+	const quint64 sectionCount = qFromLittleEndian<quint64>(m_map + 24);
+	const quint64 tableOffset = qFromLittleEndian<quint64>(m_map + 32);
+	if (headerSize + xmlSize > (quint64)fileSize || tableOffset > (quint64)fileSize
+			|| sectionCount > ((quint64)fileSize - tableOffset)/tableEntrySize) {
+		m_error = i18n("The project file %1 is corrupted.", fileName);
+		return false;
+	}
+
+	m_sections.clear();
+	for (quint64 i = 0; i < sectionCount; ++i) {
+		const uchar* entry = m_map + tableOffset + i*tableEntrySize;
+		Section section;
+		section.data = reinterpret_cast<const char*>(m_map);
+		section.offset = qFromLittleEndian<quint64>(entry);
+		section.size = qFromLittleEndian<quint64>(entry + 8);
+		section.storedSize = qFromLittleEndian<quint64>(entry + 16);
+		section.compression = qFromLittleEndian<quint32>(entry + 24);
+		if (section.offset + section.storedSize > (quint64)fileSize
+				|| (section.compression == NoCompression && section.storedSize != section.size)) {
+			m_error = i18n("The project file %1 is corrupted.", fileName);
+			return false;
+		}
+		m_sections << section;
+	}
+
+	//the XML document is not copied
+	setData(QByteArray::fromRawData(reinterpret_cast<const char*>(m_map) + headerSize, xmlSize));
+	return true;
+}
+
+QString BinaryProjectFile::lastError() const {
+	return m_error;
+}
+
+/*!
+	returns the size of the data in the section \c index or -1, if there is no such section.
+*/
+qint64 BinaryProjectFile::sectionSize(int index) const {
+	if (index < 0 || index >= m_sections.size())
+		return -1;
+
+	return m_sections.at(index).size;
+}
+
+/*!
+	copies (or decompresses) the data of the section \c index to \c data that has to provide sectionSize() bytes.
+	Can be called from different threads in parallel.
+*/
+bool BinaryProjectFile::readSection(int index, char* data) const {
+	if (!m_map || index < 0 || index >= m_sections.size())
+		return false;
+
+	const Section& section = m_sections.at(index);
+	const char* src = reinterpret_cast<const char*>(m_map) + section.offset;
+	if (section.compression == NoCompression) {
+		memcpy(data, src, section.size);
+		return true;
+	}
+
+	const char* end = src + section.storedSize;
+	quint64 pos = 0;
+	while (src + 4 <= end && pos < section.size) {
+		const quint32 blockSize = qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(src));
+		src += 4;
+		if (blockSize > (quint64)(end - src))
+			return false;
+		const QByteArray block = qUncompress(reinterpret_cast<const uchar*>(src), blockSize);
+		if (block.isEmpty() || pos + block.size() > section.size)
+			return false;
+		memcpy(data + pos, block.constData(), block.size());
+		pos += block.size();
+		src += blockSize;
+	}
+
+	return (pos == section.size);
+}
@@ -0,0 +1,70 @@
+/***************************************************************************
+    File                 : BinaryProjectFile.h
+    Project              : LabPlot
+    Description          : Project file with the column data in binary sections
+    --------------------------------------------------------------------
+    Copyright            : (C) 2017 LabPlot developers
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+#ifndef BINARYPROJECTFILE_H
+#define BINARYPROJECTFILE_H
+
+#include <QBuffer>
+#include <QFile>
+#include <QVector>
+
+class BinaryProjectFile : public QBuffer {
+	public:
+		BinaryProjectFile();
+		~BinaryProjectFile();
+
+		static bool isBinaryProjectFile(const QString& fileName);
+
+		//saving
+		void setCompressionEnabled(bool);
+		bool isCompressionEnabled() const;
+		int addSection(const char* data, qint64 size);
+		bool save(const QString& fileName);
+
+		//loading
+		bool load(const QString& fileName);
+		QString lastError() const;
+		qint64 sectionSize(int index) const;
+		bool readSection(int index, char* data) const;
+
+	private:
+		struct Section {
+			const char* data;	//data to be saved
+			quint64 offset;		//offset of the section in the file
+			quint64 size;		//size of the data
+			quint64 storedSize;	//size of the section in the file
+			quint32 compression;
+		};
+
+		QVector<Section> m_sections;
+		bool m_compressionEnabled;
+		QFile m_file;
+		const uchar* m_map;
+		QString m_error;
+};
+
+#endif
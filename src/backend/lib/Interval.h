@@ -153,6 +153,22 @@ template<class T> class IntervalBase {
 			}
 
 		}
+		//! Return the intersection of two lists of sorted and disjoint intervals
+		static QList< Interval<T> > intersectionOfLists(const QList< Interval<T> >& first, const QList< Interval<T> >& second) {
+			QList< Interval<T> > list;
+			int i = 0, j = 0;
+			while( i < first.size() && j < second.size() )
+			{
+				const Interval<T> temp = intersection(first.at(i), second.at(j));
+				if(temp.isValid())
+					list.append(temp);
+				if(first.at(i).end() < second.at(j).end())
+					i++;
+				else
+					j++;
+			}
+			return list;
+		}
 		//! Subtract an interval from all intervals in the list
 		/**
 		 * Remark: This may increase or decrease the list size.
@@ -195,30 +195,54 @@ template<class T> class IntervalAttribute
 };
 
 //! A class representing an interval-based attribute (bool version)
+/**
+ * The intervals are kept sorted and merged, i.e. they neither intersect nor touch each other.
+ * This allows to find the interval containing a row with a binary search.
+ */
 template<> class IntervalAttribute<bool>
 {
 	public:
 		IntervalAttribute<bool>() {}
-		IntervalAttribute<bool>(QList< Interval<int> > intervals) : m_intervals(intervals) {}
+		IntervalAttribute<bool>(QList< Interval<int> > intervals)
+		{
+			foreach(const Interval<int>& iv, intervals)
+				setValue(iv, true);
+		}
 		IntervalAttribute<bool>& operator=(const IntervalAttribute<bool>& other)
 		{
-			m_intervals.clear();
-			foreach(const Interval<int>& iv, other.intervals())
-				m_intervals.append(iv);
+			m_intervals = other.m_intervals;
 			return *this;
 		}
 
 		void setValue(Interval<int> i, bool value=true)
 		{
+			if(!i.isValid())
+				return;
+
 			if(value)
 			{
-				foreach(const Interval<int>& iv, m_intervals)
-					if(iv.contains(i))
-						return;
-
-				Interval<int>::mergeIntervalIntoList(&m_intervals, i);
+				// merge all intervals intersecting or touching the new one
+				int first = lowerBound(i.start()-1);
+				int last = first;
+				Interval<int> merged = i;
+				while(last < m_intervals.size() && m_intervals.at(last).start() <= i.end()+1)
+				{
+					merged = Interval<int>(qMin(merged.start(), m_intervals.at(last).start()),
+							qMax(merged.end(), m_intervals.at(last).end()));
+					last++;
+				}
+				m_intervals.erase(m_intervals.begin()+first, m_intervals.begin()+last);
+				m_intervals.insert(first, merged);
 			} else { // unset
-				Interval<int>::subtractIntervalFromList(&m_intervals, i);
+				int c = lowerBound(i.start());
+				while(c < m_intervals.size() && m_intervals.at(c).start() <= i.end())
+				{
+					const Interval<int> iv = m_intervals.takeAt(c);
+					if(iv.start() < i.start())
+						m_intervals.insert(c++, Interval<int>(iv.start(), i.start()-1));
+					if(iv.end() > i.end())
+						m_intervals.insert(c++, Interval<int>(i.end()+1, iv.end()));
+				}
 			}
 		}
 
@@ -229,72 +253,87 @@ template<> class IntervalAttribute<bool>
 
 		bool isSet(int row) const
 		{
-			foreach(Interval<int> iv, m_intervals)
-				if(iv.contains(row))
-					return true;
-			return false;
+			const int c = lowerBound(row);
+			return (c < m_intervals.size() && m_intervals.at(c).start() <= row);
 		}
 
 		bool isSet(Interval<int> i) const
 		{
-			foreach(Interval<int> iv, m_intervals)
-				if(iv.contains(i))
-					return true;
-			return false;
+			const int c = lowerBound(i.start());
+			return (c < m_intervals.size() && m_intervals.at(c).contains(i));
 		}
 
 		void insertRows(int before, int count)
 		{
-			QList< Interval<int> > temp_list;
-			int c;
-			// first: split all intervals that contain 'before'
-			for(c=0; c<m_intervals.size(); c++)
+			// first: split the interval that contains 'before'
+			int c = lowerBound(before);
+			if(c < m_intervals.size() && m_intervals.at(c).start() < before)
 			{
-				if(m_intervals.at(c).contains(before))
-				{
-					temp_list = Interval<int>::split(m_intervals.at(c), before);
-					m_intervals.replace(c, temp_list.at(0));
-					if(temp_list.size()>1)
-						m_intervals.insert(c++, temp_list.at(1));
-
-				}
+				const Interval<int> iv = m_intervals.at(c);
+				m_intervals.replace(c, Interval<int>(iv.start(), before-1));
+				m_intervals.insert(++c, Interval<int>(before, iv.end()));
 			}
 			// second: translate all intervals that start at 'before' or later
-			for(c=0; c<m_intervals.size(); c++)
-			{
-				if(m_intervals.at(c).start() >= before)
-					m_intervals[c].translate(count);
-			}
-
+			for(; c<m_intervals.size(); c++)
+				m_intervals[c].translate(count);
 		}
 
 		void removeRows(int first, int count)
 		{
-			int c;
 			// first: remove the relevant rows from all intervals
-			Interval<int>::subtractIntervalFromList(&m_intervals, Interval<int>(first, first+count-1));
+			setValue(Interval<int>(first, first+count-1), false);
 			// second: translate all intervals that start at 'first+count' or later
-			for(c=0; c<m_intervals.size(); c++)
-			{
-				if(m_intervals.at(c).start() >= first+count)
-					m_intervals[c].translate(-count);
-			}
-			// third: merge as many intervals as possible
-			for(c=m_intervals.size()-1; c>=0; c--)
+			const int next = lowerBound(first+count);
+			for(int c=next; c<m_intervals.size(); c++)
+				m_intervals[c].translate(-count);
+			// third: merge the intervals that touch each other now
+			if(next > 0 && next < m_intervals.size() && m_intervals.at(next-1).touches(m_intervals.at(next)))
 			{
-				Interval<int> iv = m_intervals.takeAt(c);
-				int size_before = m_intervals.size();
-				Interval<int>::mergeIntervalIntoList(&m_intervals, iv);
-				if(size_before == m_intervals.size()) // merge successful
-					c--;
+				m_intervals.replace(next-1, Interval<int>::merge(m_intervals.at(next-1), m_intervals.at(next)));
+				m_intervals.removeAt(next);
 			}
 		}
 
 		QList< Interval<int> > intervals() const { return m_intervals; }
 
+		//! Return the intervals of rows in \c range that are not set
+		/**
+		 * Allows to iterate over the unset rows blockwise instead of calling isSet() for every row.
+		 */
+		QList< Interval<int> > unsetIntervals(Interval<int> range) const
+		{
+			QList< Interval<int> > list;
+			int start = range.start();
+			for(int c=lowerBound(range.start()); c<m_intervals.size() && m_intervals.at(c).start() <= range.end(); c++)
+			{
+				if(m_intervals.at(c).start() > start)
+					list.append(Interval<int>(start, m_intervals.at(c).start()-1));
+				start = m_intervals.at(c).end()+1;
+			}
+			if(start <= range.end())
+				list.append(Interval<int>(start, range.end()));
+			return list;
+		}
+
 		void clear() { m_intervals.clear(); }
 
 	private:
+		//! Return the index of the first interval ending at \c row or later
+		int lowerBound(int row) const
+		{
+			int low = 0;
+			int high = m_intervals.size();
+			while(low < high)
+			{
+				const int mid = (low+high)/2;
+				if(m_intervals.at(mid).end() < row)
+					low = mid+1;
+				else
+					high = mid;
+			}
+			return low;
+		}
+
 		QList< Interval<int> > m_intervals;
 };
 
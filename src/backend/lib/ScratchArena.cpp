@@ -0,0 +1,202 @@
+/***************************************************************************
+    File                 : ScratchArena.cpp
+    Project              : LabPlot
+    Description          : Per-thread arena for temporary buffers
+    --------------------------------------------------------------------
+    Copyright            : (C) 2017 LabPlot developers
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "backend/lib/ScratchArena.h"
+#include <QThreadStorage>
+#include <QAtomicInteger>
+#include <cstdlib>
+#include <new>
+
+//allocations are aligned to cache lines
+static const qint64 alignment = 64;
+static const qint64 minBlockSize = 64*1024;
+
+//one arena per thread, deleted when the thread finishes
+static QThreadStorage<ScratchArena*> arenas;
+
+//instrumentation, summed over all threads
+static QAtomicInteger<qint64> totalInUse(0);
+static QAtomicInteger<qint64> totalReserved(0);
+static QAtomicInteger<qint64> peakInUse(0);
+static QAtomicInteger<qint64> maxRetained(64*1024*1024);
+static QAtomicPointer<void> usageHook(0);
+
+/*!
+	\class ScratchArena
+	\brief Per-thread bump allocator for temporary buffers of the calculations.
+
+	Buffers of the size of the data (e.g. the arrays passed to GSL or nsl) are taken from
+	this arena via a ScratchScope instead of the stack or the heap. The memory is released
+	at the end of the scope and reused by the next calculation in the same thread.
+	When the outermost scope is left, blocks are joined into one block of the size used so far,
+	more than setMaxRetainedBytes() are returned to the system.
+
+	\ingroup backend
+*/
+ScratchArena::ScratchArena() : m_block(0), m_offset(0), m_used(0), m_reserved(0), m_hint(0), m_scopes(0) {
+}
+
+ScratchArena::~ScratchArena() {
+	freeBlocks();
+}
+
+/*!
+	returns the arena of the current thread.
+*/
+ScratchArena* ScratchArena::instance() {
+	if (!arenas.hasLocalData())
+		arenas.setLocalData(new ScratchArena());
+	return arenas.localData();
+}
+
+/*!
+	sets the function called with the total number of bytes in use and reserved
+	whenever scratch memory is allocated or released (in the thread doing this).
+*/
+void ScratchArena::setUsageHook(UsageHook hook) {
+	usageHook.storeRelease(reinterpret_cast<void*>(hook));
+}
+
+qint64 ScratchArena::bytesInUse() {
+	return totalInUse.load();
+}
+
+qint64 ScratchArena::bytesReserved() {
+	return totalReserved.load();
+}
+
+qint64 ScratchArena::peakBytesInUse() {
+	return peakInUse.load();
+}
+
+/*!
+	sets the number of bytes an arena keeps for the next calculations after all scopes were left.
+*/
+void ScratchArena::setMaxRetainedBytes(qint64 bytes) {
+	maxRetained.store(bytes);
+}
+
+void* ScratchArena::allocate(qint64 size) {
+	size = qMax(alignment, (size + alignment - 1)/alignment*alignment);
+
+	while (m_block < m_blocks.size() && m_offset + size > m_blocks.at(m_block).size) {
+		//the rest of the block is skipped
+		++m_block;
+		m_offset = 0;
+	}
+
+	if (m_block == m_blocks.size()) {
+		const qint64 blockSize = qMax(size, qMax(minBlockSize, qMax(m_hint, m_reserved)));
+		Block block;
+		block.base = static_cast<char*>(malloc(blockSize + alignment));
+		if (!block.base)
+			throw std::bad_alloc();
+		block.data = block.base + (alignment - reinterpret_cast<quintptr>(block.base) % alignment) % alignment;
+		block.size = blockSize;
+		m_blocks << block;
+		m_reserved += blockSize;
+		totalReserved.fetchAndAddRelaxed(blockSize);
+	}
+
+	void* data = m_blocks.at(m_block).data + m_offset;
+	m_offset += size;
+	m_used += size;
+
+	const qint64 inUse = totalInUse.fetchAndAddRelaxed(size) + size;
+	qint64 peak = peakInUse.load();
+	while (inUse > peak && !peakInUse.testAndSetRelaxed(peak, inUse))
+		peak = peakInUse.load();
+
+	notify();
+	return data;
+}
+
+ScratchArena::Mark ScratchArena::mark() const {
+	Mark mark;
+	mark.block = m_block;
+	mark.offset = m_offset;
+	mark.used = m_used;
+	return mark;
+}
+
+void ScratchArena::release(const Mark& mark) {
+	totalInUse.fetchAndAddRelaxed(mark.used - m_used);
+	m_block = mark.block;
+	m_offset = mark.offset;
+	m_used = mark.used;
+
+	//all buffers released: keep one block of the size needed so far
+	if (m_scopes == 0 && (m_blocks.size() > 1 || m_reserved > maxRetained.load())) {
+		const qint64 reserved = m_reserved;
+		freeBlocks();
+		if (reserved <= maxRetained.load())
+			m_hint = reserved;
+	}
+
+	notify();
+}
+
+void ScratchArena::freeBlocks() {
+	foreach (const Block& block, m_blocks)
+		free(block.base);
+	m_blocks.clear();
+	totalReserved.fetchAndAddRelaxed(-m_reserved);
+	m_reserved = 0;
+	m_hint = 0;
+	m_block = 0;
+	m_offset = 0;
+}
+
+void ScratchArena::notify() const {
+	UsageHook hook = reinterpret_cast<UsageHook>(usageHook.loadAcquire());
+	if (hook)
+		hook(totalInUse.load(), totalReserved.load());
+}
+
+/*!
+	\class ScratchScope
+	\brief Allocates temporary buffers from the ScratchArena of the current thread
+	and releases them when the scope is left.
+
+	\code
+	ScratchScope scratch;
+	double* x = scratch.allocate<double>(count);
+	\endcode
+
+	Scopes can be nested, the buffers are not initialized.
+
+	\ingroup backend
+*/
+ScratchScope::ScratchScope() : m_arena(ScratchArena::instance()), m_mark(m_arena->mark()) {
+	++m_arena->m_scopes;
+}
+
+ScratchScope::~ScratchScope() {
+	--m_arena->m_scopes;
+	m_arena->release(m_mark);
+}
@@ -0,0 +1,93 @@
+/***************************************************************************
+    File                 : ScratchArena.h
+    Project              : LabPlot
+    Description          : Per-thread arena for temporary buffers
+    --------------------------------------------------------------------
+    Copyright            : (C) 2017 LabPlot developers
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+#ifndef SCRATCHARENA_H
+#define SCRATCHARENA_H
+
+#include <QVector>
+
+//temporary buffers of the calculations, see ScratchScope
+
+class ScratchArena {
+	public:
+		~ScratchArena();
+
+		static ScratchArena* instance();
+
+		//instrumentation
+		typedef void (*UsageHook)(qint64 bytesInUse, qint64 bytesReserved);
+		static void setUsageHook(UsageHook);
+		static qint64 bytesInUse();
+		static qint64 bytesReserved();
+		static qint64 peakBytesInUse();
+		static void setMaxRetainedBytes(qint64);
+
+	private:
+		friend class ScratchScope;
+		struct Block {
+			char* base;	//allocated memory
+			char* data;	//aligned start
+			qint64 size;
+		};
+		struct Mark {
+			int block;
+			qint64 offset;
+			qint64 used;
+		};
+
+		ScratchArena();
+		void* allocate(qint64 size);
+		Mark mark() const;
+		void release(const Mark&);
+		void freeBlocks();
+		void notify() const;
+
+		QVector<Block> m_blocks;
+		int m_block;		//block the next allocation is taken from
+		qint64 m_offset;	//position in this block
+		qint64 m_used;
+		qint64 m_reserved;
+		qint64 m_hint;		//size of the next block
+		int m_scopes;		//number of open scopes
+};
+
+class ScratchScope {
+	public:
+		ScratchScope();
+		~ScratchScope();
+
+		template <typename T> T* allocate(qint64 count) {
+			return static_cast<T*>(m_arena->allocate(count*qint64(sizeof(T))));
+		}
+
+	private:
+		Q_DISABLE_COPY(ScratchScope)
+		ScratchArena* m_arena;
+		ScratchArena::Mark m_mark;
+};
+
+#endif
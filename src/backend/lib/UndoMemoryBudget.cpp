@@ -0,0 +1,137 @@
+/***************************************************************************
+    File                 : UndoMemoryBudget.cpp
+    Project              : LabPlot
+    Description          : Memory limit for the data kept by the undo commands
+    --------------------------------------------------------------------
+    Copyright            : (C) 2017 LabPlot developers
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "backend/lib/UndoMemoryBudget.h"
+#include <QUndoStack>
+#include <QVector>
+
+/*!
+	\class BudgetedUndoCommand
+	\brief Base class for undo commands keeping larger amounts of data to undo and redo their changes.
+
+	The data is accounted for in UndoMemoryBudget. Once released, the command must not be undone or redone anymore,
+	the stack is never moved behind it (\sa UndoMemoryBudget::firstUndoableIndex()).
+
+	\ingroup backend
+*/
+BudgetedUndoCommand::BudgetedUndoCommand(QUndoCommand* parent) : QUndoCommand(parent), m_released(false) {
+}
+
+bool BudgetedUndoCommand::isReleased() const {
+	return m_released;
+}
+
+/*!
+	returns the memory kept by \c command and its child commands in bytes.
+*/
+qint64 BudgetedUndoCommand::totalMemoryCost(const QUndoCommand* command) {
+	qint64 cost = 0;
+	const BudgetedUndoCommand* budgeted = dynamic_cast<const BudgetedUndoCommand*>(command);
+	if (budgeted)
+		cost += budgeted->memoryCost();
+
+	for (int i = 0; i < command->childCount(); ++i)
+		cost += totalMemoryCost(command->child(i));
+
+	return cost;
+}
+
+/*!
+	releases the memory kept by \c command and its child commands.
+*/
+void BudgetedUndoCommand::releaseTotalMemory(QUndoCommand* command) {
+	BudgetedUndoCommand* budgeted = dynamic_cast<BudgetedUndoCommand*>(command);
+	if (budgeted && !budgeted->m_released) {
+		budgeted->releaseMemory();
+		budgeted->m_released = true;
+	}
+
+	for (int i = 0; i < command->childCount(); ++i)
+		releaseTotalMemory(const_cast<QUndoCommand*>(command->child(i)));
+}
+
+/*!
+	\class UndoMemoryBudget
+	\brief Limits the memory kept by the commands on an undo stack.
+
+	If the commands that can be undone keep more memory than the limit, the memory of the oldest commands
+	is released. These commands can't be undone anymore, the undo action and the history stop at the first
+	command that was not released, \sa firstUndoableIndex(). The most recent command always stays undoable.
+	The commands that can be redone are not touched.
+
+	\ingroup backend
+*/
+UndoMemoryBudget::UndoMemoryBudget(QUndoStack* stack) : QObject(stack),
+	m_stack(stack), m_limit(0), m_usage(0), m_firstUndoable(0) {
+
+	connect(m_stack, SIGNAL(indexChanged(int)), this, SLOT(indexChanged(int)));
+}
+
+/*!
+	sets the memory limit in bytes, 0 for no limit.
+*/
+void UndoMemoryBudget::setLimit(qint64 limit) {
+	m_limit = limit;
+	indexChanged(m_stack->index());
+}
+
+qint64 UndoMemoryBudget::limit() const {
+	return m_limit;
+}
+
+/*!
+	returns the memory kept by the commands on the stack in bytes.
+*/
+qint64 UndoMemoryBudget::usage() const {
+	return m_usage;
+}
+
+/*!
+	returns the index of the oldest command on the stack that can still be undone.
+*/
+int UndoMemoryBudget::firstUndoableIndex() const {
+	return m_firstUndoable;
+}
+
+void UndoMemoryBudget::indexChanged(int index) {
+	if (m_stack->count() == 0 || m_firstUndoable > m_stack->count())
+		m_firstUndoable = 0;
+
+	QVector<qint64> costs(m_stack->count());
+	m_usage = 0;
+	for (int i = m_firstUndoable; i < m_stack->count(); ++i) {
+		costs[i] = BudgetedUndoCommand::totalMemoryCost(m_stack->command(i));
+		m_usage += costs[i];
+	}
+
+	while (m_limit > 0 && m_usage > m_limit && m_firstUndoable < index - 1) {
+		BudgetedUndoCommand::releaseTotalMemory(const_cast<QUndoCommand*>(m_stack->command(m_firstUndoable)));
+		m_usage -= costs[m_firstUndoable];
+		++m_firstUndoable;
+	}
+}
@@ -0,0 +1,72 @@
+/***************************************************************************
+    File                 : UndoMemoryBudget.h
+    Project              : LabPlot
+    Description          : Memory limit for the data kept by the undo commands
+    --------------------------------------------------------------------
+    Copyright            : (C) 2017 LabPlot developers
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+#ifndef UNDOMEMORYBUDGET_H
+#define UNDOMEMORYBUDGET_H
+
+#include <QObject>
+#include <QUndoCommand>
+
+class QUndoStack;
+
+class BudgetedUndoCommand : public QUndoCommand {
+	public:
+		explicit BudgetedUndoCommand(QUndoCommand* parent = 0);
+
+		virtual qint64 memoryCost() const = 0;
+		virtual void releaseMemory() = 0;
+		bool isReleased() const;
+
+		static qint64 totalMemoryCost(const QUndoCommand*);
+		static void releaseTotalMemory(QUndoCommand*);
+
+	protected:
+		bool m_released;
+};
+
+class UndoMemoryBudget : public QObject {
+	Q_OBJECT
+
+	public:
+		explicit UndoMemoryBudget(QUndoStack*);
+
+		void setLimit(qint64);
+		qint64 limit() const;
+		qint64 usage() const;
+		int firstUndoableIndex() const;
+
+	private:
+		QUndoStack* m_stack;
+		qint64 m_limit;
+		qint64 m_usage;
+		int m_firstUndoable;
+
+	private slots:
+		void indexChanged(int);
+};
+
+#endif
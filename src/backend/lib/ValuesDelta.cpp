@@ -0,0 +1,158 @@
+/***************************************************************************
+    File                 : ValuesDelta.cpp
+    Project              : LabPlot
+    Description          : Compressed reversible difference of two arrays of doubles
+    --------------------------------------------------------------------
+    Copyright            : (C) 2017 LabPlot developers
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "backend/lib/ValuesDelta.h"
+#include <cstring>
+
+//number of values compressed together
+static const int blockSize = 65536;
+
+/*!
+	\class ValuesDelta
+	\brief Compressed difference between two arrays of doubles that allows to get each of the arrays back from the other one.
+
+	The bit patterns of the values both arrays have in common are XORed, values that didn't change
+	become zero. The bytes of the values are shuffled so that the bytes with the same significance
+	(sign and exponent, upper and lower parts of the mantissa) are compressed together.
+	The values of the longer array behind the common part are stored compressed as they are.
+
+	Used by the undo commands of the columns to store the replaced values, \sa ColumnReplaceValuesCmd.
+
+	\ingroup backend
+*/
+ValuesDelta::ValuesDelta() : m_fromSize(0), m_toSize(0), m_encoded(false) {
+}
+
+/*!
+	stores the difference between the \c fromSize values at \c from and the \c toSize values at \c to.
+*/
+void ValuesDelta::encode(const double* from, int fromSize, const double* to, int toSize) {
+	clear();
+	const int common = qMin(fromSize, toSize);
+	compress(from, to, common, m_xorBlocks);
+	compress(from + common, 0, fromSize - common, m_fromTail);
+	compress(to + common, 0, toSize - common, m_toTail);
+	m_fromSize = fromSize;
+	m_toSize = toSize;
+	m_encoded = true;
+}
+
+/*!
+	returns the second array from the values of the first array at \c data if \c forward is \c true
+	and the first array from the values of the second array otherwise.
+*/
+QVector<double> ValuesDelta::apply(const double* data, bool forward) const {
+	QVector<double> result(forward ? m_toSize : m_fromSize);
+	const int common = qMin(m_fromSize, m_toSize);
+	decompress(m_xorBlocks, data, result.data());
+	decompress(forward ? m_toTail : m_fromTail, 0, result.data() + common);
+	return result;
+}
+
+void ValuesDelta::clear() {
+	m_xorBlocks.clear();
+	m_fromTail.clear();
+	m_toTail.clear();
+	m_fromSize = 0;
+	m_toSize = 0;
+	m_encoded = false;
+}
+
+bool ValuesDelta::isEmpty() const {
+	return !m_encoded;
+}
+
+int ValuesDelta::fromSize() const {
+	return m_fromSize;
+}
+
+int ValuesDelta::toSize() const {
+	return m_toSize;
+}
+
+/*!
+	returns the number of bytes used for the compressed data.
+*/
+qint64 ValuesDelta::memoryCost() const {
+	qint64 cost = 0;
+	foreach (const QByteArray& block, m_xorBlocks)
+		cost += block.size();
+	foreach (const QByteArray& block, m_fromTail)
+		cost += block.size();
+	foreach (const QByteArray& block, m_toTail)
+		cost += block.size();
+	return cost;
+}
+
+/*!
+	compresses the \c count values at \c data, XORed with the values at \c other if \c other is not null, block-wise into \c blocks.
+*/
+void ValuesDelta::compress(const double* data, const double* other, int count, QVector<QByteArray>& blocks) {
+	QByteArray shuffled;
+	for (int start = 0; start < count; start += blockSize) {
+		const int size = qMin(blockSize, count - start);
+		shuffled.resize(size*8);
+		uchar* bytes = reinterpret_cast<uchar*>(shuffled.data());
+		for (int i = 0; i < size; ++i) {
+			quint64 value;
+			memcpy(&value, data + start + i, 8);
+			if (other) {
+				quint64 otherValue;
+				memcpy(&otherValue, other + start + i, 8);
+				value ^= otherValue;
+			}
+			for (int b = 0; b < 8; ++b)
+				bytes[b*size + i] = (uchar)(value >> (8*b));
+		}
+		blocks << qCompress(shuffled, 1);
+	}
+}
+
+/*!
+	decompresses \c blocks to \c data and XORs the values with the values at \c other if \c other is not null.
+*/
+void ValuesDelta::decompress(const QVector<QByteArray>& blocks, const double* other, double* data) {
+	int start = 0;
+	foreach (const QByteArray& block, blocks) {
+		const QByteArray shuffled = qUncompress(block);
+		const uchar* bytes = reinterpret_cast<const uchar*>(shuffled.constData());
+		const int size = shuffled.size()/8;
+		for (int i = 0; i < size; ++i) {
+			quint64 value = 0;
+			for (int b = 0; b < 8; ++b)
+				value |= (quint64)bytes[b*size + i] << (8*b);
+			if (other) {
+				quint64 otherValue;
+				memcpy(&otherValue, other + start + i, 8);
+				value ^= otherValue;
+			}
+			memcpy(data + start + i, &value, 8);
+		}
+		start += size;
+	}
+}
@@ -0,0 +1,58 @@
+/***************************************************************************
+    File                 : ValuesDelta.h
+    Project              : LabPlot
+    Description          : Compressed reversible difference of two arrays of doubles
+    --------------------------------------------------------------------
+    Copyright            : (C) 2017 LabPlot developers
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+#ifndef VALUESDELTA_H
+#define VALUESDELTA_H
+
+#include <QByteArray>
+#include <QVector>
+
+class ValuesDelta {
+	public:
+		ValuesDelta();
+
+		void encode(const double* from, int fromSize, const double* to, int toSize);
+		QVector<double> apply(const double* data, bool forward) const;
+		void clear();
+		bool isEmpty() const;
+		int fromSize() const;
+		int toSize() const;
+		qint64 memoryCost() const;
+
+	private:
+		static void compress(const double* data, const double* other, int count, QVector<QByteArray>& blocks);
+		static void decompress(const QVector<QByteArray>& blocks, const double* other, double* data);
+
+		QVector<QByteArray> m_xorBlocks;	//XOR of the values both arrays have in common
+		QVector<QByteArray> m_fromTail;		//values of the first array behind the common part
+		QVector<QByteArray> m_toTail;		//values of the second array behind the common part
+		int m_fromSize;
+		int m_toSize;
+		bool m_encoded;
+};
+
+#endif
@@ -28,11 +28,8 @@
 
 #include "nsl_dft.h"
 #include "nsl_common.h"
-#include <gsl/gsl_fft_real.h>
-#include <gsl/gsl_fft_halfcomplex.h>
-#ifdef HAVE_FFTW3
-#include <fftw3.h>
-#endif
+#include "nsl_fft.h"
+#include <gsl/gsl_math.h>
 
 const char* nsl_dft_result_type_name[] = {i18n("Magnitude"), i18n("Amplitude"), i18n("real part"), i18n("imaginary part"), i18n("Power"), i18n("Phase"),
 		i18n("Amplitude in dB"), i18n("normalized amplitude in dB"), i18n("Magnitude squared"), i18n("Amplitude squared"), i18n("raw")};
@@ -51,18 +48,15 @@ int nsl_dft_transform_window(double data[], size_t stride, size_t n, int two_sid
 
 int nsl_dft_transform(double data[], size_t stride, size_t n, int two_sided, nsl_dft_result_type type) {
 	size_t i;
-	double result[2*n];
 	size_t N=n/2;	/* number of resulting data points */
 	if(two_sided)
 		N=n;
-#ifdef HAVE_FFTW3
-	/* stride ignored */
-	(void)stride;
-
-	fftw_plan plan = fftw_plan_dft_r2c_1d(n, data, (fftw_complex *) result, FFTW_ESTIMATE);
-	fftw_execute(plan);
-	fftw_destroy_plan(plan);
 
+	/* 1. transform (cached plan and result buffer) */
+	double* result = nsl_fft_real_forward(data, stride, n);
+	if (result == NULL)
+		return -1;
+#ifdef HAVE_FFTW3
 	/* 2. unpack data */
 	if(two_sided) {
 		for(i = 1; i < n-i; i++) {
@@ -74,17 +68,6 @@ int nsl_dft_transform(double data[], size_t stride, size_t n, int two_sided, nsl
 			result[2*i+1] = 0;
 		}
 	}
-#else
-	/* 1. transform */
-	gsl_fft_real_wavetable *real = gsl_fft_real_wavetable_alloc(n);
-	gsl_fft_real_workspace *work = gsl_fft_real_workspace_alloc(n);
-
-	gsl_fft_real_transform(data, stride, n, real, work);
-	gsl_fft_real_wavetable_free(real);
-	gsl_fft_real_workspace_free(work);
-
-	/* 2. unpack data */
-	gsl_fft_halfcomplex_unpack(data, result, stride, n);
 #endif
 
 	/* 3. write result */
@@ -0,0 +1,234 @@
+/***************************************************************************
+    File                 : nsl_fft.c
+    Project              : LabPlot
+    Description          : NSL FFT plan and workspace cache
+    --------------------------------------------------------------------
+    Copyright            : (C) 2017 LabPlot developers
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "nsl_fft.h"
+#include "nsl_common.h"
+#include <string.h>
+#include <gsl/gsl_fft_real.h>
+#include <gsl/gsl_fft_halfcomplex.h>
+#ifdef HAVE_FFTW3
+#include <fftw3.h>
+#endif
+
+typedef enum {nsl_fft_direction_forward, nsl_fft_direction_inverse} nsl_fft_direction;
+
+/* cached transform of size n */
+typedef struct {
+	size_t n;		/* 0: unused entry */
+	nsl_fft_direction direction;
+	unsigned long used;	/* time of the last use */
+	size_t memory;
+	double* buffer;		/* complex result (forward) or complex input (inverse) */
+#ifdef HAVE_FFTW3
+	fftw_plan plan;
+	double* real;		/* real input (forward) or real result (inverse) */
+#else
+	gsl_fft_real_wavetable* real;
+	gsl_fft_halfcomplex_wavetable* hc;
+	gsl_fft_real_workspace* work;
+#endif
+} nsl_fft_cache_entry;
+
+static nsl_fft_cache_entry nsl_fft_cache[NSL_FFT_CACHE_SIZE];
+static unsigned long nsl_fft_cache_time = 0;
+static int nsl_fft_measure = 0;
+
+static void nsl_fft_cache_release(nsl_fft_cache_entry* entry) {
+#ifdef HAVE_FFTW3
+	if (entry->plan)
+		fftw_destroy_plan(entry->plan);
+	fftw_free(entry->real);
+	fftw_free(entry->buffer);
+#else
+	if (entry->real)
+		gsl_fft_real_wavetable_free(entry->real);
+	if (entry->hc)
+		gsl_fft_halfcomplex_wavetable_free(entry->hc);
+	if (entry->work)
+		gsl_fft_real_workspace_free(entry->work);
+	free(entry->buffer);
+#endif
+	memset(entry, 0, sizeof(nsl_fft_cache_entry));
+}
+
+/* creates the plan (wavetable) and the buffers of the transform. returns 0 on success */
+static int nsl_fft_cache_init(nsl_fft_cache_entry* entry, size_t n, nsl_fft_direction direction) {
+	entry->n = n;
+	entry->direction = direction;
+#ifdef HAVE_FFTW3
+	const unsigned flags = nsl_fft_measure ? FFTW_MEASURE : FFTW_ESTIMATE;
+	/* the buffers are aligned by fftw_malloc() */
+	entry->real = fftw_alloc_real(n);
+	if (direction == nsl_fft_direction_forward) {
+		/* room for the two-sided result */
+		entry->buffer = (double *) fftw_alloc_complex(n);
+		entry->memory = 3*n*sizeof(double);
+		if (entry->real && entry->buffer)
+			entry->plan = fftw_plan_dft_r2c_1d(n, entry->real, (fftw_complex *) entry->buffer, flags);
+	} else {
+		entry->buffer = (double *) fftw_alloc_complex(n/2+1);
+		entry->memory = (n+2*(n/2+1))*sizeof(double);
+		if (entry->real && entry->buffer)
+			entry->plan = fftw_plan_dft_c2r_1d(n, (fftw_complex *) entry->buffer, entry->real, flags);
+	}
+
+	return entry->plan ? 0 : -1;
+#else
+	entry->work = gsl_fft_real_workspace_alloc(n);
+	/* workspace and trigonometric tables */
+	entry->memory = 2*n*sizeof(double);
+	if (direction == nsl_fft_direction_forward) {
+		entry->real = gsl_fft_real_wavetable_alloc(n);
+		entry->buffer = (double *) malloc(2*n*sizeof(double));
+		entry->memory += 2*n*sizeof(double);
+		return (entry->work && entry->real && entry->buffer) ? 0 : -1;
+	} else {
+		entry->hc = gsl_fft_halfcomplex_wavetable_alloc(n);
+		return (entry->work && entry->hc) ? 0 : -1;
+	}
+#endif
+}
+
+/* returns the cached transform of size n, creating it (in place of the least recently used one) if necessary */
+static nsl_fft_cache_entry* nsl_fft_cache_get(size_t n, nsl_fft_direction direction) {
+	if (n == 0)
+		return NULL;
+
+	nsl_fft_cache_entry* entry = NULL;
+	size_t i;
+	for (i = 0; i < NSL_FFT_CACHE_SIZE; i++) {
+		if (nsl_fft_cache[i].n == n && nsl_fft_cache[i].direction == direction) {
+			nsl_fft_cache[i].used = ++nsl_fft_cache_time;
+			return &nsl_fft_cache[i];
+		}
+		/* unused entries have used == 0 */
+		if (entry == NULL || nsl_fft_cache[i].used < entry->used)
+			entry = &nsl_fft_cache[i];
+	}
+
+	nsl_fft_cache_release(entry);
+	if (nsl_fft_cache_init(entry, n, direction) != 0) {
+		printf("nsl_fft: could not allocate transform of size %zu\n", n);
+		nsl_fft_cache_release(entry);
+		return NULL;
+	}
+	entry->used = ++nsl_fft_cache_time;
+
+	return entry;
+}
+
+double* nsl_fft_real_forward(double data[], size_t stride, size_t n) {
+	nsl_fft_cache_entry* entry = nsl_fft_cache_get(n, nsl_fft_direction_forward);
+	if (entry == NULL)
+		return NULL;
+
+#ifdef HAVE_FFTW3
+	size_t i;
+	for (i = 0; i < n; i++)
+		entry->real[i] = data[i*stride];
+	fftw_execute(entry->plan);
+#else
+	gsl_fft_real_transform(data, stride, n, entry->real, entry->work);
+	gsl_fft_halfcomplex_unpack(data, entry->buffer, stride, n);
+#endif
+
+	return entry->buffer;
+}
+
+int nsl_fft_real_inverse(double fdata[], double data[], size_t n) {
+	nsl_fft_cache_entry* entry = nsl_fft_cache_get(n, nsl_fft_direction_inverse);
+	if (entry == NULL)
+		return -1;
+
+	size_t i;
+#ifdef HAVE_FFTW3
+	/* the c2r transform overwrites its input */
+	memcpy(entry->buffer, fdata, 2*(n/2+1)*sizeof(double));
+	fftw_execute(entry->plan);
+	for (i = 0; i < n; i++)
+		data[i] = entry->real[i]/n;
+#else
+	/* pack into halfcomplex format */
+	data[0] = fdata[0];
+	for (i = 1; i < n-i; i++) {
+		data[2*i-1] = fdata[2*i];
+		data[2*i] = fdata[2*i+1];
+	}
+	if (i == n-i)
+		data[n-1] = fdata[n];
+
+	gsl_fft_halfcomplex_inverse(data, 1, n, entry->hc, entry->work);
+#endif
+
+	return 0;
+}
+
+void nsl_fft_cache_clear(void) {
+	size_t i;
+	for (i = 0; i < NSL_FFT_CACHE_SIZE; i++)
+		nsl_fft_cache_release(&nsl_fft_cache[i]);
+}
+
+size_t nsl_fft_cache_count(void) {
+	size_t i, count = 0;
+	for (i = 0; i < NSL_FFT_CACHE_SIZE; i++)
+		if (nsl_fft_cache[i].n > 0)
+			count++;
+
+	return count;
+}
+
+size_t nsl_fft_cache_memory(void) {
+	size_t i, memory = 0;
+	for (i = 0; i < NSL_FFT_CACHE_SIZE; i++)
+		memory += nsl_fft_cache[i].memory;
+
+	return memory;
+}
+
+void nsl_fft_set_measure(int measure) {
+	nsl_fft_measure = measure;
+}
+
+int nsl_fft_wisdom_import(const char* filename) {
+#ifdef HAVE_FFTW3
+	return fftw_import_wisdom_from_filename(filename) ? 0 : -1;
+#else
+	(void)filename;
+	return -1;
+#endif
+}
+
+int nsl_fft_wisdom_export(const char* filename) {
+#ifdef HAVE_FFTW3
+	return fftw_export_wisdom_to_filename(filename) ? 0 : -1;
+#else
+	(void)filename;
+	return -1;
+#endif
+}
@@ -0,0 +1,68 @@
+/***************************************************************************
+    File                 : nsl_fft.h
+    Project              : LabPlot
+    Description          : NSL FFT plan and workspace cache
+    --------------------------------------------------------------------
+    Copyright            : (C) 2017 LabPlot developers
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef NSL_FFT_H
+#define NSL_FFT_H
+
+#include <stdlib.h>
+
+/* FFT plan and workspace cache
+
+	The FFTW plans (or GSL wavetables) and the work buffers of the real transforms
+	are kept per size and direction and reused by the following transforms of the same size.
+	A transform of a cached size only costs the execution of the plan.
+	The least recently used entry is released when more than NSL_FFT_CACHE_SIZE sizes are used.
+	The cache is not thread-safe.
+*/
+#define NSL_FFT_CACHE_SIZE 8
+
+/* transforms the real data of size n (with stride).
+	returns the complex result re0,im0,re1,im1,... in a cached buffer of 2*n doubles
+	that is valid until the next transform of size n.
+	The first n/2+1 values are set (FFTW) or all n values (GSL: data contains the halfcomplex result).
+	returns NULL if the transform could not be allocated.
+*/
+double* nsl_fft_real_forward(double data[], size_t stride, size_t n);
+/* inverse transform of the first n/2+1 complex values of fdata (re0,im0,re1,im1,...) into the real data of size n.
+	The result is normalized. fdata may be the buffer returned by nsl_fft_real_forward() */
+int nsl_fft_real_inverse(double fdata[], double data[], size_t n);
+
+/* releases all cached plans and buffers */
+void nsl_fft_cache_clear(void);
+/* number of cached transforms and memory used by them in bytes */
+size_t nsl_fft_cache_count(void);
+size_t nsl_fft_cache_memory(void);
+
+/* FFTW: plan new transforms with FFTW_MEASURE instead of FFTW_ESTIMATE
+	(slower planning, faster execution, profits from imported wisdom) */
+void nsl_fft_set_measure(int measure);
+/* FFTW: import/export the accumulated wisdom from/to the file filename. returns 0 on success */
+int nsl_fft_wisdom_import(const char* filename);
+int nsl_fft_wisdom_export(const char* filename);
+
+#endif /* NSL_FFT_H */
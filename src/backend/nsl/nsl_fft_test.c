@@ -0,0 +1,83 @@
+/***************************************************************************
+    File                 : nsl_fft_test.c
+    Project              : LabPlot
+    Description          : NSL FFT cache test
+    --------------------------------------------------------------------
+    Copyright            : (C) 2017 LabPlot developers
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+#include "nsl_fft.h"
+
+/* compare the cached transforms with the direct DFT and time repeated transforms of the same size */
+int main() {
+	size_t n, i, k;
+	double maxerr = 0;
+	for (n = 1; n <= 64; n++) {
+		double* data = (double *)malloc(n*sizeof(double));
+		double* orig = (double *)malloc(n*sizeof(double));
+		for (i = 0; i < n; i++)
+			orig[i] = data[i] = sin(0.3*i) + (i % 3);
+
+		double* fdata = nsl_fft_real_forward(data, 1, n);
+		for (k = 0; k < n/2+1; k++) {
+			double re = 0, im = 0;
+			for (i = 0; i < n; i++) {
+				re += orig[i]*cos(2.*M_PI*i*k/n);
+				im -= orig[i]*sin(2.*M_PI*i*k/n);
+			}
+			maxerr = fmax(maxerr, fmax(fabs(fdata[2*k] - re), fabs(fdata[2*k+1] - im)));
+		}
+
+		nsl_fft_real_inverse(fdata, data, n);
+		for (i = 0; i < n; i++)
+			maxerr = fmax(maxerr, fabs(data[i] - orig[i]));
+
+		free(data);
+		free(orig);
+	}
+	printf("max error for n = 1 .. 64: %g\n", maxerr);
+	printf("cached transforms: %zu (%zu bytes)\n", nsl_fft_cache_count(), nsl_fft_cache_memory());
+
+	/* repeated transforms only execute the cached plan */
+	n = 1000003;	/* prime */
+	const int repeat = 10;
+	double* data = (double *)malloc(n*sizeof(double));
+	int r;
+	for (r = 0; r < repeat; r++) {
+		for (i = 0; i < n; i++)
+			data[i] = sin(0.001*i);
+		clock_t start = clock();
+		double* fdata = nsl_fft_real_forward(data, 1, n);
+		nsl_fft_real_inverse(fdata, data, n);
+		printf("n = %zu, run %d: %g s\n", n, r + 1, (double)(clock() - start)/CLOCKS_PER_SEC);
+	}
+	free(data);
+
+	nsl_fft_cache_clear();
+	printf("cached transforms after clear: %zu\n", nsl_fft_cache_count());
+
+	return 0;
+}
@@ -30,7 +30,6 @@
 #include "nsl_geom.h"
 #include "nsl_common.h"
 #include "nsl_sort.h"
-#include "nsl_stats.h"
 
 const char* nsl_geom_linesim_type_name[] = {i18n("Douglas-Peucker (number)"), i18n("Douglas-Peucker (tolerance)"), i18n("Visvalingam-Whyatt"), i18n("Reumann-Witkam"), i18n("perpendicular distance"), i18n("n-th point"),
 	i18n("radial distance"), i18n("Interpolation"), i18n("Opheim"), i18n("Lang")};
@@ -90,17 +89,35 @@ double nsl_geom_linesim_area_error(const double xdata[], const double ydata[], c
 	return area/(double)n;
 }
 
+/* extent of the data in x and y (single pass over the data) */
+static void nsl_geom_linesim_extent(const double xdata[], const double ydata[], const size_t n, double *dx, double *dy) {
+	double xmin = xdata[0], xmax = xdata[0], ymin = ydata[0], ymax = ydata[0];
+	size_t i;
+	for (i = 1; i < n; i++) {
+		if (xdata[i] < xmin)
+			xmin = xdata[i];
+		else if (xdata[i] > xmax)
+			xmax = xdata[i];
+		if (ydata[i] < ymin)
+			ymin = ydata[i];
+		else if (ydata[i] > ymax)
+			ymax = ydata[i];
+	}
+	*dx = xmax - xmin;
+	*dy = ymax - ymin;
+}
+
 double nsl_geom_linesim_clip_diag_perpoint(const double xdata[], const double ydata[], const size_t n) {
-	double dx = nsl_stats_maximum(xdata, n, NULL) - nsl_stats_minimum(xdata, n, NULL);
-	double dy = nsl_stats_maximum(ydata, n, NULL) - nsl_stats_minimum(ydata, n, NULL);
+	double dx, dy;
+	nsl_geom_linesim_extent(xdata, ydata, n, &dx, &dy);
 	double d = sqrt(dx*dx+dy*dy);
 
 	return d/(double)n;	/* per point */
 }
 
 double nsl_geom_linesim_clip_area_perpoint(const double xdata[], const double ydata[], const size_t n) {
-	double dx = nsl_stats_maximum(xdata, n, NULL) - nsl_stats_minimum(xdata, n, NULL);
-	double dy = nsl_stats_maximum(ydata, n, NULL) - nsl_stats_minimum(ydata, n, NULL);
+	double dx, dy;
+	nsl_geom_linesim_extent(xdata, ydata, n, &dx, &dy);
 	double A = dx*dy;
 
 	return A/(double)n;	/* per point */
@@ -121,40 +138,137 @@ double nsl_geom_linesim_avg_dist_perpoint(const double xdata[], const double yda
 
 /*********** simplification algorithms *********/
 
-void nsl_geom_linesim_douglas_peucker_step(const double xdata[], const double ydata[], const size_t start, const size_t end, size_t *nout, const double tol, size_t index[]) {
-	/*printf("DP: %d - %d\n", start, end);*/
+/*********** indexed min-heap used by the simplification algorithms *********/
+
+/* heap of items 0..n-1 with the key key[item]. pos[item] is the position of the item in the heap */
+typedef struct {
+	size_t *item;
+	size_t *pos;
+	double *key;
+	size_t size;
+} nsl_geom_linesim_heap;
+
+static int nsl_geom_linesim_heap_alloc(nsl_geom_linesim_heap *heap, const size_t n) {
+	heap->item = (size_t *)malloc(n * sizeof(size_t));
+	heap->pos = (size_t *)malloc(n * sizeof(size_t));
+	heap->key = (double *)malloc(n * sizeof(double));
+	heap->size = 0;
+
+	return (heap->item != NULL && heap->pos != NULL && heap->key != NULL);
+}
+
+static void nsl_geom_linesim_heap_free(nsl_geom_linesim_heap *heap) {
+	free(heap->item);
+	free(heap->pos);
+	free(heap->key);
+}
+
+static void nsl_geom_linesim_heap_up(nsl_geom_linesim_heap *heap, size_t i) {
+	const size_t item = heap->item[i];
+	const double key = heap->key[item];
+	while (i > 0) {
+		const size_t parent = (i-1)/2;
+		if (heap->key[heap->item[parent]] <= key)
+			break;
+		heap->item[i] = heap->item[parent];
+		heap->pos[heap->item[i]] = i;
+		i = parent;
+	}
+	heap->item[i] = item;
+	heap->pos[item] = i;
+}
+
+static void nsl_geom_linesim_heap_down(nsl_geom_linesim_heap *heap, size_t i) {
+	const size_t item = heap->item[i];
+	const double key = heap->key[item];
+	for (;;) {
+		size_t child = 2*i+1;
+		if (child >= heap->size)
+			break;
+		if (child+1 < heap->size && heap->key[heap->item[child+1]] < heap->key[heap->item[child]])
+			child++;
+		if (key <= heap->key[heap->item[child]])
+			break;
+		heap->item[i] = heap->item[child];
+		heap->pos[heap->item[i]] = i;
+		i = child;
+	}
+	heap->item[i] = item;
+	heap->pos[item] = i;
+}
+
+static void nsl_geom_linesim_heap_push(nsl_geom_linesim_heap *heap, const size_t item, const double key) {
+	heap->key[item] = key;
+	heap->item[heap->size] = item;
+	nsl_geom_linesim_heap_up(heap, heap->size++);
+}
+
+static size_t nsl_geom_linesim_heap_pop(nsl_geom_linesim_heap *heap) {
+	const size_t top = heap->item[0];
+	if (--heap->size > 0) {
+		heap->item[0] = heap->item[heap->size];
+		nsl_geom_linesim_heap_down(heap, 0);
+	}
 
-	size_t i, nkey = start;
-	double dist, maxdist = 0;
-	/* search for key (biggest perp. distance) */
+	return top;
+}
+
+/*********** simplification algorithms *********/
+
+/* maximum perp. distance of the points between start and end to the line start -- end. key: point of maximum distance */
+static double nsl_geom_linesim_segment_maxdist(const double xdata[], const double ydata[], const size_t start, const size_t end, size_t *key) {
+	size_t i;
+	double dist, maxdist = -1;
 	for (i = start+1; i < end; i++) {
 		dist = nsl_geom_point_line_dist(xdata[start], ydata[start], xdata[end], ydata[end], xdata[i], ydata[i]);
 		if (dist > maxdist) {
-			maxdist=dist;
-			nkey=i;
+			maxdist = dist;
+			*key = i;
 		}
 	}
-	/*printf("maxdist = %g @ i = %zu\n", maxdist, nkey);*/
-
-	if (maxdist > tol) {
-		/*printf("take %d\n", nkey);*/
-		index[(*nout)++]=nkey;
-		if (nkey-start > 1)
-			nsl_geom_linesim_douglas_peucker_step(xdata, ydata, start, nkey, nout, tol, index);
-		if (end-nkey > 1)
-			nsl_geom_linesim_douglas_peucker_step(xdata, ydata, nkey, end, nout, tol, index);
-	}
 
-	/*printf("nout=%d\n", *nout);*/
+	return maxdist;
 }
 
 size_t nsl_geom_linesim_douglas_peucker(const double xdata[], const double ydata[], const size_t n, const double tol, size_t index[]) {
 	size_t nout = 0;
 
+	/* segments still to be processed (explicit stack instead of recursion) */
+	size_t *stack = (size_t *)malloc(2 * n * sizeof(size_t));
+	if (stack == NULL) {
+		printf("nsl_geom_linesim_douglas_peucker(): could not allocate memory for %zu points\n", n);
+		return 0;
+	}
+	size_t nstack = 0;
+
 	/*first point*/
 	index[nout++] = 0;
-
-	nsl_geom_linesim_douglas_peucker_step(xdata, ydata, 0, n-1, &nout, tol, index);
+	if (n > 2) {
+		stack[nstack++] = 0;
+		stack[nstack++] = n-1;
+	}
+	while (nstack > 0) {
+		const size_t end = stack[--nstack];
+		const size_t start = stack[--nstack];
+
+		/* search for key (biggest perp. distance) */
+		size_t nkey = start;
+		double maxdist = nsl_geom_linesim_segment_maxdist(xdata, ydata, start, end, &nkey);
+		/*printf("maxdist = %g @ i = %zu\n", maxdist, nkey);*/
+
+		if (maxdist > tol) {
+			index[nout++] = nkey;
+			if (end-nkey > 1) {
+				stack[nstack++] = nkey;
+				stack[nstack++] = end;
+			}
+			if (nkey-start > 1) {
+				stack[nstack++] = start;
+				stack[nstack++] = nkey;
+			}
+		}
+	}
+	free(stack);
 
 	/* last point */
 	if (index[nout-1] != n-1)
@@ -170,6 +284,10 @@ size_t nsl_geom_linesim_douglas_peucker_auto(const double xdata[], const double
 	return nsl_geom_linesim_douglas_peucker(xdata, ydata, n, tol, index);
 }
 
+/*
+ * the segments between the taken points are kept in a heap ordered by their maximum distance (negative key)
+ * and in a linked list (next[]) of the taken points. Every step splits the segment of maximum distance.
+ */
 double nsl_geom_linesim_douglas_peucker_variant(const double xdata[], const double ydata[], const size_t n, const size_t nout, size_t index[]) {
 	size_t i;
 	if (nout >= n) {	/* all points */
@@ -179,88 +297,59 @@ double nsl_geom_linesim_douglas_peucker_variant(const double xdata[], const doub
 	}
 
 	/* first and last point */
-	size_t ntmp = 0;
-	index[ntmp++] = 0;
-	index[ntmp++] = n-1;
+	index[0] = 0;
+	index[1] = n-1;
 
 	if (nout <= 2)	/* using first and last point */
 		return DBL_MAX;
 
-	double *dist = (double *)malloc(n * sizeof(double));
-	double *maxdist = (double *)malloc(nout * sizeof(double));	/* max dist per edge */
-	for (i = 0; i < n; i++) {	/* initialize  dist */
-		dist[i] = nsl_geom_point_line_dist(xdata[0], ydata[0], xdata[n-1], ydata[n-1], xdata[i], ydata[i]);
-		/*printf("%zu: %g\n", i, dist[i]);*/
+	nsl_geom_linesim_heap heap;	/* segments identified by their start point */
+	size_t *next = (size_t *)malloc(n * sizeof(size_t));	/* next taken point */
+	size_t *key = (size_t *)malloc(n * sizeof(size_t));	/* point of max dist per segment */
+	if (!nsl_geom_linesim_heap_alloc(&heap, n) || next == NULL || key == NULL) {
+		printf("nsl_geom_linesim_douglas_peucker_variant(): could not allocate memory for %zu points\n", n);
+		nsl_geom_linesim_heap_free(&heap);
+		free(next);
+		free(key);
+		return DBL_MAX;
 	}
-	for (i = 0; i < nout; i++)
-		maxdist[i] = 0;
 
-	double newmaxdist;
-	while (ntmp < nout) {
-		size_t key = 0, v;
-
-		/* find edge of maximum */
-		size_t maxindex;
-		nsl_stats_maximum(maxdist, ntmp, &maxindex);
-		/*printf("found edge of max at index %zu\n", maxindex);*/
-		/*newmaxdist = nsl_stats_maximum(dist, n, &key);*/
-		newmaxdist = 0;
-		for (i = index[maxindex]+1; i < index[maxindex+1]; i++) {
-			/*printf("i=%zu\n", i);*/
-			if (dist[i] > newmaxdist) {
-				newmaxdist = dist[i];
-				key = i;
-			}
-		}
+	next[0] = n-1;
+	nsl_geom_linesim_heap_push(&heap, 0, -nsl_geom_linesim_segment_maxdist(xdata, ydata, 0, n-1, &key[0]));
 
-		/*printf("found key %zu (dist = %g)\n", key, newmaxdist);*/
+	size_t ntmp = 2;
+	double newmaxdist = 0;
+	while (ntmp < nout) {
+		/* split the segment of maximum distance at its key */
+		const size_t start = nsl_geom_linesim_heap_pop(&heap);
+		const size_t end = next[start], k = key[start];
+		newmaxdist = -heap.key[start];
+		/*printf("found key %zu (dist = %g)\n", k, newmaxdist);*/
+		next[start] = k;
+		next[k] = end;
 		ntmp++;
-		dist[key] = 0;
-
-		/* find index of previous key */
-		size_t previndex = 0;
-		while (index[previndex+1] < key)
-			previndex++;
-		/*printf("previndex = %zu (update key %zu - %zu)\n", previndex, index[previndex], index[previndex+1]);*/
-
-		/* shift maxdist */
-		for (v = ntmp; v > previndex; v--)
-			maxdist[v] = maxdist[v-1];
 
-		/* update dist[]. no update on last key */
+		/* no update on last key */
 		if (ntmp < nout) {
-			double tmpmax = 0;
-			for (v = index[previndex]+1; v < key; v++) {
-				/*printf("%zu to %zu - %zu", v, index[previndex], key);*/
-				dist[v] = nsl_geom_point_line_dist(xdata[index[previndex]], ydata[index[previndex]], xdata[key], ydata[key], 
-					xdata[v], ydata[v]);
-				if (dist[v] > tmpmax)
-					tmpmax = dist[v];
-
-				/*printf(" dist = %g\n", dist[v]);*/
-			}
-			maxdist[previndex] = tmpmax;
-
-			tmpmax = 0;
-			for (v = key+1; v < index[previndex+1]; v++) {
-				/*printf("%zu to %zu - %zu", v, key, index[previndex+1]);*/
-				dist[v] = nsl_geom_point_line_dist(xdata[key], ydata[key], xdata[index[previndex+1]], ydata[index[previndex+1]], 
-					xdata[v], ydata[v]);
-				if (dist[v] > tmpmax)
-					tmpmax = dist[v];
-				/*printf(" dist = %g\n", dist[v]);*/
-			}
-			maxdist[previndex+1] = tmpmax;
+			if (k-start > 1)
+				nsl_geom_linesim_heap_push(&heap, start, -nsl_geom_linesim_segment_maxdist(xdata, ydata, start, k, &key[start]));
+			if (end-k > 1)
+				nsl_geom_linesim_heap_push(&heap, k, -nsl_geom_linesim_segment_maxdist(xdata, ydata, k, end, &key[k]));
 		}
+	}
 
-		/* put into index array */
-		for (v = ntmp; v > previndex+1; v--)
-			index[v] = index[v-1];
-		index[previndex+1] = key;
+	/* put into index array (sorted by following the list) */
+	i = 0;
+	size_t v = 0;
+	while (v != n-1) {
+		index[i++] = v;
+		v = next[v];
 	}
+	index[i] = n-1;
 
-	free(dist);
-	free(maxdist);
+	nsl_geom_linesim_heap_free(&heap);
+	free(next);
+	free(key);
 
 	return newmaxdist;
 }
@@ -410,78 +499,76 @@ size_t nsl_geom_linesim_interp_auto(const double xdata[], const double ydata[],
 	return nsl_geom_linesim_interp(xdata, ydata, n, tol, index);
 }
 
+/*
+ * the remaining points are kept in a doubly linked list (prev[], next[]) and
+ * the inner points in a heap ordered by their area. Removing a point only updates its neighbors.
+ */
 size_t nsl_geom_linesim_visvalingam_whyatt(const double xdata[], const double ydata[], const size_t n, const double tol, size_t index[]) {
 	if (n < 3)	/* we need at least three points */
 		return 0;
 
+	nsl_geom_linesim_heap heap;	/* area associated with every point */
+	size_t *prev = (size_t *)malloc(n * sizeof(size_t));
+	size_t *next = (size_t *)malloc(n * sizeof(size_t));
+	if (!nsl_geom_linesim_heap_alloc(&heap, n) || prev == NULL || next == NULL) {
+		printf("nsl_geom_linesim_visvalingam_whyatt(): could not allocate memory for %zu points\n", n);
+		nsl_geom_linesim_heap_free(&heap);
+		free(prev);
+		free(next);
+		return 0;
+	}
+
 	size_t i, nout = n;
-	double *area = (double *) malloc((n-2)*sizeof(double));	/* area associated with every point */
-	for (i = 0; i < n; i++)
-		index[i] = i;
-	for (i = 1; i < n-1; i++)
-		area[i-1] = nsl_geom_three_point_area(xdata[i-1], ydata[i-1], xdata[i], ydata[i], xdata[i+1], ydata[i+1]);
-
-	double minarea;
-	size_t minindex;
-	while ( (minarea = nsl_stats_minimum(area, n-2, &minindex)) < tol && nout > 2) {
-		/*for (i=0; i < n-2; i++)
-			if (area[i]<DBL_MAX)
-				printf("area[%zu] = %g\n", i, area[i]);
-		*/
-		/* remove point minindex */
-		/*printf("removing point %zu (minindex = %zu, minarea = %g) nout=%zu\n", minindex+1, minindex, minarea, nout-1);*/
-		index[minindex+1] = 0;
-		area[minindex] = DBL_MAX;
+	for (i = 0; i < n; i++) {
+		prev[i] = i-1;
+		next[i] = i+1;
+	}
+	for (i = 1; i < n-1; i++) {
+		heap.key[i] = nsl_geom_three_point_area(xdata[i-1], ydata[i-1], xdata[i], ydata[i], xdata[i+1], ydata[i+1]);
+		heap.item[i-1] = i;
+		heap.pos[i] = i-1;
+	}
+	heap.size = n-2;
+	for (i = heap.size/2 + 1; i > 0; i--)
+		nsl_geom_linesim_heap_down(&heap, i-1);
+
+	while (heap.size > 0 && heap.key[heap.item[0]] < tol && nout > 2) {
+		/* remove point with minimal area */
+		const size_t p = nsl_geom_linesim_heap_pop(&heap);
+		const size_t before = prev[p], after = next[p];
+		/*printf("removing point %zu (area = %g) nout=%zu\n", p, heap.key[p], nout-1);*/
+		next[before] = after;
+		prev[after] = before;
+
+		/* update area of neigbor points (take largest value of new and old area) */
 		double tmparea;
-		/* update area of neigbor points */
-		size_t before = minindex, after = minindex+2;	/* find index before and after */
-		while (index[before] == 0 && before > 0)
-			before--;
-		while (index[after] == 0 && after < n-1)
-			after++;
-		if (minindex > 0) {	/*before */
-			if (before > 0) {
-				size_t beforebefore=before-1;
-				while (index[beforebefore] == 0 && beforebefore > 0)
-					beforebefore--;
-				/*printf("recalculate area[%zu] from %zu %zu %zu\n", before-1, beforebefore, before, after);*/
-				tmparea = nsl_geom_three_point_area(xdata[beforebefore], ydata[beforebefore], xdata[before], ydata[before], xdata[after], ydata[after]);
-				if (tmparea > area[before-1])	/* take largest value of new and old area */
-					area[before-1] = tmparea;
+		if (before > 0) {
+			tmparea = nsl_geom_three_point_area(xdata[prev[before]], ydata[prev[before]], xdata[before], ydata[before], xdata[after], ydata[after]);
+			if (tmparea > heap.key[before]) {
+				heap.key[before] = tmparea;
+				nsl_geom_linesim_heap_down(&heap, heap.pos[before]);
 			}
 		}
-		if (minindex < n-3) {	/* after */
-			if (after < n-1) {
-				size_t afterafter = after+1;
-				while (index[afterafter] == 0 && afterafter < n-1)
-					afterafter++;
-				/*printf("recalculate area[%zu] from %zu %zu %zu\n",after-1, before, after, afterafter);*/
-				tmparea = nsl_geom_three_point_area(xdata[before], ydata[before], xdata[after], ydata[after], xdata[afterafter], ydata[afterafter]);
-				if (tmparea > area[after-1])	/* take largest value of new and old area */
-					area[after-1] = tmparea;
+		if (after < n-1) {
+			tmparea = nsl_geom_three_point_area(xdata[before], ydata[before], xdata[after], ydata[after], xdata[next[after]], ydata[next[after]]);
+			if (tmparea > heap.key[after]) {
+				heap.key[after] = tmparea;
+				nsl_geom_linesim_heap_down(&heap, heap.pos[after]);
 			}
 		}
 		nout--;
-	};
-
-	/*for(i=0;i<n;i++)
-		printf("INDEX = %d\n", index[i]);
-	*/
-
-	/* condens index */
-	i = 1;
-	size_t newi = 1;
-	while (newi < n-1) {
-		while (index[newi] == 0)
-			newi++;
-		index[i++] = index[newi++];
-	};
-
-	/*for(i=0;i<nout;i++)
-		printf("INDEX2 = %d\n", index[i]);
-	*/
-
-	free(area);
+	}
+
+	/* collect remaining points */
+	size_t v = 0;
+	for (i = 0; i < nout; i++) {
+		index[i] = v;
+		v = next[v];
+	}
+
+	nsl_geom_linesim_heap_free(&heap);
+	free(prev);
+	free(next);
 	return nout;
 }
 size_t nsl_geom_linesim_visvalingam_whyatt_auto(const double xdata[], const double ydata[], const size_t n, size_t index[]) {
@@ -0,0 +1,93 @@
+/***************************************************************************
+    File                 : nsl_geom_linesim_perf_test.c  
+    Project              : LabPlot
+    Description          : NSL line simplification performance test
+    --------------------------------------------------------------------
+    Copyright            : (C) 2017 LabPlot developers
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <sys/time.h>
+#include "nsl_geom_linesim.h"
+
+/* number of points: 10^MINEXP .. 10^MAXEXP (can be limited with the first argument) */
+#define MINEXP 4
+#define MAXEXP 8
+
+static unsigned long long elapsed(struct timeval *time1) {
+	struct timeval time2;
+	gettimeofday(&time2, NULL);
+	unsigned long long ms = 1000 * (time2.tv_sec - time1->tv_sec) + (time2.tv_usec - time1->tv_usec) / 1000;
+	gettimeofday(time1, NULL);
+	return ms;
+}
+
+int main(int argc, char *argv[]) {
+	int exp, maxexp = MAXEXP;
+	if (argc > 1)
+		maxexp = atoi(argv[1]);
+
+	printf("%10s %12s %12s %12s %12s\n", "n", "DP (ms)", "DP var (ms)", "VW (ms)", "VW nout");
+	size_t n = 1;
+	for (exp = 0; exp < MINEXP; exp++)
+		n *= 10;
+	for (exp = MINEXP; exp <= maxexp; exp++, n *= 10) {
+		double *xdata = (double *)malloc(n*sizeof(double));
+		double *ydata = (double *)malloc(n*sizeof(double));
+		size_t *index = (size_t *)malloc(n*sizeof(size_t));
+		if (xdata == NULL || ydata == NULL || index == NULL) {
+			printf("%10zu not enough memory\n", n);
+			free(xdata);
+			free(ydata);
+			free(index);
+			break;
+		}
+
+		/* noisy signal */
+		size_t i;
+		srand(1);
+		for (i = 0; i < n; i++) {
+			xdata[i] = (double)i;
+			ydata[i] = 100.*sin(20.*M_PI*i/n) + (double)rand()/RAND_MAX;
+		}
+
+		struct timeval time;
+		gettimeofday(&time, NULL);
+		nsl_geom_linesim_douglas_peucker_auto(xdata, ydata, n, index);
+		unsigned long long dp = elapsed(&time);
+		nsl_geom_linesim_douglas_peucker_variant(xdata, ydata, n, n/10, index);
+		unsigned long long dpvar = elapsed(&time);
+		size_t nout = nsl_geom_linesim_visvalingam_whyatt_auto(xdata, ydata, n, index);
+		unsigned long long vw = elapsed(&time);
+
+		printf("%10zu %12llu %12llu %12llu %12zu\n", n, dp, dpvar, vw, nout);
+
+		free(xdata);
+		free(ydata);
+		free(index);
+	}
+
+	return 0;
+}
@@ -34,6 +34,7 @@
 #include <gsl/gsl_linalg.h>
 #include <gsl/gsl_blas.h>
 #include <gsl/gsl_sf_gamma.h>   /* gsl_sf_choose */
+#include <string.h>
 
 const char* nsl_smooth_type_name[] = { i18n("moving average (central)"), i18n("moving average (lagged)"), i18n("percentile"), i18n("Savitzky-Golay") };
 const char* nsl_smooth_pad_mode_name[] = { i18n("none"), i18n("interpolating"), i18n("mirror"), i18n("nearest"), i18n("constant"), i18n("periodic") };
@@ -41,318 +42,592 @@ const char* nsl_smooth_weight_type_name[] = { i18n("uniform (rectangular)"), i18
 		i18n("quartic (biweight)"), i18n("triweight"), i18n("tricube"), i18n("cosine")  };
 double nsl_smooth_pad_constant_lvalue = 0.0, nsl_smooth_pad_constant_rvalue = 0.0;
 
-int nsl_smooth_moving_average(double *data, unsigned int n, unsigned int points, nsl_smooth_weight_type weight, nsl_smooth_pad_mode mode) {
-	unsigned int i,j;
-	double *result = (double *)malloc(n*sizeof(double));
-	for (i=0; i<n; i++)
-		result[i]=0;
-
-	for(i=0;i<n;i++) {
-		unsigned int np=points;
-		unsigned int half=(points-1)/2;
-		if(mode == nsl_smooth_pad_none) { /* reduce points */
-			half = GSL_MIN(GSL_MIN((points-1)/2,i),n-i-1);
-			np = 2*half+1;
+/* weights of the central moving average over np points */
+static void nsl_smooth_weights(double *w, unsigned int np, nsl_smooth_weight_type weight) {
+	unsigned int j;
+	double sum = 0.0;
+	switch(weight) {
+	case nsl_smooth_weight_uniform:
+		for(j=0;j<np;j++)
+			w[j]=1./np;
+		break;
+	case nsl_smooth_weight_triangular:
+		sum = gsl_pow_2((np+1)/2);
+		for(j=0;j<np;j++)
+			w[j]=GSL_MIN(j+1,np-j)/sum;
+		break;
+	case nsl_smooth_weight_binomial:
+		sum = (np-1)/2.;
+		for(j=0;j<np;j++)
+			w[j]=gsl_sf_choose(2*sum,sum+fabs(j-sum))/pow(4.,sum);
+		break;
+	case nsl_smooth_weight_parabolic:
+		for(j=0;j<np;j++) {
+			w[j]=nsl_sf_kernel_parabolic(2.*(j-(np-1)/2.)/(np+1));
+			sum += w[j];
+		}
+		for(j=0;j<np;j++)
+			w[j] /= sum;
+		break;
+	case nsl_smooth_weight_quartic:
+		for(j=0;j<np;j++) {
+			w[j]=nsl_sf_kernel_quartic(2.*(j-(np-1)/2.)/(np+1));
+			sum += w[j];
+		}
+		for(j=0;j<np;j++)
+			w[j] /= sum;
+		break;
+	case nsl_smooth_weight_triweight:
+		for(j=0;j<np;j++) {
+			w[j]=nsl_sf_kernel_triweight(2.*(j-(np-1)/2.)/(np+1));
+			sum += w[j];
 		}
+		for(j=0;j<np;j++)
+			w[j] /= sum;
+		break;
+	case nsl_smooth_weight_tricube:
+		for(j=0;j<np;j++) {
+			w[j]=nsl_sf_kernel_tricube(2.*(j-(np-1)/2.)/(np+1));
+			sum += w[j];
+		}
+		for(j=0;j<np;j++)
+			w[j] /= sum;
+		break;
+	case nsl_smooth_weight_cosine:
+		for(j=0;j<np;j++) {
+			w[j]=nsl_sf_kernel_cosine((j-(np-1)/2.)/((np+1)/2.));
+			sum += w[j];
+		}
+		for(j=0;j<np;j++)
+			w[j] /= sum;
+		break;
+	}
+}
 
-		/* weight */
-		double sum=0.0, *w = (double *)malloc(np*sizeof(double));
-		switch(weight) {
-		case nsl_smooth_weight_uniform:
-			for(j=0;j<np;j++)
-				w[j]=1./np;
-			break;
-		case nsl_smooth_weight_triangular:
-			sum = gsl_pow_2((np+1)/2);
-			for(j=0;j<np;j++)
-				w[j]=GSL_MIN(j+1,np-j)/sum;
-			break;
-		case nsl_smooth_weight_binomial:
-			sum = (np-1)/2.;
-			for(j=0;j<np;j++)
-				w[j]=gsl_sf_choose(2*sum,sum+fabs(j-sum))/pow(4.,sum);
-			break;
-		case nsl_smooth_weight_parabolic:
-			for(j=0;j<np;j++) {
-				w[j]=nsl_sf_kernel_parabolic(2.*(j-(np-1)/2.)/(np+1));
-				sum += w[j];
+/* weights of the lagged moving average over np points */
+static void nsl_smooth_weights_lagged(double *w, unsigned int np, nsl_smooth_weight_type weight) {
+	unsigned int j;
+	double sum = 0.0;
+	switch(weight) {
+	case nsl_smooth_weight_uniform:
+		for(j=0;j<np;j++)
+			w[j]=1./np;
+		break;
+	case nsl_smooth_weight_triangular:
+		sum = np*(np+1)/2;
+		for(j=0;j<np;j++)
+			w[j]=(j+1)/sum;
+		break;
+	case nsl_smooth_weight_binomial:
+		for(j=0;j<np;j++) {
+			w[j]=gsl_sf_choose(2*(np-1),j);
+			sum += w[j];
+		}
+		for(j=0;j<np;j++)
+			w[j] /= sum;
+		break;
+	case nsl_smooth_weight_parabolic:
+		for(j=0;j<np;j++) {
+			w[j]=nsl_sf_kernel_parabolic(1.-(1+j)/(double)np);
+			sum += w[j];
+		}
+		for(j=0;j<np;j++)
+			w[j] /= sum;
+		break;
+	case nsl_smooth_weight_quartic:
+		for(j=0;j<np;j++) {
+			w[j]=nsl_sf_kernel_quartic(1.-(1+j)/(double)np);
+			sum += w[j];
+		}
+		for(j=0;j<np;j++)
+			w[j] /= sum;
+		break;
+	case nsl_smooth_weight_triweight:
+		for(j=0;j<np;j++) {
+			w[j]=nsl_sf_kernel_triweight(1.-(1+j)/(double)np);
+			sum += w[j];
+		}
+		for(j=0;j<np;j++)
+			w[j] /= sum;
+		break;
+	case nsl_smooth_weight_tricube:
+		for(j=0;j<np;j++) {
+			w[j]=nsl_sf_kernel_tricube(1.-(1+j)/(double)np);
+			sum += w[j];
+		}
+		for(j=0;j<np;j++)
+			w[j] /= sum;
+		break;
+	case nsl_smooth_weight_cosine:
+		for(j=0;j<np;j++) {
+			w[j]=nsl_sf_kernel_cosine((np-1-j)/(double)np);
+			sum += w[j];
+		}
+		for(j=0;j<np;j++)
+			w[j] /= sum;
+		break;
+	}
+}
+
+/* minimal number of output points processed together, small enough to keep them in the cache */
+#define NSL_SMOOTH_BLOCKSIZE 512
+
+/*
+ * data[i] = sum_j w[j]*data[i-offset+j] for i = first .. last-1 (all indices inside data) in place.
+ * If w is NULL, the uniform average is calculated as running sum, which is recalculated
+ * at the beginning of every block to avoid accumulating rounding errors.
+ *
+ * The loops are interchanged blockwise, so the inner loop over i can be vectorized
+ * while every result is still summed up in the order of j. The results of a block are
+ * written back when the next block was calculated, since this needs up to offset values before it.
+ */
+static int nsl_smooth_convolve(double *data, size_t first, size_t last, const double *w, unsigned int np, unsigned int offset) {
+	const size_t blocksize = GSL_MAX(NSL_SMOOTH_BLOCKSIZE, offset);
+	double *buffer = (double *)malloc(2*blocksize*sizeof(double));
+	if (buffer == NULL)
+		return -1;
+
+	size_t start, pending = 0, npending = 0, i, block = 0;
+	unsigned int j;
+	for (start = first; start < last; start += blocksize, block++) {
+		const size_t count = GSL_MIN(last - start, blocksize);
+		double *r = buffer + (block % 2)*blocksize;
+		const double *d = data + start - offset;
+		if (w == NULL) {
+			double sum = 0;
+			for (j = 0; j < np; j++)
+				sum += d[j];
+			r[0] = sum/np;
+			for (i = 1; i < count; i++) {
+				sum += d[i-1+np] - d[i-1];
+				r[i] = sum/np;
 			}
-			for(j=0;j<np;j++)
-				w[j] /= sum;
-			break;
-		case nsl_smooth_weight_quartic:
-			for(j=0;j<np;j++) {
-				w[j]=nsl_sf_kernel_quartic(2.*(j-(np-1)/2.)/(np+1));
-				sum += w[j];
+		} else {
+			for (i = 0; i < count; i++)
+				r[i] = 0;
+			for (j = 0; j < np; j++) {
+				const double wj = w[j];
+				for (i = 0; i < count; i++)
+					r[i] += wj*d[i+j];
 			}
-			for(j=0;j<np;j++)
-				w[j] /= sum;
+		}
+
+		if (npending > 0)
+			memcpy(data + pending, buffer + ((block+1) % 2)*blocksize, npending*sizeof(double));
+		pending = start;
+		npending = count;
+	}
+	if (npending > 0)
+		memcpy(data + pending, buffer + ((block+1) % 2)*blocksize, npending*sizeof(double));
+
+	free(buffer);
+	return 0;
+}
+
+/* central moving average at point i near the edges using the padding mode */
+static double nsl_smooth_moving_average_point(const double *data, unsigned int n, unsigned int i, const double *w, unsigned int np, unsigned int half, nsl_smooth_pad_mode mode) {
+	unsigned int j;
+	double result = 0;
+	for(j=0;j<np;j++) {
+		int index=i-half+j;
+		switch(mode) {
+		case nsl_smooth_pad_none:
+			result += w[j]*data[index];
 			break;
-		case nsl_smooth_weight_triweight:
-			for(j=0;j<np;j++) {
-				w[j]=nsl_sf_kernel_triweight(2.*(j-(np-1)/2.)/(np+1));
-				sum += w[j];
-			}
-			for(j=0;j<np;j++)
-				w[j] /= sum;
+		case nsl_smooth_pad_interp:
+			printf("not implemented yet\n");
 			break;
-		case nsl_smooth_weight_tricube:
-			for(j=0;j<np;j++) {
-				w[j]=nsl_sf_kernel_tricube(2.*(j-(np-1)/2.)/(np+1));
-				sum += w[j];
-			}
-			for(j=0;j<np;j++)
-				w[j] /= sum;
+		case nsl_smooth_pad_mirror:
+			index=abs((int)(i-half+j));
+			result += w[j]*data[GSL_MIN(index,2*((int)n-1)-index)];
 			break;
-		case nsl_smooth_weight_cosine:
-			for(j=0;j<np;j++) {
-				w[j]=nsl_sf_kernel_cosine((j-(np-1)/2.)/((np+1)/2.));
-				sum += w[j];
-			}
-			for(j=0;j<np;j++)
-				w[j] /= sum;
+		case nsl_smooth_pad_nearest:
+			result += w[j]*data[GSL_MIN((int)n-1,GSL_MAX(0,index))];
+			break;
+		case nsl_smooth_pad_constant:
+			if(index<0)
+				result += w[j]*nsl_smooth_pad_constant_lvalue;
+			else if(index>(int)n-1)
+				result += w[j]*nsl_smooth_pad_constant_rvalue;
+			else
+				result += w[j]*data[index];
+			break;
+		case nsl_smooth_pad_periodic:
+			if(index<0)
+				index = n+index;
+			else if(index>(int)n-1)
+				index = index-n;
+			result += w[j]*data[index];
 			break;
 		}
+	}
 
-		/*printf("(%d) w:",i);
-		for(j=0;j<np;j++)
-			printf(" %g",w[j]);
-		printf(" (half=%d) index = ",half);*/
+	return result;
+}
 
-		/* calculate weighted average */
-		for(j=0;j<np;j++) {
-			int index=i-half+j;
-			switch(mode) {
-			case nsl_smooth_pad_none:
-				result[i] += w[j]*data[index];
-				break;
-			case nsl_smooth_pad_interp:
-				printf("not implemented yet\n");
-				break;
-			case nsl_smooth_pad_mirror:
-				index=abs((int)(i-half+j));
-				/*printf(" %d",GSL_MIN(index,2*(n-1)-index));*/
-				result[i] += w[j]*data[GSL_MIN(index,2*((int)n-1)-index)];
-				break;
-			case nsl_smooth_pad_nearest:
-				/*printf(" %d",GSL_MIN(n-1,GSL_MAX(0,index)));*/
-				result[i] += w[j]*data[GSL_MIN((int)n-1,GSL_MAX(0,index))];
-				break;
-			case nsl_smooth_pad_constant:
-				if(index<0)
-					result[i] += w[j]*nsl_smooth_pad_constant_lvalue;
-				else if(index>(int)n-1)
-					result[i] += w[j]*nsl_smooth_pad_constant_rvalue;
-				else
-					result[i] += w[j]*data[index];
-				break;
-			case nsl_smooth_pad_periodic:
-				if(index<0)
-					index = n+index;
-				else if(index>(int)n-1)
-					index = index-n;
-				result[i] += w[j]*data[index];
-				break;
-			}
-		}
-		/*puts("");*/
+int nsl_smooth_moving_average(double *data, unsigned int n, unsigned int points, nsl_smooth_weight_type weight, nsl_smooth_pad_mode mode) {
+	unsigned int i;
+	const unsigned int maxhalf = (points-1)/2;
+	/* number of points used for the inner points */
+	const unsigned int np = (mode == nsl_smooth_pad_none) ? 2*maxhalf+1 : points;
+	/* inner points: the whole window is inside the data */
+	const unsigned int first = GSL_MIN(maxhalf, n), last = (n + maxhalf >= np) ? GSL_MAX(n + maxhalf - np + 1, first) : first;
+
+	double *w = (double *)malloc(np*sizeof(double));
+	double *edgew = (double *)malloc(np*sizeof(double));
+	double *edge = (double *)malloc((n - (last - first) + 1)*sizeof(double));	/* results at the edges */
+	if (w == NULL || edgew == NULL || edge == NULL) {
 		free(w);
+		free(edgew);
+		free(edge);
+		return -1;
 	}
-	
-	for (i=0; i<n; i++)
-		data[i]=result[i];
-	free(result);
 
-	return 0;
-}
+	/* weights are calculated once */
+	nsl_smooth_weights(w, np, weight);
 
-int nsl_smooth_moving_average_lagged(double *data, unsigned int n, unsigned int points, nsl_smooth_weight_type weight, nsl_smooth_pad_mode mode) {
-	unsigned int i,j;
-	double *result = (double *)malloc(n*sizeof(double));
-	for (i=0; i<n; i++)
-		result[i]=0;
-
-	for(i=0;i<n;i++) {
-		unsigned int np=points;
-		unsigned int half=(points-1)/2;
-		if(mode == nsl_smooth_pad_none) { /* reduce points */
-			np = GSL_MIN(points,i+1);
-			half = np-1;
-		}
-
-		/* weight */
-		double sum=0.0, *w = (double *)malloc(np*sizeof(double));
-		switch(weight) {
-		case nsl_smooth_weight_uniform:
-			for(j=0;j<np;j++)
-				w[j]=1./np;
-			break;
-		case nsl_smooth_weight_triangular:
-			sum = np*(np+1)/2;
-			for(j=0;j<np;j++)
-				w[j]=(j+1)/sum;
+	/* edges (calculated first since the inner points are smoothed in place) */
+	unsigned int nedge = 0;
+	for (i = 0; i < n; i++) {
+		if (i == first)
+			i = last;
+		if (i >= n)
 			break;
-		case nsl_smooth_weight_binomial:
-			for(j=0;j<np;j++) {
-				w[j]=gsl_sf_choose(2*(np-1),j);
-				sum += w[j];
-			}
-			for(j=0;j<np;j++)
-				w[j] /= sum;
+
+		if (mode == nsl_smooth_pad_none) { /* reduce points */
+			const unsigned int half = GSL_MIN(GSL_MIN(maxhalf,i),n-i-1);
+			nsl_smooth_weights(edgew, 2*half+1, weight);
+			edge[nedge++] = nsl_smooth_moving_average_point(data, n, i, edgew, 2*half+1, half, mode);
+		} else
+			edge[nedge++] = nsl_smooth_moving_average_point(data, n, i, w, np, maxhalf, mode);
+	}
+
+	int status = nsl_smooth_convolve(data, first, last, weight == nsl_smooth_weight_uniform ? NULL : w, np, maxhalf);
+
+	memcpy(data, edge, first*sizeof(double));
+	memcpy(data + last, edge + first, (n - last)*sizeof(double));
+	free(w);
+	free(edgew);
+	free(edge);
+
+	return status;
+}
+
+/* lagged moving average at point i near the left edge using the padding mode */
+static double nsl_smooth_moving_average_lagged_point(const double *data, unsigned int n, unsigned int i, const double *w, unsigned int np, nsl_smooth_pad_mode mode) {
+	unsigned int j;
+	double result = 0;
+	for(j=0;j<np;j++) {
+		int index=i-np+1+j;
+		switch(mode) {
+		case nsl_smooth_pad_none:
+			result += w[j]*data[index];
 			break;
-		case nsl_smooth_weight_parabolic:
-			for(j=0;j<np;j++) {
-				w[j]=nsl_sf_kernel_parabolic(1.-(1+j)/(double)np);
-				sum += w[j];
-			}
-			for(j=0;j<np;j++)
-				w[j] /= sum;
+		case nsl_smooth_pad_interp:
+			printf("not implemented yet\n");
 			break;
-		case nsl_smooth_weight_quartic:
-			for(j=0;j<np;j++) {
-				w[j]=nsl_sf_kernel_quartic(1.-(1+j)/(double)np);
-				sum += w[j];
-			}
-			for(j=0;j<np;j++)
-				w[j] /= sum;
+		case nsl_smooth_pad_mirror:
+			index=abs(index);
+			result += w[j]*data[index];
 			break;
-		case nsl_smooth_weight_triweight:
-			for(j=0;j<np;j++) {
-				w[j]=nsl_sf_kernel_triweight(1.-(1+j)/(double)np);
-				sum += w[j];
-			}
-			for(j=0;j<np;j++)
-				w[j] /= sum;
+		case nsl_smooth_pad_nearest:
+			result += w[j]*data[GSL_MAX(0,index)];
 			break;
-		case nsl_smooth_weight_tricube:
-			for(j=0;j<np;j++) {
-				w[j]=nsl_sf_kernel_tricube(1.-(1+j)/(double)np);
-				sum += w[j];
-			}
-			for(j=0;j<np;j++)
-				w[j] /= sum;
+		case nsl_smooth_pad_constant:
+			if(index < 0)
+				result += w[j]*nsl_smooth_pad_constant_lvalue;
+			else
+				result += w[j]*data[index];
 			break;
-		case nsl_smooth_weight_cosine:
-			for(j=0;j<np;j++) {
-				w[j]=nsl_sf_kernel_cosine((np-1-j)/(double)np);
-				sum += w[j];
-			}
-			for(j=0;j<np;j++)
-				w[j] /= sum;
+		case nsl_smooth_pad_periodic:
+			if(index < 0)
+				index += n;
+			result += w[j]*data[index];
 			break;
 		}
+	}
 
-		/*printf("(%d) w:",i);
-		for(j=0;j<np;j++)
-			printf(" %g",w[j]);
-		printf(" (half=%d) index = ",half);*/
+	return result;
+}
 
-		/* calculate weighted average */
-		for(j=0;j<np;j++) {
-			int index=i-np+1+j;
-			switch(mode) {
-			case nsl_smooth_pad_none:
-				result[i] += w[j]*data[i-half+j];
-				/*printf(" %d",index);*/
-				break;
-			case nsl_smooth_pad_interp:
-				printf("not implemented yet\n");
-				break;
-			case nsl_smooth_pad_mirror:
-				index=abs(index);
-				/*printf(" %d",index);*/
-				result[i] += w[j]*data[index];
-				break;
-			case nsl_smooth_pad_nearest:
-				/*printf(" %d",GSL_MAX(0,index));*/
-				result[i] += w[j]*data[index];
-				break;
-			case nsl_smooth_pad_constant:
-				if(index < 0)
-					result[i] += w[j]*nsl_smooth_pad_constant_lvalue;
-				else
-					result[i] += w[j]*data[index];
-
-				break;
-			case nsl_smooth_pad_periodic:
-				if(index < 0)
-					index += n;
-				/*printf(" %d",index);*/
-				result[i] += w[j]*data[index];
-				break;
-			}
-		}
-		/*puts("");*/
+int nsl_smooth_moving_average_lagged(double *data, unsigned int n, unsigned int points, nsl_smooth_weight_type weight, nsl_smooth_pad_mode mode) {
+	unsigned int i;
+	/* inner points: the whole window is inside the data */
+	const unsigned int first = GSL_MIN(points-1, n);
+
+	double *w = (double *)malloc(points*sizeof(double));
+	double *edgew = (double *)malloc(points*sizeof(double));
+	double *edge = (double *)malloc((first + 1)*sizeof(double));	/* results at the left edge */
+	if (w == NULL || edgew == NULL || edge == NULL) {
 		free(w);
+		free(edgew);
+		free(edge);
+		return -1;
 	}
 
-	for (i=0; i<n; i++)
-		data[i]=result[i];
-	free(result);
+	/* weights are calculated once */
+	nsl_smooth_weights_lagged(w, points, weight);
+
+	/* left edge (calculated first since the inner points are smoothed in place) */
+	for (i = 0; i < first; i++) {
+		if (mode == nsl_smooth_pad_none) { /* reduce points */
+			nsl_smooth_weights_lagged(edgew, i+1, weight);
+			edge[i] = nsl_smooth_moving_average_lagged_point(data, n, i, edgew, i+1, mode);
+		} else
+			edge[i] = nsl_smooth_moving_average_lagged_point(data, n, i, w, points, mode);
+	}
+
+	int status = nsl_smooth_convolve(data, first, n, weight == nsl_smooth_weight_uniform ? NULL : w, points, points-1);
 
+	memcpy(data, edge, first*sizeof(double));
+	free(w);
+	free(edgew);
+	free(edge);
+
+	return status;
+}
+
+/*
+ * order statistic of the values in a sliding window:
+ * the values needed for a block of output points are ranked once and
+ * the window is a Fenwick tree counting the ranks of the values in the window.
+ * Adding/removing a value and finding the k-th smallest value are O(log(block size)).
+ */
+#define NSL_SMOOTH_PERCENTILE_BLOCKSIZE 4096
+
+typedef struct {
+	double value;
+	size_t index;
+} nsl_smooth_rank_item;
+
+static int nsl_smooth_rank_compare(const void *a, const void *b) {
+	const double va = ((const nsl_smooth_rank_item *)a)->value, vb = ((const nsl_smooth_rank_item *)b)->value;
+	if (va < vb)
+		return -1;
+	if (va > vb)
+		return 1;
 	return 0;
 }
 
+static void nsl_smooth_window_add(unsigned int tree[], size_t size, size_t rank, int count) {
+	for (rank++; rank <= size; rank += rank & (~rank + 1))
+		tree[rank-1] += count;
+}
+
+/* rank of the k-th (k=1,..) smallest value in the window */
+static size_t nsl_smooth_window_kth(const unsigned int tree[], size_t size, size_t mask, size_t k) {
+	size_t rank = 0;
+	for (; mask > 0; mask >>= 1) {
+		if (rank + mask <= size && tree[rank+mask-1] < k) {
+			rank += mask;
+			k -= tree[rank-1];
+		}
+	}
+	return rank;
+}
+
+/* value at (unpadded) position index using the padding mode */
+static double nsl_smooth_pad_value(const double data[], int index, unsigned int n, nsl_smooth_pad_mode mode) {
+	switch(mode) {
+	case nsl_smooth_pad_none:
+	case nsl_smooth_pad_interp:
+		break;
+	case nsl_smooth_pad_mirror:
+		index = abs(index);
+		index = GSL_MIN(index,2*((int)n-1)-index);
+		break;
+	case nsl_smooth_pad_nearest:
+		index = GSL_MIN((int)n-1,GSL_MAX(0,index));
+		break;
+	case nsl_smooth_pad_constant:
+		if (index < 0)
+			return nsl_smooth_pad_constant_lvalue;
+		else if (index > (int)n-1)
+			return nsl_smooth_pad_constant_rvalue;
+		break;
+	case nsl_smooth_pad_periodic:
+		if (index < 0)
+			index = n+index;
+		else if (index > (int)n-1)
+			index = index-n;
+		break;
+	}
+	return data[index];
+}
+
+/* positions beyond the window (type 2 with p close to 1) are clamped to the last value */
+#define NSL_SMOOTH_KTH(k) sorted[nsl_smooth_window_kth(tree, size, mask, GSL_MIN((size_t)(k), n-1)+1)]
+/* same as nsl_stats_quantile_sorted() with the k-th value d[k] of the window taken from the tree */
+static double nsl_smooth_window_quantile(const double sorted[], const unsigned int tree[], size_t size, size_t mask, size_t n, double p, nsl_stats_quantile_type type) {
+	switch(type) {
+	case nsl_stats_quantile_type1:
+		if (p == 0.0)
+			return NSL_SMOOTH_KTH(0);
+		else
+			return NSL_SMOOTH_KTH((int)ceil(n*p)-1);
+	case nsl_stats_quantile_type2:
+		if (p == 0.0)
+			return NSL_SMOOTH_KTH(0);
+		else if (p == 1.0)
+			return NSL_SMOOTH_KTH(n-1);
+		else
+			return (NSL_SMOOTH_KTH((int)ceil(n*p)-1)+NSL_SMOOTH_KTH((int)ceil(n*p+1)-1))/2.;
+	case nsl_stats_quantile_type3:
+		if(p <= 0.5/n)
+			return NSL_SMOOTH_KTH(0);
+		else
+#ifdef _WIN32
+			return NSL_SMOOTH_KTH((int)(n*p)-1);
+#else
+			return NSL_SMOOTH_KTH(lrint(n*p)-1);
+#endif
+	case nsl_stats_quantile_type4:
+		if(p < 1./n)
+			return NSL_SMOOTH_KTH(0);
+		else if (p == 1.0)
+			return NSL_SMOOTH_KTH(n-1);
+		else {
+			int i = floor(n*p);
+			const double a = NSL_SMOOTH_KTH(i-1), b = NSL_SMOOTH_KTH(i);
+			return a+(n*p-i)*(b-a);
+		}
+	case nsl_stats_quantile_type5:
+		if(p < 0.5/n)
+			return NSL_SMOOTH_KTH(0);
+		else if (p >= (n-0.5)/n)
+			return NSL_SMOOTH_KTH(n-1);
+		else {
+			int i = floor(n*p+0.5);
+			const double a = NSL_SMOOTH_KTH(i-1), b = NSL_SMOOTH_KTH(i);
+			return a+(n*p+0.5-i)*(b-a);
+		}
+	case nsl_stats_quantile_type6:
+		if(p < 1./(n+1.))
+			return NSL_SMOOTH_KTH(0);
+		else if (p > n/(n+1.))
+			return NSL_SMOOTH_KTH(n-1);
+		else {
+			int i = floor((n+1)*p);
+			const double a = NSL_SMOOTH_KTH(i-1), b = NSL_SMOOTH_KTH(i);
+			return a+((n+1)*p-i)*(b-a);
+		}
+	case nsl_stats_quantile_type7:
+		if (p == 1.0)
+			return NSL_SMOOTH_KTH(n-1);
+		else {
+			int i = floor((n-1)*p+1);
+			const double a = NSL_SMOOTH_KTH(i-1), b = NSL_SMOOTH_KTH(i);
+			return a+((n-1)*p+1-i)*(b-a);
+		}
+	case nsl_stats_quantile_type8:
+		if (p < 2./3./(n+1./3.))
+			return NSL_SMOOTH_KTH(0);
+		else if (p >= (n-1./3.)/(n+1./3.))
+			return NSL_SMOOTH_KTH(n-1);
+		else {
+			int i = floor((n+1./3.)*p+1./3.);
+			const double a = NSL_SMOOTH_KTH(i-1), b = NSL_SMOOTH_KTH(i);
+			return a+((n+1./3.)*p+1./3.-i)*(b-a);
+		}
+	case nsl_stats_quantile_type9:
+		if (p < 5./8./(n+1./4.))
+			return NSL_SMOOTH_KTH(0);
+		else if (p >= (n-3./8.)/(n+1./4.))
+			return NSL_SMOOTH_KTH(n-1);
+		else {
+			int i = floor((n+1./4.)*p+3./8.);
+			const double a = NSL_SMOOTH_KTH(i-1), b = NSL_SMOOTH_KTH(i);
+			return a+((n+1./4.)*p+3./8.-i)*(b-a);
+		}
+	}
+
+	return 0;
+}
+#undef NSL_SMOOTH_KTH
+
 int nsl_smooth_percentile(double *data, unsigned int n, unsigned int points, double percentile, nsl_smooth_pad_mode mode) {
-	unsigned int i,j;
+	/*using type 4 as default */
+	return nsl_smooth_percentile_type(data, n, points, percentile, mode, nsl_stats_quantile_type4);
+}
+
+int nsl_smooth_percentile_type(double *data, unsigned int n, unsigned int points, double percentile, nsl_smooth_pad_mode mode, nsl_stats_quantile_type type) {
+	if (mode == nsl_smooth_pad_interp) {
+		printf("not implemented yet\n");
+		return -1;
+	}
+
+	/* the ranks of a block are kept small enough to stay in the cache but large compared to the window */
+	const int maxhalf = (points-1)/2;
+	const unsigned int blocksize = GSL_MAX(NSL_SMOOTH_PERCENTILE_BLOCKSIZE, points);
+	const size_t maxsize = blocksize + points;
 	double *result = (double *)malloc(n*sizeof(double));
+	nsl_smooth_rank_item *items = (nsl_smooth_rank_item *)malloc(maxsize*sizeof(nsl_smooth_rank_item));
+	size_t *rank = (size_t *)malloc(maxsize*sizeof(size_t));
+	double *sorted = (double *)malloc(maxsize*sizeof(double));
+	unsigned int *tree = (unsigned int *)malloc(maxsize*sizeof(unsigned int));
+	if (result == NULL || items == NULL || rank == NULL || sorted == NULL || tree == NULL) {
+		free(result);
+		free(items);
+		free(rank);
+		free(sorted);
+		free(tree);
+		return -1;
+	}
 
-	for(i=0;i<n;i++) {
-		unsigned int np=points;
-		unsigned int half=(points-1)/2;
-		if(mode == nsl_smooth_pad_none) { /* reduce points */
-			half = GSL_MIN(GSL_MIN((points-1)/2,i),n-i-1);
-			np = 2*half+1;
+	unsigned int start;
+	for (start = 0; start < n; start += blocksize) {
+		const unsigned int end = GSL_MIN(n, start + blocksize);
+
+		/* rank all values used by the windows of the block */
+		int first = (int)start - maxhalf, last = (int)end-1 - maxhalf + (int)points-1, j;
+		if (mode == nsl_smooth_pad_none) {
+			first = GSL_MAX(first, 0);
+			last = GSL_MIN(last, (int)n-1);
+		}
+		const size_t size = last-first+1;
+		size_t i, mask = 1;
+		for (j = first; j <= last; j++) {
+			items[j-first].value = nsl_smooth_pad_value(data, j, n, mode);
+			items[j-first].index = j-first;
 		}
+		qsort(items, size, sizeof(nsl_smooth_rank_item), nsl_smooth_rank_compare);
+		for (i = 0; i < size; i++) {
+			sorted[i] = items[i].value;
+			rank[items[i].index] = i;
+		}
+		while (2*mask <= size)
+			mask *= 2;
+		memset(tree, 0, size*sizeof(unsigned int));
+
+		/* slide the window [lo, hi] over the block */
+		int lo = 0, hi = -1;
+		for (i = start; i < end; i++) {
+			unsigned int np = points, half = maxhalf;
+			if(mode == nsl_smooth_pad_none) { /* reduce points */
+				half = GSL_MIN(GSL_MIN((points-1)/2,i),n-i-1);
+				np = 2*half+1;
+			}
 
-		double *values = (double *)malloc(np*sizeof(double));
-		for(j=0;j<np;j++) {
-			int index = i-half+j;
-			switch(mode) {
-			case nsl_smooth_pad_none:
-				/*printf(" %d",index);*/
-				values[j] = data[index];
-				break;
-			case nsl_smooth_pad_interp:
-				printf("not implemented yet\n");
-				break;
-			case nsl_smooth_pad_mirror:
-				index=abs(index);
-				/*printf(" %d",GSL_MIN(index,2*(n-1)-index));*/
-				values[j] = data[GSL_MIN(index,2*((int)n-1)-index)];
-				break;
-			case nsl_smooth_pad_nearest:
-				/*printf(" %d",GSL_MIN(n-1,GSL_MAX(0,index)));*/
-				values[j] = data[GSL_MIN((int)n-1,GSL_MAX(0,index))];
-				break;
-			case nsl_smooth_pad_constant:
-				if(index<0)
-					values[j] = nsl_smooth_pad_constant_lvalue;
-				else if(index>(int)n-1)
-					values[j] = nsl_smooth_pad_constant_rvalue;
-				else
-					values[j] = data[index];
-				break;
-			case nsl_smooth_pad_periodic:
-				if(index<0)
-					index = n+index;
-				else if(index>(int)n-1)
-					index = index-n;
-				/*printf(" %d",index);*/
-				values[j] = data[index];
-				break;
+			const int newlo = (int)i-(int)half-first, newhi = newlo+(int)np-1;
+			if (i == start) {
+				lo = newlo;
+				hi = newlo-1;
 			}
-		}
-		/*puts("");*/
+			while (hi < newhi)
+				nsl_smooth_window_add(tree, size, rank[++hi], 1);
+			while (lo < newlo)
+				nsl_smooth_window_add(tree, size, rank[lo++], -1);
 
-		/*using type 4 as default */
-		result[i] = nsl_stats_quantile(values, 1, np, percentile, nsl_stats_quantile_type4);
-		free(values);
+			result[i] = nsl_smooth_window_quantile(sorted, tree, size, mask, np, percentile, type);
+		}
 	}
 
-	for (i=0; i<n; i++)
-		data[i]=result[i];
+	memcpy(data, result, n*sizeof(double));
 	free(result);
+	free(items);
+	free(rank);
+	free(sorted);
+	free(tree);
 
 	return 0;
 }
@@ -403,6 +678,67 @@ int nsl_smooth_savgol_coeff(int points, int order, gsl_matrix *h) {
 	return error;
 }
 
+/* cached Savitzky-Golay coefficient matrices, the reduced ones for pad mode "none" included.
+ * Not thread-safe, like the FFT plan cache the analysis jobs use it from one worker thread only. */
+#define NSL_SMOOTH_SAVGOL_CACHE_SIZE 16
+
+typedef struct {
+	unsigned int points;
+	unsigned int order;
+	gsl_matrix *h;
+	unsigned long used;
+} nsl_smooth_savgol_cache_entry;
+
+static nsl_smooth_savgol_cache_entry nsl_smooth_savgol_cache[NSL_SMOOTH_SAVGOL_CACHE_SIZE];
+static unsigned long nsl_smooth_savgol_cache_time = 0;
+
+/* returns the cached coefficient matrix for (points, order), calculating it in place of the least recently used one if necessary */
+static const gsl_matrix* nsl_smooth_savgol_cached_coeff(unsigned int points, unsigned int order, int *error) {
+	nsl_smooth_savgol_cache_entry *entry = NULL;
+	size_t i;
+	for (i = 0; i < NSL_SMOOTH_SAVGOL_CACHE_SIZE; i++) {
+		if (nsl_smooth_savgol_cache[i].h != NULL && nsl_smooth_savgol_cache[i].points == points
+				&& nsl_smooth_savgol_cache[i].order == order) {
+			nsl_smooth_savgol_cache[i].used = ++nsl_smooth_savgol_cache_time;
+			*error = 0;
+			return nsl_smooth_savgol_cache[i].h;
+		}
+		if (entry == NULL || nsl_smooth_savgol_cache[i].used < entry->used)
+			entry = &nsl_smooth_savgol_cache[i];
+	}
+
+	if (entry->h != NULL)
+		gsl_matrix_free(entry->h);
+	entry->h = NULL;
+	entry->used = 0;
+
+	gsl_matrix *h = gsl_matrix_alloc(points, points);
+	if (h == NULL) {
+		*error = GSL_ENOMEM;
+		return NULL;
+	}
+	*error = nsl_smooth_savgol_coeff(points, order, h);
+	if (*error) {
+		gsl_matrix_free(h);
+		return NULL;
+	}
+
+	entry->points = points;
+	entry->order = order;
+	entry->h = h;
+	entry->used = ++nsl_smooth_savgol_cache_time;
+	return h;
+}
+
+void nsl_smooth_savgol_cache_clear(void) {
+	size_t i;
+	for (i = 0; i < NSL_SMOOTH_SAVGOL_CACHE_SIZE; i++) {
+		if (nsl_smooth_savgol_cache[i].h != NULL)
+			gsl_matrix_free(nsl_smooth_savgol_cache[i].h);
+		memset(&nsl_smooth_savgol_cache[i], 0, sizeof(nsl_smooth_savgol_cache_entry));
+	}
+}
+
 void nsl_smooth_pad_constant_set(double lvalue, double rvalue) {
 	nsl_smooth_pad_constant_lvalue = lvalue;
 	nsl_smooth_pad_constant_rvalue = rvalue;
@@ -423,120 +759,113 @@ int nsl_smooth_savgol(double *data, unsigned int n, unsigned int points, unsigne
 	}
 
 	/* Savitzky-Golay coefficient matrix, y' = H y */
-	gsl_matrix *h = gsl_matrix_alloc(points, points);
-	error = nsl_smooth_savgol_coeff(points, order, h);
+	const gsl_matrix *h = nsl_smooth_savgol_cached_coeff(points, order, &error);
 	if (error) {
 		printf("Internal error in Savitzky-Golay algorithm:\n%s",gsl_strerror(error));
-		gsl_matrix_free(h);
 		return error;
 	}
 
-	double *result = (double *)malloc(n*sizeof(double));
-	for (i = 0; i < n; i++)
-		result[i] = 0;
+	/* results at the left and right edge (calculated first since the inner points are smoothed in place) */
+	double *left = (double *)calloc(half+1, sizeof(double));
+	double *right = (double *)calloc(half+1, sizeof(double));
+	if (left == NULL || right == NULL) {
+		free(left);
+		free(right);
+		return -1;
+	}
 
-	/* left edge */
 	if(mode == nsl_smooth_pad_none) {
+		/* left and right edge: the i-th point from the left and from the right use the same reduced matrix */
 		for (i = 0; i < half; i++) {
 			/*reduce points and order*/
 			unsigned int rpoints = 2*i+1, rorder = GSL_MIN(order, rpoints-GSL_MIN(rpoints, 2));
 
-			gsl_matrix *rh = gsl_matrix_alloc(rpoints, rpoints);
-			error = nsl_smooth_savgol_coeff(rpoints, rorder, rh);
+			const gsl_matrix *rh = nsl_smooth_savgol_cached_coeff(rpoints, rorder, &error);
 			if (error) {
 				printf("Internal error in Savitzky-Golay algorithm:\n%s",gsl_strerror(error));
-				gsl_matrix_free(rh);
-				free(result);
+				free(left);
+				free(right);
 				return error;
 			}
-			
+
+			for (k = 0; k < rpoints; k++)
+				left[i] += gsl_matrix_get(rh, i, k) * data[k];
 			for (k = 0; k < rpoints; k++)
-				result[i] += gsl_matrix_get(rh, i, k) * data[k];
+				right[half-1-i] += gsl_matrix_get(rh, i, k) * data[n-rpoints+k];
 		}
 	} else {
 		for (i = 0; i < half; i++) {
 			for (k = 0; k < points; k++)
 				switch(mode) {
 				case nsl_smooth_pad_interp:
-					result[i] += gsl_matrix_get(h, i, k) * data[k];
+					left[i] += gsl_matrix_get(h, i, k) * data[k];
 					break;
 				case nsl_smooth_pad_mirror:
-					result[i] += gsl_matrix_get(h, half, k) * data[abs((int)(k+i-half))];
+					left[i] += gsl_matrix_get(h, half, k) * data[abs((int)(k+i-half))];
 					break;
 				case nsl_smooth_pad_nearest:
-					result[i] += gsl_matrix_get(h, half, k) * data[i+k-GSL_MIN(half,i+k)];
+					left[i] += gsl_matrix_get(h, half, k) * data[i+k-GSL_MIN(half,i+k)];
 					break;
 				case nsl_smooth_pad_constant:
 					if (k<half-i)
-						result[i] += gsl_matrix_get(h, half, k) * nsl_smooth_pad_constant_lvalue;
+						left[i] += gsl_matrix_get(h, half, k) * nsl_smooth_pad_constant_lvalue;
 					else
-						result[i] += gsl_matrix_get(h, half, k) * data[i-half+k];
+						left[i] += gsl_matrix_get(h, half, k) * data[i-half+k];
 					break;
 				case nsl_smooth_pad_periodic:
-					result[i] += gsl_matrix_get(h, half, k) * data[k<half-i?n+i+k-half:i-half+k];
+					left[i] += gsl_matrix_get(h, half, k) * data[k<half-i?n+i+k-half:i-half+k];
 				case nsl_smooth_pad_none:
 					break;
 				}
 		}
 	}
 
-	/* central part: convolve with fixed row of h */
-	for (i = half; i < n-half; i++)
-		for (k = 0; k < points; k++)
-			result[i] += gsl_matrix_get(h, half, k) * data[i-half+k];
-
 	/* right edge */
-	if(mode == nsl_smooth_pad_none) {
-		for (i = n-half; i < n; i++) {
-			/*reduce points and order*/
-			unsigned int rpoints = 2*(n-1-i) + 1, rorder=GSL_MIN(order, rpoints-GSL_MIN(2, rpoints));
-
-			gsl_matrix *rh = gsl_matrix_alloc(rpoints, rpoints);
-			error = nsl_smooth_savgol_coeff(rpoints, rorder, rh);
-			if (error) {
-				printf("Internal error in Savitzky-Golay algorithm:\n%s",gsl_strerror(error));
-				gsl_matrix_free(rh);
-				free(result);
-				return error;
-			}
-			
-			for (k = 0; k < rpoints; k++)
-				result[i] += gsl_matrix_get(rh, n-1-i, k) * data[n-rpoints+k];
-		}
-	} else {
+	if(mode != nsl_smooth_pad_none) {
 		for (i = n-half; i < n; i++) {
 			for (k = 0; k < points; k++)
 				switch(mode) {
 				case nsl_smooth_pad_interp:
-					result[i] += gsl_matrix_get(h, points-n+i, k) * data[n-points+k];
+					right[i-(n-half)] += gsl_matrix_get(h, points-n+i, k) * data[n-points+k];
 					break;
 				case nsl_smooth_pad_mirror:
-					result[i] += gsl_matrix_get(h, half, k) * data[n-1-abs((int)(k+1+i-n-half))];
+					right[i-(n-half)] += gsl_matrix_get(h, half, k) * data[n-1-abs((int)(k+1+i-n-half))];
 					break;
 				case nsl_smooth_pad_nearest:
-					result[i] += gsl_matrix_get(h, half, k) * data[GSL_MIN(i-half+k,n-1)];
+					right[i-(n-half)] += gsl_matrix_get(h, half, k) * data[GSL_MIN(i-half+k,n-1)];
 					break;
 				case nsl_smooth_pad_constant:
 					if (k < n-i+half)
-						result[i] += gsl_matrix_get(h, half, k) * data[i-half+k];
+						right[i-(n-half)] += gsl_matrix_get(h, half, k) * data[i-half+k];
 					else
-						result[i] += gsl_matrix_get(h, half, k) * nsl_smooth_pad_constant_rvalue;
+						right[i-(n-half)] += gsl_matrix_get(h, half, k) * nsl_smooth_pad_constant_rvalue;
 					break;
 				case nsl_smooth_pad_periodic:
-					result[i] += gsl_matrix_get(h, half, k) * data[(i-half+k) % n];
+					right[i-(n-half)] += gsl_matrix_get(h, half, k) * data[(i-half+k) % n];
 				case nsl_smooth_pad_none:
 					break;
 				}
 		}
 	}
 
-	gsl_matrix_free(h);
+	/* central part: convolve with fixed row of h */
+	double *coeff = (double *)malloc(points*sizeof(double));
+	if (coeff == NULL) {
+		free(left);
+		free(right);
+		return -1;
+	}
+	for (k = 0; k < points; k++)
+		coeff[k] = gsl_matrix_get(h, half, k);
+	error = nsl_smooth_convolve(data, half, n-half, coeff, points, half);
+	free(coeff);
 
-	for (i = 0; i < n; i++)
-		data[i] = result[i];
-	free(result);
+	memcpy(data, left, half*sizeof(double));
+	memcpy(data + n-half, right, half*sizeof(double));
+	free(left);
+	free(right);
 
-	return 0;
+	return error;
 }
 
 int nsl_smooth_savgol_default( double *data, unsigned int n, unsigned int points, unsigned int order) {
@@ -30,6 +30,7 @@
 #define NSL_SMOOTH_H
 
 #include <gsl/gsl_matrix.h>
+#include "nsl_stats.h"
 
 #define NSL_SMOOTH_TYPE_COUNT 4
 typedef enum {nsl_smooth_type_moving_average, nsl_smooth_type_moving_average_lagged, nsl_smooth_type_percentile,
@@ -70,6 +71,8 @@ int nsl_smooth_moving_average_lagged(double *data, unsigned int n, unsigned int
 
 /* Percentile filter */
 int nsl_smooth_percentile(double *data, unsigned int n, unsigned int points, double percentile, nsl_smooth_pad_mode mode);
+/* Percentile filter using the quantile estimation type */
+int nsl_smooth_percentile_type(double *data, unsigned int n, unsigned int points, double percentile, nsl_smooth_pad_mode mode, nsl_stats_quantile_type type);
 
 /* Savitzky-Golay coefficents */
 /**
@@ -101,6 +104,8 @@ void nsl_smooth_pad_constant_set(double lvalue, double rvalue);
  * generic method able to handle non-uniform input data.
  */
 int nsl_smooth_savgol(double *data, unsigned int n, unsigned int points, unsigned int order, nsl_smooth_pad_mode mode);
+/* releases the coefficient matrices cached by nsl_smooth_savgol() (not thread-safe) */
+void nsl_smooth_savgol_cache_clear(void);
 
 /* Savitzky-Golay default smooting (interp) */
 int nsl_smooth_savgol_default(double *data, unsigned int n, unsigned int points, unsigned int order);
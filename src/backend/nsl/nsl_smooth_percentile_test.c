@@ -27,7 +27,74 @@
  ***************************************************************************/
 
 #include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
 #include "nsl_smooth.h"
+#include "nsl_common.h"
+#include <gsl/gsl_sort.h>
+
+/* size of the data for the comparison and the benchmark */
+#define N 6000
+#define NBENCH 10000000
+#define POINTSBENCH 501
+
+/* previous implementation (sorting every window) as reference */
+void percentile_reference(double *data, unsigned int n, unsigned int points, double percentile, nsl_smooth_pad_mode mode, nsl_stats_quantile_type type) {
+	unsigned int i,j;
+	double *result = (double *)malloc(n*sizeof(double));
+	double *values = (double *)malloc((points+1)*sizeof(double));
+
+	for(i=0;i<n;i++) {
+		unsigned int np=points;
+		unsigned int half=(points-1)/2;
+		if(mode == nsl_smooth_pad_none) {
+			half = i < (points-1)/2 ? i : (points-1)/2;
+			half = half < n-i-1 ? half : n-i-1;
+			np = 2*half+1;
+		}
+
+		for(j=0;j<np;j++) {
+			int index = i-half+j;
+			switch(mode) {
+			case nsl_smooth_pad_none:
+			case nsl_smooth_pad_interp:
+				values[j] = data[index];
+				break;
+			case nsl_smooth_pad_mirror:
+				index=abs(index);
+				values[j] = data[index < 2*((int)n-1)-index ? index : 2*((int)n-1)-index];
+				break;
+			case nsl_smooth_pad_nearest:
+				values[j] = data[index < 0 ? 0 : (index > (int)n-1 ? (int)n-1 : index)];
+				break;
+			case nsl_smooth_pad_constant:
+				if(index<0)
+					values[j] = nsl_smooth_pad_constant_lvalue;
+				else if(index>(int)n-1)
+					values[j] = nsl_smooth_pad_constant_rvalue;
+				else
+					values[j] = data[index];
+				break;
+			case nsl_smooth_pad_periodic:
+				if(index<0)
+					index = n+index;
+				else if(index>(int)n-1)
+					index = index-n;
+				values[j] = data[index];
+				break;
+			}
+		}
+
+		/* type 2 may use the value after the window (clamped to the last value) */
+		gsl_sort(values, 1, np);
+		values[np] = values[np-1];
+		result[i] = nsl_stats_quantile_sorted(values, 1, np, percentile, type);
+	}
+
+	memcpy(data, result, n*sizeof(double));
+	free(values);
+	free(result);
+}
 
 int main() {
 	double data[9]={2,2,5,2,1,0,1,4,9};
@@ -63,4 +130,48 @@ int main() {
 	for(i=0;i<9;i++)
 		printf(" %g",data5[i]);
 	puts("");
+
+	/* compare with the reference for all padding modes and quantile types */
+	double *data6 = (double *)malloc(N*sizeof(double));
+	double *data7 = (double *)malloc(N*sizeof(double));
+	int mode, type, errors = 0;
+	unsigned int p, pointlist[] = {3, 4, 51, 101};
+	double percentiles[] = {0., 0.25, 0.5, 0.9, 1.};
+	nsl_smooth_pad_constant_set(-1., 2.);
+	for (mode = nsl_smooth_pad_none; mode <= nsl_smooth_pad_periodic; mode++) {
+		if (mode == nsl_smooth_pad_interp)
+			continue;
+		for (type = nsl_stats_quantile_type1; type <= nsl_stats_quantile_type9; type++) {
+			for (p = 0; p < sizeof(pointlist)/sizeof(pointlist[0]); p++) {
+				unsigned int k;
+				for (k = 0; k < sizeof(percentiles)/sizeof(percentiles[0]); k++) {
+					srand(p);
+					for (i = 0; i < N; i++)
+						data6[i] = data7[i] = (rand() % 100 == 0) ? 1. : (double)rand()/RAND_MAX;
+					nsl_smooth_percentile_type(data6, N, pointlist[p], percentiles[k], mode, type);
+					percentile_reference(data7, N, pointlist[p], percentiles[k], mode, type);
+					if (memcmp(data6, data7, N*sizeof(double)) != 0) {
+						printf("%s, type %d, points = %u, percentile = %g: different results\n", nsl_smooth_pad_mode_name[mode], type, pointlist[p], percentiles[k]);
+						errors++;
+					}
+				}
+			}
+		}
+	}
+	printf("comparison with reference: %d errors\n", errors);
+	free(data6);
+	free(data7);
+
+	/* benchmark */
+	double *data8 = (double *)malloc(NBENCH*sizeof(double));
+	for (i = 0; i < NBENCH; i++)
+		data8[i] = sin(i/1000.) + (double)rand()/RAND_MAX;
+	struct timeval time1, time2;
+	gettimeofday(&time1, NULL);
+	status = nsl_smooth_percentile(data8, NBENCH, POINTSBENCH, percentile, nsl_smooth_pad_mirror);
+	gettimeofday(&time2, NULL);
+	printf("median of %d points (window %d): %llu ms\n", NBENCH, POINTSBENCH, (unsigned long long)1000 * (time2.tv_sec - time1.tv_sec) + (time2.tv_usec - time1.tv_usec) / 1000);
+	free(data8);
+
+	return errors;
 }
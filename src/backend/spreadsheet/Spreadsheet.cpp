@@ -38,9 +38,15 @@
 #include <QPrintPreviewDialog>
 
 #include <QIcon>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QThread>
 #include <KConfigGroup>
 #include <KLocale>
 
+#include <algorithm>
+#include <cmath>
+
 /*!
   \class Spreadsheet
   \brief Aspect providing a spreadsheet table with column logic.
@@ -430,233 +436,217 @@ int Spreadsheet::colY(int col)
 	return -1;
 }
 
-/*! Sorts the given list of column.
-  If 'leading' is a null pointer, each column is sorted separately.
-*/
-void Spreadsheet::sortColumns(Column *leading, QList<Column*> cols, bool ascending)
-{
-	if(cols.isEmpty()) return;
-
-	// the normal QPair comparison does not work properly with descending sorting
-	// thefore we use our own compare functions
-	class CompareFunctions {
-		public:
-			static bool doubleLess(const QPair<double, int>& a, const QPair<double, int>& b)
-			{
-				return a.first < b.first;
-			}
-			static bool doubleGreater(const QPair<double, int>& a, const QPair<double, int>& b)
-			{
-				return a.first > b.first;
-			}
-			static bool QStringLess(const QPair<QString, int>& a, const QPair<QString, int>& b)
-			{
-				return a < b;
-			}
-			static bool QStringGreater(const QPair<QString, int>& a, const QPair<QString, int>& b)
-			{
-				return a > b;
-			}
-			static bool QDateTimeLess(const QPair<QDateTime, int>& a, const QPair<QDateTime, int>& b)
-			{
-				return a < b;
-			}
-			static bool QDateTimeGreater(const QPair<QDateTime, int>& a, const QPair<QDateTime, int>& b)
-			{
-				return a > b;
-			}
-	};
+//number of rows from which on the sorting is distributed over several threads
+static const int parallelSortRows = 65536;
 
-	WAIT_CURSOR;
-	beginMacro(i18n("%1: sort columns", name()));
+/*!
+  values of a key column of the sorting, copied once before sorting
+*/
+struct SortKey {
+	AbstractColumn::ColumnMode mode;
+	bool ascending;
+	QVector<double> values;
+	QStringList texts;
+	QList<QDateTime> dateTimes;
+};
 
-	if(leading == 0) { // sort separately
-		foreach(Column *col, cols) {
-			switch (col->columnMode()) {
-				case AbstractColumn::Numeric:
-					{
-						int rows = col->rowCount();
-						QList< QPair<double, int> > map;
-
-						for(int j=0; j<rows; j++)
-							map.append(QPair<double, int>(col->valueAt(j), j));
-
-						if(ascending)
-							qStableSort(map.begin(), map.end(), CompareFunctions::doubleLess);
-						else
-							qStableSort(map.begin(), map.end(), CompareFunctions::doubleGreater);
-
-						QListIterator< QPair<double, int> > it(map);
-						Column *temp_col = new Column("temp", col->columnMode());
-
-						int k=0;
-						// put the values in the right order into temp_col
-						while(it.hasNext()) {
-							temp_col->copy(col, it.peekNext().second, k, 1);
-							temp_col->setMasked(col->isMasked(it.next().second));
-							k++;
-						}
-						// copy the sorted column
-						col->copy(temp_col, 0, 0, rows);
-						delete temp_col;
-						break;
-					}
-				case AbstractColumn::Text:
-					{
-						int rows = col->rowCount();
-						QList< QPair<QString, int> > map;
-
-						for(int j=0; j<rows; j++)
-							map.append(QPair<QString, int>(col->textAt(j), j));
-
-						if(ascending)
-							qStableSort(map.begin(), map.end(), CompareFunctions::QStringLess);
-						else
-							qStableSort(map.begin(), map.end(), CompareFunctions::QStringGreater);
-
-						QListIterator< QPair<QString, int> > it(map);
-						Column *temp_col = new Column("temp", col->columnMode());
-
-						int k=0;
-						// put the values in the right order into temp_col
-						while(it.hasNext()) {
-							temp_col->copy(col, it.peekNext().second, k, 1);
-							temp_col->setMasked(col->isMasked(it.next().second));
-							k++;
-						}
-						// copy the sorted column
-						col->copy(temp_col, 0, 0, rows);
-						delete temp_col;
-						break;
-					}
-				case AbstractColumn::DateTime:
-				case AbstractColumn::Month:
-				case AbstractColumn::Day:
-					{
-						int rows = col->rowCount();
-						QList< QPair<QDateTime, int> > map;
-
-						for(int j=0; j<rows; j++)
-							map.append(QPair<QDateTime, int>(col->dateTimeAt(j), j));
-
-						if(ascending)
-							qStableSort(map.begin(), map.end(), CompareFunctions::QDateTimeLess);
-						else
-							qStableSort(map.begin(), map.end(), CompareFunctions::QDateTimeGreater);
-
-						QListIterator< QPair<QDateTime, int> > it(map);
-						Column *temp_col = new Column("temp", col->columnMode());
-
-						int k=0;
-						// put the values in the right order into temp_col
-						while(it.hasNext()) {
-							temp_col->copy(col, it.peekNext().second, k, 1);
-							temp_col->setMasked(col->isMasked(it.next().second));
-							k++;
-						}
-						// copy the sorted column
-						col->copy(temp_col, 0, 0, rows);
-						delete temp_col;
-						break;
-					}
-			}
-		}
-	} else { // sort with leading column
-		switch (leading->columnMode()) {
-			case AbstractColumn::Numeric:
-				{
-					QList< QPair<double, int> > map;
-					int rows = leading->rowCount();
-
-					for(int i=0; i<rows; i++)
-						map.append(QPair<double, int>(leading->valueAt(i), i));
-
-					if(ascending)
-						qStableSort(map.begin(), map.end(), CompareFunctions::doubleLess);
-					else
-						qStableSort(map.begin(), map.end(), CompareFunctions::doubleGreater);
-					QListIterator< QPair<double, int> > it(map);
-
-					foreach (Column *col, cols) {
-						Column *temp_col = new Column("temp", col->columnMode());
-						it.toFront();
-						int j=0;
-						// put the values in the right order into temp_col
-						while(it.hasNext()) {
-							temp_col->copy(col, it.peekNext().second, j, 1);
-							temp_col->setMasked(col->isMasked(it.next().second));
-							j++;
-						}
-						// copy the sorted column
-						col->copy(temp_col, 0, 0, rows);
-						delete temp_col;
+/*!
+  compares two rows by the sort keys, the first key that differs decides.
+  NaN values are sorted to the end for both directions.
+*/
+class RowComparator {
+public:
+	explicit RowComparator(const QVector<SortKey>& keys) : m_keys(keys) {}
+
+	bool operator()(int a, int b) const {
+		for (int i = 0; i < m_keys.size(); ++i) {
+			const SortKey& key = m_keys.at(i);
+			int result = 0;
+			switch (key.mode) {
+			case AbstractColumn::Numeric: {
+					const double x = key.values.at(a);
+					const double y = key.values.at(b);
+					if (std::isnan(x) || std::isnan(y)) {
+						if (std::isnan(x) && std::isnan(y))
+							continue;
+						return std::isnan(y);
 					}
+					result = (x < y) ? -1 : (x > y);
 					break;
 				}
 			case AbstractColumn::Text:
-				{
-					QList< QPair<QString, int> > map;
-					int rows = leading->rowCount();
-
-					for(int i=0; i<rows; i++)
-						map.append(QPair<QString, int>(leading->textAt(i), i));
-
-					if(ascending)
-						qStableSort(map.begin(), map.end(), CompareFunctions::QStringLess);
-					else
-						qStableSort(map.begin(), map.end(), CompareFunctions::QStringGreater);
-					QListIterator< QPair<QString, int> > it(map);
-
-					foreach (Column *col, cols) {
-						Column *temp_col = new Column("temp", col->columnMode());
-						it.toFront();
-						int j=0;
-						// put the values in the right order into temp_col
-						while(it.hasNext()) {
-							temp_col->copy(col, it.peekNext().second, j, 1);
-							temp_col->setMasked(col->isMasked(it.next().second));
-							j++;
-						}
-						// copy the sorted column
-						col->copy(temp_col, 0, 0, rows);
-						delete temp_col;
-					}
-					break;
-				}
+				result = QString::compare(key.texts.at(a), key.texts.at(b));
+				break;
 			case AbstractColumn::DateTime:
 			case AbstractColumn::Month:
-			case AbstractColumn::Day:
-				{
-					QList< QPair<QDateTime, int> > map;
-					int rows = leading->rowCount();
-
-					for(int i=0; i<rows; i++)
-						map.append(QPair<QDateTime, int>(leading->dateTimeAt(i), i));
-
-					if(ascending)
-						qStableSort(map.begin(), map.end(), CompareFunctions::QDateTimeLess);
-					else
-						qStableSort(map.begin(), map.end(), CompareFunctions::QDateTimeGreater);
-					QListIterator< QPair<QDateTime, int> > it(map);
-
-					foreach (Column *col, cols) {
-						Column *temp_col = new Column("temp", col->columnMode());
-						it.toFront();
-						int j=0;
-						// put the values in the right order into temp_col
-						while(it.hasNext()) {
-							temp_col->copy(col, it.peekNext().second, j, 1);
-							temp_col->setMasked(col->isMasked(it.next().second));
-							j++;
-						}
-						// copy the sorted column
-						col->copy(temp_col, 0, 0, rows);
-						delete temp_col;
-					}
+			case AbstractColumn::Day: {
+					const QDateTime& x = key.dateTimes.at(a);
+					const QDateTime& y = key.dateTimes.at(b);
+					result = (x < y) ? -1 : (y < x);
 					break;
 				}
+			}
+
+			if (result != 0)
+				return key.ascending ? (result < 0) : (result > 0);
 		}
+
+		return false;
 	}
+
+private:
+	const QVector<SortKey>& m_keys;
+};
+
+/* task classes for the parallel stable sort */
+class SortRangeTask : public QRunnable {
+public:
+	SortRangeTask(int* begin, int* end, const RowComparator& comparator) : m_begin(begin), m_end(end), m_comparator(comparator) {}
+
+	void run() {
+		std::stable_sort(m_begin, m_end, m_comparator);
+	}
+
+private:
+	int* m_begin;
+	int* m_end;
+	const RowComparator& m_comparator;
+};
+
+class MergeRangesTask : public QRunnable {
+public:
+	MergeRangesTask(const int* source, int begin, int middle, int end, int* target, const RowComparator& comparator)
+		: m_source(source), m_begin(begin), m_middle(middle), m_end(end), m_target(target), m_comparator(comparator) {}
+
+	void run() {
+		//std::merge takes the elements of the first range first for equal keys, this keeps the sorting stable
+		std::merge(m_source + m_begin, m_source + m_middle, m_source + m_middle, m_source + m_end, m_target + m_begin, m_comparator);
+	}
+
+private:
+	const int* m_source;
+	int m_begin;
+	int m_middle;
+	int m_end;
+	int* m_target;
+	const RowComparator& m_comparator;
+};
+
+/*!
+  returns the permutation of the rows sorting the columns \c keys stably in the directions \c ascending.
+  The number of rows is given by the first key, shorter keys are treated as empty at the end.
+  Larger columns are sorted in ranges in parallel and the sorted ranges are merged pairwise, also in parallel.
+*/
+static QVector<int> sortPermutation(const QList<Column*>& keyColumns, const QList<bool>& ascending) {
+	const int rows = keyColumns.first()->rowCount();
+	QVector<SortKey> keys(keyColumns.size());
+	for (int i = 0; i < keyColumns.size(); ++i) {
+		const Column* col = keyColumns.at(i);
+		SortKey& key = keys[i];
+		key.mode = col->columnMode();
+		key.ascending = ascending.at(i);
+		switch (key.mode) {
+		case AbstractColumn::Numeric:
+			key.values = *static_cast< QVector<double>* >(col->data());
+			if (key.values.size() < rows)
+				key.values.insert(key.values.end(), rows - key.values.size(), NAN);
+			break;
+		case AbstractColumn::Text:
+			key.texts = *static_cast< QStringList* >(col->data());
+			while (key.texts.size() < rows)
+				key.texts << QString();
+			break;
+		case AbstractColumn::DateTime:
+		case AbstractColumn::Month:
+		case AbstractColumn::Day:
+			key.dateTimes = *static_cast< QList<QDateTime>* >(col->data());
+			while (key.dateTimes.size() < rows)
+				key.dateTimes << QDateTime();
+			break;
+		}
+	}
+
+	QVector<int> permutation(rows);
+	for (int i = 0; i < rows; ++i)
+		permutation[i] = i;
+
+	const RowComparator comparator(keys);
+	const int ranges = qMin(QThread::idealThreadCount(), rows/parallelSortRows);
+	if (ranges < 2) {
+		std::stable_sort(permutation.begin(), permutation.end(), comparator);
+		return permutation;
+	}
+
+	QVector<int> bounds;
+	for (int i = 0; i <= ranges; ++i)
+		bounds << (qint64)rows*i/ranges;
+
+	//the tasks run in a local pool, waitForDone() doesn't wait for unrelated tasks in the global pool
+	QThreadPool pool;
+	int* data = permutation.data();
+	for (int i = 0; i < ranges; ++i)
+		pool.start(new SortRangeTask(data + bounds.at(i), data + bounds.at(i + 1), comparator));
+	pool.waitForDone();
+
+	QVector<int> buffer(rows);
+	int* source = data;
+	int* target = buffer.data();
+	while (bounds.size() > 2) {
+		QVector<int> merged;
+		for (int i = 0; i + 1 < bounds.size(); i += 2) {
+			merged << bounds.at(i);
+			if (i + 2 < bounds.size())
+				pool.start(new MergeRangesTask(source, bounds.at(i), bounds.at(i + 1), bounds.at(i + 2), target, comparator));
+			else
+				std::copy(source + bounds.at(i), source + bounds.at(i + 1), target + bounds.at(i));
+		}
+		merged << rows;
+		pool.waitForDone();
+
+		bounds = merged;
+		std::swap(source, target);
+	}
+
+	if (source != data)
+		std::copy(source, source + rows, data);
+
+	return permutation;
+}
+
+/*! Sorts the given list of column.
+  If 'leading' is a null pointer, each column is sorted separately.
+*/
+void Spreadsheet::sortColumns(Column *leading, QList<Column*> cols, bool ascending)
+{
+	if(cols.isEmpty()) return;
+
+	if(leading != 0) {
+		sortColumns(QList<Column*>() << leading, QList<bool>() << ascending, cols);
+		return;
+	}
+
+	WAIT_CURSOR;
+	beginMacro(i18n("%1: sort columns", name()));
+	foreach(Column* col, cols)
+		col->permuteRows(sortPermutation(QList<Column*>() << col, QList<bool>() << ascending));
+	endMacro();
+	RESET_CURSOR;
+}
+
+/*! Sorts the columns \c cols by the columns \c keys.
+  The rows are compared by the first key, equal rows by the second key and so on.
+  \c ascending contains the direction for each key.
+  The order of the rows is determined once and applied to all columns including the masking.
+*/
+void Spreadsheet::sortColumns(const QList<Column*>& keys, const QList<bool>& ascending, const QList<Column*>& cols)
+{
+	if(cols.isEmpty() || keys.isEmpty() || keys.size() != ascending.size()) return;
+
+	WAIT_CURSOR;
+	beginMacro(i18n("%1: sort columns", name()));
+	const QVector<int> permutation = sortPermutation(keys, ascending);
+	foreach(Column* col, cols)
+		col->permuteRows(permutation);
 	endMacro();
 	RESET_CURSOR;
 } // end of sortColumns()
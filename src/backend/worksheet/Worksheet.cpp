@@ -29,6 +29,8 @@
 #include "Worksheet.h"
 #include "WorksheetPrivate.h"
 #include "WorksheetElement.h"
+#include "WorksheetUpdateScheduler.h"
+#include "WorksheetLayerCache.h"
 #include "commonfrontend/worksheet/WorksheetView.h"
 #include "backend/worksheet/plots/cartesian/CartesianPlot.h"
 #include "backend/worksheet/TextLabel.h"
@@ -270,6 +272,20 @@ QGraphicsScene *Worksheet::scene() const {
 	return d->m_scene;
 }
 
+/*!
+	returns the scheduler collecting the changes of the data shown on this worksheet.
+*/
+WorksheetUpdateScheduler* Worksheet::updateScheduler() const {
+	return d->m_updateScheduler;
+}
+
+/*!
+	returns the cache limiting the memory used by the pixmaps of the elements on this worksheet.
+*/
+WorksheetLayerCache* Worksheet::layerCache() const {
+	return d->m_layerCache;
+}
+
 QRectF Worksheet::pageRect() const {
 	return d->m_scene->sceneRect();
 }
@@ -588,6 +604,10 @@ void Worksheet::setPageRect(const QRectF& rect) {
 }
 
 void Worksheet::setPrinting(bool on) const {
+	//the pending updates have to be applied before the worksheet is printed or exported
+	if (on)
+		d->m_updateScheduler->process();
+
 	QList<WorksheetElement*> childElements = children<WorksheetElement>(AbstractAspect::Recursive | AbstractAspect::IncludeHidden);
 	foreach(WorksheetElement* elem, childElements)
 		elem->setPrinting(on);
@@ -612,6 +632,8 @@ void Worksheet::setTheme(const QString& theme) {
 //##############################################################################
 WorksheetPrivate::WorksheetPrivate(Worksheet* owner):q(owner),
 	m_scene(new QGraphicsScene()),
+	m_updateScheduler(new WorksheetUpdateScheduler(owner)),
+	m_layerCache(new WorksheetLayerCache(owner)),
 	scaleContent(false) {
 }
 
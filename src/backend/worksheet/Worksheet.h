@@ -39,6 +39,8 @@ class QGraphicsScene;
 class QRectF;
 
 class WorksheetPrivate;
+class WorksheetUpdateScheduler;
+class WorksheetLayerCache;
 
 class Worksheet: public AbstractPart, public scripted {
 	Q_OBJECT
@@ -69,6 +71,8 @@ class Worksheet: public AbstractPart, public scripted {
 		void update();
 		void setPrinting(bool) const;
 		void setThemeName(const QString&);
+		WorksheetUpdateScheduler* updateScheduler() const;
+		WorksheetLayerCache* layerCache() const;
 
 		void setItemSelectedInView(const QGraphicsItem*, const bool);
 		void setSelectedInView(const bool);
@@ -111,6 +111,15 @@ void WorksheetElement::setZValue(qreal value) {
 	graphicsItem()->setZValue(value);
 }
 
+/*!
+	returns the update scheduler of the worksheet the element belongs to or 0,
+	if the element is not (yet) part of a worksheet.
+*/
+WorksheetUpdateScheduler* WorksheetElement::updateScheduler() const {
+	Worksheet* worksheet = ancestor<Worksheet>();
+	return worksheet ? worksheet->updateScheduler() : 0;
+}
+
 /**
     This does exactly what Qt internally does to creates a shape from a painter path.
 */
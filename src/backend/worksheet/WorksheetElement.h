@@ -37,6 +37,7 @@ class QAction;
 class QGraphicsItem;
 class QPen;
 class KConfig;
+class WorksheetUpdateScheduler;
 
 class WorksheetElement : public AbstractAspect {
 	Q_OBJECT
@@ -68,6 +69,8 @@ class WorksheetElement : public AbstractAspect {
 		QMenu* m_moveInFrontOfMenu;
 
 	protected:
+		WorksheetUpdateScheduler* updateScheduler() const;
+
 		static QPen selectedPen;
 		static float selectedOpacity;
 		static QPen hoveredPen;
@@ -0,0 +1,104 @@
+/***************************************************************************
+    File                 : WorksheetLayerCache.cpp
+    Project              : LabPlot
+    Description          : Memory limit for the cached pixmaps of the worksheet elements
+    --------------------------------------------------------------------
+    Copyright            : (C) 2017 LabPlot developers
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "WorksheetLayerCache.h"
+#include "backend/lib/macros.h"
+
+//default limit for the pixmaps of all elements of one worksheet
+static const qint64 defaultLimit = 256*1024*1024;
+
+/*!
+	\class WorksheetLayerCache
+	\brief Limits the memory used by the pixmaps cached by the elements of a worksheet.
+
+	The elements report the size of their cached pixmaps with use() every time they paint them.
+	If the sum exceeds limit(), the least recently used elements release their pixmaps
+	(\sa Client::releaseLayers()) and render them again when they become visible the next time.
+	The element using the cache at the moment is never released.
+
+	\ingroup worksheet
+*/
+WorksheetLayerCache::WorksheetLayerCache(QObject* parent) : QObject(parent), m_size(0), m_limit(defaultLimit) {
+}
+
+void WorksheetLayerCache::setLimit(qint64 bytes) {
+	m_limit = bytes;
+	evict();
+}
+
+qint64 WorksheetLayerCache::limit() const {
+	return m_limit;
+}
+
+/*!
+	returns the size of all registered pixmaps in bytes.
+*/
+qint64 WorksheetLayerCache::size() const {
+	return m_size;
+}
+
+/*!
+	marks \c client as the most recently used one with pixmaps of \c bytes bytes in total.
+*/
+void WorksheetLayerCache::use(Client* client, qint64 bytes) {
+	if (!m_clients.isEmpty() && m_clients.first() == client) {
+		m_size += bytes - m_sizes.value(client);
+		m_sizes[client] = bytes;
+		evict();
+		return;
+	}
+
+	if (m_sizes.contains(client)) {
+		m_clients.removeOne(client);
+		m_size -= m_sizes.value(client);
+	}
+	m_clients.prepend(client);
+	m_sizes[client] = bytes;
+	m_size += bytes;
+	evict();
+}
+
+/*!
+	removes \c client from the cache, to be called when the client is deleted or released its pixmaps itself.
+*/
+void WorksheetLayerCache::remove(Client* client) {
+	if (!m_sizes.contains(client))
+		return;
+
+	m_clients.removeOne(client);
+	m_size -= m_sizes.take(client);
+}
+
+void WorksheetLayerCache::evict() {
+	while (m_size > m_limit && m_clients.size() > 1) {
+		Client* client = m_clients.takeLast();
+		m_size -= m_sizes.take(client);
+		client->releaseLayers();
+		DEBUG("WorksheetLayerCache: released the pixmaps of an element, " << m_size/1024 << " kB in use");
+	}
+}
@@ -0,0 +1,65 @@
+/***************************************************************************
+    File                 : WorksheetLayerCache.h
+    Project              : LabPlot
+    Description          : Memory limit for the cached pixmaps of the worksheet elements
+    --------------------------------------------------------------------
+    Copyright            : (C) 2017 LabPlot developers
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+#ifndef WORKSHEETLAYERCACHE_H
+#define WORKSHEETLAYERCACHE_H
+
+#include <QObject>
+#include <QList>
+#include <QHash>
+
+class WorksheetLayerCache : public QObject {
+	Q_OBJECT
+
+	public:
+		//! element keeping cached pixmaps
+		class Client {
+			public:
+				virtual ~Client() {}
+				//! drops the cached pixmaps, they are rendered again when needed
+				virtual void releaseLayers() = 0;
+		};
+
+		explicit WorksheetLayerCache(QObject* parent = 0);
+
+		void setLimit(qint64 bytes);
+		qint64 limit() const;
+		qint64 size() const;
+
+		void use(Client*, qint64 bytes);
+		void remove(Client*);
+
+	private:
+		void evict();
+
+		QList<Client*> m_clients;	//the most recently used client first
+		QHash<Client*, qint64> m_sizes;
+		qint64 m_size;
+		qint64 m_limit;
+};
+
+#endif
@@ -34,6 +34,8 @@
 class Worksheet;
 class WorksheetElementContainer;
 class QGraphicsScene;
+class WorksheetUpdateScheduler;
+class WorksheetLayerCache;
 
 class WorksheetPrivate{
 	public:
@@ -43,6 +45,8 @@ class WorksheetPrivate{
 		Worksheet* const q;
 		QRectF pageRect;
 		QGraphicsScene* m_scene;
+		WorksheetUpdateScheduler* m_updateScheduler;
+		WorksheetLayerCache* m_layerCache;
 		bool useViewSize;
 		bool scaleContent;
 
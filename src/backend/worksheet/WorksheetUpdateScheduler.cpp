@@ -0,0 +1,196 @@
+/***************************************************************************
+    File                 : WorksheetUpdateScheduler.cpp
+    Project              : LabPlot
+    Description          : Coalesced update of the worksheet elements
+    --------------------------------------------------------------------
+    Copyright            : (C) 2017 LabPlot developers
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "backend/worksheet/WorksheetUpdateScheduler.h"
+#include "backend/worksheet/Worksheet.h"
+#include "backend/worksheet/plots/cartesian/CartesianPlot.h"
+#include "backend/worksheet/plots/cartesian/XYCurve.h"
+#include "backend/lib/macros.h"
+
+/*!
+	\class WorksheetUpdateScheduler
+	\brief Collects the changes of the data shown on a worksheet and updates the affected elements
+	in one deferred pass.
+
+	A change of the data in a column used by several curves, or of several columns at once (e.g. on
+	the re-import of a file), used to retransform the curves once per signal and to autoscale the plot
+	(and to retransform all its curves again) on every single change.
+	Instead, the curves and plots only mark themselves dirty (\sa invalidate()) and the pass
+	executed once in the next iteration of the event loop (\sa process()):
+	\li autoscales every affected plot once, the retransforms of the curves requested by the plots
+	while rescaling are only collected (\sa deferRetransform()),
+	\li retransforms every curve that was invalidated or had to be retransformed because of the new scales exactly once.
+
+	The number of the requested and of the actually performed retransforms is counted,
+	the difference is the number of the avoided ones.
+
+	\ingroup worksheet
+*/
+WorksheetUpdateScheduler::WorksheetUpdateScheduler(QObject* parent) : QObject(parent),
+	m_pending(false), m_collecting(false), m_requested(0), m_performed(0) {
+}
+
+/*!
+	marks the curve \c curve dirty. \c flags specifies which data of the curve was changed,
+	the scales of the parent plot are marked dirty in the same directions.
+*/
+void WorksheetUpdateScheduler::invalidate(XYCurve* curve, DirtyFlags flags) {
+	++m_requested;
+	if (!m_curveSet.contains(curve)) {
+		m_curveSet << curve;
+		m_curves << curve;
+		watch(curve);
+	}
+
+	CartesianPlot* plot = dynamic_cast<CartesianPlot*>(curve->parentAspect());
+	if (plot)
+		invalidate(plot, flags);
+	else
+		schedule();
+}
+
+/*!
+	marks the plot \c plot dirty. The plot is autoscaled in the directions given by \c flags
+	in the next pass if auto-scaling is active there.
+*/
+void WorksheetUpdateScheduler::invalidate(CartesianPlot* plot, DirtyFlags flags) {
+	if (!m_plotFlags.contains(plot)) {
+		m_plots << plot;
+		watch(plot);
+	}
+	m_plotFlags[plot] |= flags;
+	schedule();
+}
+
+/*!
+	called by \c curve before it is retransformed. Returns \c true if the retransform was only
+	collected since the pass is currently rescaling the plots. The curve is retransformed later in the same pass.
+*/
+bool WorksheetUpdateScheduler::deferRetransform(XYCurve* curve) {
+	if (!m_collecting)
+		return false;
+
+	++m_requested;
+	if (!m_curveSet.contains(curve)) {
+		m_curveSet << curve;
+		m_curves << curve;
+		watch(curve);
+	}
+	return true;
+}
+
+bool WorksheetUpdateScheduler::isPending() const {
+	return m_pending;
+}
+
+/*!
+	returns the number of the curve retransforms requested by the data changes and by the rescaled plots.
+*/
+int WorksheetUpdateScheduler::requestedRetransforms() const {
+	return m_requested;
+}
+
+/*!
+	returns the number of the curve retransforms that were actually performed.
+*/
+int WorksheetUpdateScheduler::performedRetransforms() const {
+	return m_performed;
+}
+
+int WorksheetUpdateScheduler::avoidedRetransforms() const {
+	return m_requested - m_performed;
+}
+
+void WorksheetUpdateScheduler::resetCounters() {
+	m_requested = 0;
+	m_performed = 0;
+}
+
+void WorksheetUpdateScheduler::watch(QObject* element) {
+	connect(element, SIGNAL(destroyed(QObject*)), this, SLOT(elementDestroyed(QObject*)), Qt::UniqueConnection);
+}
+
+/*!
+	removes the deleted curve or plot from the dirty elements, the queued QPointers are null then and skipped.
+*/
+void WorksheetUpdateScheduler::elementDestroyed(QObject* element) {
+	m_curveSet.remove(element);
+	m_plotFlags.remove(element);
+}
+
+void WorksheetUpdateScheduler::schedule() {
+	if (m_pending)
+		return;
+
+	m_pending = true;
+	QMetaObject::invokeMethod(this, "process", Qt::QueuedConnection);
+}
+
+/*!
+	executes the deferred pass: autoscales the dirty plots and retransforms the dirty curves.
+	Elements that were deleted or removed from the worksheet in the meantime are skipped.
+*/
+void WorksheetUpdateScheduler::process() {
+	if (!m_pending)
+		return;
+
+	m_pending = false;
+
+	//the changes done while processing are handled in the next pass
+	const QVector<QPointer<CartesianPlot> > plots = m_plots;
+	const QHash<const QObject*, int> plotFlags = m_plotFlags;
+	m_plots.clear();
+	m_plotFlags.clear();
+
+	m_collecting = true;
+	foreach (const QPointer<CartesianPlot>& plot, plots) {
+		if (!plot || plot->ancestor<Worksheet>() != parent())
+			continue;
+
+		const int flags = plotFlags.value(plot.data());
+		plot->updateAutoScale(flags & XDataDirty, flags & YDataDirty);
+	}
+	m_collecting = false;
+
+	const QVector<QPointer<XYCurve> > curves = m_curves;
+	m_curves.clear();
+	m_curveSet.clear();
+
+	int performed = 0;
+	foreach (const QPointer<XYCurve>& curve, curves) {
+		if (!curve || curve->ancestor<Worksheet>() != parent())
+			continue;
+
+		curve->retransform();
+		++performed;
+	}
+	m_performed += performed;
+
+	DEBUG("WorksheetUpdateScheduler::process(): " << plots.size() << " plots, " << performed
+		<< " curves retransformed, " << avoidedRetransforms() << " retransforms avoided in total");
+}
@@ -0,0 +1,83 @@
+/***************************************************************************
+    File                 : WorksheetUpdateScheduler.h
+    Project              : LabPlot
+    Description          : Coalesced update of the worksheet elements
+    --------------------------------------------------------------------
+    Copyright            : (C) 2017 LabPlot developers
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef WORKSHEETUPDATESCHEDULER_H
+#define WORKSHEETUPDATESCHEDULER_H
+
+#include <QObject>
+#include <QPointer>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+
+class CartesianPlot;
+class XYCurve;
+
+class WorksheetUpdateScheduler : public QObject {
+	Q_OBJECT
+
+	public:
+		enum DirtyFlag {XDataDirty = 0x01, YDataDirty = 0x02};
+		Q_DECLARE_FLAGS(DirtyFlags, DirtyFlag)
+
+		explicit WorksheetUpdateScheduler(QObject* parent = 0);
+
+		void invalidate(XYCurve*, DirtyFlags);
+		void invalidate(CartesianPlot*, DirtyFlags);
+		bool deferRetransform(XYCurve*);
+		bool isPending() const;
+
+		int requestedRetransforms() const;
+		int performedRetransforms() const;
+		int avoidedRetransforms() const;
+		void resetCounters();
+
+	public slots:
+		void process();
+
+	private slots:
+		void elementDestroyed(QObject*);
+
+	private:
+		void schedule();
+		void watch(QObject*);
+
+		bool m_pending;
+		bool m_collecting;
+		QVector<QPointer<XYCurve> > m_curves;
+		QSet<const QObject*> m_curveSet;	//the entries of deleted elements are removed in elementDestroyed(),
+		QVector<QPointer<CartesianPlot> > m_plots;
+		QHash<const QObject*, int> m_plotFlags;	//new elements at the same address are not skipped
+
+		int m_requested;
+		int m_performed;
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(WorksheetUpdateScheduler::DirtyFlags)
+
+#endif
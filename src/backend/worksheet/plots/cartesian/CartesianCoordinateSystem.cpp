@@ -29,6 +29,21 @@
 
 #include "backend/worksheet/plots/cartesian/CartesianCoordinateSystem.h"
 #include "backend/worksheet/plots/cartesian/CartesianPlot.h"
+#include "backend/lib/ScratchArena.h"
+
+#include <algorithm>
+#include <cstring>
+
+//the fuzzy comparisons of AbstractCoordinateSystem, inlined for the loops over the arrays of values
+static const float fuzzyEpsilon = 0.0000001;
+
+static inline bool fuzzyLessThan(float a, float b) {
+	return (b - a) > ( (fabs(a) < fabs(b) ? fabs(b) : fabs(a)) * fuzzyEpsilon);
+}
+
+static inline bool fuzzyGreaterThan(float a, float b) {
+	return (a - b) > ( (fabs(a) < fabs(b) ? fabs(b) : fabs(a)) * fuzzyEpsilon);
+}
 
 /* ============================================================================ */
 /* =================================== scales ================================= */
@@ -61,6 +76,19 @@ bool CartesianScale::contains(double value) const {
 	return m_interval.fuzzyContains(value);
 }
 
+/*!
+	sets the entries in \c mask to 0 for all of the \c count values in \c values
+	that are not contained in the interval of the scale.
+*/
+void CartesianScale::contains(const double* values, char* mask, int count) const {
+	const float start = m_interval.start();
+	const float end = m_interval.end();
+	for (int i = 0; i < count; ++i) {
+		const float value = values[i];
+		mask[i] &= (char)(fuzzyLessThan(start, value) & fuzzyGreaterThan(end, value));
+	}
+}
+
 /**
  * \class CartesianCoordinateSystem::LinearScale
  * \brief implementation of the linear scale for cartesian coordinate system.
@@ -76,6 +104,13 @@ class LinearScale : public CartesianScale {
 			return true;
 		}
 
+		virtual void map(const double* values, double* result, int count) const {
+			const double a = m_a;
+			const double b = m_b;
+			for (int i = 0; i < count; ++i)
+				result[i] = values[i] * b + a;
+		}
+
 		virtual bool inverseMap(double *value) const {
 			if (m_b == 0.0)
 				return false;
@@ -110,6 +145,14 @@ class LogScale : public CartesianScale {
 			return true;
 		}
 
+		//values that can't be mapped are set to NaN
+		virtual void map(const double* values, double* result, int count) const {
+			const double a = m_a;
+			const double factor = m_b/log(m_c);
+			for (int i = 0; i < count; ++i)
+				result[i] = (values[i] > 0.0) ? log(values[i]) * factor + a : NAN;
+		}
+
 		virtual bool inverseMap(double *value) const {
 			if (m_a == 0.0)
 				return false;
@@ -199,87 +242,138 @@ CartesianScale *CartesianScale::createLogScale(const Interval<double> &interval,
 //##############################################################################
 //######################### logical to scene mappers ###########################
 //##############################################################################
-QList<QPointF> CartesianCoordinateSystem::mapLogicalToScene(const QList<QPointF> &points, const MappingFlags &flags) const {
-	const QRectF pageRect = d->plot->plotRect();
-	QList<QPointF> result;
-	bool noPageClipping = pageRect.isNull() || (flags & SuppressPageClipping);
+/*!
+	maps the \c count values in \c values with the scales \c scales into \c result and
+	sets the entries in \c mask to 0 for the values outside of the intervals of the scales
+	or that can't be mapped. With range breaks, the scale of a value is determined by
+	a binary search over the intervals of the scales.
+*/
+static void mapValues(const QList<CartesianScale*>& scales, int count, const double* values, double* result, char* mask) {
+	//the valid scales sorted by the start of their intervals
+	QVector<QPair<double, const CartesianScale*> > sorted;
+	foreach (const CartesianScale* scale, scales) {
+		if (!scale) continue;
+		Interval<double> interval;
+		scale->getProperties(NULL, &interval);
+		sorted << qMakePair(interval.start(), scale);
+	}
 
-	foreach (const CartesianScale* xScale, d->xScales) {
-		if (!xScale) continue;
+	if (sorted.isEmpty()) {
+		memset(mask, 0, count);
+		return;
+	}
 
-		foreach (const CartesianScale* yScale, d->yScales) {
-			if (!yScale) continue;
+	if (sorted.size() == 1) {
+		const CartesianScale* scale = sorted.first().second;
+		scale->map(values, result, count);
+		scale->contains(values, mask, count);
+	} else {
+		std::sort(sorted.begin(), sorted.end());
+		QVector<double> starts(sorted.size());
+		for (int k = 0; k < sorted.size(); ++k)
+			starts[k] = sorted.at(k).first;
+
+		for (int i = 0; i < count; ++i) {
+			const int k = std::upper_bound(starts.constBegin(), starts.constEnd(), values[i]) - starts.constBegin() - 1;
+			result[i] = values[i];
+			if (k < 0 || !sorted.at(k).second->contains(values[i]) || !sorted.at(k).second->map(&result[i]))
+				mask[i] = 0;
+		}
+	}
 
-			foreach(const QPointF& point, points) {
-				double x = point.x();
-				double y = point.y();
+	for (int i = 0; i < count; ++i)
+		mask[i] &= (char)!std::isnan(result[i]);
+}
 
-				if (!xScale->contains(x))
-					continue;
+/*!
+	Maps the \c count points with the logical coordinates \c x and \c y to the scene coordinates \c sceneX and \c sceneY.
+	\c visible is set to 1 for the points inside of the ranges of the scales and (without \c SuppressPageClipping)
+	inside of the plot rect, and to 0 for all other points. The scene coordinates of the invisible points are undefined.
 
-				if (!yScale->contains(y))
-					continue;
+	The values are processed as contiguous arrays, the points of one scale are mapped in one loop
+	without any calls of virtual functions or allocations per point.
+ */
+void CartesianCoordinateSystem::mapLogicalToScene(int count, const double* x, const double* y,
+		double* sceneX, double* sceneY, char* visible, const MappingFlags& flags) const {
+	if (count <= 0)
+		return;
 
-				if (!xScale->map(&x))
-					continue;
+	memset(visible, 1, count);
+	mapValues(d->xScales, count, x, sceneX, visible);
+	mapValues(d->yScales, count, y, sceneY, visible);
 
-				if (!yScale->map(&y))
-					continue;
+	const QRectF pageRect = d->plot->plotRect();
+	if (pageRect.isNull() || (flags & SuppressPageClipping))
+		return;
+
+	//see rectContainsPoint()
+	const QRectF rect = pageRect.normalized();
+	const float l = rect.left();
+	const float r = rect.right();
+	const float t = rect.top();
+	const float b = rect.bottom();
+	if (AbstractCoordinateSystem::essentiallyEqual(l, r) || AbstractCoordinateSystem::essentiallyEqual(t, b)) {
+		memset(visible, 0, count);
+		return;
+	}
 
-				const QPointF mappedPoint(x, y);
-				if (noPageClipping || rectContainsPoint(pageRect, mappedPoint))
-					result.append(mappedPoint);
-			}
-		}
+	for (int i = 0; i < count; ++i) {
+		const float px = sceneX[i];
+		const float py = sceneY[i];
+		visible[i] &= (char)(!fuzzyLessThan(px, l) & !fuzzyGreaterThan(px, r) & !fuzzyLessThan(py, t) & !fuzzyGreaterThan(py, b));
 	}
+}
 
+/*!
+	Maps the \c count x-values in \c x to the scene x-coordinates \c sceneX. \c visible is set to 1
+	for the values inside of the ranges of the x-scales and to 0 otherwise, no page clipping is done.
+ */
+void CartesianCoordinateSystem::mapLogicalXToScene(int count, const double* x, double* sceneX, char* visible) const {
+	if (count <= 0)
+		return;
+
+	memset(visible, 1, count);
+	mapValues(d->xScales, count, x, sceneX, visible);
+}
+
+QList<QPointF> CartesianCoordinateSystem::mapLogicalToScene(const QList<QPointF> &points, const MappingFlags &flags) const {
+	QList<QPointF> result;
+	std::vector<bool> visiblePoints(points.size(), false);
+	mapLogicalToScene(points, result, visiblePoints, flags);
 	return result;
 }
 
 /*!
-	Maps the points in logical coordinates from \c points and fills the \c restrictedPoints with the points in logical coordinates restricted to the current intervals.
+	Maps the points in logical coordinates from \c logicalPoints to scene coordinates.
 	\param logicalPoints List of points in logical coordinates
-	\param scenePoints List for the points in scene coordinates
-	\param restrictedLogicalPoints List for the logical coordinates restricted to the current region of the coordinate system
+	\param scenePoints List the visible points in scene coordinates are appended to
+	\param visiblePoints Vector of the size of \c logicalPoints, the entries for the visible points are set to \c true
 	\param flags
  */
 void CartesianCoordinateSystem::mapLogicalToScene(const QList<QPointF>& logicalPoints,
 												  QList<QPointF>& scenePoints,
 												  std::vector<bool>& visiblePoints,
 												  const MappingFlags& flags) const{
-	const QRectF pageRect = d->plot->plotRect();
-	QList<QPointF> result;
-	bool noPageClipping = pageRect.isNull() || (flags & SuppressPageClipping);
-
-	foreach (const CartesianScale* xScale, d->xScales) {
-		if (!xScale) continue;
-
-		foreach (const CartesianScale* yScale, d->yScales) {
-			if (!yScale) continue;
-
-			for (int i=0; i<logicalPoints.size(); ++i) {
-				const QPointF& point = logicalPoints.at(i);
-				double x = point.x();
-				double y = point.y();
-
-				if (!xScale->contains(x))
-					continue;
-
-				if (!yScale->contains(y))
-					continue;
-
-				if (!xScale->map(&x))
-					continue;
+	const int count = logicalPoints.size();
+	ScratchScope scratch;
+	double* x = scratch.allocate<double>(count);
+	double* y = scratch.allocate<double>(count);
+	double* sceneX = scratch.allocate<double>(count);
+	double* sceneY = scratch.allocate<double>(count);
+	char* visible = scratch.allocate<char>(count);
+	for (int i = 0; i < count; ++i) {
+		const QPointF& point = logicalPoints.at(i);
+		x[i] = point.x();
+		y[i] = point.y();
+	}
 
-				if (!yScale->map(&y))
-					continue;
+	mapLogicalToScene(count, x, y, sceneX, sceneY, visible, flags);
 
-				const QPointF mappedPoint(x, y);
-				if (noPageClipping || rectContainsPoint(pageRect, mappedPoint)) {
-					scenePoints.append(mappedPoint);
-					visiblePoints[i].flip();
-				}
-			}
+	scenePoints.reserve(scenePoints.size() + count);
+	for (int i = 0; i < count; ++i) {
+		if (visible[i]) {
+			scenePoints.append(QPointF(sceneX[i], sceneY[i]));
+			visiblePoints[i] = true;
 		}
 	}
 }
@@ -320,8 +414,18 @@ QPointF CartesianCoordinateSystem::mapLogicalToScene(const QPointF& logicalPoint
 }
 
 QList<QLineF> CartesianCoordinateSystem::mapLogicalToScene(const QList<QLineF> &lines, const MappingFlags &flags) const{
+	QVector<QLineF> result;
+	mapLogicalToScene(lines.toVector(), result, flags);
+	return result.toList();
+}
+
+/*!
+	Maps the lines in logical coordinates from \c lines to scene coordinates and stores the visible (clipped) lines in \c result.
+	The end points of the lines clipped to the ranges of the scales are mapped in one batch per scale.
+ */
+void CartesianCoordinateSystem::mapLogicalToScene(const QVector<QLineF>& lines, QVector<QLineF>& result, const MappingFlags& flags) const {
 	QRectF pageRect = d->plot->plotRect();
-	QList<QLineF> result;
+	result.clear();
 	bool doPageClipping = !pageRect.isNull() && !(flags & SuppressPageClipping);
 
 	double xGapBefore = NAN;
@@ -385,29 +489,42 @@ QList<QLineF> CartesianCoordinateSystem::mapLogicalToScene(const QList<QLineF> &
 
 			QRectF scaleRect = QRectF(xInterval.start(), yInterval.start(),
 					xInterval.end() - xInterval.start(), yInterval.end() - yInterval.start()).normalized();
-			foreach (QLineF line, lines) {
-				LineClipResult clipResult;
-				if (!AbstractCoordinateSystem::clipLineToRect(&line, scaleRect, &clipResult))
-					continue;
-
-				double x1 = line.x1();
-				double x2 = line.x2();
-				double y1 = line.y1();
-				double y2 = line.y2();
-
-				if (!xScale->map(&x1))
-					continue;
 
-				if (!xScale->map(&x2))
+			//clip the lines to the ranges of the current scales, the end points of the line k are stored at 2k and 2k+1
+			const int count = lines.size();
+			ScratchScope scratch;
+			double* x = scratch.allocate<double>(2*count);
+			double* y = scratch.allocate<double>(2*count);
+			QVector<LineClipResult> clipResults((flags & MarkGaps) ? count : 0);
+			int n = 0;
+			for (int i = 0; i < count; ++i) {
+				QLineF line = lines.at(i);
+				if (!AbstractCoordinateSystem::clipLineToRect(&line, scaleRect, (flags & MarkGaps) ? &clipResults[n] : NULL))
 					continue;
 
-				if (!yScale->map(&y1))
-					continue;
+				x[2*n] = line.x1();
+				x[2*n+1] = line.x2();
+				y[2*n] = line.y1();
+				y[2*n+1] = line.y2();
+				++n;
+			}
 
-				if (!yScale->map(&y2))
+			double* sceneX = scratch.allocate<double>(2*n);
+			double* sceneY = scratch.allocate<double>(2*n);
+			xScale->map(x, sceneX, 2*n);
+			yScale->map(y, sceneY, 2*n);
+			result.reserve(result.size() + n);
+
+			for (int k = 0; k < n; ++k) {
+				const double x1 = sceneX[2*k];
+				const double x2 = sceneX[2*k+1];
+				const double y1 = sceneY[2*k];
+				const double y2 = sceneY[2*k+1];
+				if (std::isnan(x1) || std::isnan(x2) || std::isnan(y1) || std::isnan(y2))
 					continue;
 
 				if (flags & MarkGaps) {
+					const LineClipResult& clipResult = clipResults.at(k);
 					//mark the end of the gap
 					if (!std::isnan(xGapBefore)) {
 						if (clipResult.xClippedLeft[0]) {
@@ -475,8 +592,6 @@ QList<QLineF> CartesianCoordinateSystem::mapLogicalToScene(const QList<QLineF> &
 			}
 		}
 	}
-
-	return result;
 }
 
 //##############################################################################
@@ -32,6 +32,7 @@
 #include "backend/worksheet/plots/AbstractCoordinateSystem.h"
 #include "backend/lib/Interval.h"
 
+#include <QVector>
 #include <vector>
 
 class CartesianPlot;
@@ -61,7 +62,9 @@ class CartesianScale {
 				double *a = NULL, double *b = NULL, double *c = NULL) const;
 
 		bool contains(double) const;
+		void contains(const double* values, char* mask, int count) const;
 		virtual bool map(double*) const = 0;
+		virtual void map(const double* values, double* result, int count) const = 0;
 		virtual bool inverseMap(double*) const = 0;
 		virtual int direction() const = 0;
 
@@ -83,6 +86,10 @@ class CartesianCoordinateSystem: public AbstractCoordinateSystem {
 		void mapLogicalToScene(const QList<QPointF>& logicalPoints, QList<QPointF>& scenePoints, std::vector<bool>& visiblePoints, const MappingFlags& flags = DefaultMapping) const;
 		virtual QPointF mapLogicalToScene(const QPointF&,const MappingFlags& flags = DefaultMapping) const;
 		virtual QList<QLineF> mapLogicalToScene(const QList<QLineF>&, const MappingFlags &flags = DefaultMapping) const;
+		void mapLogicalToScene(const QVector<QLineF>& lines, QVector<QLineF>& result, const MappingFlags& flags = DefaultMapping) const;
+		void mapLogicalToScene(int count, const double* x, const double* y, double* sceneX, double* sceneY,
+				char* visible, const MappingFlags& flags = DefaultMapping) const;
+		void mapLogicalXToScene(int count, const double* x, double* sceneX, char* visible) const;
 
 		virtual QList<QPointF> mapSceneToLogical(const QList<QPointF>&, const MappingFlags &flags = DefaultMapping) const;
 		virtual QPointF mapSceneToLogical(const QPointF&, const MappingFlags &flags = DefaultMapping) const;
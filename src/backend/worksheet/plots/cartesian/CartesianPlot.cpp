@@ -46,6 +46,7 @@
 #include "backend/worksheet/plots/PlotArea.h"
 #include "backend/worksheet/plots/AbstractPlotPrivate.h"
 #include "backend/worksheet/Worksheet.h"
+#include "backend/worksheet/WorksheetUpdateScheduler.h"
 #include "backend/worksheet/plots/cartesian/Axis.h"
 #include "backend/worksheet/TextLabel.h"
 #include "backend/lib/XmlStreamReader.h"
@@ -1108,6 +1109,7 @@ void CartesianPlot::childAdded(const AbstractAspect* child) {
 		connect(curve, SIGNAL(dataChanged()), this, SLOT(dataChanged()));
 		connect(curve, SIGNAL(xDataChanged()), this, SLOT(xDataChanged()));
 		connect(curve, SIGNAL(yDataChanged()), this, SLOT(yDataChanged()));
+		connect(curve, SIGNAL(dataAppended()), this, SLOT(dataAppended()));
 		connect(curve, SIGNAL(visibilityChanged(bool)), this, SLOT(curveVisibilityChanged()));
 
 		//update the legend on changes of the name, line and symbol styles
@@ -1158,6 +1160,7 @@ void CartesianPlot::updateLegend() {
 /*!
 	called when in one of the curves the data was changed.
 	Autoscales the coordinate system and the x-axes, when "auto-scale" is active.
+	If the plot is part of a worksheet, this is done in the next update pass of the worksheet.
 */
 void CartesianPlot::dataChanged() {
 	Q_D(CartesianPlot);
@@ -1165,12 +1168,16 @@ void CartesianPlot::dataChanged() {
 	Q_ASSERT(curve);
 	d->curvesXMinMaxIsDirty = true;
 	d->curvesYMinMaxIsDirty = true;
-	if (d->autoScaleX && d->autoScaleY)
-		this->scaleAuto();
-	else if (d->autoScaleX)
-		this->scaleAutoX();
-	else if (d->autoScaleY)
-		this->scaleAutoY();
+
+	const WorksheetUpdateScheduler::DirtyFlags flags = WorksheetUpdateScheduler::XDataDirty | WorksheetUpdateScheduler::YDataDirty;
+	WorksheetUpdateScheduler* scheduler = updateScheduler();
+	if (scheduler) {
+		if (d->autoScaleX || d->autoScaleY)
+			scheduler->invalidate(this, flags);
+		else
+			scheduler->invalidate(curve, flags);
+	} else if (d->autoScaleX || d->autoScaleY)
+		updateAutoScale(true, true);
 	else
 		curve->retransform();
 }
@@ -1187,7 +1194,14 @@ void CartesianPlot::xDataChanged() {
 	XYCurve* curve = dynamic_cast<XYCurve*>(QObject::sender());
 	Q_ASSERT(curve);
 	d->curvesXMinMaxIsDirty = true;
-	if (d->autoScaleX)
+
+	WorksheetUpdateScheduler* scheduler = updateScheduler();
+	if (scheduler) {
+		if (d->autoScaleX)
+			scheduler->invalidate(this, WorksheetUpdateScheduler::XDataDirty);
+		else
+			scheduler->invalidate(curve, WorksheetUpdateScheduler::XDataDirty);
+	} else if (d->autoScaleX)
 		this->scaleAutoX();
 	else
 		curve->retransform();
@@ -1205,22 +1219,64 @@ void CartesianPlot::yDataChanged() {
 	XYCurve* curve = dynamic_cast<XYCurve*>(QObject::sender());
 	Q_ASSERT(curve);
 	d->curvesYMinMaxIsDirty = true;
-	if (d->autoScaleY)
+
+	WorksheetUpdateScheduler* scheduler = updateScheduler();
+	if (scheduler) {
+		if (d->autoScaleY)
+			scheduler->invalidate(this, WorksheetUpdateScheduler::YDataDirty);
+		else
+			scheduler->invalidate(curve, WorksheetUpdateScheduler::YDataDirty);
+	} else if (d->autoScaleY)
 		this->scaleAutoY();
 	else
 		curve->retransform();
 }
 
+/*!
+	called when rows were appended to the data of one of the curves.
+	The curve has already processed the new rows, the plot is only autoscaled if required.
+*/
+void CartesianPlot::dataAppended() {
+	if (project()->isLoading())
+		return;
+
+	Q_D(CartesianPlot);
+	d->curvesXMinMaxIsDirty = true;
+	d->curvesYMinMaxIsDirty = true;
+
+	WorksheetUpdateScheduler* scheduler = updateScheduler();
+	if (scheduler)
+		scheduler->invalidate(this, WorksheetUpdateScheduler::XDataDirty | WorksheetUpdateScheduler::YDataDirty);
+	else
+		updateAutoScale(true, true);
+}
+
 void CartesianPlot::curveVisibilityChanged() {
 	Q_D(CartesianPlot);
 	d->curvesXMinMaxIsDirty = true;
 	d->curvesYMinMaxIsDirty = true;
 	updateLegend();
-	if (d->autoScaleX && d->autoScaleY)
+
+	WorksheetUpdateScheduler* scheduler = updateScheduler();
+	if (scheduler)
+		scheduler->invalidate(this, WorksheetUpdateScheduler::XDataDirty | WorksheetUpdateScheduler::YDataDirty);
+	else
+		updateAutoScale(true, true);
+}
+
+/*!
+	autoscales the plot after the data of the curves was changed in x-direction (\c x)
+	and/or in y-direction (\c y). Only the directions with active "auto-scale" are rescaled.
+*/
+void CartesianPlot::updateAutoScale(bool x, bool y) {
+	Q_D(CartesianPlot);
+	x = x && d->autoScaleX;
+	y = y && d->autoScaleY;
+	if (x && y)
 		this->scaleAuto();
-	else if (d->autoScaleX)
+	else if (x)
 		this->scaleAutoX();
-	else if (d->autoScaleY)
+	else if (y)
 		this->scaleAutoY();
 }
 
@@ -94,6 +94,7 @@ class CartesianPlot:public AbstractPlot{
 		virtual bool load(XmlStreamReader*);
 		virtual void loadThemeConfig(const KConfig&);
 		void saveTheme(KConfig& config);
+		void updateAutoScale(bool x, bool y);
 
 		BASIC_D_ACCESSOR_DECL(bool, autoScaleX, AutoScaleX)
 		BASIC_D_ACCESSOR_DECL(bool, autoScaleY, AutoScaleY)
@@ -226,6 +227,7 @@ class CartesianPlot:public AbstractPlot{
 		void dataChanged();
 		void xDataChanged();
 		void yDataChanged();
+		void dataAppended();
 		void curveVisibilityChanged();
 
 		//SLOTs for changes triggered via QActions in the context menu
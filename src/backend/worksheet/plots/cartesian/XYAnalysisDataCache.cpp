@@ -0,0 +1,201 @@
+/***************************************************************************
+    File                 : XYAnalysisDataCache.cpp
+    Project              : LabPlot
+    Description          : Cache of the valid source data of the analysis curves
+    --------------------------------------------------------------------
+    Copyright            : (C) 2017 LabPlot developers
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "XYAnalysisDataCache.h"
+#include "backend/core/AbstractColumn.h"
+#include "backend/lib/macros.h"
+
+//maximal size in bytes of the data kept in the cache
+static const qint64 maxBytes = 64*1024*1024;
+
+Q_GLOBAL_STATIC(XYAnalysisDataCache, analysisDataCache)
+
+/*!
+	\class XYAnalysisDataCache
+	\brief Cache of the valid source data of the analysis curves.
+
+	The analysis curves only process the rows of their source columns where x and y are valid,
+	not masked and x lies in the range of the analysis. validData() compacts these rows
+	into one x- and one y-vector which are kept for the last used (x column, y column, x range)
+	combinations, so several analysis curves of the same source share the data.
+	The vectors are implicitly shared with the jobs, jobs modifying the data in place detach from the cache.
+	An entry is only kept as long as a job still holds its vectors (see release()) and the size of all entries
+	is limited to \c maxBytes. The entries of a column are dropped when its data or masking changes or the column is deleted.
+
+	\ingroup worksheet
+*/
+XYAnalysisDataCache::XYAnalysisDataCache() : m_bytes(0) {
+}
+
+XYAnalysisDataCache* XYAnalysisDataCache::instance() {
+	return analysisDataCache();
+}
+
+/*!
+	returns in \c xdata and \c ydata the values in all rows where the values of \c xColumn and \c yColumn
+	are valid and not masked and the x-value lies in the interval [\c xmin, \c xmax].
+*/
+void XYAnalysisDataCache::validData(const AbstractColumn* xColumn, const AbstractColumn* yColumn, double xmin, double xmax,
+		QVector<double>& xdata, QVector<double>& ydata) {
+	for (int i = 0; i < m_entries.size(); ++i) {
+		const Entry& entry = m_entries.at(i);
+		if (entry.xColumn == xColumn && entry.yColumn == yColumn && entry.xmin == xmin && entry.xmax == xmax) {
+			xdata = entry.xdata;
+			ydata = entry.ydata;
+			m_entries.move(i, 0);
+			DEBUG("XYAnalysisDataCache: reusing" << xdata.size() << "points");
+			return;
+		}
+	}
+
+	read(xColumn, yColumn, xmin, xmax, xdata, ydata);
+
+	const qint64 bytes = size(xdata, ydata);
+	if (bytes > maxBytes)
+		return;
+
+	Entry entry;
+	entry.xColumn = xColumn;
+	entry.yColumn = yColumn;
+	entry.xmin = xmin;
+	entry.xmax = xmax;
+	entry.xdata = xdata;
+	entry.ydata = ydata;
+	m_entries.prepend(entry);
+	m_bytes += bytes;
+
+	//drop the least recently used entries
+	while (m_bytes > maxBytes) {
+		const Entry& last = m_entries.last();
+		m_bytes -= size(last.xdata, last.ydata);
+		m_entries.removeLast();
+	}
+
+	watch(xColumn);
+	watch(yColumn);
+}
+
+/*!
+	removes all entries from the cache.
+*/
+void XYAnalysisDataCache::clear() {
+	m_entries.clear();
+	m_bytes = 0;
+
+	foreach (const AbstractColumn* column, m_watchedColumns)
+		disconnect(column, 0, this, 0);
+	m_watchedColumns.clear();
+}
+
+/*!
+	removes the entries whose vectors are not used by any job anymore, called when a job is deleted.
+*/
+void XYAnalysisDataCache::release() {
+	for (int i = m_entries.size() - 1; i >= 0; --i) {
+		const Entry& entry = m_entries.at(i);
+		if (entry.xdata.isEmpty() || entry.xdata.isDetached() || entry.ydata.isDetached()) {
+			m_bytes -= size(entry.xdata, entry.ydata);
+			m_entries.removeAt(i);
+		}
+	}
+}
+
+qint64 XYAnalysisDataCache::size(const QVector<double>& xdata, const QVector<double>& ydata) {
+	return (qint64)(xdata.capacity() + ydata.capacity())*sizeof(double);
+}
+
+void XYAnalysisDataCache::watch(const AbstractColumn* column) {
+	if (m_watchedColumns.contains(column))
+		return;
+
+	m_watchedColumns.insert(column);
+	connect(column, SIGNAL(dataChanged(const AbstractColumn*)), this, SLOT(columnChanged(const AbstractColumn*)));
+	connect(column, SIGNAL(maskingChanged(const AbstractColumn*)), this, SLOT(columnChanged(const AbstractColumn*)));
+	connect(column, SIGNAL(modeChanged(const AbstractColumn*)), this, SLOT(columnChanged(const AbstractColumn*)));
+	connect(column, SIGNAL(rowsInserted(const AbstractColumn*,int,int)), this, SLOT(columnChanged(const AbstractColumn*)));
+	connect(column, SIGNAL(rowsRemoved(const AbstractColumn*,int,int)), this, SLOT(columnChanged(const AbstractColumn*)));
+	connect(column, SIGNAL(aboutToBeDestroyed(const AbstractColumn*)), this, SLOT(columnChanged(const AbstractColumn*)));
+}
+
+void XYAnalysisDataCache::columnChanged(const AbstractColumn* column) {
+	for (int i = m_entries.size() - 1; i >= 0; --i) {
+		const Entry& entry = m_entries.at(i);
+		if (entry.xColumn == column || entry.yColumn == column) {
+			m_bytes -= size(entry.xdata, entry.ydata);
+			m_entries.removeAt(i);
+		}
+	}
+
+	//the column is watched again when it is used the next time
+	disconnect(column, 0, this, 0);
+	m_watchedColumns.remove(column);
+}
+
+/*!
+	compacts the valid rows spanwise, the masked rows are skipped blockwise.
+*/
+void XYAnalysisDataCache::read(const AbstractColumn* xColumn, const AbstractColumn* yColumn, double xmin, double xmax,
+		QVector<double>& xdata, QVector<double>& ydata) {
+	const int rows = qMin(xColumn->rowCount(), yColumn->rowCount());
+	const Interval<int> range(0, rows - 1);
+	const QList< Interval<int> > intervals = Interval<int>::intersectionOfLists(xColumn->unmaskedIntervals(range),
+			yColumn->unmaskedIntervals(range));
+
+	int size = 0;
+	foreach (const Interval<int>& interval, intervals)
+		size += interval.size();
+	xdata.resize(size);
+	ydata.resize(size);
+	double* x = xdata.data();
+	double* y = ydata.data();
+
+	int n = 0;
+	foreach (const Interval<int>& interval, intervals) {
+		AbstractColumn::SpanReader xReader(xColumn, interval.start(), interval.end());
+		AbstractColumn::SpanReader yReader(yColumn, interval.start(), interval.end());
+		while (xReader.next() && yReader.next()) {
+			const double* xValues = xReader.values();
+			const double* yValues = yReader.values();
+			for (int i = 0; i < xReader.count(); ++i) {
+				//NaNs fail the range check
+				if (xValues[i] >= xmin && xValues[i] <= xmax && !std::isnan(yValues[i])) {
+					x[n] = xValues[i];
+					y[n] = yValues[i];
+					++n;
+				}
+			}
+		}
+	}
+
+	xdata.resize(n);
+	ydata.resize(n);
+	if (n < size/2) {
+		xdata.squeeze();
+		ydata.squeeze();
+	}
+}
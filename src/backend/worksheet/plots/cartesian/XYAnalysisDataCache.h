@@ -0,0 +1,73 @@
+/***************************************************************************
+    File                 : XYAnalysisDataCache.h
+    Project              : LabPlot
+    Description          : Cache of the valid source data of the analysis curves
+    --------------------------------------------------------------------
+    Copyright            : (C) 2017 LabPlot developers
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+#ifndef XYANALYSISDATACACHE_H
+#define XYANALYSISDATACACHE_H
+
+#include <QObject>
+#include <QVector>
+#include <QList>
+#include <QSet>
+
+class AbstractColumn;
+
+class XYAnalysisDataCache : public QObject {
+	Q_OBJECT
+
+	public:
+		XYAnalysisDataCache();
+		static XYAnalysisDataCache* instance();
+
+		void validData(const AbstractColumn* xColumn, const AbstractColumn* yColumn, double xmin, double xmax,
+				QVector<double>& xdata, QVector<double>& ydata);
+		void clear();
+		void release();
+
+	private slots:
+		void columnChanged(const AbstractColumn*);
+
+	private:
+		struct Entry {
+			const AbstractColumn* xColumn;
+			const AbstractColumn* yColumn;
+			double xmin;
+			double xmax;
+			QVector<double> xdata;
+			QVector<double> ydata;
+		};
+
+		void watch(const AbstractColumn*);
+		static qint64 size(const QVector<double>& xdata, const QVector<double>& ydata);
+		static void read(const AbstractColumn* xColumn, const AbstractColumn* yColumn, double xmin, double xmax,
+				QVector<double>& xdata, QVector<double>& ydata);
+
+		QList<Entry> m_entries;	//the most recently used entry first
+		QSet<const AbstractColumn*> m_watchedColumns;
+		qint64 m_bytes;	//size of the data of all entries
+};
+
+#endif
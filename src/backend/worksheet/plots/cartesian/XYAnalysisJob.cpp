@@ -0,0 +1,170 @@
+/***************************************************************************
+    File                 : XYAnalysisJob.cpp
+    Project              : LabPlot
+    Description          : Background calculation of the analysis curves
+    --------------------------------------------------------------------
+    Copyright            : (C) 2017 Alexander Semke (alexander.semke@web.de)
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "XYAnalysisJob.h"
+#include "XYAnalysisDataCache.h"
+#include <QThreadPool>
+
+//the nsl functions keep global state (FFT plans, padding values),
+//the jobs of all analysis curves are therefore executed one after the other in one worker thread
+class AnalysisThreadPool : public QThreadPool {
+public:
+	AnalysisThreadPool() {
+		setMaxThreadCount(1);
+	}
+};
+Q_GLOBAL_STATIC(AnalysisThreadPool, analysisThreadPool)
+
+/*!
+	\class XYAnalysisJob
+	\brief Calculation of an analysis curve running in a worker thread.
+
+	The analysis curves copy the source data and the settings into a job on the GUI thread
+	and start it with their XYAnalysisScheduler. compute() works on this snapshot only and runs in the
+	worker thread, publish() writes the result into the result columns of the curve and runs
+	in the GUI thread afterwards. Jobs that were canceled meanwhile are not published.
+
+	\ingroup worksheet
+*/
+XYAnalysisJob::XYAnalysisJob() : m_scheduler(0), m_id(0), m_canceled(0), m_elapsedTime(0) {
+	setAutoDelete(false);
+	m_timer.start();
+}
+
+XYAnalysisJob::~XYAnalysisJob() {
+	//the source data of the derived job is already released here
+	XYAnalysisDataCache* cache = XYAnalysisDataCache::instance();
+	if (cache)
+		cache->release();
+}
+
+void XYAnalysisJob::run() {
+	if (!isCanceled())
+		compute();
+	m_elapsedTime = m_timer.elapsed();
+
+	//notify the scheduler before releasing the job, the scheduler can be deleted afterwards
+	QMetaObject::invokeMethod(m_scheduler, "jobFinished", Qt::QueuedConnection, Q_ARG(quint64, m_id));
+	m_done.release();
+}
+
+/*!
+	returns \c true if a newer job was started for the curve. Long calculations should check this
+	regularly in compute() and stop if the result is not needed anymore.
+*/
+bool XYAnalysisJob::isCanceled() const {
+	return m_canceled.load() != 0;
+}
+
+/*!
+	notifies the curve about the progress (0 to 100) of the calculation, to be called in compute().
+*/
+void XYAnalysisJob::reportProgress(int value) const {
+	QMetaObject::invokeMethod(m_scheduler, "jobProgress", Qt::QueuedConnection, Q_ARG(quint64, m_id), Q_ARG(int, value));
+}
+
+/*!
+	returns the time in ms from the creation of the job (the copy of the source data) till the end of compute().
+*/
+qint64 XYAnalysisJob::elapsedTime() const {
+	return m_elapsedTime;
+}
+
+/*!
+	\class XYAnalysisScheduler
+	\brief Runs the jobs of one analysis curve, cancels the running job when a new one is started.
+
+	\ingroup worksheet
+*/
+XYAnalysisScheduler::XYAnalysisScheduler(QObject* parent) : QObject(parent), m_current(0), m_lastId(0) {
+}
+
+XYAnalysisScheduler::~XYAnalysisScheduler() {
+	cancel();
+	foreach (XYAnalysisJob* job, m_jobs) {
+		job->m_done.acquire();
+		delete job;
+	}
+}
+
+/*!
+	starts the calculation \c job in the worker thread. The scheduler takes the ownership of the job.
+	A previously started job that was not published yet is canceled.
+*/
+void XYAnalysisScheduler::start(XYAnalysisJob* job) {
+	cancel();
+
+	job->m_scheduler = this;
+	job->m_id = ++m_lastId;
+	m_jobs[job->m_id] = job;
+	m_current = job;
+	analysisThreadPool()->start(job);
+}
+
+void XYAnalysisScheduler::cancel() {
+	if (m_current) {
+		m_current->m_canceled.store(1);
+		m_current = 0;
+	}
+}
+
+/*!
+	returns \c true if a job was started and not published yet.
+*/
+bool XYAnalysisScheduler::isRunning() const {
+	return (m_current != 0);
+}
+
+/*!
+	waits for the current job to finish and publishes its result (e.g. before the curve is saved).
+*/
+void XYAnalysisScheduler::waitForDone() {
+	if (!m_current)
+		return;
+
+	m_current->m_done.acquire();
+	m_current->m_done.release();
+	jobFinished(m_current->m_id);
+}
+
+void XYAnalysisScheduler::jobFinished(quint64 id) {
+	XYAnalysisJob* job = m_jobs.take(id);
+	if (!job)
+		return;	//already published in waitForDone()
+
+	if (job == m_current) {
+		m_current = 0;
+		job->publish();
+	}
+	delete job;
+}
+
+void XYAnalysisScheduler::jobProgress(quint64 id, int value) {
+	if (m_current && m_current->m_id == id)
+		emit progress(value);
+}
@@ -0,0 +1,90 @@
+/***************************************************************************
+    File                 : XYAnalysisJob.h
+    Project              : LabPlot
+    Description          : Background calculation of the analysis curves
+    --------------------------------------------------------------------
+    Copyright            : (C) 2017 Alexander Semke (alexander.semke@web.de)
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef XYANALYSISJOB_H
+#define XYANALYSISJOB_H
+
+#include <QObject>
+#include <QRunnable>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QSemaphore>
+#include <QMap>
+
+class XYAnalysisScheduler;
+
+class XYAnalysisJob : public QRunnable {
+	public:
+		XYAnalysisJob();
+		virtual ~XYAnalysisJob();
+
+		void run();
+		bool isCanceled() const;
+
+	protected:
+		virtual void compute() = 0;
+		virtual void publish() = 0;
+		void reportProgress(int) const;
+		qint64 elapsedTime() const;
+
+	private:
+		friend class XYAnalysisScheduler;
+		XYAnalysisScheduler* m_scheduler;
+		quint64 m_id;
+		QAtomicInt m_canceled;
+		QSemaphore m_done;
+		QElapsedTimer m_timer;
+		qint64 m_elapsedTime;
+};
+
+class XYAnalysisScheduler : public QObject {
+	Q_OBJECT
+
+	public:
+		explicit XYAnalysisScheduler(QObject* parent = 0);
+		~XYAnalysisScheduler();
+
+		void start(XYAnalysisJob*);
+		void cancel();
+		bool isRunning() const;
+		void waitForDone();
+
+	signals:
+		void progress(int);
+
+	private slots:
+		void jobFinished(quint64 id);
+		void jobProgress(quint64 id, int value);
+
+	private:
+		QMap<quint64, XYAnalysisJob*> m_jobs;	//started jobs, deleted in jobFinished()
+		XYAnalysisJob* m_current;		//the last started job, the only one to be published
+		quint64 m_lastId;
+};
+
+#endif
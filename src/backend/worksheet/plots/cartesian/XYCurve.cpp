@@ -43,10 +43,13 @@
 #include "backend/core/Project.h"
 #include "backend/spreadsheet/Spreadsheet.h"
 #include "backend/worksheet/Worksheet.h"
+#include "backend/worksheet/WorksheetUpdateScheduler.h"
 #include "backend/lib/XmlStreamReader.h"
+#include "backend/lib/ScratchArena.h"
 #include "backend/lib/macros.h"
 
 #include <QPainter>
+#include <QPixmapCache>
 #include <QGraphicsSceneContextMenuEvent>
 #include <QMenu>
 // #include <QElapsedTimer>
@@ -57,6 +60,8 @@
 
 #include <cmath>
 #include <vector>
+#include <algorithm>
+#include <limits>
 extern "C" {
 #include <gsl/gsl_spline.h>
 #include <gsl/gsl_errno.h>
@@ -208,7 +213,14 @@ bool XYCurve::isVisible() const {
 
 void XYCurve::setPrinting(bool on) {
 	Q_D(XYCurve);
+	if (d->m_printing == on)
+		return;
+
 	d->m_printing = on;
+
+	//the line is decimated for the screen only
+	if (d->lineType == XYCurve::Line)
+		d->updateLines();
 }
 
 //##############################################################################
@@ -351,10 +363,9 @@ void XYCurve::setXColumn(const AbstractColumn* column) {
 		//emit xDataChanged() in order to notify the plot about the changes
 		emit xDataChanged();
 		if (column) {
-			connect(column, SIGNAL(dataChanged(const AbstractColumn*)), this, SIGNAL(xDataChanged()));
-
-			//update the curve itself on changes
-			connect(column, SIGNAL(dataChanged(const AbstractColumn*)), this, SLOT(retransform()));
+			//update the curve itself and notify the plot on changes
+			connect(column, SIGNAL(dataChanged(const AbstractColumn*)), this, SLOT(xColumnDataChanged()));
+			connect(column, SIGNAL(rowsInserted(const AbstractColumn*,int,int)), this, SLOT(handleRowsInserted(const AbstractColumn*,int,int)));
 			connect(column->parentAspect(), SIGNAL(aspectAboutToBeRemoved(const AbstractAspect*)),
 					this, SLOT(xColumnAboutToBeRemoved(const AbstractAspect*)));
 			//TODO: add disconnect in the undo-function
@@ -371,10 +382,9 @@ void XYCurve::setYColumn(const AbstractColumn* column) {
 		//emit yDataChanged() in order to notify the plot about the changes
 		emit yDataChanged();
 		if (column) {
-			connect(column, SIGNAL(dataChanged(const AbstractColumn*)), this, SIGNAL(yDataChanged()));
-
-			//update the curve itself on changes
-			connect(column, SIGNAL(dataChanged(const AbstractColumn*)), this, SLOT(retransform()));
+			//update the curve itself and notify the plot on changes
+			connect(column, SIGNAL(dataChanged(const AbstractColumn*)), this, SLOT(yColumnDataChanged()));
+			connect(column, SIGNAL(rowsInserted(const AbstractColumn*,int,int)), this, SLOT(handleRowsInserted(const AbstractColumn*,int,int)));
 			connect(column->parentAspect(), SIGNAL(aspectAboutToBeRemoved(const AbstractAspect*)),
 					this, SLOT(yColumnAboutToBeRemoved(const AbstractAspect*)));
 			//TODO: add disconnect in the undo-function
@@ -404,14 +414,14 @@ void XYCurve::setLineInterpolationPointsCount(int count) {
 		exec(new XYCurveSetLineInterpolationPointsCountCmd(d, count, i18n("%1: set the number of interpolation points")));
 }
 
-STD_SETTER_CMD_IMPL_F_S(XYCurve, SetLinePen, QPen, linePen, recalcShapeAndBoundingRect)
+STD_SETTER_CMD_IMPL_F_S(XYCurve, SetLinePen, QPen, linePen, recalcLineShape)
 void XYCurve::setLinePen(const QPen &pen) {
 	Q_D(XYCurve);
 	if (pen != d->linePen)
 		exec(new XYCurveSetLinePenCmd(d, pen, i18n("%1: set line style")));
 }
 
-STD_SETTER_CMD_IMPL_F_S(XYCurve, SetLineOpacity, qreal, lineOpacity, updatePixmap);
+STD_SETTER_CMD_IMPL_F_S(XYCurve, SetLineOpacity, qreal, lineOpacity, updateLinePixmap);
 void XYCurve::setLineOpacity(qreal opacity) {
 	Q_D(XYCurve);
 	if (opacity != d->lineOpacity)
@@ -426,14 +436,14 @@ void XYCurve::setDropLineType(DropLineType type) {
 		exec(new XYCurveSetDropLineTypeCmd(d, type, i18n("%1: drop line type changed")));
 }
 
-STD_SETTER_CMD_IMPL_F_S(XYCurve, SetDropLinePen, QPen, dropLinePen, recalcShapeAndBoundingRect)
+STD_SETTER_CMD_IMPL_F_S(XYCurve, SetDropLinePen, QPen, dropLinePen, recalcLineShape)
 void XYCurve::setDropLinePen(const QPen &pen) {
 	Q_D(XYCurve);
 	if (pen != d->dropLinePen)
 		exec(new XYCurveSetDropLinePenCmd(d, pen, i18n("%1: set drop line style")));
 }
 
-STD_SETTER_CMD_IMPL_F_S(XYCurve, SetDropLineOpacity, qreal, dropLineOpacity, updatePixmap)
+STD_SETTER_CMD_IMPL_F_S(XYCurve, SetDropLineOpacity, qreal, dropLineOpacity, updateLinePixmap)
 void XYCurve::setDropLineOpacity(qreal opacity) {
 	Q_D(XYCurve);
 	if (opacity != d->dropLineOpacity)
@@ -462,7 +472,7 @@ void XYCurve::setSymbolsRotationAngle(qreal angle) {
 		exec(new XYCurveSetSymbolsRotationAngleCmd(d, angle, i18n("%1: rotate symbols")));
 }
 
-STD_SETTER_CMD_IMPL_F_S(XYCurve, SetSymbolsBrush, QBrush, symbolsBrush, updatePixmap)
+STD_SETTER_CMD_IMPL_F_S(XYCurve, SetSymbolsBrush, QBrush, symbolsBrush, updateSymbolsPixmap)
 void XYCurve::setSymbolsBrush(const QBrush &brush) {
 	Q_D(XYCurve);
 	if (brush != d->symbolsBrush)
@@ -476,7 +486,7 @@ void XYCurve::setSymbolsPen(const QPen &pen) {
 		exec(new XYCurveSetSymbolsPenCmd(d, pen, i18n("%1: set symbol outline style")));
 }
 
-STD_SETTER_CMD_IMPL_F_S(XYCurve, SetSymbolsOpacity, qreal, symbolsOpacity, updatePixmap)
+STD_SETTER_CMD_IMPL_F_S(XYCurve, SetSymbolsOpacity, qreal, symbolsOpacity, updateSymbolsPixmap)
 void XYCurve::setSymbolsOpacity(qreal opacity) {
 	Q_D(XYCurve);
 	if (opacity != d->symbolsOpacity)
@@ -525,7 +535,7 @@ void XYCurve::setValuesRotationAngle(qreal angle) {
 		exec(new XYCurveSetValuesRotationAngleCmd(d, angle, i18n("%1: rotate values")));
 }
 
-STD_SETTER_CMD_IMPL_F_S(XYCurve, SetValuesOpacity, qreal, valuesOpacity, updatePixmap)
+STD_SETTER_CMD_IMPL_F_S(XYCurve, SetValuesOpacity, qreal, valuesOpacity, updateValuesPixmap)
 void XYCurve::setValuesOpacity(qreal opacity) {
 	Q_D(XYCurve);
 	if (opacity != d->valuesOpacity)
@@ -555,7 +565,7 @@ void XYCurve::setValuesFont(const QFont& font) {
 		exec(new XYCurveSetValuesFontCmd(d, font, i18n("%1: set values font")));
 }
 
-STD_SETTER_CMD_IMPL_F_S(XYCurve, SetValuesColor, QColor, valuesColor, updatePixmap)
+STD_SETTER_CMD_IMPL_F_S(XYCurve, SetValuesColor, QColor, valuesColor, updateValuesPixmap)
 void XYCurve::setValuesColor(const QColor& color) {
 	Q_D(XYCurve);
 	if (color != d->valuesColor)
@@ -570,56 +580,56 @@ void XYCurve::setFillingPosition(FillingPosition position) {
 		exec(new XYCurveSetFillingPositionCmd(d, position, i18n("%1: filling position changed")));
 }
 
-STD_SETTER_CMD_IMPL_F_S(XYCurve, SetFillingType, PlotArea::BackgroundType, fillingType, updatePixmap)
+STD_SETTER_CMD_IMPL_F_S(XYCurve, SetFillingType, PlotArea::BackgroundType, fillingType, updateFillingPixmap)
 void XYCurve::setFillingType(PlotArea::BackgroundType type) {
 	Q_D(XYCurve);
 	if (type != d->fillingType)
 		exec(new XYCurveSetFillingTypeCmd(d, type, i18n("%1: filling type changed")));
 }
 
-STD_SETTER_CMD_IMPL_F_S(XYCurve, SetFillingColorStyle, PlotArea::BackgroundColorStyle, fillingColorStyle, updatePixmap)
+STD_SETTER_CMD_IMPL_F_S(XYCurve, SetFillingColorStyle, PlotArea::BackgroundColorStyle, fillingColorStyle, updateFillingPixmap)
 void XYCurve::setFillingColorStyle(PlotArea::BackgroundColorStyle style) {
 	Q_D(XYCurve);
 	if (style != d->fillingColorStyle)
 		exec(new XYCurveSetFillingColorStyleCmd(d, style, i18n("%1: filling color style changed")));
 }
 
-STD_SETTER_CMD_IMPL_F_S(XYCurve, SetFillingImageStyle, PlotArea::BackgroundImageStyle, fillingImageStyle, updatePixmap)
+STD_SETTER_CMD_IMPL_F_S(XYCurve, SetFillingImageStyle, PlotArea::BackgroundImageStyle, fillingImageStyle, updateFillingPixmap)
 void XYCurve::setFillingImageStyle(PlotArea::BackgroundImageStyle style) {
 	Q_D(XYCurve);
 	if (style != d->fillingImageStyle)
 		exec(new XYCurveSetFillingImageStyleCmd(d, style, i18n("%1: filling image style changed")));
 }
 
-STD_SETTER_CMD_IMPL_F_S(XYCurve, SetFillingBrushStyle, Qt::BrushStyle, fillingBrushStyle, updatePixmap)
+STD_SETTER_CMD_IMPL_F_S(XYCurve, SetFillingBrushStyle, Qt::BrushStyle, fillingBrushStyle, updateFillingPixmap)
 void XYCurve::setFillingBrushStyle(Qt::BrushStyle style) {
 	Q_D(XYCurve);
 	if (style != d->fillingBrushStyle)
 		exec(new XYCurveSetFillingBrushStyleCmd(d, style, i18n("%1: filling brush style changed")));
 }
 
-STD_SETTER_CMD_IMPL_F_S(XYCurve, SetFillingFirstColor, QColor, fillingFirstColor, updatePixmap)
+STD_SETTER_CMD_IMPL_F_S(XYCurve, SetFillingFirstColor, QColor, fillingFirstColor, updateFillingPixmap)
 void XYCurve::setFillingFirstColor(const QColor& color) {
 	Q_D(XYCurve);
 	if (color != d->fillingFirstColor)
 		exec(new XYCurveSetFillingFirstColorCmd(d, color, i18n("%1: set filling first color")));
 }
 
-STD_SETTER_CMD_IMPL_F_S(XYCurve, SetFillingSecondColor, QColor, fillingSecondColor, updatePixmap)
+STD_SETTER_CMD_IMPL_F_S(XYCurve, SetFillingSecondColor, QColor, fillingSecondColor, updateFillingPixmap)
 void XYCurve::setFillingSecondColor(const QColor& color) {
 	Q_D(XYCurve);
 	if (color != d->fillingSecondColor)
 		exec(new XYCurveSetFillingSecondColorCmd(d, color, i18n("%1: set filling second color")));
 }
 
-STD_SETTER_CMD_IMPL_F_S(XYCurve, SetFillingFileName, QString, fillingFileName, updatePixmap)
+STD_SETTER_CMD_IMPL_F_S(XYCurve, SetFillingFileName, QString, fillingFileName, updateFillingPixmap)
 void XYCurve::setFillingFileName(const QString& fileName) {
 	Q_D(XYCurve);
 	if (fileName != d->fillingFileName)
 		exec(new XYCurveSetFillingFileNameCmd(d, fileName, i18n("%1: set filling image")));
 }
 
-STD_SETTER_CMD_IMPL_F_S(XYCurve, SetFillingOpacity, qreal, fillingOpacity, updatePixmap)
+STD_SETTER_CMD_IMPL_F_S(XYCurve, SetFillingOpacity, qreal, fillingOpacity, updateFillingPixmap)
 void XYCurve::setFillingOpacity(qreal opacity) {
 	Q_D(XYCurve);
 	if (opacity != d->fillingOpacity)
@@ -707,14 +717,14 @@ void XYCurve::setErrorBarsType(ErrorBarsType type) {
 		exec(new XYCurveSetErrorBarsTypeCmd(d, type, i18n("%1: error bar type changed")));
 }
 
-STD_SETTER_CMD_IMPL_F_S(XYCurve, SetErrorBarsPen, QPen, errorBarsPen, recalcShapeAndBoundingRect)
+STD_SETTER_CMD_IMPL_F_S(XYCurve, SetErrorBarsPen, QPen, errorBarsPen, recalcErrorBarsShape)
 void XYCurve::setErrorBarsPen(const QPen& pen) {
 	Q_D(XYCurve);
 	if (pen != d->errorBarsPen)
 		exec(new XYCurveSetErrorBarsPenCmd(d, pen, i18n("%1: set error bar style")));
 }
 
-STD_SETTER_CMD_IMPL_F_S(XYCurve, SetErrorBarsOpacity, qreal, errorBarsOpacity, updatePixmap)
+STD_SETTER_CMD_IMPL_F_S(XYCurve, SetErrorBarsOpacity, qreal, errorBarsOpacity, updateErrorBarsPixmap)
 void XYCurve::setErrorBarsOpacity(qreal opacity) {
 	Q_D(XYCurve);
 	if (opacity != d->errorBarsOpacity)
@@ -733,12 +743,56 @@ void XYCurve::retransform() {
 	DEBUG("XYCurve::retransform()");
 	Q_D(XYCurve);
 
+	//the curve is retransformed once at the end of the current update pass of the worksheet
+	WorksheetUpdateScheduler* scheduler = updateScheduler();
+	if (scheduler && scheduler->deferRetransform(this))
+		return;
+
 	WAIT_CURSOR;
 	QApplication::processEvents(QEventLoop::AllEvents, 0);
 	d->retransform();
 	RESET_CURSOR;
 }
 
+/*!
+	called when rows were inserted into the x- or y-column. If the rows were appended
+	(e.g. by a followed file data source), only the new rows are processed.
+*/
+void XYCurve::handleRowsInserted(const AbstractColumn* column, int before, int count) {
+	Q_D(XYCurve);
+	if (before != column->rowCount() - count) {
+		retransform();
+		return;
+	}
+
+	d->retransformAppendedRows();
+	emit dataAppended();
+}
+
+/*!
+	called when the data in the x-column was changed. The curve is retransformed in the next update pass
+	of the worksheet, so several changes of the columns cause only one retransform.
+*/
+void XYCurve::xColumnDataChanged() {
+	WorksheetUpdateScheduler* scheduler = updateScheduler();
+	if (scheduler)
+		scheduler->invalidate(this, WorksheetUpdateScheduler::XDataDirty);
+	else
+		retransform();
+
+	emit xDataChanged();
+}
+
+void XYCurve::yColumnDataChanged() {
+	WorksheetUpdateScheduler* scheduler = updateScheduler();
+	if (scheduler)
+		scheduler->invalidate(this, WorksheetUpdateScheduler::YDataDirty);
+	else
+		retransform();
+
+	emit yDataChanged();
+}
+
 void XYCurve::updateValues() {
 	Q_D(XYCurve);
 	d->updateValues();
@@ -849,12 +903,17 @@ void XYCurve::navigateTo() {
 //######################### Private implementation #############################
 //##############################################################################
 XYCurvePrivate::XYCurvePrivate(XYCurve *owner) : m_printing(false), m_hovered(false), m_suppressRecalc(false),
-	m_suppressRetransform(false), m_hoverEffectImageIsDirty(false), m_selectionEffectImageIsDirty(false),
-	sourceDataChangedSinceLastRecalc(false), q(owner) {
+	m_suppressRetransform(false), m_processedRows(0), m_dirtyLayers(AllLayers), m_layersSize(0), m_effectScale(0),
+	sourceDataChangedSinceLastRecalc(false), symbolsGridCellSize(1), symbolsGridColumns(0), symbolsGridRows(0), q(owner) {
 	setFlag(QGraphicsItem::ItemIsSelectable, true);
 	setAcceptHoverEvents(true);
 }
 
+XYCurvePrivate::~XYCurvePrivate() {
+	if (m_layerCache)
+		m_layerCache->remove(this);
+}
+
 QString XYCurvePrivate::name() const {
 	return q->name();
 }
@@ -870,6 +929,50 @@ QPainterPath XYCurvePrivate::shape() const {
 	return curveShape;
 }
 
+/*!
+  Reimplementation of QGraphicsItem::contains(). The symbols are not part of the shape,
+  the symbols around \c point are determined via the grid of the symbol positions.
+*/
+bool XYCurvePrivate::contains(const QPointF& point) const {
+	if (curveShape.contains(point))
+		return true;
+
+	if (symbolsStyle == Symbol::NoSymbols)
+		return false;
+
+	const QRectF symbolRect = symbolPath.boundingRect();
+	const QRectF rect(point.x() - symbolRect.right(), point.y() - symbolRect.bottom(), symbolRect.width(), symbolRect.height());
+	foreach (int index, symbolsInRect(rect)) {
+		if (symbolPath.contains(point - symbolPointsScene.at(index)))
+			return true;
+	}
+
+	return false;
+}
+
+/*!
+  Reimplementation of QGraphicsItem::collidesWithPath() taking the symbols into account, \sa contains().
+*/
+bool XYCurvePrivate::collidesWithPath(const QPainterPath& path, Qt::ItemSelectionMode mode) const {
+	if (symbolsStyle == Symbol::NoSymbols || symbolsGridCellStart.isEmpty())
+		return QGraphicsItem::collidesWithPath(path, mode);
+
+	if (mode == Qt::ContainsItemShape || mode == Qt::ContainsItemBoundingRect)
+		return path.contains(boundingRectangle);
+
+	if (QGraphicsItem::collidesWithPath(path, mode))
+		return true;
+
+	const QRectF symbolRect = symbolPath.boundingRect();
+	const QRectF rect = path.boundingRect().adjusted(-symbolRect.right(), -symbolRect.bottom(), -symbolRect.left(), -symbolRect.top());
+	foreach (int index, symbolsInRect(rect)) {
+		if (path.intersects(symbolPath.translated(symbolPointsScene.at(index))))
+			return true;
+	}
+
+	return false;
+}
+
 void XYCurvePrivate::contextMenuEvent(QGraphicsSceneContextMenuEvent* event) {
 	q->createContextMenu()->exec(event->screenPos());
 }
@@ -893,71 +996,67 @@ void XYCurvePrivate::retransform() {
 	symbolPointsLogical.clear();
 	symbolPointsScene.clear();
 	connectedPointsLogical.clear();
+	visiblePoints.clear();
+	m_processedRows = 0;
 
 	if ( (NULL == xColumn) || (NULL == yColumn) ) {
 		linePath = QPainterPath();
 		dropLinePath = QPainterPath();
-		symbolsPath = QPainterPath();
+		symbolPath = QPainterPath();
+		symbolsBoundingRect = QRectF();
+		symbolsGridCellStart.clear();
+		symbolsGridPoints.clear();
 		valuesPath = QPainterPath();
 		errorBarsPath = QPainterPath();
 		recalcShapeAndBoundingRect();
 		return;
 	}
 
-	int startRow = 0;
-	int endRow = xColumn->rowCount() - 1;
-	QPointF tempPoint;
+	//the scene coordinates are calculated together with the logical points
+	const AbstractPlot* plot = dynamic_cast<const AbstractPlot*>(q->parentAspect());
+	const CartesianCoordinateSystem *cSystem = plot ? dynamic_cast<const CartesianCoordinateSystem*>(plot->coordinateSystem()) : 0;
+	Q_ASSERT(!plot || cSystem);
 
-	AbstractColumn::ColumnMode xColMode = xColumn->columnMode();
-	AbstractColumn::ColumnMode yColMode = yColumn->columnMode();
+	m_processedRows = qMin(xColumn->rowCount(), yColumn->rowCount());
+	appendPoints(0, m_processedRows - 1, cSystem);
+	if (!plot)
+		return;
 
-	//take over only valid and non masked points.
-	for (int row = startRow; row <= endRow; row++) {
-		if ( xColumn->isValid(row) && yColumn->isValid(row)
-				&& (!xColumn->isMasked(row)) && (!yColumn->isMasked(row)) ) {
+	m_suppressRecalc = true;
+	updateLines();
+	updateDropLines();
+	updateSymbols();
+	updateValues();
+	m_suppressRecalc = false;
+	updateErrorBars();
+}
 
-			switch (xColMode) {
-			case AbstractColumn::Numeric:
-				tempPoint.setX(xColumn->valueAt(row));
-				break;
-			case AbstractColumn::Text:
-			//TODO
-			case AbstractColumn::DateTime:
-			case AbstractColumn::Month:
-			case AbstractColumn::Day:
-				//TODO
-				break;
-			}
+/*!
+  takes over the rows appended to the data columns since the last call of retransform().
+  Only the coordinates of the new points are determined, the available points are kept.
+*/
+void XYCurvePrivate::retransformAppendedRows() {
+	if (m_suppressRetransform || (NULL == xColumn) || (NULL == yColumn))
+		return;
 
-			switch (yColMode) {
-			case AbstractColumn::Numeric:
-				tempPoint.setY(yColumn->valueAt(row));
-				break;
-			case AbstractColumn::Text:
-			//TODO
-			case AbstractColumn::DateTime:
-			case AbstractColumn::Month:
-			case AbstractColumn::Day:
-				//TODO
-				break;
-			}
-			symbolPointsLogical.append(tempPoint);
-			connectedPointsLogical.push_back(true);
-		} else {
-			if (!connectedPointsLogical.empty())
-				connectedPointsLogical[connectedPointsLogical.size()-1] = false;
-		}
-	}
+	const int endRow = qMin(xColumn->rowCount(), yColumn->rowCount()) - 1;
+	if (endRow < m_processedRows)
+		return;
 
-	//calculate the scene coordinates
 	const AbstractPlot* plot = dynamic_cast<const AbstractPlot*>(q->parentAspect());
 	if (!plot)
 		return;
 
+	//the scene coordinates of the available points were not calculated yet
+	if (visiblePoints.size() != (size_t)symbolPointsLogical.size()) {
+		retransform();
+		return;
+	}
+
 	const CartesianCoordinateSystem *cSystem = dynamic_cast<const CartesianCoordinateSystem*>(plot->coordinateSystem());
 	Q_ASSERT(cSystem);
-	visiblePoints = std::vector<bool>(symbolPointsLogical.count(), false);
-	cSystem->mapLogicalToScene(symbolPointsLogical, symbolPointsScene, visiblePoints);
+	appendPoints(m_processedRows, endRow, cSystem);
+	m_processedRows = endRow + 1;
 
 	m_suppressRecalc = true;
 	updateLines();
@@ -968,11 +1067,143 @@ void XYCurvePrivate::retransform() {
 	updateErrorBars();
 }
 
+/*!
+  appends the valid and non masked points in the rows \c startRow,...,\c endRow of the data columns
+  to \c symbolPointsLogical. The points are mapped in one batch with \c cSystem, the visible ones are appended
+  to \c symbolPointsScene and \c visiblePoints is extended accordingly. Without \c cSystem only the logical points are taken over.
+*/
+void XYCurvePrivate::appendPoints(int startRow, int endRow, const CartesianCoordinateSystem* cSystem) {
+	const int rows = endRow - startRow + 1;
+	if (rows <= 0)
+		return;
+
+	ScratchScope scratch;
+	double* x = scratch.allocate<double>(rows);
+	double* y = scratch.allocate<double>(rows);
+	const int count = readPoints(startRow, endRow, x, y);
+
+	symbolPointsLogical.reserve(symbolPointsLogical.size() + count);
+	for (int i = 0; i < count; ++i)
+		symbolPointsLogical.append(QPointF(x[i], y[i]));
+
+	if (!cSystem)
+		return;
+
+	double* sceneX = scratch.allocate<double>(count);
+	double* sceneY = scratch.allocate<double>(count);
+	char* visible = scratch.allocate<char>(count);
+	cSystem->mapLogicalToScene(count, x, y, sceneX, sceneY, visible);
+
+	symbolPointsScene.reserve(symbolPointsScene.size() + count);
+	visiblePoints.reserve(visiblePoints.size() + count);
+	for (int i = 0; i < count; ++i) {
+		if (visible[i])
+			symbolPointsScene.append(QPointF(sceneX[i], sceneY[i]));
+		visiblePoints.push_back(visible[i]);
+	}
+}
+
+/*!
+  writes the valid and non masked points in the rows \c startRow,...,\c endRow
+  of the data columns into \c x and \c y and updates the connection of the points.
+  \c x and \c y have to provide space for all rows, returns the number of points.
+*/
+int XYCurvePrivate::readPoints(int startRow, int endRow, double* x, double* y) {
+	QPointF tempPoint;
+	int n = 0;
+
+	AbstractColumn::ColumnMode xColMode = xColumn->columnMode();
+	AbstractColumn::ColumnMode yColMode = yColumn->columnMode();
+
+	//take over only valid and non masked points, the masked rows are skipped blockwise
+	const Interval<int> range(startRow, endRow);
+	const QList< Interval<int> > unmaskedIntervals = Interval<int>::intersectionOfLists(xColumn->unmaskedIntervals(range),
+			yColumn->unmaskedIntervals(range));
+	int row = startRow;
+
+	//numeric columns are read spanwise without the virtual calls per row
+	if (xColMode == AbstractColumn::Numeric && yColMode == AbstractColumn::Numeric) {
+		foreach (const Interval<int>& interval, unmaskedIntervals) {
+			if (interval.start() > row && !connectedPointsLogical.empty())
+				connectedPointsLogical[connectedPointsLogical.size()-1] = false;
+
+			AbstractColumn::SpanReader xReader(xColumn, interval.start(), interval.end());
+			AbstractColumn::SpanReader yReader(yColumn, interval.start(), interval.end());
+			while (xReader.next() && yReader.next()) {
+				const double* xValues = xReader.values();
+				const double* yValues = yReader.values();
+				for (int i = 0; i < xReader.count(); ++i) {
+					if (!std::isnan(xValues[i]) && !std::isnan(yValues[i])) {
+						x[n] = xValues[i];
+						y[n] = yValues[i];
+						++n;
+						connectedPointsLogical.push_back(true);
+					} else if (!connectedPointsLogical.empty())
+						connectedPointsLogical[connectedPointsLogical.size()-1] = false;
+				}
+			}
+			row = interval.end() + 1;
+		}
+		if (row <= endRow && !connectedPointsLogical.empty())
+			connectedPointsLogical[connectedPointsLogical.size()-1] = false;
+		return n;
+	}
+
+	foreach (const Interval<int>& interval, unmaskedIntervals) {
+		//no connection over masked rows
+		if (interval.start() > row && !connectedPointsLogical.empty())
+			connectedPointsLogical[connectedPointsLogical.size()-1] = false;
+
+		for (row = interval.start(); row <= interval.end(); row++) {
+			if ( xColumn->isValid(row) && yColumn->isValid(row) ) {
+
+				switch (xColMode) {
+				case AbstractColumn::Numeric:
+					tempPoint.setX(xColumn->valueAt(row));
+					break;
+				case AbstractColumn::Text:
+				//TODO
+				case AbstractColumn::DateTime:
+				case AbstractColumn::Month:
+				case AbstractColumn::Day:
+					//TODO
+					break;
+				}
+
+				switch (yColMode) {
+				case AbstractColumn::Numeric:
+					tempPoint.setY(yColumn->valueAt(row));
+					break;
+				case AbstractColumn::Text:
+				//TODO
+				case AbstractColumn::DateTime:
+				case AbstractColumn::Month:
+				case AbstractColumn::Day:
+					//TODO
+					break;
+				}
+				x[n] = tempPoint.x();
+				y[n] = tempPoint.y();
+				++n;
+				connectedPointsLogical.push_back(true);
+			} else {
+				if (!connectedPointsLogical.empty())
+					connectedPointsLogical[connectedPointsLogical.size()-1] = false;
+			}
+		}
+	}
+	if (row <= endRow && !connectedPointsLogical.empty())
+		connectedPointsLogical[connectedPointsLogical.size()-1] = false;
+
+	return n;
+}
+
 /*!
   recalculates the painter path for the lines connecting the data points.
   Called each time when the type of this connection is changed.
 */
 void XYCurvePrivate::updateLines() {
+	m_dirtyLayers |= LineLayer;
 	linePath = QPainterPath();
 	lines.clear();
 	if (lineType == XYCurve::NoLine) {
@@ -998,12 +1229,26 @@ void XYCurvePrivate::updateLines() {
 	switch (lineType) {
 	case XYCurve::NoLine:
 		break;
-	case XYCurve::Line:
-		for (int i = 0; i < count - 1; i++) {
-			if (!lineSkipGaps && !connectedPointsLogical[i]) continue;
-			lines.append(QLineF(symbolPointsLogical.at(i), symbolPointsLogical.at(i+1)));
+	case XYCurve::Line: {
+		if (m_printing) {
+			//printing and exporting draw the exact line
+			for (int i = 0; i < count - 1; i++) {
+				if (!lineSkipGaps && !connectedPointsLogical[i]) continue;
+				lines.append(QLineF(symbolPointsLogical.at(i), symbolPointsLogical.at(i+1)));
+			}
+			break;
+		}
+
+		//only the points relevant for the line at the current plot size and range are connected
+		QVector<QPointF> points;
+		std::vector<bool> connected;
+		decimateLinePoints(points, connected);
+		for (int i = 0; i < points.size() - 1; i++) {
+			if (!lineSkipGaps && !connected[i]) continue;
+			lines.append(QLineF(points.at(i), points.at(i+1)));
 		}
 		break;
+	}
 	case XYCurve::StartHorizontal:
 		for (int i = 0; i < count - 1; i++) {
 			if (!lineSkipGaps && !connectedPointsLogical[i]) continue;
@@ -1089,7 +1334,9 @@ void XYCurvePrivate::updateLines() {
 		gsl_interp_accel *acc = gsl_interp_accel_alloc();
 		gsl_spline *spline = 0;
 
-		double x[count],  y[count];
+		ScratchScope scratch;
+		double* x = scratch.allocate<double>(count);
+		double* y = scratch.allocate<double>(count);
 		for (int i = 0; i < count; i++) {
 			x[i] = symbolPointsLogical.at(i).x();
 			y[i] = symbolPointsLogical.at(i).y();
@@ -1161,8 +1408,9 @@ void XYCurvePrivate::updateLines() {
 
 	//map the lines to scene coordinates
 	const CartesianPlot* plot = dynamic_cast<const CartesianPlot*>(q->parentAspect());
-	const AbstractCoordinateSystem* cSystem = plot->coordinateSystem();
-	lines = cSystem->mapLogicalToScene(lines);
+	const CartesianCoordinateSystem* cSystem = dynamic_cast<const CartesianCoordinateSystem*>(plot->coordinateSystem());
+	const QVector<QLineF> logicalLines = lines;
+	cSystem->mapLogicalToScene(logicalLines, lines);
 
 	//new line path
 	foreach (const QLineF& line, lines) {
@@ -1174,11 +1422,110 @@ void XYCurvePrivate::updateLines() {
 	recalcShapeAndBoundingRect();
 }
 
+/*!
+  level-of-detail reduction of the points connected by a straight line (M4-decimation).
+
+  The points in \c symbolPointsLogical are grouped into buckets of consecutive and connected points
+  falling into the same column of half a scene unit. The layers are rendered into pixmaps in scene resolution
+  (\sa renderLayers()), a bucket is therefore narrower than a pixel of the pixmap.
+  For every bucket only the first, the last and the points with the minimal and maximal y-value are kept.
+  The decimated line differs from the line connecting all points only by the antialiasing of single pixels,
+  when printing or exporting the line connecting all points is drawn (\sa XYCurve::setPrinting()).
+  Runs of consecutive points left or right of the visible x-range are reduced to their first and last points.
+  The number of points in \c points is therefore limited by the width of the plot and not by the number of rows.
+  \c connected contains for every point in \c points whether it is connected with the next point.
+*/
+void XYCurvePrivate::decimateLinePoints(QVector<QPointF>& points, std::vector<bool>& connected) const {
+	const int count = symbolPointsLogical.count();
+	const CartesianPlot* plot = dynamic_cast<const CartesianPlot*>(q->parentAspect());
+	const CartesianCoordinateSystem* cSystem = dynamic_cast<const CartesianCoordinateSystem*>(plot->coordinateSystem());
+	const QList<CartesianScale*> xScales = cSystem->xScales();
+
+	//map all x-values in one batch
+	ScratchScope scratch;
+	double* x = scratch.allocate<double>(count);
+	double* sceneX = scratch.allocate<double>(count);
+	char* mapped = scratch.allocate<char>(count);
+	for (int i = 0; i < count; ++i)
+		x[i] = symbolPointsLogical.at(i).x();
+	cSystem->mapLogicalXToScene(count, x, sceneX, mapped);
+
+	//visible x-range covered by all x-scales
+	double xStart = INFINITY;
+	double xEnd = -INFINITY;
+	foreach (const CartesianScale* xScale, xScales) {
+		if (!xScale) continue;
+		Interval<double> interval;
+		xScale->getProperties(NULL, &interval);
+		xStart = qMin(xStart, qMin(interval.start(), interval.end()));
+		xEnd = qMax(xEnd, qMax(interval.start(), interval.end()));
+	}
+
+	//bucket keys for points that are not mapped to a column in the plot
+	static const qint64 NoBucket = std::numeric_limits<qint64>::min();
+	static const qint64 LeftBucket = NoBucket + 1;
+	static const qint64 RightBucket = std::numeric_limits<qint64>::max();
+	static const double bucketWidth = 0.5;
+
+	points.reserve(qMin(count, 4*1024));
+	connected.reserve(qMin(count, 4*1024));
+
+	qint64 bucket = NoBucket;
+	int first = 0, last = 0, min = 0, max = 0;
+	int indices[4];
+	for (int i = 0; i <= count; ++i) {
+		qint64 key = NoBucket;
+		if (i < count) {
+			if (x[i] < xStart)
+				key = LeftBucket;
+			else if (x[i] > xEnd)
+				key = RightBucket;
+			else if (mapped[i])
+				key = (qint64)floor(sceneX[i]/bucketWidth);
+
+			//add the point to the current bucket if it's in the same column and connected with the previous point
+			if (key != NoBucket && key == bucket && (lineSkipGaps || connectedPointsLogical[i-1])) {
+				last = i;
+				const double y = symbolPointsLogical.at(i).y();
+				if (y < symbolPointsLogical.at(min).y())
+					min = i;
+				if (y > symbolPointsLogical.at(max).y())
+					max = i;
+				continue;
+			}
+		}
+
+		//flush the current bucket, for off-screen buckets the extrema are not relevant
+		if (i > 0) {
+			int n = 0;
+			indices[n++] = first;
+			if (bucket != LeftBucket && bucket != RightBucket) {
+				indices[n++] = min;
+				indices[n++] = max;
+			}
+			indices[n++] = last;
+			std::sort(indices, indices + n);
+			for (int j = 0; j < n; ++j) {
+				if (j > 0 && indices[j] == indices[j-1])
+					continue;
+				points.append(symbolPointsLogical.at(indices[j]));
+				connected.push_back(true);
+			}
+			connected[connected.size()-1] = connectedPointsLogical[last];
+		}
+
+		//start a new bucket
+		bucket = key;
+		first = last = min = max = i;
+	}
+}
+
 /*!
   recalculates the painter path for the drop lines.
   Called each time when the type of the drop lines is changed.
 */
 void XYCurvePrivate::updateDropLines() {
+	m_dirtyLayers |= LineLayer;
 	dropLinePath = QPainterPath();
 	if (dropLineType == XYCurve::NoDropLine) {
 		recalcShapeAndBoundingRect();
@@ -1187,7 +1534,8 @@ void XYCurvePrivate::updateDropLines() {
 
 	//calculate drop lines
 	const CartesianPlot* plot = dynamic_cast<const CartesianPlot*>(q->parentAspect());
-	QList<QLineF> lines;
+	QVector<QLineF> lines;
+	lines.reserve(symbolPointsScene.size());
 	float xMin = 0;
 	float yMin = 0;
 
@@ -1242,11 +1590,12 @@ void XYCurvePrivate::updateDropLines() {
 	}
 
 	//map the drop lines to scene coordinates
-	const AbstractCoordinateSystem* cSystem = plot->coordinateSystem();
-	lines = cSystem->mapLogicalToScene(lines);
+	const CartesianCoordinateSystem* cSystem = dynamic_cast<const CartesianCoordinateSystem*>(plot->coordinateSystem());
+	QVector<QLineF> sceneLines;
+	cSystem->mapLogicalToScene(lines, sceneLines);
 
 	//new painter path for the drop lines
-	foreach (const QLineF& line, lines) {
+	foreach (const QLineF& line, sceneLines) {
 		dropLinePath.moveTo(line.p1());
 		dropLinePath.lineTo(line.p2());
 	}
@@ -1255,7 +1604,11 @@ void XYCurvePrivate::updateDropLines() {
 }
 
 void XYCurvePrivate::updateSymbols() {
-	symbolsPath = QPainterPath();
+	m_dirtyLayers |= SymbolsLayer;
+	symbolPath = QPainterPath();
+	symbolsBoundingRect = QRectF();
+	symbolsGridCellStart.clear();
+	symbolsGridPoints.clear();
 	if (symbolsStyle != Symbol::NoSymbols) {
 		QPainterPath path = Symbol::pathFromStyle(symbolsStyle);
 
@@ -1268,21 +1621,100 @@ void XYCurvePrivate::updateSymbols() {
 			trafo.rotate(symbolsRotationAngle);
 			path = trafo.map(path);
 		}
+		symbolPath = path;
 
-		foreach (const QPointF& point, symbolPointsScene) {
-			trafo.reset();
-			trafo.translate(point.x(), point.y());
-			symbolsPath.addPath(trafo.map(path));
-		}
+		//the single symbols are not composed to one path anymore, only the grid used for the hit-testing is updated
+		updateSymbolsGrid();
 	}
 
 	recalcShapeAndBoundingRect();
 }
 
+/*!
+  sorts the symbol positions into a uniform grid used in contains() and collidesWithPath().
+  The cells are at least as large as a symbol so that a hit-test only visits a few cells.
+*/
+void XYCurvePrivate::updateSymbolsGrid() {
+	const int count = symbolPointsScene.size();
+	if (count == 0)
+		return;
+
+	const qreal penWidth = (symbolsPen.style() != Qt::NoPen) ? symbolsPen.widthF() : 0;
+	const QRectF symbolRect = symbolPath.boundingRect().adjusted(-penWidth/2, -penWidth/2, penWidth/2, penWidth/2);
+
+	qreal xMin = symbolPointsScene.at(0).x();
+	qreal xMax = xMin;
+	qreal yMin = symbolPointsScene.at(0).y();
+	qreal yMax = yMin;
+	for (int i = 1; i < count; ++i) {
+		const QPointF& point = symbolPointsScene.at(i);
+		xMin = qMin(xMin, point.x());
+		xMax = qMax(xMax, point.x());
+		yMin = qMin(yMin, point.y());
+		yMax = qMax(yMax, point.y());
+	}
+	symbolsGridRect = QRectF(xMin, yMin, xMax - xMin, yMax - yMin);
+	symbolsBoundingRect = symbolsGridRect.adjusted(symbolRect.left(), symbolRect.top(), symbolRect.right(), symbolRect.bottom());
+
+	//about one point per cell
+	const qreal symbolExtent = qMax(qMax(-symbolRect.left(), symbolRect.right()), qMax(-symbolRect.top(), symbolRect.bottom()));
+	symbolsGridCellSize = qMax(qMax(2*symbolExtent, (qreal)1.), sqrt(symbolsGridRect.width()*symbolsGridRect.height()/count));
+	symbolsGridColumns = (int)(symbolsGridRect.width()/symbolsGridCellSize) + 1;
+	symbolsGridRows = (int)(symbolsGridRect.height()/symbolsGridCellSize) + 1;
+	while ((qint64)symbolsGridColumns*symbolsGridRows > 4*(qint64)count + 64) {
+		//points on a line, don't create a grid with mostly empty cells
+		symbolsGridCellSize *= 2;
+		symbolsGridColumns = (int)(symbolsGridRect.width()/symbolsGridCellSize) + 1;
+		symbolsGridRows = (int)(symbolsGridRect.height()/symbolsGridCellSize) + 1;
+	}
+
+	//count the points per cell and store the point indices sorted by cells
+	QVector<int> cells(count);
+	symbolsGridCellStart.fill(0, symbolsGridColumns*symbolsGridRows + 1);
+	for (int i = 0; i < count; ++i) {
+		const QPointF& point = symbolPointsScene.at(i);
+		const int column = qMin((int)((point.x() - xMin)/symbolsGridCellSize), symbolsGridColumns - 1);
+		const int row = qMin((int)((point.y() - yMin)/symbolsGridCellSize), symbolsGridRows - 1);
+		cells[i] = row*symbolsGridColumns + column;
+		++symbolsGridCellStart[cells[i] + 1];
+	}
+	for (int i = 1; i < symbolsGridCellStart.size(); ++i)
+		symbolsGridCellStart[i] += symbolsGridCellStart[i - 1];
+
+	symbolsGridPoints.resize(count);
+	QVector<int> fill = symbolsGridCellStart;
+	for (int i = 0; i < count; ++i)
+		symbolsGridPoints[fill[cells[i]]++] = i;
+}
+
+/*!
+  returns the indices of the symbols whose positions lie in the grid cells overlapping \c rect.
+*/
+QVector<int> XYCurvePrivate::symbolsInRect(const QRectF& rect) const {
+	QVector<int> indices;
+	if (symbolsGridCellStart.isEmpty())
+		return indices;
+
+	const int column1 = qMax((int)floor((rect.left() - symbolsGridRect.left())/symbolsGridCellSize), 0);
+	const int column2 = qMin((int)floor((rect.right() - symbolsGridRect.left())/symbolsGridCellSize), symbolsGridColumns - 1);
+	const int row1 = qMax((int)floor((rect.top() - symbolsGridRect.top())/symbolsGridCellSize), 0);
+	const int row2 = qMin((int)floor((rect.bottom() - symbolsGridRect.top())/symbolsGridCellSize), symbolsGridRows - 1);
+	for (int row = row1; row <= row2; ++row) {
+		for (int column = column1; column <= column2; ++column) {
+			const int cell = row*symbolsGridColumns + column;
+			for (int i = symbolsGridCellStart.at(cell); i < symbolsGridCellStart.at(cell + 1); ++i)
+				indices << symbolsGridPoints.at(i);
+		}
+	}
+
+	return indices;
+}
+
 /*!
   recreates the value strings to be shown and recalculates their draw position.
 */
 void XYCurvePrivate::updateValues() {
+	m_dirtyLayers |= ValuesLayer;
 	valuesPath = QPainterPath();
 	valuesPoints.clear();
 	valuesStrings.clear();
@@ -1408,6 +1840,7 @@ void XYCurvePrivate::updateValues() {
 }
 
 void XYCurvePrivate::updateFilling() {
+	m_dirtyLayers |= FillingLayer;
 	fillPolygons.clear();
 
 	if (fillingPosition==XYCurve::NoFilling) {
@@ -1415,9 +1848,9 @@ void XYCurvePrivate::updateFilling() {
 		return;
 	}
 
-	QList<QLineF> fillLines;
+	QVector<QLineF> fillLines;
 	const CartesianPlot* plot = dynamic_cast<const CartesianPlot*>(q->parentAspect());
-	const AbstractCoordinateSystem* cSystem = plot->coordinateSystem();
+	const CartesianCoordinateSystem* cSystem = dynamic_cast<const CartesianCoordinateSystem*>(plot->coordinateSystem());
 
 	//if there're no interpolation lines available (XYCurve::NoLine selected), create line-interpolation,
 	//use already available lines otherwise.
@@ -1428,7 +1861,8 @@ void XYCurvePrivate::updateFilling() {
 			if (!lineSkipGaps && !connectedPointsLogical[i]) continue;
 			fillLines.append(QLineF(symbolPointsLogical.at(i), symbolPointsLogical.at(i+1)));
 		}
-		fillLines = cSystem->mapLogicalToScene(fillLines);
+		const QVector<QLineF> logicalLines = fillLines;
+		cSystem->mapLogicalToScene(logicalLines, fillLines);
 
 		//no lines available (no points), nothing to do
 		if (fillLines.isEmpty())
@@ -1641,16 +2075,17 @@ void XYCurvePrivate::updateFilling() {
 }
 
 void XYCurvePrivate::updateErrorBars() {
+	m_dirtyLayers |= ErrorBarsLayer;
 	errorBarsPath = QPainterPath();
 	if (xErrorType==XYCurve::NoError && yErrorType==XYCurve::NoError) {
 		recalcShapeAndBoundingRect();
 		return;
 	}
 
-	QList<QLineF> lines;
+	QVector<QLineF> lines;
 	float errorPlus, errorMinus;
 	const CartesianPlot* plot = dynamic_cast<const CartesianPlot*>(q->parentAspect());
-	const AbstractCoordinateSystem* cSystem = plot->coordinateSystem();
+	const CartesianCoordinateSystem* cSystem = dynamic_cast<const CartesianCoordinateSystem*>(plot->coordinateSystem());
 
 	//the cap size for the errorbars is given in scene units.
 	//determine first the (half of the) cap size in logical units:
@@ -1766,10 +2201,11 @@ void XYCurvePrivate::updateErrorBars() {
 	}
 
 	//map the error bars to scene coordinates
-	lines = cSystem->mapLogicalToScene(lines);
+	QVector<QLineF> sceneLines;
+	cSystem->mapLogicalToScene(lines, sceneLines);
 
 	//new painter path for the drop lines
-	foreach (const QLineF& line, lines) {
+	foreach (const QLineF& line, sceneLines) {
 		errorBarsPath.moveTo(line.p1());
 		errorBarsPath.lineTo(line.p2());
 	}
@@ -1787,122 +2223,227 @@ void XYCurvePrivate::recalcShapeAndBoundingRect() {
 
 	prepareGeometryChange();
 	curveShape = QPainterPath();
+	QRectF layerRects[layerCount];
+	if (fillingPosition != XYCurve::NoFilling) {
+		foreach (const QPolygonF& pol, fillPolygons)
+			layerRects[0] = layerRects[0].united(pol.boundingRect());
+	}
+
 	if (lineType != XYCurve::NoLine) {
-		curveShape.addPath(WorksheetElement::shapeFromPath(linePath, linePen));
+		const QPainterPath path = WorksheetElement::shapeFromPath(linePath, linePen);
+		curveShape.addPath(path);
+		layerRects[1] = path.boundingRect();
 	}
 
 	if (dropLineType != XYCurve::NoDropLine) {
-		curveShape.addPath(WorksheetElement::shapeFromPath(dropLinePath, dropLinePen));
+		const QPainterPath path = WorksheetElement::shapeFromPath(dropLinePath, dropLinePen);
+		curveShape.addPath(path);
+		layerRects[1] = layerRects[1].united(path.boundingRect());
 	}
 
-	if (symbolsStyle != Symbol::NoSymbols) {
-		curveShape.addPath(symbolsPath);
+	if (xErrorType != XYCurve::NoError || yErrorType != XYCurve::NoError) {
+		const QPainterPath path = WorksheetElement::shapeFromPath(errorBarsPath, errorBarsPen);
+		curveShape.addPath(path);
+		layerRects[2] = path.boundingRect();
 	}
 
+	if (symbolsStyle != Symbol::NoSymbols)
+		layerRects[3] = symbolsBoundingRect;
+
 	if (valuesType != XYCurve::NoValues) {
 		curveShape.addPath(valuesPath);
+		layerRects[4] = valuesPath.boundingRect();
 	}
 
-	if (xErrorType != XYCurve::NoError || yErrorType != XYCurve::NoError) {
-		curveShape.addPath(WorksheetElement::shapeFromPath(errorBarsPath, errorBarsPen));
+	//the layers are rendered again if their content (marked in the update functions) or their position changed
+	boundingRectangle = QRectF();
+	int changedLayers = 0;
+	for (int i = 0; i < layerCount; ++i) {
+		boundingRectangle = boundingRectangle.united(layerRects[i]);
+		if (layerRects[i] != m_layerRects[i]) {
+			m_layerRects[i] = layerRects[i];
+			changedLayers |= (1 << i);
+		}
 	}
 
-	boundingRectangle = curveShape.boundingRect();
-
-	foreach (const QPolygonF& pol, fillPolygons)
-		boundingRectangle = boundingRectangle.united(pol.boundingRect());
-
 	//TODO: when the selection is painted, line intersections are visible.
 	//simplified() removes those artifacts but is horrible slow for curves with large number of points.
 	//search for an alternative.
 	//curveShape = curveShape.simplified();
 
-	updatePixmap();
+	updatePixmap(changedLayers);
 }
 
 void XYCurvePrivate::draw(QPainter *painter) {
 	DEBUG("XYCurvePrivate::draw()");
+	for (int i = 0; i < layerCount; ++i)
+		drawLayer(painter, i);
+	DEBUG("XYCurvePrivate::draw() DONE");
+}
 
-	//draw filling
-	if (fillingPosition != XYCurve::NoFilling) {
-		painter->setOpacity(fillingOpacity);
-		painter->setPen(Qt::SolidLine);
-		drawFilling(painter);
-	}
+/*!
+  draws the layer with the index \c index (filling, lines and drop lines, error bars, symbols, values).
+*/
+void XYCurvePrivate::drawLayer(QPainter* painter, int index) {
+	switch (index) {
+	case 0:
+		//draw filling
+		if (fillingPosition != XYCurve::NoFilling) {
+			painter->setOpacity(fillingOpacity);
+			painter->setPen(Qt::SolidLine);
+			drawFilling(painter);
+		}
+		break;
+	case 1:
+		//draw lines
+		if (lineType != XYCurve::NoLine) {
+			painter->setOpacity(lineOpacity);
+			painter->setPen(linePen);
+			painter->setBrush(Qt::NoBrush);
+			painter->drawPath(linePath);
+		}
 
-	//draw lines
-	if (lineType != XYCurve::NoLine) {
-		painter->setOpacity(lineOpacity);
-		painter->setPen(linePen);
-		painter->setBrush(Qt::NoBrush);
-		painter->drawPath(linePath);
+		//draw drop lines
+		if (dropLineType != XYCurve::NoDropLine) {
+			painter->setOpacity(dropLineOpacity);
+			painter->setPen(dropLinePen);
+			painter->setBrush(Qt::NoBrush);
+			painter->drawPath(dropLinePath);
+		}
+		break;
+	case 2:
+		//draw error bars
+		if ( (xErrorType != XYCurve::NoError) || (yErrorType != XYCurve::NoError) ) {
+			painter->setOpacity(errorBarsOpacity);
+			painter->setPen(errorBarsPen);
+			painter->setBrush(Qt::NoBrush);
+			painter->drawPath(errorBarsPath);
+		}
+		break;
+	case 3:
+		//draw symbols
+		if (symbolsStyle != Symbol::NoSymbols) {
+			painter->setOpacity(symbolsOpacity);
+			painter->setPen(symbolsPen);
+			painter->setBrush(symbolsBrush);
+			drawSymbols(painter);
+		}
+		break;
+	case 4:
+		//draw values
+		if (valuesType != XYCurve::NoValues) {
+			painter->setOpacity(valuesOpacity);
+			//don't use any painter pen, since this will force QPainter to render the text outline which is expensive
+			painter->setPen(Qt::NoPen);
+			painter->setBrush(valuesColor);
+			drawValues(painter);
+		}
+		break;
 	}
+}
 
-	//draw drop lines
-	if (dropLineType != XYCurve::NoDropLine) {
-		painter->setOpacity(dropLineOpacity);
-		painter->setPen(dropLinePen);
-		painter->setBrush(Qt::NoBrush);
-		painter->drawPath(dropLinePath);
-	}
+/*!
+  marks the cached pixmaps of \c layers (\sa Layer) as outdated and schedules the repaint of their area.
+  The layers are rendered again in the next call of paint().
+*/
+void XYCurvePrivate::updatePixmap(int layers) {
+	m_dirtyLayers |= layers;
+	if (!m_dirtyLayers)
+		return;
 
-	//draw error bars
-	if ( (xErrorType != XYCurve::NoError) || (yErrorType != XYCurve::NoError) ) {
-		painter->setOpacity(errorBarsOpacity);
-		painter->setPen(errorBarsPen);
-		painter->setBrush(Qt::NoBrush);
-		painter->drawPath(errorBarsPath);
-	}
+	m_effectMask = QImage();
+	m_hoverEffectImage = QImage();
+	m_selectionEffectImage = QImage();
 
-	//draw symbols
-	if (symbolsStyle != Symbol::NoSymbols) {
-		painter->setOpacity(symbolsOpacity);
-		painter->setPen(symbolsPen);
-		painter->setBrush(symbolsBrush);
-		drawSymbols(painter);
+	//the effects cover the whole curve
+	if (m_hovered || isSelected()) {
+		update();
+		return;
 	}
 
-	//draw values
-	if (valuesType != XYCurve::NoValues) {
-		painter->setOpacity(valuesOpacity);
-		//don't use any painter pen, since this will force QPainter to render the text outline which is expensive
-		painter->setPen(Qt::NoPen);
-		painter->setBrush(valuesColor);
-		drawValues(painter);
+	QRectF rect;
+	for (int i = 0; i < layerCount; ++i) {
+		if (m_dirtyLayers & (1 << i))
+			rect = rect.united(m_layerRects[i]);
 	}
+	update(rect);
+}
 
-	DEBUG("XYCurvePrivate::draw() DONE");
+void XYCurvePrivate::updateLinePixmap() {
+	updatePixmap(LineLayer);
 }
 
-void XYCurvePrivate::updatePixmap() {
-	DEBUG("XYCurvePrivate::updatePixmap()");
-	WAIT_CURSOR;
+void XYCurvePrivate::updateSymbolsPixmap() {
+	updatePixmap(SymbolsLayer);
+}
 
-// 	QTime timer;
-// 	timer.start();
-	m_hoverEffectImageIsDirty = true;
-	m_selectionEffectImageIsDirty = true;
-	if (boundingRectangle.width() == 0 || boundingRectangle.width() == 0) {
-		m_pixmap = QPixmap();
-		RESET_CURSOR;
-		return;
-	}
-	QPixmap pixmap(ceil(boundingRectangle.width()), ceil(boundingRectangle.height()));
-	pixmap.fill(Qt::transparent);
-	QPainter painter(&pixmap);
-	painter.setRenderHint(QPainter::Antialiasing, true);
-	painter.translate(-boundingRectangle.topLeft());
+void XYCurvePrivate::updateValuesPixmap() {
+	updatePixmap(ValuesLayer);
+}
 
-	draw(&painter);
-	painter.end();
-	m_pixmap = pixmap;
+void XYCurvePrivate::updateFillingPixmap() {
+	updatePixmap(FillingLayer);
+}
 
-	//QApplication::processEvents(QEventLoop::AllEvents, 0);
+void XYCurvePrivate::updateErrorBarsPixmap() {
+	updatePixmap(ErrorBarsLayer);
+}
 
-// 	qDebug() << "Update the pixmap: " << timer.elapsed() << "ms";
-	update();
-	RESET_CURSOR;
-	DEBUG("XYCurvePrivate::updatePixmap() DONE");
+/*!
+  called when the pen of the lines or of the drop lines changed, the shape changes with the pen width.
+*/
+void XYCurvePrivate::recalcLineShape() {
+	m_dirtyLayers |= LineLayer;
+	recalcShapeAndBoundingRect();
+}
+
+void XYCurvePrivate::recalcErrorBarsShape() {
+	m_dirtyLayers |= ErrorBarsLayer;
+	recalcShapeAndBoundingRect();
+}
+
+/*!
+  renders the outdated layers into their pixmaps in scene resolution.
+*/
+void XYCurvePrivate::renderLayers() {
+	DEBUG("XYCurvePrivate::renderLayers() layers =" << m_dirtyLayers);
+	for (int i = 0; i < layerCount; ++i) {
+		if (!(m_dirtyLayers & (1 << i)))
+			continue;
+
+		const QRectF& rect = m_layerRects[i];
+		if (rect.width() <= 0 || rect.height() <= 0) {
+			m_layers[i] = QPixmap();
+			continue;
+		}
+
+		QPixmap pixmap(ceil(rect.width()), ceil(rect.height()));
+		pixmap.fill(Qt::transparent);
+		QPainter painter(&pixmap);
+		painter.setRenderHint(QPainter::Antialiasing, true);
+		painter.translate(-rect.topLeft());
+		drawLayer(&painter, i);
+		painter.end();
+		m_layers[i] = pixmap;
+	}
+	m_dirtyLayers = 0;
+
+	m_layersSize = 0;
+	for (int i = 0; i < layerCount; ++i)
+		m_layersSize += (qint64)m_layers[i].width()*m_layers[i].height()*m_layers[i].depth()/8;
+}
+
+/*!
+  drops the cached pixmaps, called by the WorksheetLayerCache if the memory limit for the worksheet is exceeded.
+*/
+void XYCurvePrivate::releaseLayers() {
+	for (int i = 0; i < layerCount; ++i)
+		m_layers[i] = QPixmap();
+	m_dirtyLayers = AllLayers;
+	m_layersSize = 0;
+	m_effectMask = QImage();
+	m_hoverEffectImage = QImage();
+	m_selectionEffectImage = QImage();
 }
 
 //TODO: move this to a central place
@@ -1991,66 +2532,173 @@ void XYCurvePrivate::paint(QPainter* painter, const QStyleOptionGraphicsItem* op
 	painter->setBrush(Qt::NoBrush);
 	painter->setRenderHint(QPainter::SmoothPixmapTransform, true);
 
- 	DEBUG("XYCurvePrivate::paint() calling drawPixmap() or draw() 		XXXXXXXXXXXXXXXXXXXX");
-	if ( KSharedConfig::openConfig()->group("Settings_Worksheet").readEntry<bool>("DoubleBuffering", true) )
-		painter->drawPixmap(boundingRectangle.topLeft(), m_pixmap); //draw the cached pixmap (fast)
-	else
-		draw(painter); //draw directly again (slow)
+	const bool effect = !m_printing && (m_hovered || isSelected());
+	if ( !m_printing && KSharedConfig::openConfig()->group("Settings_Worksheet").readEntry<bool>("DoubleBuffering", true) ) {
+		//draw the cached pixmaps of the layers (fast)
+		if (m_dirtyLayers)
+			renderLayers();
+		for (int i = 0; i < layerCount; ++i) {
+			if (!m_layers[i].isNull())
+				painter->drawPixmap(m_layerRects[i].topLeft(), m_layers[i]);
+		}
+	} else {
+		draw(painter); //draw directly again (slow), when printing or exporting the exact paths are drawn
+		if (effect && m_dirtyLayers)
+			renderLayers();
+	}
 
 // 	qDebug() << "Paint the pixmap: " << timer.elapsed() << "ms";
 
-	if (m_hovered && !isSelected() && !m_printing) {
-// 		timer.start();
-		if (m_hoverEffectImageIsDirty) {
-			QPixmap pix = m_pixmap;
-			pix.fill(q->hoveredPen.color());
-			pix.setAlphaChannel(m_pixmap.alphaChannel());
-			m_hoverEffectImage = blurred(pix.toImage(), m_pixmap.rect(), 5);
-			m_hoverEffectImageIsDirty = false;
-		}
+	//the effects are calculated in the resolution of the paint device, but never larger than the pixmaps
+	const qreal scale = qMin(1., sqrt(fabs(painter->worldTransform().determinant()))*painter->device()->devicePixelRatio());
+	if (effect && scale > 0 && boundingRectangle.width() > 0 && boundingRectangle.height() > 0) {
+		const bool selected = isSelected();
+		QImage& image = selected ? m_selectionEffectImage : m_hoverEffectImage;
+		if (image.isNull() || scale != m_effectScale)
+			image = effectImage(selected ? q->selectedPen.color() : q->hoveredPen.color(), scale);
 
-		painter->setOpacity(q->hoveredOpacity*2);
-		painter->drawImage(boundingRectangle.topLeft(), m_hoverEffectImage, m_pixmap.rect());
-// 		qDebug() << "Paint hovering effect: " << timer.elapsed() << "ms";
-		return;
+		painter->setOpacity((selected ? q->selectedOpacity : q->hoveredOpacity)*2);
+		painter->drawImage(QRectF(boundingRectangle.topLeft(), QSizeF(image.width()/scale, image.height()/scale)), image);
 	}
 
-	if (isSelected() && !m_printing) {
-// 		timer.start();
-		if (m_selectionEffectImageIsDirty) {
-			QPixmap pix = m_pixmap;
-			pix.fill(q->selectedPen.color());
-			pix.setAlphaChannel(m_pixmap.alphaChannel());
-			m_selectionEffectImage = blurred(pix.toImage(), m_pixmap.rect(), 5);
-			m_selectionEffectImageIsDirty = false;
-		}
+	//register the pixmaps as the most recently used ones of the worksheet
+	const Worksheet* worksheet = q->ancestor<Worksheet>();
+	WorksheetLayerCache* cache = worksheet ? worksheet->layerCache() : 0;
+	if (cache != m_layerCache) {
+		if (m_layerCache)
+			m_layerCache->remove(this);
+		m_layerCache = cache;
+	}
+	if (m_layerCache) {
+		const qint64 effectsSize = m_effectMask.byteCount() + m_hoverEffectImage.byteCount() + m_selectionEffectImage.byteCount();
+		m_layerCache->use(this, m_layersSize + effectsSize);
+	}
+}
 
-		painter->setOpacity(q->selectedOpacity*2);
-		painter->drawImage(boundingRectangle.topLeft(), m_selectionEffectImage, m_pixmap.rect());
-// 		qDebug() << "Paint selection effect: " << timer.elapsed() << "ms";
-		return;
+/*!
+  returns the blurred outline of the curve in the color \c color for the hover and selection effects.
+  The alpha mask of the layers is cached for the resolution \c scale (device pixels per scene unit).
+*/
+QImage XYCurvePrivate::effectImage(const QColor& color, qreal scale) {
+	if (m_effectMask.isNull() || scale != m_effectScale) {
+		m_effectScale = scale;
+		m_hoverEffectImage = QImage();
+		m_selectionEffectImage = QImage();
+
+		m_effectMask = QImage(ceil(boundingRectangle.width()*scale), ceil(boundingRectangle.height()*scale),
+				QImage::Format_ARGB32_Premultiplied);
+		m_effectMask.fill(Qt::transparent);
+		QPainter painter(&m_effectMask);
+		painter.setRenderHint(QPainter::SmoothPixmapTransform, true);
+		painter.scale(scale, scale);
+		painter.translate(-boundingRectangle.topLeft());
+		for (int i = 0; i < layerCount; ++i) {
+			if (!m_layers[i].isNull())
+				painter.drawPixmap(m_layerRects[i].topLeft(), m_layers[i]);
+		}
 	}
+
+	QImage image = m_effectMask;
+	QPainter painter(&image);
+	painter.setCompositionMode(QPainter::CompositionMode_SourceIn);
+	painter.fillRect(image.rect(), color);
+	painter.end();
+	return blurred(image, image.rect(), qBound(1, qRound(5*scale), 17));
 }
 
 /*!
-	Drawing of symbolsPath is very slow, so we draw every symbol in the loop which is much faster (factor 10)
+	On screen, every symbol is rasterized once into a sprite (\sa symbolSprite()) which is blitted
+	at all pixel positions covered by the symbols. When printing and exporting, or for transformations and brushes
+	the sprite can't reproduce, the exact paths are drawn for every symbol.
 */
 void XYCurvePrivate::drawSymbols(QPainter* painter) {
-	QPainterPath path = Symbol::pathFromStyle(symbolsStyle);
-
-	QTransform trafo;
-	trafo.scale(symbolsSize, symbolsSize);
-	path = trafo.map(path);
-	trafo.reset();
-	if (symbolsRotationAngle != 0) {
-		trafo.rotate(symbolsRotationAngle);
-		path = trafo.map(path);
+	const QTransform& world = painter->worldTransform();
+	const Qt::BrushStyle brushStyle = symbolsBrush.style();
+	const bool exact = m_printing || world.type() > QTransform::TxScale
+		|| brushStyle == Qt::LinearGradientPattern || brushStyle == Qt::RadialGradientPattern
+		|| brushStyle == Qt::ConicalGradientPattern || brushStyle == Qt::TexturePattern;
+
+	QPoint offset;
+	const qreal ratio = painter->device()->devicePixelRatio();
+	const QPixmap sprite = exact ? QPixmap() : symbolSprite(world.m11()*ratio, world.m22()*ratio,
+			painter->testRenderHint(QPainter::Antialiasing), offset);
+
+	if (sprite.isNull()) {
+		//drawing of one path containing all symbols is very slow, so we draw every symbol in the loop which is much faster (factor 10)
+		QTransform trafo;
+		foreach (const QPointF& point, symbolPointsScene) {
+			trafo.reset();
+			trafo.translate(point.x(), point.y());
+			painter->drawPath(trafo.map(symbolPath));
+		}
+		return;
 	}
+
+	//positions in device pixels at which the sprite is (partially) visible on the paint device
+	const QRect visibleRect(-offset.x() - sprite.width() + 1, -offset.y() - sprite.height() + 1,
+			painter->device()->width()*ratio + sprite.width(), painter->device()->height()*ratio + sprite.height());
+	std::vector<bool> occupied((size_t)visibleRect.width()*visibleRect.height(), false);
+
+	painter->save();
+	painter->resetTransform();
+	painter->scale(1./ratio, 1./ratio);
 	foreach (const QPointF& point, symbolPointsScene) {
-		trafo.reset();
-		trafo.translate(point.x(), point.y());
-		painter->drawPath(trafo.map(path));
+		const QPointF mapped = world.map(point)*ratio;
+		const int x = qRound(mapped.x()) - visibleRect.left();
+		const int y = qRound(mapped.y()) - visibleRect.top();
+		if (x < 0 || y < 0 || x >= visibleRect.width() || y >= visibleRect.height())
+			continue;
+
+		//draw only one sprite per pixel position
+		const size_t index = (size_t)y*visibleRect.width() + x;
+		if (occupied[index])
+			continue;
+		occupied[index] = true;
+
+		painter->drawPixmap(x + visibleRect.left() + offset.x(), y + visibleRect.top() + offset.y(), sprite);
 	}
+	painter->restore();
+}
+
+/*!
+	returns the sprite of the current symbol for the device scaling factors \c sx and \c sy.
+	The sprites are shared in the global pixmap cache, one for each combination of the symbol properties
+	and the scaling factors. \c offset is set to the position of the top left corner of the sprite
+	relative to the symbol position in device pixels.
+	Returns a null pixmap if the symbol is too large in device pixels to be cached.
+*/
+QPixmap XYCurvePrivate::symbolSprite(qreal sx, qreal sy, bool antialiasing, QPoint& offset) const {
+	const qreal penWidth = (symbolsPen.style() != Qt::NoPen) ? qMax(symbolsPen.widthF(), (qreal)1.) : 0;
+	const QRectF symbolRect = symbolPath.boundingRect().adjusted(-penWidth, -penWidth, penWidth, penWidth);
+	const QRectF deviceRect(symbolRect.left()*sx, symbolRect.top()*sy, symbolRect.width()*sx, symbolRect.height()*sy);
+	offset = QPoint(floor(deviceRect.left()), floor(deviceRect.top()));
+	const QSize size(ceil(deviceRect.right()) - offset.x() + 1, ceil(deviceRect.bottom()) - offset.y() + 1);
+	if (size.width() > 256 || size.height() > 256)
+		return QPixmap();
+
+	const QString key = QString("XYCurveSymbol_%1_%2_%3_%4_%5_%6_%7_%8")
+			.arg((int)symbolsStyle).arg(symbolsSize).arg(symbolsRotationAngle)
+			.arg(symbolsPen.color().rgba()).arg(symbolsPen.widthF()).arg((int)symbolsPen.style())
+			.arg(symbolsBrush.color().rgba()).arg((int)symbolsBrush.style())
+		+ QString("_%1_%2_%3_%4_%5").arg((int)symbolsPen.joinStyle()).arg((int)symbolsPen.capStyle())
+			.arg(sx).arg(sy).arg(antialiasing);
+
+	QPixmap sprite;
+	if (!QPixmapCache::find(key, &sprite)) {
+		sprite = QPixmap(size);
+		sprite.fill(Qt::transparent);
+		QPainter painter(&sprite);
+		painter.setRenderHint(QPainter::Antialiasing, antialiasing);
+		painter.translate(-offset);
+		painter.scale(sx, sy);
+		painter.setPen(symbolsPen);
+		painter.setBrush(symbolsBrush);
+		painter.drawPath(symbolPath);
+		painter.end();
+		QPixmapCache::insert(key, sprite);
+	}
+
+	return sprite;
 }
 
 void XYCurvePrivate::drawValues(QPainter* painter) {
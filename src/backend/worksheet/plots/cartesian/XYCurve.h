@@ -144,6 +144,9 @@ class XYCurve: public WorksheetElement {
 	private slots:
 		void updateValues();
 		void updateErrorBars();
+		void handleRowsInserted(const AbstractColumn*, int before, int count);
+		void xColumnDataChanged();
+		void yColumnDataChanged();
 		void xColumnAboutToBeRemoved(const AbstractAspect*);
 		void yColumnAboutToBeRemoved(const AbstractAspect*);
 		void valuesColumnAboutToBeRemoved(const AbstractAspect*);
@@ -175,6 +178,7 @@ class XYCurve: public WorksheetElement {
 		void dataChanged(); //emitted when the actual curve data to be plotted was changed to re-adjust the plot
 		void xDataChanged();
 		void yDataChanged();
+		void dataAppended(); //emitted when rows were appended to the data columns and only the new rows were processed
 		void visibilityChanged(bool);
 
 		friend class XYCurveSetDataSourceTypeCmd;
@@ -29,43 +29,77 @@
 #ifndef XYCURVEPRIVATE_H
 #define XYCURVEPRIVATE_H
 
+#include "backend/worksheet/WorksheetLayerCache.h"
 #include <QGraphicsItem>
+#include <QPointer>
 #include <vector>
 
 class CartesianPlot;
+class CartesianCoordinateSystem;
 
-class XYCurvePrivate: public QGraphicsItem {
+class XYCurvePrivate: public QGraphicsItem, public WorksheetLayerCache::Client {
 	public:
 		explicit XYCurvePrivate(XYCurve *owner);
+		~XYCurvePrivate();
+
+		//the separately cached parts of the curve, painted in this order
+		enum Layer {FillingLayer = 0x01, LineLayer = 0x02, ErrorBarsLayer = 0x04, SymbolsLayer = 0x08, ValuesLayer = 0x10,
+			AllLayers = 0x1f};
+		static const int layerCount = 5;
 
 		QString name() const;
 		virtual QRectF boundingRect() const;
 		QPainterPath shape() const;
+		virtual bool contains(const QPointF&) const;
+		virtual bool collidesWithPath(const QPainterPath&, Qt::ItemSelectionMode mode = Qt::IntersectsItemShape) const;
 
 		bool m_printing;
 		bool m_hovered;
 		bool m_suppressRecalc;
 		bool m_suppressRetransform;
-		QPixmap m_pixmap;
+		int m_processedRows;	//number of rows of the data columns taken over in retransform()
+		QPixmap m_layers[layerCount];		//cached pixmaps of the layers
+		QRectF m_layerRects[layerCount];	//scene rectangles of the layers
+		int m_dirtyLayers;			//layers to be rendered again before the next paint
+		qint64 m_layersSize;			//size of the cached pixmaps in bytes
+		QPointer<WorksheetLayerCache> m_layerCache;
+		QImage m_effectMask;			//curve at display resolution for the hover and selection effects
+		qreal m_effectScale;
 		QImage m_hoverEffectImage;
 		QImage m_selectionEffectImage;
-		bool m_hoverEffectImageIsDirty;
-		bool m_selectionEffectImageIsDirty;
 
 		void retransform();
+		void retransformAppendedRows();
+		void appendPoints(int startRow, int endRow, const CartesianCoordinateSystem*);
+		int readPoints(int startRow, int endRow, double* x, double* y);
 		void updateLines();
+		void decimateLinePoints(QVector<QPointF>&, std::vector<bool>&) const;
 		void updateDropLines();
 		void updateSymbols();
+		void updateSymbolsGrid();
+		QVector<int> symbolsInRect(const QRectF&) const;
 		void updateValues();
 		void updateFilling();
 		void updateErrorBars();
 		bool swapVisible(bool on);
 		void recalcShapeAndBoundingRect();
 		void drawSymbols(QPainter*);
+		QPixmap symbolSprite(qreal sx, qreal sy, bool antialiasing, QPoint& offset) const;
 		void drawValues(QPainter*);
 		void drawFilling(QPainter*);
 		void draw(QPainter*);
-		void updatePixmap();
+		void drawLayer(QPainter*, int index);
+		void updatePixmap(int layers = AllLayers);
+		void updateLinePixmap();
+		void updateSymbolsPixmap();
+		void updateValuesPixmap();
+		void updateFillingPixmap();
+		void updateErrorBarsPixmap();
+		void recalcLineShape();
+		void recalcErrorBarsShape();
+		void renderLayers();
+		virtual void releaseLayers();
+		QImage effectImage(const QColor&, qreal scale);
 
 		virtual void paint(QPainter*, const QStyleOptionGraphicsItem*, QWidget* widget = 0);
 
@@ -145,12 +179,21 @@ class XYCurvePrivate: public QGraphicsItem {
 		QPainterPath dropLinePath;
 		QPainterPath valuesPath;
 		QPainterPath errorBarsPath;
-		QPainterPath symbolsPath;
+		QPainterPath symbolPath;	//path of a single symbol, scaled and rotated
+		QRectF symbolsBoundingRect;
 		QRectF boundingRectangle;
 		QPainterPath curveShape;
-		QList<QLineF> lines;
+		QVector<QLineF> lines;
 		QList<QPointF> symbolPointsLogical;	//points in logical coordinates
 		QList<QPointF> symbolPointsScene;	//points in scene coordinates
+		//uniform grid of the symbol positions used for the hit-testing, the indices of the points
+		//in the cell i are stored in symbolsGridPoints from symbolsGridCellStart[i] to symbolsGridCellStart[i+1]
+		QRectF symbolsGridRect;
+		qreal symbolsGridCellSize;
+		int symbolsGridColumns;
+		int symbolsGridRows;
+		QVector<int> symbolsGridCellStart;
+		QVector<int> symbolsGridPoints;
 		std::vector<bool> visiblePoints;	//vector of the size of symbolPointsLogical with true of false for the points currently visible or not in the plot
 		QList<QPointF> valuesPoints;
 		std::vector<bool> connectedPointsLogical;  //vector of the size of symbolPointsLogical with true for points connected with the consecutive point and
@@ -39,12 +39,14 @@
 #include "backend/core/column/Column.h"
 #include "backend/lib/commandtemplates.h"
 #include "backend/lib/macros.h"
+#include "backend/worksheet/plots/cartesian/XYAnalysisJob.h"
+#include "backend/worksheet/plots/cartesian/XYAnalysisDataCache.h"
+#include "backend/lib/ScratchArena.h"
 
 #include <cmath>	// isnan
 
 #include <KLocale>
 #include <QIcon>
-#include <QElapsedTimer>
 #include <QThreadPool>
 
 XYDataReductionCurve::XYDataReductionCurve(const QString& name)
@@ -136,12 +138,134 @@ void XYDataReductionCurve::setDataReductionData(const XYDataReductionCurve::Data
 //##############################################################################
 //######################### Private implementation #############################
 //##############################################################################
+/* data reduction of the copied source data in the worker thread */
+class DataReductionJob : public XYAnalysisJob {
+public:
+	DataReductionJob(XYDataReductionCurvePrivate* curve) : m_curve(curve), m_dataReductionData(curve->dataReductionData),
+		m_npoints(0), m_posError(0), m_areaError(0) {
+	}
+
+	QVector<double> xdataVector;
+	QVector<double> ydataVector;
+
+protected:
+	void compute() {
+		const unsigned int n = xdataVector.size();
+
+		//the data is only read and stays shared with XYAnalysisDataCache
+		const double* xdata = xdataVector.constData();
+		const double* ydata = ydataVector.constData();
+
+		// dataReduction settings
+		const nsl_geom_linesim_type type = m_dataReductionData.type;
+		const double tol = m_dataReductionData.tolerance;
+		const double tol2 = m_dataReductionData.tolerance2;
+
+		DEBUG("n =" << n);
+		DEBUG("type:" << nsl_geom_linesim_type_name[type]);
+		DEBUG("tolerance/step:" << tol);
+		DEBUG("tolerance2/repeat/maxtol/region:" << tol2);
+
+		reportProgress(10);
+
+		double calcTolerance = 0;		// calculated tolerance from Douglas-Peucker variant
+		ScratchScope scratch;
+		size_t* index = scratch.allocate<size_t>(n);
+		switch (type) {
+		case nsl_geom_linesim_type_douglas_peucker_variant:	// tol used as number of points
+			m_npoints = tol;
+			calcTolerance = nsl_geom_linesim_douglas_peucker_variant(xdata, ydata, n, m_npoints, index);
+			break;
+		case nsl_geom_linesim_type_douglas_peucker:
+			m_npoints = nsl_geom_linesim_douglas_peucker(xdata, ydata, n, tol, index);
+			break;
+		case nsl_geom_linesim_type_nthpoint:	// tol used as step
+			m_npoints = nsl_geom_linesim_nthpoint(n, (int)tol, index);
+			break;
+		case nsl_geom_linesim_type_raddist:
+			m_npoints = nsl_geom_linesim_raddist(xdata, ydata, n, tol, index);
+			break;
+		case nsl_geom_linesim_type_perpdist:	// tol2 used as repeat
+			m_npoints = nsl_geom_linesim_perpdist_repeat(xdata, ydata, n, tol, tol2, index);
+			break;
+		case nsl_geom_linesim_type_interp:
+			m_npoints = nsl_geom_linesim_interp(xdata, ydata, n, tol, index);
+			break;
+		case nsl_geom_linesim_type_visvalingam_whyatt:
+			m_npoints = nsl_geom_linesim_visvalingam_whyatt(xdata, ydata, n, tol, index);
+			break;
+		case nsl_geom_linesim_type_reumann_witkam:
+			m_npoints = nsl_geom_linesim_reumann_witkam(xdata, ydata, n, tol, index);
+			break;
+		case nsl_geom_linesim_type_opheim:
+			m_npoints = nsl_geom_linesim_opheim(xdata, ydata, n, tol, tol2, index);
+			break;
+		case nsl_geom_linesim_type_lang:	// tol2 used as region
+			m_npoints = nsl_geom_linesim_opheim(xdata, ydata, n, tol, tol2, index);
+			break;
+		}
+
+		DEBUG("npoints =" << m_npoints);
+		if (type == nsl_geom_linesim_type_douglas_peucker_variant) {
+			DEBUG("calculated tolerance =" << calcTolerance);
+		} else
+			Q_UNUSED(calcTolerance);
+
+		reportProgress(80);
+
+		m_xVector.resize(m_npoints);
+		m_yVector.resize(m_npoints);
+		for (unsigned int i = 0; i < m_npoints; i++) {
+			m_xVector[i] = xdata[index[i]];
+			m_yVector[i] = ydata[index[i]];
+		}
+
+		reportProgress(90);
+		m_posError = nsl_geom_linesim_positional_squared_error(xdata, ydata, n, index);
+		m_areaError = nsl_geom_linesim_area_error(xdata, ydata, n, index);
+	}
+
+	void publish() {
+		m_curve->xVector->swap(m_xVector);
+		m_curve->yVector->swap(m_yVector);
+
+		//write the result
+		XYDataReductionCurve::DataReductionResult& dataReductionResult = m_curve->dataReductionResult;
+		dataReductionResult.available = true;
+		dataReductionResult.valid = true;
+		if (m_npoints > 0)
+			dataReductionResult.status = QString("OK");
+		else
+			dataReductionResult.status = QString("FAILURE");
+		dataReductionResult.elapsedTime = elapsedTime();
+		dataReductionResult.npoints = m_npoints;
+		dataReductionResult.posError = m_posError;
+		dataReductionResult.areaError = m_areaError;
+
+		//redraw the curve
+		m_curve->xColumn->invalidateProperties();
+		m_curve->yColumn->invalidateProperties();
+		emit (m_curve->q->dataChanged());
+	}
+
+private:
+	XYDataReductionCurvePrivate* m_curve;
+	const XYDataReductionCurve::DataReductionData m_dataReductionData;
+	QVector<double> m_xVector;
+	QVector<double> m_yVector;
+	size_t m_npoints;
+	double m_posError;
+	double m_areaError;
+};
+
 XYDataReductionCurvePrivate::XYDataReductionCurvePrivate(XYDataReductionCurve* owner) : XYCurvePrivate(owner),
 	xDataColumn(0), yDataColumn(0), 
 	xColumn(0), yColumn(0), 
 	xVector(0), yVector(0), 
 	q(owner)  {
 
+	//the progress of the data reduction running in the worker thread
+	QObject::connect(&scheduler, SIGNAL(progress(int)), q, SIGNAL(completed(int)));
 }
 
 XYDataReductionCurvePrivate::~XYDataReductionCurvePrivate() {
@@ -153,10 +277,10 @@ XYDataReductionCurvePrivate::~XYDataReductionCurvePrivate() {
 // see XYFitCurvePrivate
 
 void XYDataReductionCurvePrivate::recalculate() {
-	QElapsedTimer timer;
-	timer.start();
+	//a running data reduction is not needed anymore
+	scheduler.cancel();
 
-	//create dataReduction result columns if not available yet, clear them otherwise
+	//create dataReduction result columns if not available yet, the previous result is kept until the new one is available
 	if (!xColumn) {
 		xColumn = new Column("x", AbstractColumn::Numeric);
 		yColumn = new Column("y", AbstractColumn::Numeric);
@@ -172,15 +296,16 @@ void XYDataReductionCurvePrivate::recalculate() {
 		q->setXColumn(xColumn);
 		q->setYColumn(yColumn);
 		q->setUndoAware(true);
-	} else {
-		xVector->clear();
-		yVector->clear();
 	}
 
 	// clear the previous result
 	dataReductionResult = XYDataReductionCurve::DataReductionResult();
 
 	if (!xDataColumn || !yDataColumn) {
+		xVector->clear();
+		yVector->clear();
+		xColumn->invalidateProperties();
+		yColumn->invalidateProperties();
 		emit (q->dataChanged());
 		sourceDataChangedSinceLastRecalc = false;
 		return;
@@ -191,130 +316,41 @@ void XYDataReductionCurvePrivate::recalculate() {
 		dataReductionResult.available = true;
 		dataReductionResult.valid = false;
 		dataReductionResult.status = i18n("Number of x and y data points must be equal.");
+		xVector->clear();
+		yVector->clear();
+		xColumn->invalidateProperties();
+		yColumn->invalidateProperties();
 		emit (q->dataChanged());
 		sourceDataChangedSinceLastRecalc = false;
 		return;
 	}
 
-	//copy all valid data point for the data reduction to temporary vectors
-	QVector<double> xdataVector;
-	QVector<double> ydataVector;
+	//copy all valid data point for the data reduction into the job
+	DataReductionJob* job = new DataReductionJob(this);
+	QVector<double>& xdataVector = job->xdataVector;
+	QVector<double>& ydataVector = job->ydataVector;
 	const double xmin = dataReductionData.xRange.first();
 	const double xmax = dataReductionData.xRange.last();
-	for (int row=0; row<xDataColumn->rowCount(); ++row) {
-		//only copy those data where _all_ values (for x and y, if given) are valid
-		if (!std::isnan(xDataColumn->valueAt(row)) && !std::isnan(yDataColumn->valueAt(row))
-			&& !xDataColumn->isMasked(row) && !yDataColumn->isMasked(row)) {
-
-			// only when inside given range
-			if (xDataColumn->valueAt(row) >= xmin && xDataColumn->valueAt(row) <= xmax) {
-				xdataVector.append(xDataColumn->valueAt(row));
-				ydataVector.append(yDataColumn->valueAt(row));
-			}
-		}
-	}
+	XYAnalysisDataCache::instance()->validData(xDataColumn, yDataColumn, xmin, xmax, xdataVector, ydataVector);
 
 	//number of data points to use
 	const unsigned int n = xdataVector.size();
 	if (n < 2) {
+		delete job;
 		dataReductionResult.available = true;
 		dataReductionResult.valid = false;
 		dataReductionResult.status = i18n("Not enough data points available.");
+		xVector->clear();
+		yVector->clear();
+		xColumn->invalidateProperties();
+		yColumn->invalidateProperties();
 		emit (q->dataChanged());
 		sourceDataChangedSinceLastRecalc = false;
 		return;
 	}
 
-	double* xdata = xdataVector.data();
-	double* ydata = ydataVector.data();
-
-	// dataReduction settings
-	const nsl_geom_linesim_type type = dataReductionData.type;
-	const double tol = dataReductionData.tolerance;
-	const double tol2 = dataReductionData.tolerance2;
-
-	DEBUG("n =" << n);
-	DEBUG("type:" << nsl_geom_linesim_type_name[type]);
-	DEBUG("tolerance/step:" << tol);
-	DEBUG("tolerance2/repeat/maxtol/region:" << tol2);
-
-///////////////////////////////////////////////////////////
-	emit q->completed(10);
-
-	size_t npoints = 0;
-	double calcTolerance = 0;		// calculated tolerance from Douglas-Peucker variant
-	size_t *index = (size_t *) malloc(n*sizeof(size_t));
-	switch (type) {
-	case nsl_geom_linesim_type_douglas_peucker_variant:	// tol used as number of points
-		npoints = tol;
-		calcTolerance = nsl_geom_linesim_douglas_peucker_variant(xdata, ydata, n, npoints, index);
-		break;
-	case nsl_geom_linesim_type_douglas_peucker:
-		npoints = nsl_geom_linesim_douglas_peucker(xdata, ydata, n, tol, index);
-		break;
-	case nsl_geom_linesim_type_nthpoint:	// tol used as step
-		npoints = nsl_geom_linesim_nthpoint(n, (int)tol, index);
-		break;
-	case nsl_geom_linesim_type_raddist:
-		npoints = nsl_geom_linesim_raddist(xdata, ydata, n, tol, index);
-		break;
-	case nsl_geom_linesim_type_perpdist:	// tol2 used as repeat
-		npoints = nsl_geom_linesim_perpdist_repeat(xdata, ydata, n, tol, tol2, index);
-		break;
-	case nsl_geom_linesim_type_interp:
-		npoints = nsl_geom_linesim_interp(xdata, ydata, n, tol, index);
-		break;
-	case nsl_geom_linesim_type_visvalingam_whyatt:
-		npoints = nsl_geom_linesim_visvalingam_whyatt(xdata, ydata, n, tol, index);
-		break;
-	case nsl_geom_linesim_type_reumann_witkam:
-		npoints = nsl_geom_linesim_reumann_witkam(xdata, ydata, n, tol, index);
-		break;
-	case nsl_geom_linesim_type_opheim:
-		npoints = nsl_geom_linesim_opheim(xdata, ydata, n, tol, tol2, index);
-		break;
-	case nsl_geom_linesim_type_lang:	// tol2 used as region
-		npoints = nsl_geom_linesim_opheim(xdata, ydata, n, tol, tol2, index);
-		break;
-	}
-
-	DEBUG("npoints =" << npoints);
-	if (type == nsl_geom_linesim_type_douglas_peucker_variant) {
-		DEBUG("calculated tolerance =" << calcTolerance);
-	} else
-		Q_UNUSED(calcTolerance);
-
-	emit q->completed(80);
-
-	xVector->resize(npoints);
-	yVector->resize(npoints);
-	for (unsigned int i = 0; i < npoints; i++) {
-		(*xVector)[i] = xdata[index[i]];
-		(*yVector)[i] = ydata[index[i]];
-	}
-
-	emit q->completed(90);
-	double posError = nsl_geom_linesim_positional_squared_error(xdata, ydata, n, index);
-	double areaError = nsl_geom_linesim_area_error(xdata, ydata, n, index);
-
-	free(index);
-
-///////////////////////////////////////////////////////////
-
-	//write the result
-	dataReductionResult.available = true;
-	dataReductionResult.valid = true;
-	if (npoints > 0)
-		dataReductionResult.status = QString("OK");
-	else
-		dataReductionResult.status = QString("FAILURE");
-	dataReductionResult.elapsedTime = timer.elapsed();
-	dataReductionResult.npoints = npoints;
-	dataReductionResult.posError = posError;
-	dataReductionResult.areaError = areaError;
-
-	//redraw the curve
-	emit (q->dataChanged());
+	//reduce in the worker thread, the result is published in DataReductionJob::publish()
+	scheduler.start(job);
 	sourceDataChangedSinceLastRecalc = false;
 }
 
@@ -325,6 +361,9 @@ void XYDataReductionCurvePrivate::recalculate() {
 void XYDataReductionCurve::save(QXmlStreamWriter* writer) const{
 	Q_D(const XYDataReductionCurve);
 
+	//save the result of a running data reduction
+	const_cast<XYDataReductionCurvePrivate*>(d)->scheduler.waitForDone();
+
 	writer->writeStartElement("xyDataReductionCurve");
 
 	//write xy-curve information
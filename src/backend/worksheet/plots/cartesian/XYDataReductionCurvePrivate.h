@@ -31,6 +31,7 @@
 
 #include "backend/worksheet/plots/cartesian/XYCurvePrivate.h"
 #include "backend/worksheet/plots/cartesian/XYDataReductionCurve.h"
+#include "backend/worksheet/plots/cartesian/XYAnalysisJob.h"
 
 class XYDataReductionCurve;
 class Column;
@@ -54,6 +55,7 @@ class XYDataReductionCurvePrivate: public XYCurvePrivate {
 		Column* yColumn; //<! column used internally for storing the y-values of the result data reduction curve
 		QVector<double>* xVector;
 		QVector<double>* yVector;
+		XYAnalysisScheduler scheduler; //<! runs the data reduction in the worker thread
 
 		XYDataReductionCurve* const q;
 };
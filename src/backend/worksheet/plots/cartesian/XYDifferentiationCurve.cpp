@@ -39,6 +39,8 @@
 #include "backend/core/column/Column.h"
 #include "backend/lib/commandtemplates.h"
 #include "backend/lib/macros.h"
+#include "backend/worksheet/plots/cartesian/XYAnalysisJob.h"
+#include "backend/worksheet/plots/cartesian/XYAnalysisDataCache.h"
 
 #include <cmath>	// isnan
 #include <cfloat>	// DBL_MIN
@@ -48,7 +50,6 @@ extern "C" {
 
 #include <KLocale>
 #include <QIcon>
-#include <QElapsedTimer>
 #include <QThreadPool>
 
 XYDifferentiationCurve::XYDifferentiationCurve(const QString& name)
@@ -140,6 +141,74 @@ void XYDifferentiationCurve::setDifferentiationData(const XYDifferentiationCurve
 //##############################################################################
 //######################### Private implementation #############################
 //##############################################################################
+/* differentiation of the copied source data in the worker thread */
+class DifferentiationJob : public XYAnalysisJob {
+public:
+	DifferentiationJob(XYDifferentiationCurvePrivate* curve) : m_curve(curve), m_differentiationData(curve->differentiationData), m_status(0) {
+	}
+
+	QVector<double> xdataVector;
+	QVector<double> ydataVector;
+
+protected:
+	void compute() {
+		const unsigned int n = xdataVector.size();
+
+		double* xdata = xdataVector.data();
+		double* ydata = ydataVector.data();
+
+		// differentiation settings
+		const nsl_diff_deriv_order_type derivOrder = m_differentiationData.derivOrder;
+		const int accOrder = m_differentiationData.accOrder;
+
+		DEBUG(nsl_diff_deriv_order_name[derivOrder] << "derivative");
+		DEBUG("accuracy order:" << accOrder);
+
+		switch (derivOrder) {
+		case nsl_diff_deriv_order_first:
+			m_status = nsl_diff_first_deriv(xdata, ydata, n, accOrder);
+			break;
+		case nsl_diff_deriv_order_second:
+			m_status = nsl_diff_second_deriv(xdata, ydata, n, accOrder);
+			break;
+		case nsl_diff_deriv_order_third:
+			m_status = nsl_diff_third_deriv(xdata, ydata, n, accOrder);
+			break;
+		case nsl_diff_deriv_order_fourth:
+			m_status = nsl_diff_fourth_deriv(xdata, ydata, n, accOrder);
+			break;
+		case nsl_diff_deriv_order_fifth:
+			m_status = nsl_diff_fifth_deriv(xdata, ydata, n, accOrder);
+			break;
+		case nsl_diff_deriv_order_sixth:
+			m_status = nsl_diff_sixth_deriv(xdata, ydata, n, accOrder);
+			break;
+		}
+	}
+
+	void publish() {
+		m_curve->xVector->swap(xdataVector);
+		m_curve->yVector->swap(ydataVector);
+
+		//write the result
+		XYDifferentiationCurve::DifferentiationResult& differentiationResult = m_curve->differentiationResult;
+		differentiationResult.available = true;
+		differentiationResult.valid = true;
+		differentiationResult.status = QString::number(m_status);
+		differentiationResult.elapsedTime = elapsedTime();
+
+		//redraw the curve
+		m_curve->xColumn->invalidateProperties();
+		m_curve->yColumn->invalidateProperties();
+		emit (m_curve->q->dataChanged());
+	}
+
+private:
+	XYDifferentiationCurvePrivate* m_curve;
+	const XYDifferentiationCurve::DifferentiationData m_differentiationData;
+	int m_status;
+};
+
 XYDifferentiationCurvePrivate::XYDifferentiationCurvePrivate(XYDifferentiationCurve* owner) : XYCurvePrivate(owner),
 	xDataColumn(0), yDataColumn(0),
 	xColumn(0), yColumn(0),
@@ -156,10 +225,10 @@ XYDifferentiationCurvePrivate::~XYDifferentiationCurvePrivate() {
 // ...
 // see XYFitCurvePrivate
 void XYDifferentiationCurvePrivate::recalculate() {
-	QElapsedTimer timer;
-	timer.start();
+	//a running differentiation is not needed anymore
+	scheduler.cancel();
 
-	//create differentiation result columns if not available yet, clear them otherwise
+	//create differentiation result columns if not available yet, the previous result is kept until the new one is available
 	if (!xColumn) {
 		xColumn = new Column("x", AbstractColumn::Numeric);
 		yColumn = new Column("y", AbstractColumn::Numeric);
@@ -175,9 +244,6 @@ void XYDifferentiationCurvePrivate::recalculate() {
 		q->setXColumn(xColumn);
 		q->setYColumn(yColumn);
 		q->setUndoAware(true);
-	} else {
-		xVector->clear();
-		yVector->clear();
 	}
 
 	// clear the previous result
@@ -197,6 +263,10 @@ void XYDifferentiationCurvePrivate::recalculate() {
 	}
 
 	if (!tmpXDataColumn || !tmpYDataColumn) {
+		xVector->clear();
+		yVector->clear();
+		xColumn->invalidateProperties();
+		yColumn->invalidateProperties();
 		emit (q->dataChanged());
 		sourceDataChangedSinceLastRecalc = false;
 		return;
@@ -207,14 +277,19 @@ void XYDifferentiationCurvePrivate::recalculate() {
 		differentiationResult.available = true;
 		differentiationResult.valid = false;
 		differentiationResult.status = i18n("Number of x and y data points must be equal.");
+		xVector->clear();
+		yVector->clear();
+		xColumn->invalidateProperties();
+		yColumn->invalidateProperties();
 		emit (q->dataChanged());
 		sourceDataChangedSinceLastRecalc = false;
 		return;
 	}
 
-	//copy all valid data point for the differentiation to temporary vectors
-	QVector<double> xdataVector;
-	QVector<double> ydataVector;
+	//copy all valid data point for the differentiation into the job
+	DifferentiationJob* job = new DifferentiationJob(this);
+	QVector<double>& xdataVector = job->xdataVector;
+	QVector<double>& ydataVector = job->ydataVector;
 
 	double xmin;
 	double xmax;
@@ -226,78 +301,26 @@ void XYDifferentiationCurvePrivate::recalculate() {
 		xmax = differentiationData.xRange.last();
 	}
 
-	for (int row=0; row<tmpXDataColumn->rowCount(); ++row) {
-		//only copy those data where _all_ values (for x and y, if given) are valid
-		if (!std::isnan(tmpXDataColumn->valueAt(row)) && !std::isnan(tmpYDataColumn->valueAt(row))
-			&& !tmpXDataColumn->isMasked(row) && !tmpYDataColumn->isMasked(row)) {
-
-			// only when inside given range
-			if (tmpXDataColumn->valueAt(row) >= xmin && tmpXDataColumn->valueAt(row) <= xmax) {
-				xdataVector.append(tmpXDataColumn->valueAt(row));
-				ydataVector.append(tmpYDataColumn->valueAt(row));
-			}
-		}
-	}
+	XYAnalysisDataCache::instance()->validData(tmpXDataColumn, tmpYDataColumn, xmin, xmax, xdataVector, ydataVector);
 
 	//number of data points to differentiate
 	const unsigned int n = xdataVector.size();
 	if (n < 3) {
+		delete job;
 		differentiationResult.available = true;
 		differentiationResult.valid = false;
 		differentiationResult.status = i18n("Not enough data points available.");
+		xVector->clear();
+		yVector->clear();
+		xColumn->invalidateProperties();
+		yColumn->invalidateProperties();
 		emit (q->dataChanged());
 		sourceDataChangedSinceLastRecalc = false;
 		return;
 	}
 
-	double* xdata = xdataVector.data();
-	double* ydata = ydataVector.data();
-
-	// differentiation settings
-	const nsl_diff_deriv_order_type derivOrder = differentiationData.derivOrder;
-	const int accOrder = differentiationData.accOrder;
-
-	DEBUG(nsl_diff_deriv_order_name[derivOrder] << "derivative");
-	DEBUG("accuracy order:" << accOrder);
-
-///////////////////////////////////////////////////////////
-	int status=0;
-
-	switch (derivOrder) {
-	case nsl_diff_deriv_order_first:
-		status = nsl_diff_first_deriv(xdata, ydata, n, accOrder);
-		break;
-	case nsl_diff_deriv_order_second:
-		status = nsl_diff_second_deriv(xdata, ydata, n, accOrder);
-		break;
-	case nsl_diff_deriv_order_third:
-		status = nsl_diff_third_deriv(xdata, ydata, n, accOrder);
-		break;
-	case nsl_diff_deriv_order_fourth:
-		status = nsl_diff_fourth_deriv(xdata, ydata, n, accOrder);
-		break;
-	case nsl_diff_deriv_order_fifth:
-		status = nsl_diff_fifth_deriv(xdata, ydata, n, accOrder);
-		break;
-	case nsl_diff_deriv_order_sixth:
-		status = nsl_diff_sixth_deriv(xdata, ydata, n, accOrder);
-		break;
-	}
-
-	xVector->resize(n);
-	yVector->resize(n);
-	memcpy(xVector->data(), xdata, n*sizeof(double));
-	memcpy(yVector->data(), ydata, n*sizeof(double));
-///////////////////////////////////////////////////////////
-
-	//write the result
-	differentiationResult.available = true;
-	differentiationResult.valid = true;
-	differentiationResult.status = QString::number(status);
-	differentiationResult.elapsedTime = timer.elapsed();
-
-	//redraw the curve
-	emit (q->dataChanged());
+	//differentiate in the worker thread, the result is published in DifferentiationJob::publish()
+	scheduler.start(job);
 	sourceDataChangedSinceLastRecalc = false;
 }
 
@@ -308,6 +331,9 @@ void XYDifferentiationCurvePrivate::recalculate() {
 void XYDifferentiationCurve::save(QXmlStreamWriter* writer) const{
 	Q_D(const XYDifferentiationCurve);
 
+	//save the result of a running differentiation
+	const_cast<XYDifferentiationCurvePrivate*>(d)->scheduler.waitForDone();
+
 	writer->writeStartElement("xyDifferentiationCurve");
 
 	//write xy-curve information
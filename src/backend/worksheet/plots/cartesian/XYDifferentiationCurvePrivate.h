@@ -31,6 +31,7 @@
 
 #include "backend/worksheet/plots/cartesian/XYCurvePrivate.h"
 #include "backend/worksheet/plots/cartesian/XYDifferentiationCurve.h"
+#include "backend/worksheet/plots/cartesian/XYAnalysisJob.h"
 
 class XYDifferentiationCurve;
 class Column;
@@ -54,6 +55,7 @@ class XYDifferentiationCurvePrivate: public XYCurvePrivate {
 		Column* yColumn; //<! column used internally for storing the y-values of the result differentiation curve
 		QVector<double>* xVector;
 		QVector<double>* yVector;
+		XYAnalysisScheduler scheduler; //<! runs the differentiation in the worker thread
 
 		XYDifferentiationCurve* const q;
 };
@@ -136,6 +136,8 @@ void XYEquationCurvePrivate::recalculate() {
 			//invalid number of points provided
 			xVector->clear();
 			yVector->clear();
+			xColumn->invalidateProperties();
+			yColumn->invalidateProperties();
 			emit (q->dataChanged());
 			return;
 		}
@@ -162,6 +164,8 @@ void XYEquationCurvePrivate::recalculate() {
 		xVector->clear();
 		yVector->clear();
 	}
+	xColumn->invalidateProperties();
+	yColumn->invalidateProperties();
 	emit (q->dataChanged());
 }
 
@@ -41,6 +41,9 @@
 #include "backend/core/column/Column.h"
 #include "backend/lib/commandtemplates.h"
 #include "backend/lib/macros.h"
+#include "backend/worksheet/plots/cartesian/XYAnalysisJob.h"
+#include "backend/worksheet/plots/cartesian/XYAnalysisDataCache.h"
+#include "backend/lib/ScratchArena.h"
 #include "backend/gsl/ExpressionParser.h"
 
 extern "C" {
@@ -50,13 +53,12 @@ extern "C" {
 #include <gsl/gsl_version.h>
 #include <gsl/gsl_cdf.h>
 #include <gsl/gsl_statistics_double.h>
-#include "backend/gsl/parser.h" 
 #include "backend/nsl/nsl_fit.h"
 #include "backend/nsl/nsl_sf_stats.h"
 }
 #include <cmath>
+#include <cstring>
 
-#include <QElapsedTimer>
 #include <QIcon>
 #include <KLocalizedString>
 #include <QThreadPool>
@@ -202,7 +204,7 @@ struct data {
 	nsl_fit_model_category modelCategory;
 	unsigned int modelType;
 	int degree;
-	QString* func;	// string containing the definition of the model/function
+	const CompiledExpression* func;	// the model/function compiled for the variables x and the parameter names
 	QStringList* paramNames;
 	double* paramMin;	// lower parameter limits
 	double* paramMax;	// upper parameter limits
@@ -221,41 +223,53 @@ int func_f(const gsl_vector* paramValues, void* params, gsl_vector* f) {
 	double* weight = ((struct data*)params)->weight;
 	nsl_fit_model_category modelCategory = ((struct data*)params)->modelCategory;
 	unsigned int modelType = ((struct data*)params)->modelType;
-	QByteArray funcba = ((struct data*)params)->func->toLocal8Bit();	// a local byte array is needed!
+	const CompiledExpression* func = ((struct data*)params)->func;	// function to evaluate
 	QStringList* paramNames = ((struct data*)params)->paramNames;
 	double *min = ((struct data*)params)->paramMin;
 	double *max = ((struct data*)params)->paramMax;
 
-	// set current values of the parameters
-	for (int i = 0; i < paramNames->size(); i++) {
+	// current values of the parameters, the same for all data points
+	const int np = paramNames->size();
+	QVector<double> paramBounded(np);
+	for (int i = 0; i < np; i++) {
 		double x = gsl_vector_get(paramValues, i);
 		// bound values if limits are set
-		assign_variable(paramNames->at(i).toLocal8Bit().data(), nsl_fit_map_bound(x, min[i], max[i]));
+		paramBounded[i] = nsl_fit_map_bound(x, min[i], max[i]);
 		QDEBUG("Parameter"<<i<<" (\" "<<paramNames->at(i).toLocal8Bit().data()<<"\")"<<'['<<min[i]<<','<<max[i]
-			<<"] free/bound:"<<QString::number(x, 'g', 15)<<' '<<QString::number(nsl_fit_map_bound(x, min[i], max[i]), 'g', 15));
+			<<"] free/bound:"<<QString::number(x, 'g', 15)<<' '<<QString::number(paramBounded[i], 'g', 15));
 	}
 
-	const char *func = funcba.data();	// function to evaluate
-	for (size_t i = 0; i < n; i++) {
-		if (std::isnan(x[i]) || std::isnan(y[i]))
-			continue;
+	if (!func->isValid())
+		return GSL_EINVAL;
 
-		// checks for allowed values of x for different models
-		// TODO: more to check
-		if (modelCategory == nsl_fit_model_distribution && modelType == nsl_sf_stats_lognormal) {
+	// checks for allowed values of x for different models
+	// TODO: more to check
+	if (modelCategory == nsl_fit_model_distribution && modelType == nsl_sf_stats_lognormal) {
+		for (size_t i = 0; i < n; i++) {
 			if (x[i] < 0)
 				x[i] = 0;
 		}
+	}
 
-		assign_variable("x", x[i]);
-		double Yi = parse(func);
+	// evaluate the function for all data points at once
+	QVector<const double*> values;
+	QVector<int> strides;
+	values << x;
+	strides << 1;
+	for (int i = 0; i < np; i++) {
+		values << &paramBounded.at(i);
+		strides << 0;
+	}
+	QVector<double> Y(n);
+	func->evaluate(values, strides, Y.data(), n);
 
-//		DEBUG("evaluate function"<<QString(func)<<": f(x["<<i<<"]) ="<<Yi);
+	for (size_t i = 0; i < n; i++) {
+		if (std::isnan(x[i]) || std::isnan(y[i]))
+			continue;
 
-		if (parse_errors() > 0)
-			return GSL_EINVAL;
+//		DEBUG("evaluate function"<<QString(func)<<": f(x["<<i<<"]) ="<<Y[i]);
 
-		gsl_vector_set(f, i, weight[i] * (Yi - y[i]));
+		gsl_vector_set(f, i, weight[i] * (Y[i] - y[i]));
 	}
 
 	return GSL_SUCCESS;
@@ -393,8 +407,9 @@ int func_df(const gsl_vector* paramValues, void* params, gsl_matrix* J) {
 		}
 		case nsl_fit_model_fourier: {	// Y(x) = a0 + (a1*cos(w*x) + b1*sin(w*x)) + ... + (an*cos(n*w*x) + bn*sin(n*w*x)
 			//parameters: w, a0, a1, b1, ... an, bn
-			double a[degree];
-			double b[degree];
+			ScratchScope scratch;
+			double* a = scratch.allocate<double>(degree);
+			double* b = scratch.allocate<double>(degree);
 			double w = nsl_fit_map_bound(gsl_vector_get(paramValues, 0), min[0], max[0]);
 			a[0] = nsl_fit_map_bound(gsl_vector_get(paramValues, 1), min[1], max[1]);
 			b[0] = 0;
@@ -915,44 +930,56 @@ int func_df(const gsl_vector* paramValues, void* params, gsl_matrix* J) {
 		}
 		break;
 	case nsl_fit_model_custom:
-		QByteArray funcba = ((struct data*)params)->func->toLocal8Bit();
-		char* func = funcba.data();
-		QByteArray nameba;
-		double value;
-		const unsigned int np = paramNames->size();
-		for (size_t i = 0; i < n; i++) {
-			x = xVector[i];
-			assign_variable("x", x);
-
-			for (unsigned int j = 0; j < np; j++) {
-				for (unsigned int k = 0; k < np; k++) {
-					if (k != j) {
-						nameba = paramNames->at(k).toLocal8Bit();
-						value = nsl_fit_map_bound(gsl_vector_get(paramValues, k), min[k], max[k]);
-						assign_variable(nameba.data(), value);
-					}
-				}
+		const CompiledExpression* func = ((struct data*)params)->func;
+		const int np = paramNames->size();
+
+		// current values of the parameters
+		QVector<double> paramBounded(np);
+		for (int j = 0; j < np; j++)
+			paramBounded[j] = nsl_fit_map_bound(gsl_vector_get(paramValues, j), min[j], max[j]);
+
+		QVector<const double*> values;
+		QVector<int> strides;
+		values << xVector;
+		strides << 1;
+		for (int j = 0; j < np; j++) {
+			values << &paramBounded.at(j);
+			strides << 0;
+		}
 
-				nameba = paramNames->at(j).toLocal8Bit();
-				char *name = nameba.data();
-				value = nsl_fit_map_bound(gsl_vector_get(paramValues, j), min[j], max[j]);
-				assign_variable(name, value);
-				double f_p = parse(func);
+		// function values for all data points
+		QVector<double> f_p(n);
+		func->evaluate(values, strides, f_p.data(), n);
 
-				double eps = 1.e-9*fabs(f_p);	// adapt step size to value
-				value += eps;
-				assign_variable(name, value);
-				double f_pdp = parse(func);
+		// function values with the j-th parameter shifted by a step size adapted to the function value of every data point
+		QVector<double> eps(n);
+		QVector<double> valuesShifted(n);
+		QVector<double> f_pdp(n);
+		for (size_t i = 0; i < n; i++)
+			eps[i] = 1.e-9*fabs(f_p[i]);
+
+		for (int j = 0; j < np; j++) {
+			if (fixed[j]) {
+				for (size_t i = 0; i < n; i++)
+					gsl_matrix_set(J, i, j, 0.);
+				continue;
+			}
+
+			for (size_t i = 0; i < n; i++)
+				valuesShifted[i] = paramBounded.at(j) + eps[i];
+			values[j+1] = valuesShifted.constData();
+			strides[j+1] = 1;
+			func->evaluate(values, strides, f_pdp.data(), n);
+			values[j+1] = &paramBounded.at(j);
+			strides[j+1] = 0;
 
 //		qDebug()<<"evaluate deriv"<<QString(func)<<": f(x["<<i<<"]) ="<<QString::number(f_p, 'g', 15);
 //		qDebug()<<"evaluate deriv"<<QString(func)<<": f(x["<<i<<"]+dx) ="<<QString::number(f_pdp, 'g', 15);
 //		qDebug()<<"	deriv = "<<QString::number((f_pdp-f_p)/eps/sigma, 'g', 15);
 
-				if (fixed[j])
-					gsl_matrix_set(J, i, j, 0.);
-				else	// calculate finite difference
-					gsl_matrix_set(J, i, j, weight[i]*(f_pdp - f_p)/eps);
-			}
+			// calculate finite difference
+			for (size_t i = 0; i < n; i++)
+				gsl_matrix_set(J, i, j, weight[i]*(f_pdp[i] - f_p[i])/eps[i]);
 		}
 	}
 
@@ -966,11 +993,380 @@ int func_fdf(const gsl_vector* x, void* params, gsl_vector* f, gsl_matrix* J) {
 	return GSL_SUCCESS;
 }
 
+/* fit of the copied source data in the worker thread. The residuals and the fit function are evaluated
+ * with the compiled model in compute() as well, publish() only takes over the results.
+ */
+class FitJob : public XYAnalysisJob {
+public:
+	FitJob(XYFitCurvePrivate* curve) : xmin(0), xmax(0), m_curve(curve), m_fitData(curve->fitData),
+		m_func(curve->fitData.model, QStringList() << "x" << curve->fitData.paramNames) {
+	}
+
+	QVector<double> xdataVector;
+	QVector<double> ydataVector;
+	QVector<double> xerrorVector;
+	QVector<double> yerrorVector;
+	QVector<double> xColumnVector;	//all values of the x-data column, used for the residuals
+	QVector<double> yColumnVector;	//all values of the y-data column, only used for the residuals of the full range
+	double xmin;
+	double xmax;
+
+protected:
+	void compute() {
+		const unsigned int maxIters = m_fitData.maxIterations;	//maximal number of iterations
+		const double delta = m_fitData.eps;		//fit tolerance
+		const unsigned int np = m_fitData.paramNames.size(); //number of fit parameters
+		const size_t n = xdataVector.size();
+
+		double* xdata = xdataVector.data();
+		double* ydata = ydataVector.data();
+		double* xerror = xerrorVector.data();	// size may be 0
+		double* yerror = yerrorVector.data();	// size may be 0
+		DEBUG("x errors " << xerrorVector.size());
+		DEBUG("y errors " << yerrorVector.size());
+		ScratchScope scratch;
+		double* weight = scratch.allocate<double>(n);
+
+		for (size_t i = 0; i < n; i++)
+			weight[i] = 1.;
+
+		switch (m_fitData.weightsType) {
+		case nsl_fit_weight_no:
+			break;
+		case nsl_fit_weight_instrumental:
+			if (yerrorVector.size() > 0)
+				for(size_t i = 0; i < n; i++)
+					weight[i] = 1./gsl_pow_2(yerror[i]);
+			break;
+		case nsl_fit_weight_direct:
+			if (yerrorVector.size() > 0)
+				for(size_t i = 0; i < n; i++)
+					weight[i] = yerror[i];
+			break;
+		case nsl_fit_weight_inverse:
+			if (yerrorVector.size() > 0)
+				for(size_t i = 0; i < n; i++)
+					weight[i] = 1./yerror[i];
+			break;
+		case nsl_fit_weight_statistical:
+			for (size_t i = 0; i < n; i++)
+				weight[i] = 1./ydata[i];
+			break;
+		case nsl_fit_weight_relative:
+			for (size_t i = 0; i < n; i++)
+				weight[i] = 1./gsl_pow_2(ydata[i]);
+			break;
+		case nsl_fit_weight_statistical_fit:
+		case nsl_fit_weight_relative_fit:
+			break;
+		}
+
+		/////////////////////// GSL >= 2 has a complete new interface! But the old one is still supported. ///////////////////////////
+		// GSL >= 2 : "the 'fdf' field of gsl_multifit_function_fdf is now deprecated and does not need to be specified for nonlinear least squares problems"
+		for (unsigned int i = 0; i < np; i++)
+			DEBUG("fixed parameter " << i << ' ' << m_fitData.paramFixed.data()[i]);
+
+		//function to fit
+		gsl_multifit_function_fdf f;
+		struct data params = {n, xdata, ydata, weight, m_fitData.modelCategory, m_fitData.modelType, m_fitData.degree, &m_func, &m_fitData.paramNames, 
+					m_fitData.paramLowerLimits.data(), m_fitData.paramUpperLimits.data(), m_fitData.paramFixed.data()};
+		f.f = &func_f;
+		f.df = &func_df;
+		f.fdf = &func_fdf;
+		f.n = n;
+		f.p = np;
+		f.params = &params;
+
+		// initialize the derivative solver (using Levenberg-Marquardt robust solver)
+		const gsl_multifit_fdfsolver_type* T = gsl_multifit_fdfsolver_lmsder;
+		gsl_multifit_fdfsolver* s = gsl_multifit_fdfsolver_alloc(T, n, np);
+
+		// set start values
+		double* x_init = m_fitData.paramStartValues.data();
+		double* x_min = m_fitData.paramLowerLimits.data();
+		double* x_max = m_fitData.paramUpperLimits.data();
+		// scale start values if limits are set
+		for (unsigned int i = 0; i < np; i++)
+			x_init[i] = nsl_fit_map_unbound(x_init[i], x_min[i], x_max[i]);
+		gsl_vector_view x = gsl_vector_view_array(x_init, np);
+		// initialize solver with function f and initial guess x
+		gsl_multifit_fdfsolver_set(s, &f, &x.vector);
+
+		// iterate
+		int status;
+		unsigned int iter = 0;
+		m_fitResult.solverOutput.clear();
+		writeSolverState(s);
+		do {
+			iter++;
+
+			// update weights for Y-depending weights
+			if (m_fitData.weightsType == nsl_fit_weight_statistical_fit) {
+				for (size_t i = 0; i < n; i++)
+					weight[i] = 1./(gsl_vector_get(s->f, i) + ydata[i]);	// 1/Y_i
+			} else if (m_fitData.weightsType == nsl_fit_weight_relative_fit) {
+				for (size_t i = 0; i < n; i++)
+					weight[i] = 1./gsl_pow_2(gsl_vector_get(s->f, i) + ydata[i]);	// 1/Y_i^2
+			}
+
+			status = gsl_multifit_fdfsolver_iterate(s);
+			writeSolverState(s);
+			if (status) break;
+			status = gsl_multifit_test_delta(s->dx, s->x, delta, delta);
+		} while (status == GSL_CONTINUE && iter < maxIters && !isCanceled());
+
+		// second run for x-error fitting
+		if (xerrorVector.size() > 0) {
+			DEBUG("Rerun fit with x errors");
+
+			// y'(x)
+			double* yd = scratch.allocate<double>(n);
+			for (size_t i = 0; i < n; i++) {
+				size_t index = i;
+				if (index == n-1)
+					index = n-2;
+				yd[i] = gsl_vector_get(s->f, index+1) + ydata[index+1] - gsl_vector_get(s->f, index) - ydata[index];
+				yd[i] /= (xdata[index+1] - xdata[index]);
+			}
+
+			switch (m_fitData.weightsType) {
+			case nsl_fit_weight_no:
+				break;
+			case nsl_fit_weight_instrumental:
+				for (size_t i = 0; i < n; i++) {
+					double sigma;
+					if (yerrorVector.size() > 0)	// x- and y-error
+						// sigma = sqrt(sigma_y^2 + (y'(x)*sigma_x)^2)
+						sigma = sqrt(gsl_pow_2(yerror[i]) + gsl_pow_2(yd[i] * xerror[i]));
+					else	// only x-error
+						sigma = yd[i] * xerror[i];
+					weight[i] = 1./gsl_pow_2(sigma);
+				}
+				break;
+			// other weight types: y'(x) considered correctly?
+			case nsl_fit_weight_direct:
+				for (size_t i = 0; i < n; i++) {
+					weight[i] = xerror[i]/yd[i];
+					if (yerrorVector.size() > 0)
+						weight[i] += yerror[i];
+				}
+				break;
+			case nsl_fit_weight_inverse:
+				for (size_t i = 0; i < n; i++) {
+					weight[i] = yd[i]/xerror[i];
+					if (yerrorVector.size() > 0)
+						weight[i] += 1./yerror[i];
+				}
+				break;
+			case nsl_fit_weight_statistical:
+			case nsl_fit_weight_relative:
+				break;
+			case nsl_fit_weight_statistical_fit:
+				for (size_t i = 0; i < n; i++)
+					weight[i] = 1./(gsl_vector_get(s->f, i) + ydata[i]);	// 1/Y_i
+			case nsl_fit_weight_relative_fit:
+				for (size_t i = 0; i < n; i++)
+					weight[i] = 1./gsl_pow_2(gsl_vector_get(s->f, i) + ydata[i]);	// 1/Y_i^2
+				break;
+			}
+
+			do {
+				iter++;
+				status = gsl_multifit_fdfsolver_iterate(s);
+				writeSolverState(s);
+				if (status) break;
+				status = gsl_multifit_test_delta(s->dx, s->x, delta, delta);
+			} while (status == GSL_CONTINUE && iter < maxIters && !isCanceled());
+		}
+
+
+		// unscale start values
+		for (unsigned int i = 0; i < np; i++)
+			x_init[i] = nsl_fit_map_bound(x_init[i], x_min[i], x_max[i]);
+
+		//get the covariance matrix
+		//TODO: scale the Jacobian when limits are used before constructing the covar matrix?
+		gsl_matrix* covar = gsl_matrix_alloc(np, np);
+#if GSL_MAJOR_VERSION >= 2
+		// the Jacobian is not part of the solver anymore
+		gsl_matrix *J = gsl_matrix_alloc(s->fdf->n, s->fdf->p);
+		gsl_multifit_fdfsolver_jac(s, J);
+		gsl_multifit_covar(J, 0.0, covar);
+#else
+		gsl_multifit_covar(s->J, 0.0, covar);
+#endif
+
+		//write the result
+		m_fitResult.available = true;
+		m_fitResult.valid = true;
+		m_fitResult.status = QString(gsl_strerror(status)); // i18n? GSL does not support translations
+		m_fitResult.iterations = iter;
+		m_fitResult.dof = n - np;
+
+		//gsl_blas_dnrm2() - computes the Euclidian norm (||r||_2 = \sqrt {\sum r_i^2}) of the vector with the elements weight[i]*(Yi - y[i])
+		//gsl_blas_dasum() - computes the absolute sum \sum |r_i| of the elements of the vector with the elements weight[i]*(Yi - y[i])
+		m_fitResult.sse = gsl_pow_2(gsl_blas_dnrm2(s->f));
+		if (m_fitResult.dof != 0) {
+			m_fitResult.rms = m_fitResult.sse/m_fitResult.dof;
+			m_fitResult.rsd = sqrt(m_fitResult.rms);
+		}
+		m_fitResult.mse = m_fitResult.sse/n;
+		m_fitResult.rmse = sqrt(m_fitResult.mse);
+		m_fitResult.mae = gsl_blas_dasum(s->f)/n;
+		//needed for coefficient of determination, R-squared
+		m_fitResult.sst = gsl_stats_tss(ydata, 1, n);
+
+		//parameter values
+		const double c = GSL_MIN_DBL(1., sqrt(m_fitResult.rms)); //limit error for poor fit
+		m_fitResult.paramValues.resize(np);
+		m_fitResult.errorValues.resize(np);
+		for (unsigned int i = 0; i < np; i++) {
+			// scale resulting values if they are bounded
+			m_fitResult.paramValues[i] = nsl_fit_map_bound(gsl_vector_get(s->x, i), x_min[i], x_max[i]);
+			m_fitResult.errorValues[i] = c*sqrt(gsl_matrix_get(covar, i, i));
+		}
+
+		// fill residuals vector. To get residuals on the correct x values, fill the rest with zeros.
+		const int rows = xColumnVector.size();
+		m_residualsVector.resize(rows);
+		if (m_fitData.evaluateFullRange) {	// evaluate full range of residuals
+			if (evaluate(xColumnVector, m_residualsVector)) {
+				for (int i = 0; i < rows; i++)
+					m_residualsVector[i] = yColumnVector.at(i) - m_residualsVector.at(i);
+			} else
+				m_residualsVector.clear();
+		} else {
+			size_t j = 0;
+			for (int i = 0; i < rows; i++) {
+				if (xColumnVector.at(i) >= xmin && xColumnVector.at(i) <= xmax)
+					m_residualsVector[i] = - gsl_vector_get(s->f, j++);
+				else	// outside range
+					m_residualsVector[i] = 0;
+			}
+		}
+
+		//calculate the fit function (vectors)
+		const int points = m_fitData.evaluatedPoints;
+		m_xVector.resize(points);
+		m_yVector.resize(points);
+		const double step = (xmax - xmin)/(double)(points - 1);
+		for (int i = 0; i < points; i++)
+			m_xVector[i] = xmin + step*i;
+		if (!evaluate(m_xVector, m_yVector)) {
+			m_xVector.clear();
+			m_yVector.clear();
+		}
+
+		//free resources
+		gsl_multifit_fdfsolver_free(s);
+		gsl_matrix_free(covar);
+	}
+
+	void publish() {
+		//write the result
+		XYFitCurve::FitResult& fitResult = m_curve->fitResult;
+		fitResult = m_fitResult;
+
+		// use results as start values if desired
+		if (m_fitData.useResults) {
+			XYFitCurve::FitData& fitData = m_curve->fitData;
+			for (int i = 0; i < fitResult.paramValues.size() && i < fitData.paramStartValues.size(); i++) {
+				fitData.paramStartValues[i] = fitResult.paramValues[i];
+				DEBUG("saving parameter " << i << ": " << fitResult.paramValues[i] << ' ' << fitData.paramStartValues.at(i));
+			}
+		}
+
+		//take over the residuals and the fit function calculated in compute()
+		m_curve->residualsVector->swap(m_residualsVector);
+		m_curve->residualsColumn->setChanged();
+		m_curve->xVector->swap(m_xVector);
+		m_curve->yVector->swap(m_yVector);
+
+		fitResult.elapsedTime = elapsedTime();
+
+		//redraw the curve
+		m_curve->xColumn->invalidateProperties();
+		m_curve->yColumn->invalidateProperties();
+		emit (m_curve->q->dataChanged());
+
+		//the start values were replaced by the results
+		if (m_fitData.useResults)
+			emit (m_curve->q->fitDataChanged(m_curve->fitData));
+	}
+
+private:
+	/*!
+	 * evaluates the model with the resulting parameter values for the x-values \c x into \c y,
+	 * \c y has to have the size of \c x. Returns \c false if the model is not valid.
+	 */
+	bool evaluate(const QVector<double>& x, QVector<double>& y) const {
+		if (!m_func.isValid())
+			return false;
+
+		//x-values are different for every point, the parameter values are the same for all points
+		QVector<const double*> values;
+		QVector<int> strides;
+		values << x.constData();
+		strides << 1;
+		for (int i = 0; i < m_fitResult.paramValues.size(); ++i) {
+			values << &m_fitResult.paramValues.at(i);
+			strides << 0;
+		}
+
+		m_func.evaluate(values, strides, y.data(), x.size());
+		for (int i = 0; i < y.size(); ++i) {
+			if (!std::isfinite(y.at(i)))
+				y[i] = NAN;
+		}
+
+		return true;
+	}
+
+	/*!
+	 * writes out the current state of the solver \c s
+	 */
+	void writeSolverState(gsl_multifit_fdfsolver* s) {
+		QString state;
+
+		//current parameter values, semicolon separated
+		double* min = m_fitData.paramLowerLimits.data();
+		double* max = m_fitData.paramUpperLimits.data();
+		for (int i = 0; i < m_fitData.paramNames.size(); ++i) {
+			double x = gsl_vector_get(s->x, i);
+			// map parameter if bounded
+			state += QString::number(nsl_fit_map_bound(x, min[i], max[i])) + '\t';
+		}
+
+		//current value of the chi2-function
+		state += QString::number(gsl_pow_2(gsl_blas_dnrm2(s->f)));
+		state += ';';
+
+		m_fitResult.solverOutput += state;
+	}
+
+	XYFitCurvePrivate* m_curve;
+	XYFitCurve::FitData m_fitData;
+	const CompiledExpression m_func;
+	XYFitCurve::FitResult m_fitResult;
+	QVector<double> m_residualsVector;
+	QVector<double> m_xVector;
+	QVector<double> m_yVector;
+};
+
+//copies the values in the first \c rows rows of \c column into \c vector
+static void copyValues(const AbstractColumn* column, int rows, QVector<double>& vector) {
+	vector.resize(rows);
+	double* data = vector.data();
+	AbstractColumn::SpanReader reader(column, 0, rows - 1);
+	while (reader.next())
+		memcpy(data + reader.first(), reader.values(), reader.count()*sizeof(double));
+}
+
 void XYFitCurvePrivate::recalculate() {
-	QElapsedTimer timer;
-	timer.start();
+	//a running fit is not needed anymore
+	scheduler.cancel();
 
-	//create fit result columns if not available yet, clear them otherwise
+	//create fit result columns if not available yet, the previous result is kept until the new one is available
 	if (!xColumn) {
 		xColumn = new Column("x", AbstractColumn::Numeric);
 		yColumn = new Column("y", AbstractColumn::Numeric);
@@ -991,23 +1387,22 @@ void XYFitCurvePrivate::recalculate() {
 		q->setXColumn(xColumn);
 		q->setYColumn(yColumn);
 		q->setUndoAware(true);
-	} else {
-		xVector->clear();
-		yVector->clear();
-		residualsVector->clear();
 	}
 
 	// clear the previous result
 	fitResult = XYFitCurve::FitResult();
 
 	//fit settings
-	const unsigned int maxIters = fitData.maxIterations;	//maximal number of iterations
-	const double delta = fitData.eps;		//fit tolerance
 	const unsigned int np = fitData.paramNames.size(); //number of fit parameters
 	if (np == 0) {
 		fitResult.available = true;
 		fitResult.valid = false;
 		fitResult.status = i18n("Model has no parameters.");
+		xVector->clear();
+		yVector->clear();
+		residualsVector->clear();
+		xColumn->invalidateProperties();
+		yColumn->invalidateProperties();
 		emit (q->dataChanged());
 		sourceDataChangedSinceLastRecalc = false;
 		return;
@@ -1027,6 +1422,11 @@ void XYFitCurvePrivate::recalculate() {
 	}
 
 	if (!tmpXDataColumn || !tmpYDataColumn) {
+		xVector->clear();
+		yVector->clear();
+		residualsVector->clear();
+		xColumn->invalidateProperties();
+		yColumn->invalidateProperties();
 		emit (q->dataChanged());
 		sourceDataChangedSinceLastRecalc = false;
 		return;
@@ -1037,6 +1437,11 @@ void XYFitCurvePrivate::recalculate() {
 		fitResult.available = true;
 		fitResult.valid = false;
 		fitResult.status = i18n("Number of x and y data points must be equal.");
+		xVector->clear();
+		yVector->clear();
+		residualsVector->clear();
+		xColumn->invalidateProperties();
+		yColumn->invalidateProperties();
 		emit (q->dataChanged());
 		sourceDataChangedSinceLastRecalc = false;
 		return;
@@ -1047,17 +1452,23 @@ void XYFitCurvePrivate::recalculate() {
 			fitResult.available = true;
 			fitResult.valid = false;
 			fitResult.status = i18n("Not sufficient weight data points provided.");
+			xVector->clear();
+			yVector->clear();
+			residualsVector->clear();
+			xColumn->invalidateProperties();
+			yColumn->invalidateProperties();
 			emit (q->dataChanged());
 			sourceDataChangedSinceLastRecalc = false;
 			return;
 		}
 	}
 
-	//copy all valid data point for the fit to temporary vectors
-	QVector<double> xdataVector;
-	QVector<double> ydataVector;
-	QVector<double> xerrorVector;
-	QVector<double> yerrorVector;
+	//copy all valid data point for the fit into the job
+	FitJob* job = new FitJob(this);
+	QVector<double>& xdataVector = job->xdataVector;
+	QVector<double>& ydataVector = job->ydataVector;
+	QVector<double>& xerrorVector = job->xerrorVector;
+	QVector<double>& yerrorVector = job->yerrorVector;
 	double xmin;
 	double xmax;
 	if (fitData.autoRange) {
@@ -1068,28 +1479,29 @@ void XYFitCurvePrivate::recalculate() {
 		xmax = fitData.xRange.last();
 	}
 
-	for (int row=0; row<tmpXDataColumn->rowCount(); ++row) {
-		//only copy those data where _all_ values (for x and y and errors, if given) are valid
-		if (!std::isnan(tmpXDataColumn->valueAt(row)) && !std::isnan(tmpYDataColumn->valueAt(row))
-			&& !tmpXDataColumn->isMasked(row) && !tmpYDataColumn->isMasked(row)) {
-
-			// only when inside given range
-			if (tmpXDataColumn->valueAt(row) >= xmin && tmpXDataColumn->valueAt(row) <= xmax) {
-				if (dataSourceType == XYCurve::DataSourceCurve || (!xErrorColumn && !yErrorColumn)) {	// x-y
-					xdataVector.append(tmpXDataColumn->valueAt(row));
-					ydataVector.append(tmpYDataColumn->valueAt(row));
-				} else if (!xErrorColumn) {		// x-y-dy
-					if (!std::isnan(yErrorColumn->valueAt(row))) {
-						xdataVector.append(tmpXDataColumn->valueAt(row));
-						ydataVector.append(tmpYDataColumn->valueAt(row));
-						yerrorVector.append(yErrorColumn->valueAt(row));
-					}
-				} else {				// x-y-dx-dy
-					if (!std::isnan(xErrorColumn->valueAt(row)) && !std::isnan(yErrorColumn->valueAt(row))) {
-						xdataVector.append(tmpXDataColumn->valueAt(row));
-						ydataVector.append(tmpYDataColumn->valueAt(row));
-						xerrorVector.append(xErrorColumn->valueAt(row));
-						yerrorVector.append(yErrorColumn->valueAt(row));
+	if (dataSourceType == XYCurve::DataSourceCurve || (!xErrorColumn && !yErrorColumn)) {	// x-y
+		XYAnalysisDataCache::instance()->validData(tmpXDataColumn, tmpYDataColumn, xmin, xmax, xdataVector, ydataVector);
+	} else {
+		for (int row=0; row<tmpXDataColumn->rowCount(); ++row) {
+			//only copy those data where _all_ values (for x and y and errors, if given) are valid
+			if (!std::isnan(tmpXDataColumn->valueAt(row)) && !std::isnan(tmpYDataColumn->valueAt(row))
+				&& !tmpXDataColumn->isMasked(row) && !tmpYDataColumn->isMasked(row)) {
+
+				// only when inside given range
+				if (tmpXDataColumn->valueAt(row) >= xmin && tmpXDataColumn->valueAt(row) <= xmax) {
+					if (!xErrorColumn) {		// x-y-dy
+						if (!std::isnan(yErrorColumn->valueAt(row))) {
+							xdataVector.append(tmpXDataColumn->valueAt(row));
+							ydataVector.append(tmpYDataColumn->valueAt(row));
+							yerrorVector.append(yErrorColumn->valueAt(row));
+						}
+					} else {				// x-y-dx-dy
+						if (!std::isnan(xErrorColumn->valueAt(row)) && !std::isnan(yErrorColumn->valueAt(row))) {
+							xdataVector.append(tmpXDataColumn->valueAt(row));
+							ydataVector.append(tmpYDataColumn->valueAt(row));
+							xerrorVector.append(xErrorColumn->valueAt(row));
+							yerrorVector.append(yErrorColumn->valueAt(row));
+						}
 					}
 				}
 			}
@@ -1099,308 +1511,55 @@ void XYFitCurvePrivate::recalculate() {
 	const size_t n = xdataVector.size();
 	DEBUG("number of data points: " << n);
 	if (n == 0) {
+		delete job;
 		fitResult.available = true;
 		fitResult.valid = false;
 		fitResult.status = i18n("No data points available.");
+		xVector->clear();
+		yVector->clear();
+		residualsVector->clear();
+		xColumn->invalidateProperties();
+		yColumn->invalidateProperties();
 		emit (q->dataChanged());
 		sourceDataChangedSinceLastRecalc = false;
 		return;
 	}
 
 	if (n < np) {
+		delete job;
 		fitResult.available = true;
 		fitResult.valid = false;
 		fitResult.status = i18n("The number of data points (%1) must be greater than or equal to the number of parameters (%2).", n, np);
+		xVector->clear();
+		yVector->clear();
+		residualsVector->clear();
+		xColumn->invalidateProperties();
+		yColumn->invalidateProperties();
 		emit (q->dataChanged());
 		sourceDataChangedSinceLastRecalc = false;
 		return;
 	}
 
-	double* xdata = xdataVector.data();
-	double* ydata = ydataVector.data();
-	double* xerror = xerrorVector.data();	// size may be 0
-	double* yerror = yerrorVector.data();	// size may be 0
-	DEBUG("x errors " << xerrorVector.size());
-	DEBUG("y errors " << yerrorVector.size());
-	double* weight = new double[n];
-
-	for (size_t i = 0; i < n; i++)
-		weight[i] = 1.;
-
-	switch (fitData.weightsType) {
-	case nsl_fit_weight_no:
-		break;
-	case nsl_fit_weight_instrumental:
-		if (yerrorVector.size() > 0)
-			for(size_t i = 0; i < n; i++)
-				weight[i] = 1./gsl_pow_2(yerror[i]);
-		break;
-	case nsl_fit_weight_direct:
-		if (yerrorVector.size() > 0)
-			for(size_t i = 0; i < n; i++)
-				weight[i] = yerror[i];
-		break;
-	case nsl_fit_weight_inverse:
-		if (yerrorVector.size() > 0)
-			for(size_t i = 0; i < n; i++)
-				weight[i] = 1./yerror[i];
-		break;
-	case nsl_fit_weight_statistical:
-		for (size_t i = 0; i < n; i++)
-			weight[i] = 1./ydata[i];
-		break;
-	case nsl_fit_weight_relative:
-		for (size_t i = 0; i < n; i++)
-			weight[i] = 1./gsl_pow_2(ydata[i]);
-		break;
-	case nsl_fit_weight_statistical_fit:
-	case nsl_fit_weight_relative_fit:
-		break;
-	}
-
-	/////////////////////// GSL >= 2 has a complete new interface! But the old one is still supported. ///////////////////////////
-	// GSL >= 2 : "the 'fdf' field of gsl_multifit_function_fdf is now deprecated and does not need to be specified for nonlinear least squares problems"
-	for (unsigned int i = 0; i < np; i++)
-		DEBUG("fixed parameter " << i << ' ' << fitData.paramFixed.data()[i]);
-
-	//function to fit
-	gsl_multifit_function_fdf f;
-	struct data params = {n, xdata, ydata, weight, fitData.modelCategory, fitData.modelType, fitData.degree, &fitData.model, &fitData.paramNames, 
-				fitData.paramLowerLimits.data(), fitData.paramUpperLimits.data(), fitData.paramFixed.data()};
-	f.f = &func_f;
-	f.df = &func_df;
-	f.fdf = &func_fdf;
-	f.n = n;
-	f.p = np;
-	f.params = &params;
-
-	// initialize the derivative solver (using Levenberg-Marquardt robust solver)
-	const gsl_multifit_fdfsolver_type* T = gsl_multifit_fdfsolver_lmsder;
-	gsl_multifit_fdfsolver* s = gsl_multifit_fdfsolver_alloc(T, n, np);
-
-	// set start values
-	double* x_init = fitData.paramStartValues.data();
-	double* x_min = fitData.paramLowerLimits.data();
-	double* x_max = fitData.paramUpperLimits.data();
-	// scale start values if limits are set
-	for (unsigned int i = 0; i < np; i++)
-		x_init[i] = nsl_fit_map_unbound(x_init[i], x_min[i], x_max[i]);
-	gsl_vector_view x = gsl_vector_view_array(x_init, np);
-	// initialize solver with function f and initial guess x
-	gsl_multifit_fdfsolver_set(s, &f, &x.vector);
-
-	// iterate
-	int status;
-	unsigned int iter = 0;
-	fitResult.solverOutput.clear();
-	writeSolverState(s);
-	do {
-		iter++;
-
-		// update weights for Y-depending weights
-		if (fitData.weightsType == nsl_fit_weight_statistical_fit) {
-			for (size_t i = 0; i < n; i++)
-				weight[i] = 1./(gsl_vector_get(s->f, i) + ydata[i]);	// 1/Y_i
-		} else if (fitData.weightsType == nsl_fit_weight_relative_fit) {
-			for (size_t i = 0; i < n; i++)
-				weight[i] = 1./gsl_pow_2(gsl_vector_get(s->f, i) + ydata[i]);	// 1/Y_i^2
-		}
-
-		status = gsl_multifit_fdfsolver_iterate(s);
-		writeSolverState(s);
-		if (status) break;
-		status = gsl_multifit_test_delta(s->dx, s->x, delta, delta);
-	} while (status == GSL_CONTINUE && iter < maxIters);
-
-	// second run for x-error fitting
-	if (xerrorVector.size() > 0) {
-		DEBUG("Rerun fit with x errors");
-
-		// y'(x)
-		double *yd = new double[n];
-		for (size_t i = 0; i < n; i++) {
-			size_t index = i;
-			if (index == n-1)
-				index = n-2;
-			yd[i] = gsl_vector_get(s->f, index+1) + ydata[index+1] - gsl_vector_get(s->f, index) - ydata[index];
-			yd[i] /= (xdata[index+1] - xdata[index]);
-		}
-
-		switch (fitData.weightsType) {
-		case nsl_fit_weight_no:
-			break;
-		case nsl_fit_weight_instrumental:
-			for (size_t i = 0; i < n; i++) {
-				double sigma;
-				if (yerrorVector.size() > 0)	// x- and y-error
-					// sigma = sqrt(sigma_y^2 + (y'(x)*sigma_x)^2)
-					sigma = sqrt(gsl_pow_2(yerror[i]) + gsl_pow_2(yd[i] * xerror[i]));
-				else	// only x-error
-					sigma = yd[i] * xerror[i];
-				weight[i] = 1./gsl_pow_2(sigma);
-			}
-			break;
-		// other weight types: y'(x) considered correctly?
-		case nsl_fit_weight_direct:
-			for (size_t i = 0; i < n; i++) {
-				weight[i] = xerror[i]/yd[i];
-				if (yerrorVector.size() > 0)
-					weight[i] += yerror[i];
-			}
-			break;
-		case nsl_fit_weight_inverse:
-			for (size_t i = 0; i < n; i++) {
-				weight[i] = yd[i]/xerror[i];
-				if (yerrorVector.size() > 0)
-					weight[i] += 1./yerror[i];
-			}
-			break;
-		case nsl_fit_weight_statistical:
-		case nsl_fit_weight_relative:
-			break;
-		case nsl_fit_weight_statistical_fit:
-			for (size_t i = 0; i < n; i++)
-				weight[i] = 1./(gsl_vector_get(s->f, i) + ydata[i]);	// 1/Y_i
-		case nsl_fit_weight_relative_fit:
-			for (size_t i = 0; i < n; i++)
-				weight[i] = 1./gsl_pow_2(gsl_vector_get(s->f, i) + ydata[i]);	// 1/Y_i^2
-			break;
-		}
-		delete[] yd;
-
-		do {
-			iter++;
-			status = gsl_multifit_fdfsolver_iterate(s);
-			writeSolverState(s);
-			if (status) break;
-			status = gsl_multifit_test_delta(s->dx, s->x, delta, delta);
-		} while (status == GSL_CONTINUE && iter < maxIters);
-	}
-
-	delete[] weight;
+	//copy the source data needed for the residuals
+	const int rows = tmpXDataColumn->rowCount();
+	copyValues(tmpXDataColumn, rows, job->xColumnVector);
+	if (fitData.evaluateFullRange)
+		copyValues(tmpYDataColumn, rows, job->yColumnVector);
 
-	// unscale start values
-	for (unsigned int i = 0; i < np; i++)
-		x_init[i] = nsl_fit_map_bound(x_init[i], x_min[i], x_max[i]);
-
-	//get the covariance matrix
-	//TODO: scale the Jacobian when limits are used before constructing the covar matrix?
-	gsl_matrix* covar = gsl_matrix_alloc(np, np);
-#if GSL_MAJOR_VERSION >= 2
-	// the Jacobian is not part of the solver anymore
-	gsl_matrix *J = gsl_matrix_alloc(s->fdf->n, s->fdf->p);
-	gsl_multifit_fdfsolver_jac(s, J);
-	gsl_multifit_covar(J, 0.0, covar);
-#else
-	gsl_multifit_covar(s->J, 0.0, covar);
-#endif
-
-	//write the result
-	fitResult.available = true;
-	fitResult.valid = true;
-	fitResult.status = QString(gsl_strerror(status)); // i18n? GSL does not support translations
-	fitResult.iterations = iter;
-	fitResult.dof = n - np;
-
-	//gsl_blas_dnrm2() - computes the Euclidian norm (||r||_2 = \sqrt {\sum r_i^2}) of the vector with the elements weight[i]*(Yi - y[i])
-	//gsl_blas_dasum() - computes the absolute sum \sum |r_i| of the elements of the vector with the elements weight[i]*(Yi - y[i])
-	fitResult.sse = gsl_pow_2(gsl_blas_dnrm2(s->f));
-	if (fitResult.dof != 0) {
-		fitResult.rms = fitResult.sse/fitResult.dof;
-		fitResult.rsd = sqrt(fitResult.rms);
-	}
-	fitResult.mse = fitResult.sse/n;
-	fitResult.rmse = sqrt(fitResult.mse);
-	fitResult.mae = gsl_blas_dasum(s->f)/n;
-	//needed for coefficient of determination, R-squared
-	fitResult.sst = gsl_stats_tss(ydata, 1, n);
-
-	//parameter values
-	const double c = GSL_MIN_DBL(1., sqrt(fitResult.rms)); //limit error for poor fit
-	fitResult.paramValues.resize(np);
-	fitResult.errorValues.resize(np);
-	for (unsigned int i = 0; i < np; i++) {
-		// scale resulting values if they are bounded
-		fitResult.paramValues[i] = nsl_fit_map_bound(gsl_vector_get(s->x, i), x_min[i], x_max[i]);
-		// use results as start values if desired
-		if (fitData.useResults) {
-			fitData.paramStartValues.data()[i] = fitResult.paramValues[i];
-			DEBUG("saving parameter " << i << ": " << fitResult.paramValues[i] << ' ' << fitData.paramStartValues.data()[i]);
-		}
-		fitResult.errorValues[i] = c*sqrt(gsl_matrix_get(covar, i, i));
-	}
-
-	// fill residuals vector. To get residuals on the correct x values, fill the rest with zeros.
-	residualsVector->resize(tmpXDataColumn->rowCount());
-	if (fitData.evaluateFullRange) {	// evaluate full range of residuals
-		xVector->resize(tmpXDataColumn->rowCount());
-		for (int i = 0; i < tmpXDataColumn->rowCount(); i++)
-			(*xVector)[i] = tmpXDataColumn->valueAt(i);
-		ExpressionParser* parser = ExpressionParser::getInstance();
-		bool rc = parser->evaluateCartesian(fitData.model, xVector, residualsVector,
-							fitData.paramNames, fitResult.paramValues);
-		for (int i = 0; i < tmpXDataColumn->rowCount(); i++)
-			(*residualsVector)[i] = tmpYDataColumn->valueAt(i) - (*residualsVector)[i];
-		if (!rc)
-			residualsVector->clear();
-	} else {	// only selected range
-		size_t j = 0;
-		for (int i = 0; i < tmpXDataColumn->rowCount(); i++) {
-			if (tmpXDataColumn->valueAt(i) >= xmin && tmpXDataColumn->valueAt(i) <= xmax)
-				residualsVector->data()[i] = - gsl_vector_get(s->f, j++);
-			else	// outside range
-				residualsVector->data()[i] = 0;
-		}
-	}
-	residualsColumn->setChanged();
-
-	//free resources
-	gsl_multifit_fdfsolver_free(s);
-	gsl_matrix_free(covar);
-
-	//calculate the fit function (vectors)
-	ExpressionParser* parser = ExpressionParser::getInstance();
-	if (fitData.evaluateFullRange) { // evaluate fit on full data range if selected
-		xmin = tmpXDataColumn->minimum();
-		xmax = tmpXDataColumn->maximum();
-	}
-	xVector->resize(fitData.evaluatedPoints);
-	yVector->resize(fitData.evaluatedPoints);
-	bool rc = parser->evaluateCartesian(fitData.model, QString::number(xmin), QString::number(xmax), fitData.evaluatedPoints, xVector, yVector,
-						fitData.paramNames, fitResult.paramValues);
-	if (!rc) {
-		xVector->clear();
-		yVector->clear();
+	//the fit function is evaluated on the full data range if selected
+	if (fitData.evaluateFullRange) {
+		job->xmin = tmpXDataColumn->minimum();
+		job->xmax = tmpXDataColumn->maximum();
+	} else {
+		job->xmin = xmin;
+		job->xmax = xmax;
 	}
 
-	fitResult.elapsedTime = timer.elapsed();
-
-	//redraw the curve
-	emit (q->dataChanged());
+	//fit in the worker thread, the result is published in FitJob::publish()
+	scheduler.start(job);
 	sourceDataChangedSinceLastRecalc = false;
 }
 
-/*!
- * writes out the current state of the solver \c s
- */
-void XYFitCurvePrivate::writeSolverState(gsl_multifit_fdfsolver* s) {
-	QString state;
-
-	//current parameter values, semicolon separated
-	double* min = fitData.paramLowerLimits.data();
-	double* max = fitData.paramUpperLimits.data();
-	for (int i = 0; i < fitData.paramNames.size(); ++i) {
-		double x = gsl_vector_get(s->x, i);
-		// map parameter if bounded
-		state += QString::number(nsl_fit_map_bound(x, min[i], max[i])) + '\t';
-	}
-
-	//current value of the chi2-function
-	state += QString::number(gsl_pow_2(gsl_blas_dnrm2(s->f)));
-	state += ';';
-
-	fitResult.solverOutput += state;
-}
 
 
 //##############################################################################
@@ -1410,6 +1569,9 @@ void XYFitCurvePrivate::writeSolverState(gsl_multifit_fdfsolver* s) {
 void XYFitCurve::save(QXmlStreamWriter* writer) const {
 	Q_D(const XYFitCurve);
 
+	//save the result of a running fit
+	const_cast<XYFitCurvePrivate*>(d)->scheduler.waitForDone();
+
 	writer->writeStartElement("xyFitCurve");
 
 	//write xy-curve information
@@ -31,6 +31,7 @@
 
 #include "backend/worksheet/plots/cartesian/XYCurvePrivate.h"
 #include "backend/worksheet/plots/cartesian/XYFitCurve.h"
+#include "backend/worksheet/plots/cartesian/XYAnalysisJob.h"
 
 class XYFitCurve;
 class Column;
@@ -65,11 +66,9 @@ class XYFitCurvePrivate: public XYCurvePrivate {
 		QVector<double>* xVector;
 		QVector<double>* yVector;
 		QVector<double>* residualsVector;
+		XYAnalysisScheduler scheduler; //<! runs the fit in the worker thread
 
 		XYFitCurve* const q;
-
-	private:
-		void writeSolverState(gsl_multifit_fdfsolver* s);
 };
 
 #endif
@@ -39,6 +39,8 @@
 #include "backend/core/column/Column.h"
 #include "backend/lib/commandtemplates.h"
 #include "backend/lib/macros.h"
+#include "backend/worksheet/plots/cartesian/XYAnalysisJob.h"
+#include "backend/worksheet/plots/cartesian/XYAnalysisDataCache.h"
 
 #include <cmath>	// isnan
 extern "C" {
@@ -52,7 +54,6 @@ extern "C" {
 }
 
 #include <KLocale>
-#include <QElapsedTimer>
 #include <QIcon>
 #include <QThreadPool>
 
@@ -145,6 +146,106 @@ void XYFourierFilterCurve::setFilterData(const XYFourierFilterCurve::FilterData&
 //##############################################################################
 //######################### Private implementation #############################
 //##############################################################################
+/* Fourier filter of the copied source data in the worker thread */
+class FourierFilterJob : public XYAnalysisJob {
+public:
+	FourierFilterJob(XYFourierFilterCurvePrivate* curve) : xmin(0), xmax(0), m_curve(curve), m_filterData(curve->filterData), m_valid(true), m_status(0) {
+	}
+
+	QVector<double> xdataVector;
+	QVector<double> ydataVector;
+	double xmin;
+	double xmax;
+
+protected:
+	void compute() {
+		const unsigned int n = xdataVector.size();
+
+		//double* xdata = xdataVector.data();
+		double* ydata = ydataVector.data();
+
+		// filter settings
+		const nsl_filter_type type = m_filterData.type;
+		const nsl_filter_form form = m_filterData.form;
+		const unsigned int order = m_filterData.order;
+		const double cutoff = m_filterData.cutoff, cutoff2 = m_filterData.cutoff2;
+		const nsl_filter_cutoff_unit unit = m_filterData.unit, unit2 = m_filterData.unit2;
+
+		DEBUG("n ="<<n);
+		DEBUG("type:"<<nsl_filter_type_name[type]);
+		DEBUG("form (order "<<order<<") :"<<nsl_filter_form_name[form]);
+		DEBUG("cutoffs ="<<cutoff<<cutoff2);
+		DEBUG("unit :"<<nsl_filter_cutoff_unit_name[unit]<<nsl_filter_cutoff_unit_name[unit2]);
+
+		// calculate index
+		double cutindex=0, cutindex2=0;
+		switch (unit) {
+		case nsl_filter_cutoff_unit_frequency:
+			cutindex = cutoff*(xmax-xmin);
+			break;
+		case nsl_filter_cutoff_unit_fraction:
+			cutindex = cutoff*n;
+			break;
+		case nsl_filter_cutoff_unit_index:
+			cutindex = cutoff;
+		}
+		switch (unit2) {
+		case nsl_filter_cutoff_unit_frequency:
+			cutindex2 = cutoff2*(xmax-xmin);
+			break;
+		case nsl_filter_cutoff_unit_fraction:
+			cutindex2 = cutoff2*n;
+			break;
+		case nsl_filter_cutoff_unit_index:
+			cutindex2 = cutoff2;
+		}
+		const double bandwidth = (cutindex2 - cutindex);
+		if ((type == nsl_filter_type_band_pass || type == nsl_filter_type_band_reject) && bandwidth <= 0) {
+			qWarning()<<"band width must be > 0. Giving up.";
+			m_valid = false;
+			return;
+		}
+
+		DEBUG("cut off @" << cutindex << cutindex2);
+		DEBUG("bandwidth =" << bandwidth);
+
+		// run filter
+		m_status = nsl_filter_fourier(ydata, n, type, form, order, cutindex, bandwidth);
+
+		m_xVector.resize(n);
+		m_yVector.resize(n);
+		memcpy(m_xVector.data(), xdataVector.constData(), n*sizeof(double));
+		memcpy(m_yVector.data(), ydata, n*sizeof(double));
+	}
+
+	void publish() {
+		m_curve->xVector->swap(m_xVector);
+		m_curve->yVector->swap(m_yVector);
+
+		//write the result
+		if (m_valid) {
+			XYFourierFilterCurve::FilterResult& filterResult = m_curve->filterResult;
+			filterResult.available = true;
+			filterResult.valid = true;
+			filterResult.status = QString(gsl_strerror(m_status));
+			filterResult.elapsedTime = elapsedTime();
+		}
+
+		//redraw the curve
+		m_curve->xColumn->invalidateProperties();
+		m_curve->yColumn->invalidateProperties();
+		emit (m_curve->q->dataChanged());
+	}
+
+private:
+	XYFourierFilterCurvePrivate* m_curve;
+	const XYFourierFilterCurve::FilterData m_filterData;
+	QVector<double> m_xVector;
+	QVector<double> m_yVector;
+	bool m_valid;
+	int m_status;
+};
+
 XYFourierFilterCurvePrivate::XYFourierFilterCurvePrivate(XYFourierFilterCurve* owner) : XYCurvePrivate(owner),
 	xDataColumn(0), yDataColumn(0), 
 	xColumn(0), yColumn(0), 
@@ -162,10 +263,10 @@ XYFourierFilterCurvePrivate::~XYFourierFilterCurvePrivate() {
 // see XYFitCurvePrivate
 
 void XYFourierFilterCurvePrivate::recalculate() {
-	QElapsedTimer timer;
-	timer.start();
+	//a running filter is not needed anymore
+	scheduler.cancel();
 
-	//create filter result columns if not available yet, clear them otherwise
+	//create filter result columns if not available yet, the previous result is kept until the new one is available
 	if (!xColumn) {
 		xColumn = new Column("x", AbstractColumn::Numeric);
 		yColumn = new Column("y", AbstractColumn::Numeric);
@@ -181,15 +282,16 @@ void XYFourierFilterCurvePrivate::recalculate() {
 		q->setXColumn(xColumn);
 		q->setYColumn(yColumn);
 		q->setUndoAware(true);
-	} else {
-		xVector->clear();
-		yVector->clear();
 	}
 
 	// clear the previous result
 	filterResult = XYFourierFilterCurve::FilterResult();
 
 	if (!xDataColumn || !yDataColumn) {
+		xVector->clear();
+		yVector->clear();
+		xColumn->invalidateProperties();
+		yColumn->invalidateProperties();
 		emit (q->dataChanged());
 		sourceDataChangedSinceLastRecalc = false;
 		return;
@@ -200,105 +302,43 @@ void XYFourierFilterCurvePrivate::recalculate() {
 		filterResult.available = true;
 		filterResult.valid = false;
 		filterResult.status = i18n("Number of x and y data points must be equal.");
+		xVector->clear();
+		yVector->clear();
+		xColumn->invalidateProperties();
+		yColumn->invalidateProperties();
 		emit (q->dataChanged());
 		sourceDataChangedSinceLastRecalc = false;
 		return;
 	}
 
-	//copy all valid data point for the filter to temporary vectors
-	QVector<double> xdataVector;
-	QVector<double> ydataVector;
+	//copy all valid data point for the filter into the job
+	FourierFilterJob* job = new FourierFilterJob(this);
+	QVector<double>& xdataVector = job->xdataVector;
+	QVector<double>& ydataVector = job->ydataVector;
 	const double xmin = filterData.xRange.first();
 	const double xmax = filterData.xRange.last();
-	for (int row=0; row<xDataColumn->rowCount(); ++row) {
-		//only copy those data where _all_ values (for x and y, if given) are valid
-		if (!std::isnan(xDataColumn->valueAt(row)) && !std::isnan(yDataColumn->valueAt(row))
-				&& !xDataColumn->isMasked(row) && !yDataColumn->isMasked(row)) {
-			// only when inside given range
-			if (xDataColumn->valueAt(row) >= xmin && xDataColumn->valueAt(row) <= xmax) {
-				xdataVector.append(xDataColumn->valueAt(row));
-				ydataVector.append(yDataColumn->valueAt(row));
-			}
-		}
-	}
+	XYAnalysisDataCache::instance()->validData(xDataColumn, yDataColumn, xmin, xmax, xdataVector, ydataVector);
 
 	//number of data points to filter
 	unsigned int n = xdataVector.size();
 	if (n == 0) {
+		delete job;
 		filterResult.available = true;
 		filterResult.valid = false;
 		filterResult.status = i18n("No data points available.");
+		xVector->clear();
+		yVector->clear();
+		xColumn->invalidateProperties();
+		yColumn->invalidateProperties();
 		emit (q->dataChanged());
 		sourceDataChangedSinceLastRecalc = false;
 		return;
 	}
 
-	//double* xdata = xdataVector.data();
-	double* ydata = ydataVector.data();
-
-
-	// filter settings
-	const nsl_filter_type type = filterData.type;
-	const nsl_filter_form form = filterData.form;
-	const unsigned int order = filterData.order;
-	const double cutoff = filterData.cutoff, cutoff2 = filterData.cutoff2;
-	const nsl_filter_cutoff_unit unit = filterData.unit, unit2 = filterData.unit2;
-
-	DEBUG("n ="<<n);
-	DEBUG("type:"<<nsl_filter_type_name[type]);
-	DEBUG("form (order "<<order<<") :"<<nsl_filter_form_name[form]);
-	DEBUG("cutoffs ="<<cutoff<<cutoff2);
-	DEBUG("unit :"<<nsl_filter_cutoff_unit_name[unit]<<nsl_filter_cutoff_unit_name[unit2]);
-
-///////////////////////////////////////////////////////////
-	// calculate index
-	double cutindex=0, cutindex2=0;
-	switch (unit) {
-	case nsl_filter_cutoff_unit_frequency:
-		cutindex = cutoff*(xmax-xmin);
-		break;
-	case nsl_filter_cutoff_unit_fraction:
-		cutindex = cutoff*n;
-		break;
-	case nsl_filter_cutoff_unit_index:
-		cutindex = cutoff;
-	}
-	switch (unit2) {
-	case nsl_filter_cutoff_unit_frequency:
-		cutindex2 = cutoff2*(xmax-xmin);
-		break;
-	case nsl_filter_cutoff_unit_fraction:
-		cutindex2 = cutoff2*n;
-		break;
-	case nsl_filter_cutoff_unit_index:
-		cutindex2 = cutoff2;
-	}
-	const double bandwidth = (cutindex2 - cutindex);
-	if ((type == nsl_filter_type_band_pass || type == nsl_filter_type_band_reject) && bandwidth <= 0) {
-		qWarning()<<"band width must be > 0. Giving up.";
-		return;
-	}
-
-	DEBUG("cut off @" << cutindex << cutindex2);
-	DEBUG("bandwidth =" << bandwidth);
-
-	// run filter
-	int status = nsl_filter_fourier(ydata, n, type, form, order, cutindex, bandwidth);
-
-	xVector->resize(n);
-	yVector->resize(n);
-	memcpy(xVector->data(), xdataVector.data(), n*sizeof(double));
-	memcpy(yVector->data(), ydata, n*sizeof(double));
-///////////////////////////////////////////////////////////
-
-	//write the result
-	filterResult.available = true;
-	filterResult.valid = true;
-	filterResult.status = QString(gsl_strerror(status));;
-	filterResult.elapsedTime = timer.elapsed();
-
-	//redraw the curve
-	emit (q->dataChanged());
+	//filter in the worker thread, the result is published in FourierFilterJob::publish()
+	job->xmin = xmin;
+	job->xmax = xmax;
+	scheduler.start(job);
 	sourceDataChangedSinceLastRecalc = false;
 }
 
@@ -309,6 +349,9 @@ void XYFourierFilterCurvePrivate::recalculate() {
 void XYFourierFilterCurve::save(QXmlStreamWriter* writer) const{
 	Q_D(const XYFourierFilterCurve);
 
+	//save the result of a running filter
+	const_cast<XYFourierFilterCurvePrivate*>(d)->scheduler.waitForDone();
+
 	writer->writeStartElement("xyFourierFilterCurve");
 
 	//write xy-curve information
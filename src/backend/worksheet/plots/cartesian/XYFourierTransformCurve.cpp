@@ -39,6 +39,8 @@
 #include "backend/core/column/Column.h"
 #include "backend/lib/commandtemplates.h"
 #include "backend/lib/macros.h"
+#include "backend/worksheet/plots/cartesian/XYAnalysisJob.h"
+#include "backend/worksheet/plots/cartesian/XYAnalysisDataCache.h"
 
 #include <cmath>	// isnan
 extern "C" {
@@ -47,7 +49,6 @@ extern "C" {
 }
 
 #include <KLocale>
-#include <QElapsedTimer>
 #include <QIcon>
 #include <QThreadPool>
 
@@ -140,6 +141,120 @@ void XYFourierTransformCurve::setTransformData(const XYFourierTransformCurve::Tr
 //##############################################################################
 //######################### Private implementation #############################
 //##############################################################################
+/* Fourier transform of the copied source data in the worker thread */
+class FourierTransformJob : public XYAnalysisJob {
+public:
+	FourierTransformJob(XYFourierTransformCurvePrivate* curve) : xmin(0), xmax(0), m_curve(curve), m_transformData(curve->transformData), m_status(0) {
+	}
+
+	QVector<double> xdataVector;
+	QVector<double> ydataVector;
+	double xmin;
+	double xmax;
+
+protected:
+	void compute() {
+		const unsigned int n = ydataVector.size();
+
+		double* xdata = xdataVector.data();
+		double* ydata = ydataVector.data();
+
+		// transform settings
+		const nsl_sf_window_type windowType = m_transformData.windowType;
+		const nsl_dft_result_type type = m_transformData.type;
+		const bool twoSided = m_transformData.twoSided;
+		const bool shifted = m_transformData.shifted;
+		const nsl_dft_xscale xScale = m_transformData.xScale;
+
+		DEBUG("n =" << n);
+		DEBUG("window type:" << nsl_sf_window_type_name[windowType]);
+		DEBUG("type:" << nsl_dft_result_type_name[type]);
+		DEBUG("scale:" << nsl_dft_xscale_name[xScale]);
+		DEBUG("two sided:" << twoSided);
+		DEBUG("shifted:" << shifted);
+#ifndef NDEBUG
+		QDebug out = qDebug();
+		for (unsigned int i=0; i < n; i++)
+			out<<ydata[i];
+#endif
+
+		// transform with window
+		m_status = nsl_dft_transform_window(ydata, 1, n, twoSided, type, windowType);
+
+		unsigned int N=n;
+		if(twoSided == false)
+			N=n/2;
+
+		switch (xScale) {
+		case nsl_dft_xscale_frequency:
+			for (unsigned int i=0; i < N; i++) {
+				if(i >= n/2 && shifted)
+					xdata[i] = (n-1)/(xmax-xmin)*(i/(double)n-1.);
+				else
+					xdata[i] = (n-1)*i/(xmax-xmin)/n;
+			}
+			break;
+		case nsl_dft_xscale_index:
+			for (unsigned int i=0; i < N; i++) {
+				if (i >= n/2 && shifted)
+					xdata[i] = (int)i-(int) N;
+				else
+					xdata[i] = i;
+			}
+			break;
+		case nsl_dft_xscale_period: {
+			double f0 = (n-1)/(xmax-xmin)/n;
+			for (unsigned int i=0; i < N; i++) {
+				double f = (n-1)*i/(xmax-xmin)/n;
+				xdata[i] = 1/(f+f0);
+			}
+			break;
+		}
+		}
+#ifndef NDEBUG
+		out = qDebug();
+		for (unsigned int i=0; i < N; i++)
+			out << ydata[i] << '(' << xdata[i] << ')';
+#endif
+
+		m_xVector.resize(N);
+		m_yVector.resize(N);
+		if(shifted) {
+			memcpy(m_xVector.data(), &xdata[n/2], n/2*sizeof(double));
+			memcpy(&m_xVector.data()[n/2], xdata, n/2*sizeof(double));
+			memcpy(m_yVector.data(), &ydata[n/2], n/2*sizeof(double));
+			memcpy(&m_yVector.data()[n/2], ydata, n/2*sizeof(double));
+		} else {
+			memcpy(m_xVector.data(), xdata, N*sizeof(double));
+			memcpy(m_yVector.data(), ydata, N*sizeof(double));
+		}
+	}
+
+	void publish() {
+		m_curve->xVector->swap(m_xVector);
+		m_curve->yVector->swap(m_yVector);
+
+		//write the result
+		XYFourierTransformCurve::TransformResult& transformResult = m_curve->transformResult;
+		transformResult.available = true;
+		transformResult.valid = true;
+		transformResult.status = QString(gsl_strerror(m_status));
+		transformResult.elapsedTime = elapsedTime();
+
+		//redraw the curve
+		m_curve->xColumn->invalidateProperties();
+		m_curve->yColumn->invalidateProperties();
+		emit (m_curve->q->dataChanged());
+	}
+
+private:
+	XYFourierTransformCurvePrivate* m_curve;
+	const XYFourierTransformCurve::TransformData m_transformData;
+	QVector<double> m_xVector;
+	QVector<double> m_yVector;
+	int m_status;
+};
+
 XYFourierTransformCurvePrivate::XYFourierTransformCurvePrivate(XYFourierTransformCurve* owner) : XYCurvePrivate(owner),
 	xDataColumn(0), yDataColumn(0), 
 	xColumn(0), yColumn(0), 
@@ -157,10 +272,10 @@ XYFourierTransformCurvePrivate::~XYFourierTransformCurvePrivate() {
 // see XYFitCurvePrivate
 
 void XYFourierTransformCurvePrivate::recalculate() {
-	QElapsedTimer timer;
-	timer.start();
+	//a running transform is not needed anymore
+	scheduler.cancel();
 
-	//create transform result columns if not available yet, clear them otherwise
+	//create transform result columns if not available yet, the previous result is kept until the new one is available
 	if (!xColumn) {
 		xColumn = new Column("x", AbstractColumn::Numeric);
 		yColumn = new Column("y", AbstractColumn::Numeric);
@@ -176,15 +291,16 @@ void XYFourierTransformCurvePrivate::recalculate() {
 		q->setXColumn(xColumn);
 		q->setYColumn(yColumn);
 		q->setUndoAware(true);
-	} else {
-		xVector->clear();
-		yVector->clear();
 	}
 
 	// clear the previous result
 	transformResult = XYFourierTransformCurve::TransformResult();
 
 	if (!xDataColumn || !yDataColumn) {
+		xVector->clear();
+		yVector->clear();
+		xColumn->invalidateProperties();
+		yColumn->invalidateProperties();
 		emit (q->dataChanged());
 		sourceDataChangedSinceLastRecalc = false;
 		return;
@@ -195,122 +311,43 @@ void XYFourierTransformCurvePrivate::recalculate() {
 		transformResult.available = true;
 		transformResult.valid = false;
 		transformResult.status = i18n("Number of x and y data points must be equal.");
+		xVector->clear();
+		yVector->clear();
+		xColumn->invalidateProperties();
+		yColumn->invalidateProperties();
 		emit (q->dataChanged());
 		sourceDataChangedSinceLastRecalc = false;
 		return;
 	}
 
-	//copy all valid data point for the transform to temporary vectors
-	QVector<double> xdataVector;
-	QVector<double> ydataVector;
+	//copy all valid data point for the transform into the job
+	FourierTransformJob* job = new FourierTransformJob(this);
+	QVector<double>& xdataVector = job->xdataVector;
+	QVector<double>& ydataVector = job->ydataVector;
 	const double xmin = transformData.xRange.first();
 	const double xmax = transformData.xRange.last();
-	for (int row=0; row<xDataColumn->rowCount(); ++row) {
-		//only copy those data where _all_ values (for x and y, if given) are valid
-		if (!std::isnan(xDataColumn->valueAt(row)) && !std::isnan(yDataColumn->valueAt(row))
-				&& !xDataColumn->isMasked(row) && !yDataColumn->isMasked(row)) {
-			// only when inside given range
-			if (xDataColumn->valueAt(row) >= xmin && xDataColumn->valueAt(row) <= xmax) {
-				xdataVector.append(xDataColumn->valueAt(row));
-				ydataVector.append(yDataColumn->valueAt(row));
-			}
-		}
-	}
+	XYAnalysisDataCache::instance()->validData(xDataColumn, yDataColumn, xmin, xmax, xdataVector, ydataVector);
 
 	//number of data points to transform
 	unsigned int n = ydataVector.size();
 	if (n == 0) {
+		delete job;
 		transformResult.available = true;
 		transformResult.valid = false;
 		transformResult.status = i18n("No data points available.");
+		xVector->clear();
+		yVector->clear();
+		xColumn->invalidateProperties();
+		yColumn->invalidateProperties();
 		emit (q->dataChanged());
 		sourceDataChangedSinceLastRecalc = false;
 		return;
 	}
 
-	double* xdata = xdataVector.data();
-	double* ydata = ydataVector.data();
-
-	// transform settings
-	const nsl_sf_window_type windowType = transformData.windowType;
-	const nsl_dft_result_type type = transformData.type;
-	const bool twoSided = transformData.twoSided;
-	const bool shifted = transformData.shifted;
-	const nsl_dft_xscale xScale = transformData.xScale;
-
-	DEBUG("n =" << n);
-	DEBUG("window type:" << nsl_sf_window_type_name[windowType]);
-	DEBUG("type:" << nsl_dft_result_type_name[type]);
-	DEBUG("scale:" << nsl_dft_xscale_name[xScale]);
-	DEBUG("two sided:" << twoSided);
-	DEBUG("shifted:" << shifted);
-#ifndef NDEBUG
-	QDebug out = qDebug();
-	for (unsigned int i=0; i < n; i++)
-		out<<ydata[i];
-#endif
-
-///////////////////////////////////////////////////////////
-	// transform with window
-	int status = nsl_dft_transform_window(ydata, 1, n, twoSided, type, windowType);
-
-	unsigned int N=n;
-	if(twoSided == false)
-		N=n/2;
-
-	switch (xScale) {
-	case nsl_dft_xscale_frequency:
-		for (unsigned int i=0; i < N; i++) {
-			if(i >= n/2 && shifted)
-				xdata[i] = (n-1)/(xmax-xmin)*(i/(double)n-1.);
-			else
-				xdata[i] = (n-1)*i/(xmax-xmin)/n;
-		}
-		break;
-	case nsl_dft_xscale_index:
-		for (unsigned int i=0; i < N; i++) {
-			if (i >= n/2 && shifted)
-				xdata[i] = (int)i-(int) N;
-			else
-				xdata[i] = i;
-		}
-		break;
-	case nsl_dft_xscale_period: {
-		double f0 = (n-1)/(xmax-xmin)/n;
-		for (unsigned int i=0; i < N; i++) {
-			double f = (n-1)*i/(xmax-xmin)/n;
-			xdata[i] = 1/(f+f0);
-		}
-		break;
-	}
-	}
-#ifndef NDEBUG
-	out = qDebug();
-	for (unsigned int i=0; i < N; i++)
-		out << ydata[i] << '(' << xdata[i] << ')';
-#endif
-
-	xVector->resize(N);
-	yVector->resize(N);
-	if(shifted) {
-		memcpy(xVector->data(), &xdata[n/2], n/2*sizeof(double));
-		memcpy(&xVector->data()[n/2], xdata, n/2*sizeof(double));
-		memcpy(yVector->data(), &ydata[n/2], n/2*sizeof(double));
-		memcpy(&yVector->data()[n/2], ydata, n/2*sizeof(double));
-	} else {
-		memcpy(xVector->data(), xdata, N*sizeof(double));
-		memcpy(yVector->data(), ydata, N*sizeof(double));
-	}
-///////////////////////////////////////////////////////////
-
-	//write the result
-	transformResult.available = true;
-	transformResult.valid = true;
-	transformResult.status = QString(gsl_strerror(status));;
-	transformResult.elapsedTime = timer.elapsed();
-
-	//redraw the curve
-	emit (q->dataChanged());
+	//transform in the worker thread, the result is published in FourierTransformJob::publish()
+	job->xmin = xmin;
+	job->xmax = xmax;
+	scheduler.start(job);
 	sourceDataChangedSinceLastRecalc = false;
 }
 
@@ -321,6 +358,9 @@ void XYFourierTransformCurvePrivate::recalculate() {
 void XYFourierTransformCurve::save(QXmlStreamWriter* writer) const{
 	Q_D(const XYFourierTransformCurve);
 
+	//save the result of a running transform
+	const_cast<XYFourierTransformCurvePrivate*>(d)->scheduler.waitForDone();
+
 	writer->writeStartElement("xyFourierTransformCurve");
 
 	//write xy-curve information
@@ -31,6 +31,7 @@
 
 #include "backend/worksheet/plots/cartesian/XYCurvePrivate.h"
 #include "backend/worksheet/plots/cartesian/XYFourierTransformCurve.h"
+#include "backend/worksheet/plots/cartesian/XYAnalysisJob.h"
 
 #include <cmath>
 #include <QDebug>
@@ -56,6 +57,7 @@ class XYFourierTransformCurvePrivate: public XYCurvePrivate {
 		Column* yColumn; //<! column used internally for storing the y-values of the result fit curve
 		QVector<double>* xVector;
 		QVector<double>* yVector;
+		XYAnalysisScheduler scheduler; //<! runs the Fourier transform in the worker thread
 
 		XYFourierTransformCurve* const q;
 
@@ -39,6 +39,8 @@
 #include "backend/core/column/Column.h"
 #include "backend/lib/commandtemplates.h"
 #include "backend/lib/macros.h"
+#include "backend/worksheet/plots/cartesian/XYAnalysisJob.h"
+#include "backend/worksheet/plots/cartesian/XYAnalysisDataCache.h"
 
 #include <cmath>	// isnan
 #include <cfloat>	// DBL_MIN
@@ -48,7 +50,6 @@ extern "C" {
 
 #include <KLocale>
 #include <QIcon>
-#include <QElapsedTimer>
 #include <QThreadPool>
 
 XYIntegrationCurve::XYIntegrationCurve(const QString& name)
@@ -140,6 +141,74 @@ void XYIntegrationCurve::setIntegrationData(const XYIntegrationCurve::Integratio
 //##############################################################################
 //######################### Private implementation #############################
 //##############################################################################
+/* integration of the copied source data in the worker thread */
+class IntegrationJob : public XYAnalysisJob {
+public:
+	IntegrationJob(XYIntegrationCurvePrivate* curve) : m_curve(curve), m_integrationData(curve->integrationData), m_status(0) {
+	}
+
+	QVector<double> xdataVector;
+	QVector<double> ydataVector;
+
+protected:
+	void compute() {
+		const size_t n = xdataVector.size();
+
+		double* xdata = xdataVector.data();
+		double* ydata = ydataVector.data();
+
+		// integration settings
+		const nsl_int_method_type method = m_integrationData.method;
+		const bool absolute = m_integrationData.absolute;
+
+		DEBUG("method:"<<nsl_int_method_name[method]);
+		DEBUG("absolute area:"<<absolute);
+
+		size_t np=n;
+
+		switch (method) {
+		case nsl_int_method_rectangle:
+			m_status = nsl_int_rectangle(xdata, ydata, n, absolute);
+			break;
+		case nsl_int_method_trapezoid:
+			m_status = nsl_int_trapezoid(xdata, ydata, n, absolute);
+			break;
+		case nsl_int_method_simpson:
+			np = nsl_int_simpson(xdata, ydata, n, absolute);
+			break;
+		case nsl_int_method_simpson_3_8:
+			np = nsl_int_simpson_3_8(xdata, ydata, n, absolute);
+			break;
+		}
+
+		xdataVector.resize(np);
+		ydataVector.resize(np);
+	}
+
+	void publish() {
+		m_curve->xVector->swap(xdataVector);
+		m_curve->yVector->swap(ydataVector);
+
+		//write the result
+		XYIntegrationCurve::IntegrationResult& integrationResult = m_curve->integrationResult;
+		integrationResult.available = true;
+		integrationResult.valid = true;
+		integrationResult.status = QString::number(m_status);
+		integrationResult.elapsedTime = elapsedTime();
+		integrationResult.value = m_curve->yVector->last();
+
+		//redraw the curve
+		m_curve->xColumn->invalidateProperties();
+		m_curve->yColumn->invalidateProperties();
+		emit (m_curve->q->dataChanged());
+	}
+
+private:
+	XYIntegrationCurvePrivate* m_curve;
+	const XYIntegrationCurve::IntegrationData m_integrationData;
+	int m_status;
+};
+
 XYIntegrationCurvePrivate::XYIntegrationCurvePrivate(XYIntegrationCurve* owner) : XYCurvePrivate(owner),
 	xDataColumn(0), yDataColumn(0), 
 	xColumn(0), yColumn(0), 
@@ -157,10 +226,10 @@ XYIntegrationCurvePrivate::~XYIntegrationCurvePrivate() {
 // see XYFitCurvePrivate
 
 void XYIntegrationCurvePrivate::recalculate() {
-	QElapsedTimer timer;
-	timer.start();
+	//a running integration is not needed anymore
+	scheduler.cancel();
 
-	//create integration result columns if not available yet, clear them otherwise
+	//create integration result columns if not available yet, the previous result is kept until the new one is available
 	if (!xColumn) {
 		xColumn = new Column("x", AbstractColumn::Numeric);
 		yColumn = new Column("y", AbstractColumn::Numeric);
@@ -176,9 +245,6 @@ void XYIntegrationCurvePrivate::recalculate() {
 		q->setXColumn(xColumn);
 		q->setYColumn(yColumn);
 		q->setUndoAware(true);
-	} else {
-		xVector->clear();
-		yVector->clear();
 	}
 
 	// clear the previous result
@@ -198,6 +264,10 @@ void XYIntegrationCurvePrivate::recalculate() {
 	}
 
 	if (!tmpXDataColumn || !tmpYDataColumn) {
+		xVector->clear();
+		yVector->clear();
+		xColumn->invalidateProperties();
+		yColumn->invalidateProperties();
 		emit (q->dataChanged());
 		sourceDataChangedSinceLastRecalc = false;
 		return;
@@ -208,14 +278,19 @@ void XYIntegrationCurvePrivate::recalculate() {
 		integrationResult.available = true;
 		integrationResult.valid = false;
 		integrationResult.status = i18n("Number of x and y data points must be equal.");
+		xVector->clear();
+		yVector->clear();
+		xColumn->invalidateProperties();
+		yColumn->invalidateProperties();
 		emit (q->dataChanged());
 		sourceDataChangedSinceLastRecalc = false;
 		return;
 	}
 
-	//copy all valid data point for the integration to temporary vectors
-	QVector<double> xdataVector;
-	QVector<double> ydataVector;
+	//copy all valid data point for the integration into the job
+	IntegrationJob* job = new IntegrationJob(this);
+	QVector<double>& xdataVector = job->xdataVector;
+	QVector<double>& ydataVector = job->ydataVector;
 
 	double xmin;
 	double xmax;
@@ -227,73 +302,25 @@ void XYIntegrationCurvePrivate::recalculate() {
 		xmax = integrationData.xRange.last();
 	}
 
-	for (int row=0; row<tmpXDataColumn->rowCount(); ++row) {
-		//only copy those data where _all_ values (for x and y, if given) are valid
-		if (!std::isnan(tmpXDataColumn->valueAt(row)) && !std::isnan(tmpYDataColumn->valueAt(row))
-			&& !tmpXDataColumn->isMasked(row) && !tmpYDataColumn->isMasked(row)) {
-
-			// only when inside given range
-			if (tmpXDataColumn->valueAt(row) >= xmin && tmpXDataColumn->valueAt(row) <= xmax) {
-				xdataVector.append(tmpXDataColumn->valueAt(row));
-				ydataVector.append(tmpYDataColumn->valueAt(row));
-			}
-		}
-	}
+	XYAnalysisDataCache::instance()->validData(tmpXDataColumn, tmpYDataColumn, xmin, xmax, xdataVector, ydataVector);
 
 	const size_t n = xdataVector.size();	// number of data points to integrate
 	if (n < 2) {
+		delete job;
 		integrationResult.available = true;
 		integrationResult.valid = false;
 		integrationResult.status = i18n("Not enough data points available.");
+		xVector->clear();
+		yVector->clear();
+		xColumn->invalidateProperties();
+		yColumn->invalidateProperties();
 		emit (q->dataChanged());
 		sourceDataChangedSinceLastRecalc = false;
 		return;
 	}
 
-	double* xdata = xdataVector.data();
-	double* ydata = ydataVector.data();
-
-	// integration settings
-	const nsl_int_method_type method = integrationData.method;
-	const bool absolute = integrationData.absolute;
-
-	DEBUG("method:"<<nsl_int_method_name[method]);
-	DEBUG("absolute area:"<<absolute);
-
-///////////////////////////////////////////////////////////
-	int status=0;
-	size_t np=n;
-
-	switch (method) {
-	case nsl_int_method_rectangle:
-		status = nsl_int_rectangle(xdata, ydata, n, absolute);
-		break;
-	case nsl_int_method_trapezoid:
-		status = nsl_int_trapezoid(xdata, ydata, n, absolute);
-		break;
-	case nsl_int_method_simpson:
-		np = nsl_int_simpson(xdata, ydata, n, absolute);
-		break;
-	case nsl_int_method_simpson_3_8:
-		np = nsl_int_simpson_3_8(xdata, ydata, n, absolute);
-		break;
-	}
-
-	xVector->resize(np);
-	yVector->resize(np);
-	memcpy(xVector->data(), xdata, np*sizeof(double));
-	memcpy(yVector->data(), ydata, np*sizeof(double));
-///////////////////////////////////////////////////////////
-
-	//write the result
-	integrationResult.available = true;
-	integrationResult.valid = true;
-	integrationResult.status = QString::number(status);
-	integrationResult.elapsedTime = timer.elapsed();
-	integrationResult.value = ydata[np-1];
-
-	//redraw the curve
-	emit (q->dataChanged());
+	//integrate in the worker thread, the result is published in IntegrationJob::publish()
+	scheduler.start(job);
 	sourceDataChangedSinceLastRecalc = false;
 }
 
@@ -304,6 +331,9 @@ void XYIntegrationCurvePrivate::recalculate() {
 void XYIntegrationCurve::save(QXmlStreamWriter* writer) const{
 	Q_D(const XYIntegrationCurve);
 
+	//save the result of a running integration
+	const_cast<XYIntegrationCurvePrivate*>(d)->scheduler.waitForDone();
+
 	writer->writeStartElement("xyIntegrationCurve");
 
 	//write xy-curve information
@@ -31,6 +31,7 @@
 
 #include "backend/worksheet/plots/cartesian/XYCurvePrivate.h"
 #include "backend/worksheet/plots/cartesian/XYIntegrationCurve.h"
+#include "backend/worksheet/plots/cartesian/XYAnalysisJob.h"
 
 class XYIntegrationCurve;
 class Column;
@@ -54,6 +55,7 @@ class XYIntegrationCurvePrivate: public XYCurvePrivate {
 		Column* yColumn; //<! column used internally for storing the y-values of the result integration curve
 		QVector<double>* xVector;
 		QVector<double>* yVector;
+		XYAnalysisScheduler scheduler; //<! runs the integration in the worker thread
 
 		XYIntegrationCurve* const q;
 };
@@ -40,6 +40,8 @@
 #include "backend/core/column/Column.h"
 #include "backend/lib/commandtemplates.h"
 #include "backend/lib/macros.h"
+#include "backend/worksheet/plots/cartesian/XYAnalysisJob.h"
+#include "backend/worksheet/plots/cartesian/XYAnalysisDataCache.h"
 
 #include <cmath>	// isnan
 #include <cfloat>	// DBL_MIN
@@ -52,7 +54,6 @@ extern "C" {
 }
 
 #include <KLocale>
-#include <QElapsedTimer>
 #include <QThreadPool>
 #include <QIcon>
 
@@ -145,6 +146,259 @@ void XYInterpolationCurve::setInterpolationData(const XYInterpolationCurve::Inte
 //##############################################################################
 //######################### Private implementation #############################
 //##############################################################################
+/* interpolation of the copied source data in the worker thread */
+class InterpolationJob : public XYAnalysisJob {
+public:
+	InterpolationJob(XYInterpolationCurvePrivate* curve) : xmin(0), xmax(0), m_curve(curve), m_interpolationData(curve->interpolationData), m_status(0) {
+	}
+
+	QVector<double> xdataVector;
+	QVector<double> ydataVector;
+	double xmin;
+	double xmax;
+
+protected:
+	void compute() {
+		const unsigned int n = xdataVector.size();
+
+		//the data is only read and stays shared with XYAnalysisDataCache
+		const double* xdata = xdataVector.constData();
+		const double* ydata = ydataVector.constData();
+
+		// interpolation settings
+		const nsl_interp_type type = m_interpolationData.type;
+		const nsl_interp_pch_variant variant = m_interpolationData.variant;
+		const double tension = m_interpolationData.tension;
+		const double continuity = m_interpolationData.continuity;
+		const double bias = m_interpolationData.bias;
+		const nsl_interp_evaluate evaluate = m_interpolationData.evaluate;
+		const unsigned int npoints = m_interpolationData.npoints;
+
+		DEBUG("type:"<<nsl_interp_type_name[type]);
+		DEBUG("cubic Hermite variant:"<<nsl_interp_pch_variant_name[variant]<<tension<<continuity<<bias);
+		DEBUG("evaluate:"<<nsl_interp_evaluate_name[evaluate]);
+		DEBUG("npoints ="<<npoints);
+
+		gsl_interp_accel *acc = gsl_interp_accel_alloc();
+		gsl_spline *spline=0;
+		switch (type) {
+		case nsl_interp_type_linear:
+			spline = gsl_spline_alloc(gsl_interp_linear, n);
+			m_status = gsl_spline_init(spline, xdata, ydata, n);
+			break;
+		case nsl_interp_type_polynomial:
+			spline = gsl_spline_alloc(gsl_interp_polynomial, n);
+			m_status = gsl_spline_init(spline, xdata, ydata, n);
+			break;
+		case nsl_interp_type_cspline:
+			spline = gsl_spline_alloc(gsl_interp_cspline, n);
+			m_status = gsl_spline_init(spline, xdata, ydata, n);
+			break;
+		case nsl_interp_type_cspline_periodic:
+			spline = gsl_spline_alloc(gsl_interp_cspline_periodic, n);
+			m_status = gsl_spline_init(spline, xdata, ydata, n);
+			break;
+		case nsl_interp_type_akima:
+			spline = gsl_spline_alloc(gsl_interp_akima, n);
+			m_status = gsl_spline_init(spline, xdata, ydata, n);
+			break;
+		case nsl_interp_type_akima_periodic:
+			spline = gsl_spline_alloc(gsl_interp_akima_periodic, n);
+			m_status = gsl_spline_init(spline, xdata, ydata, n);
+			break;
+		case nsl_interp_type_steffen:
+	#if GSL_MAJOR_VERSION >= 2
+			spline = gsl_spline_alloc(gsl_interp_steffen, n);
+			m_status = gsl_spline_init(spline, xdata, ydata, n);
+	#endif
+			break;
+		case nsl_interp_type_cosine:
+		case nsl_interp_type_pch:
+		case nsl_interp_type_rational:
+		case nsl_interp_type_exponential:
+			break;
+		}
+
+		m_xVector.resize(npoints);
+		m_yVector.resize(npoints);
+		for (unsigned int i = 0; i < npoints; i++) {
+			unsigned int a=0,b=n-1;
+
+			double x = xmin + i*(xmax-xmin)/(npoints-1);
+			m_xVector[i] = x;
+
+			// find index a,b for interval [x[a],x[b]] around x[i] using bisection
+			int j=0;
+			if (type == nsl_interp_type_cosine || type == nsl_interp_type_exponential || type == nsl_interp_type_pch) {
+				while (b-a > 1) {
+					j=floor((a+b)/2.);
+					if (xdata[j] > x)
+						b=j;
+					else
+						a=j;
+				}
+			}
+
+			// evaluate interpolation
+			double t;
+			switch (type) {
+			case nsl_interp_type_linear:
+			case nsl_interp_type_polynomial:
+			case nsl_interp_type_cspline:
+			case nsl_interp_type_cspline_periodic:
+			case nsl_interp_type_akima:
+			case nsl_interp_type_akima_periodic:
+			case nsl_interp_type_steffen:
+				switch (evaluate) {
+				case nsl_interp_evaluate_function:
+					m_yVector[i] = gsl_spline_eval(spline, x, acc);
+					break;
+				case nsl_interp_evaluate_derivative:
+					m_yVector[i] = gsl_spline_eval_deriv(spline, x, acc);
+					break;
+				case nsl_interp_evaluate_second_derivative:
+					m_yVector[i] = gsl_spline_eval_deriv2(spline, x, acc);
+					break;
+				case nsl_interp_evaluate_integral:
+					m_yVector[i] = gsl_spline_eval_integ(spline, xmin, x, acc);
+					break;
+				}
+				break;
+			case nsl_interp_type_cosine:
+				t = (x-xdata[a])/(xdata[b]-xdata[a]);
+				t = (1.-cos(M_PI*t))/2.;
+				m_yVector[i] =  ydata[a] + t*(ydata[b]-ydata[a]);
+				break;
+			case nsl_interp_type_exponential:
+				t = (x-xdata[a])/(xdata[b]-xdata[a]);
+				m_yVector[i] = ydata[a]*pow(ydata[b]/ydata[a],t);
+				break;
+			case nsl_interp_type_pch: {
+				t = (x-xdata[a])/(xdata[b]-xdata[a]);
+				double t2=t*t, t3=t2*t;
+				double h1=2.*t3-3.*t2+1, h2=-2.*t3+3.*t2, h3=t3-2*t2+t, h4=t3-t2;
+				double m1=0.,m2=0.;
+				switch (variant) {
+				case nsl_interp_pch_variant_finite_difference:
+					if (a==0)
+						m1=(ydata[b]-ydata[a])/(xdata[b]-xdata[a]);
+					else
+						m1=( (ydata[b]-ydata[a])/(xdata[b]-xdata[a]) + (ydata[a]-ydata[a-1])/(xdata[a]-xdata[a-1]) )/2.;
+					if (b==n-1)
+						m2=(ydata[b]-ydata[a])/(xdata[b]-xdata[a]);
+					else
+						m2=( (ydata[b+1]-ydata[b])/(xdata[b+1]-xdata[b]) + (ydata[b]-ydata[a])/(xdata[b]-xdata[a]) )/2.;
+
+					break;
+				case nsl_interp_pch_variant_catmull_rom:
+					if (a==0)
+						m1=(ydata[b]-ydata[a])/(xdata[b]-xdata[a]);
+					else
+						m1=(ydata[b]-ydata[a-1])/(xdata[b]-xdata[a-1]);
+					if (b==n-1)
+						m2=(ydata[b]-ydata[a])/(xdata[b]-xdata[a]);
+					else
+						m2=(ydata[b+1]-ydata[a])/(xdata[b+1]-xdata[a]);
+
+					break;
+				case nsl_interp_pch_variant_cardinal:
+					if (a==0)
+						m1=(ydata[b]-ydata[a])/(xdata[b]-xdata[a]);
+					else
+						m1=(ydata[b]-ydata[a-1])/(xdata[b]-xdata[a-1]);
+					m1 *= (1.-tension);
+					if (b==n-1)
+						m2=(ydata[b]-ydata[a])/(xdata[b]-xdata[a]);
+					else
+						m2=(ydata[b+1]-ydata[a])/(xdata[b+1]-xdata[a]);
+					m2 *= (1.-tension);
+
+					break;
+				case nsl_interp_pch_variant_kochanek_bartels:
+					if (a==0)
+						m1=(1.+continuity)*(1.-bias)*(ydata[b]-ydata[a])/(xdata[b]-xdata[a]);
+					else
+						m1=( (1.-continuity)*(1.+bias)*(ydata[a]-ydata[a-1])/(xdata[a]-xdata[a-1]) 
+							+ (1.+continuity)*(1.-bias)*(ydata[b]-ydata[a])/(xdata[b]-xdata[a]) )/2.;
+					m1 *= (1.-tension);
+					if (b==n-1)
+						m2=(1.+continuity)*(1.+bias)*(ydata[b]-ydata[a])/(xdata[b]-xdata[a]);
+					else
+						m2=( (1.+continuity)*(1.+bias)*(ydata[b]-ydata[a])/(xdata[b]-xdata[a]) 
+							+ (1.-continuity)*(1.-bias)*(ydata[b+1]-ydata[b])/(xdata[b+1]-xdata[b]) )/2.;
+					m2 *= (1.-tension);
+					
+					break;
+				}	
+
+				// Hermite polynomial
+				m_yVector[i] = ydata[a]*h1+ydata[b]*h2+(xdata[b]-xdata[a])*(m1*h3+m2*h4);
+			}
+				break;
+			case nsl_interp_type_rational: {
+				double v,dv;
+				nsl_interp_ratint(xdata, ydata, n, x, &v, &dv);
+				m_yVector[i] = v;
+				//TODO: use error dv
+				break;
+			}
+			}
+		}
+
+		// calculate "evaluate" option for own types
+		if (type == nsl_interp_type_cosine || type == nsl_interp_type_exponential || type == nsl_interp_type_pch || type == nsl_interp_type_rational) {
+			switch (evaluate) {
+			case nsl_interp_evaluate_function:
+				break;
+			case nsl_interp_evaluate_derivative:
+				nsl_diff_first_deriv_second_order(m_xVector.data(), m_yVector.data(), npoints);
+				break;
+			case nsl_interp_evaluate_second_derivative:
+				nsl_diff_second_deriv_second_order(m_xVector.data(), m_yVector.data(), npoints);
+				break;
+			case nsl_interp_evaluate_integral:
+				nsl_int_trapezoid(m_xVector.data(), m_yVector.data(), npoints, 0);
+				break;
+			}
+		}
+
+		// check values
+		for (unsigned int i = 0; i < npoints; i++) {
+			if (m_yVector[i] > CartesianScale::LIMIT_MAX)
+				m_yVector[i] = CartesianScale::LIMIT_MAX;
+			else if (m_yVector[i] < CartesianScale::LIMIT_MIN)
+				m_yVector[i] = CartesianScale::LIMIT_MIN;
+		}
+
+		gsl_spline_free(spline);
+		gsl_interp_accel_free(acc);
+	}
+
+	void publish() {
+		m_curve->xVector->swap(m_xVector);
+		m_curve->yVector->swap(m_yVector);
+
+		//write the result
+		XYInterpolationCurve::InterpolationResult& interpolationResult = m_curve->interpolationResult;
+		interpolationResult.available = true;
+		interpolationResult.valid = true;
+		interpolationResult.status = QString(gsl_strerror(m_status));
+		interpolationResult.elapsedTime = elapsedTime();
+
+		//redraw the curve
+		m_curve->xColumn->invalidateProperties();
+		m_curve->yColumn->invalidateProperties();
+		emit (m_curve->q->dataChanged());
+	}
+
+private:
+	XYInterpolationCurvePrivate* m_curve;
+	const XYInterpolationCurve::InterpolationData m_interpolationData;
+	QVector<double> m_xVector;
+	QVector<double> m_yVector;
+	int m_status;
+};
+
 XYInterpolationCurvePrivate::XYInterpolationCurvePrivate(XYInterpolationCurve* owner) : XYCurvePrivate(owner),
 	xDataColumn(0), yDataColumn(0), 
 	xColumn(0), yColumn(0), 
@@ -162,10 +416,10 @@ XYInterpolationCurvePrivate::~XYInterpolationCurvePrivate() {
 // see XYFitCurvePrivate
 
 void XYInterpolationCurvePrivate::recalculate() {
-	QElapsedTimer timer;
-	timer.start();
+	//a running interpolation is not needed anymore
+	scheduler.cancel();
 
-	//create interpolation result columns if not available yet, clear them otherwise
+	//create interpolation result columns if not available yet, the previous result is kept until the new one is available
 	if (!xColumn) {
 		xColumn = new Column("x", AbstractColumn::Numeric);
 		yColumn = new Column("y", AbstractColumn::Numeric);
@@ -181,9 +435,6 @@ void XYInterpolationCurvePrivate::recalculate() {
 		q->setXColumn(xColumn);
 		q->setYColumn(yColumn);
 		q->setUndoAware(true);
-	} else {
-		xVector->clear();
-		yVector->clear();
 	}
 
 	// clear the previous result
@@ -203,6 +454,10 @@ void XYInterpolationCurvePrivate::recalculate() {
 	}
 
 	if (!tmpXDataColumn || !tmpYDataColumn) {
+		xVector->clear();
+		yVector->clear();
+		xColumn->invalidateProperties();
+		yColumn->invalidateProperties();
 		emit (q->dataChanged());
 		sourceDataChangedSinceLastRecalc = false;
 		return;
@@ -213,14 +468,19 @@ void XYInterpolationCurvePrivate::recalculate() {
 		interpolationResult.available = true;
 		interpolationResult.valid = false;
 		interpolationResult.status = i18n("Number of x and y data points must be equal.");
+		xVector->clear();
+		yVector->clear();
+		xColumn->invalidateProperties();
+		yColumn->invalidateProperties();
 		emit (q->dataChanged());
 		sourceDataChangedSinceLastRecalc = false;
 		return;
 	}
 
-	//copy all valid data point for the interpolation to temporary vectors
-	QVector<double> xdataVector;
-	QVector<double> ydataVector;
+	//copy all valid data point for the interpolation into the job
+	InterpolationJob* job = new InterpolationJob(this);
+	QVector<double>& xdataVector = job->xdataVector;
+	QVector<double>& ydataVector = job->ydataVector;
 
 	double xmin;
 	double xmax;
@@ -232,254 +492,28 @@ void XYInterpolationCurvePrivate::recalculate() {
 		xmax = interpolationData.xRange.last();
 	}
 
-	for (int row=0; row<tmpXDataColumn->rowCount(); ++row) {
-		//only copy those data where _all_ values (for x and y, if given) are valid
-		if (!std::isnan(tmpXDataColumn->valueAt(row)) && !std::isnan(tmpYDataColumn->valueAt(row))
-			&& !tmpXDataColumn->isMasked(row) && !tmpYDataColumn->isMasked(row)) {
-
-			// only when inside given range
-			if (tmpXDataColumn->valueAt(row) >= xmin && tmpXDataColumn->valueAt(row) <= xmax) {
-				xdataVector.append(tmpXDataColumn->valueAt(row));
-				ydataVector.append(tmpYDataColumn->valueAt(row));
-			}
-		}
-	}
+	XYAnalysisDataCache::instance()->validData(tmpXDataColumn, tmpYDataColumn, xmin, xmax, xdataVector, ydataVector);
 
 	//number of data points to interpolate
 	const unsigned int n = xdataVector.size();
 	if (n < 2) {
+		delete job;
 		interpolationResult.available = true;
 		interpolationResult.valid = false;
 		interpolationResult.status = i18n("Not enough data points available.");
+		xVector->clear();
+		yVector->clear();
+		xColumn->invalidateProperties();
+		yColumn->invalidateProperties();
 		emit (q->dataChanged());
 		sourceDataChangedSinceLastRecalc = false;
 		return;
 	}
 
-	double* xdata = xdataVector.data();
-	double* ydata = ydataVector.data();
-
-	// interpolation settings
-	const nsl_interp_type type = interpolationData.type;
-	const nsl_interp_pch_variant variant = interpolationData.variant;
-	const double tension = interpolationData.tension;
-	const double continuity = interpolationData.continuity;
-	const double bias = interpolationData.bias;
-	const nsl_interp_evaluate evaluate = interpolationData.evaluate;
-	const unsigned int npoints = interpolationData.npoints;
-
-	DEBUG("type:"<<nsl_interp_type_name[type]);
-	DEBUG("cubic Hermite variant:"<<nsl_interp_pch_variant_name[variant]<<tension<<continuity<<bias);
-	DEBUG("evaluate:"<<nsl_interp_evaluate_name[evaluate]);
-	DEBUG("npoints ="<<npoints);
-
-///////////////////////////////////////////////////////////
-	int status=0;
-
-	gsl_interp_accel *acc = gsl_interp_accel_alloc();
-	gsl_spline *spline=0;
-	switch (type) {
-	case nsl_interp_type_linear:
-		spline = gsl_spline_alloc(gsl_interp_linear, n);
-		status = gsl_spline_init(spline, xdata, ydata, n);
-		break;
-	case nsl_interp_type_polynomial:
-		spline = gsl_spline_alloc(gsl_interp_polynomial, n);
-		status = gsl_spline_init(spline, xdata, ydata, n);
-		break;
-	case nsl_interp_type_cspline:
-		spline = gsl_spline_alloc(gsl_interp_cspline, n);
-		status = gsl_spline_init(spline, xdata, ydata, n);
-		break;
-	case nsl_interp_type_cspline_periodic:
-		spline = gsl_spline_alloc(gsl_interp_cspline_periodic, n);
-		status = gsl_spline_init(spline, xdata, ydata, n);
-		break;
-	case nsl_interp_type_akima:
-		spline = gsl_spline_alloc(gsl_interp_akima, n);
-		status = gsl_spline_init(spline, xdata, ydata, n);
-		break;
-	case nsl_interp_type_akima_periodic:
-		spline = gsl_spline_alloc(gsl_interp_akima_periodic, n);
-		status = gsl_spline_init(spline, xdata, ydata, n);
-		break;
-	case nsl_interp_type_steffen:
-#if GSL_MAJOR_VERSION >= 2
-		spline = gsl_spline_alloc(gsl_interp_steffen, n);
-		status = gsl_spline_init(spline, xdata, ydata, n);
-#endif
-		break;
-	case nsl_interp_type_cosine:
-	case nsl_interp_type_pch:
-	case nsl_interp_type_rational:
-	case nsl_interp_type_exponential:
-		break;
-	}
-
-	xVector->resize(npoints);
-	yVector->resize(npoints);
-	for (unsigned int i = 0; i < npoints; i++) {
-		unsigned int a=0,b=n-1;
-
-		double x = xmin + i*(xmax-xmin)/(npoints-1);
-		(*xVector)[i] = x;
-
-		// find index a,b for interval [x[a],x[b]] around x[i] using bisection
-		int j=0;
-		if (type == nsl_interp_type_cosine || type == nsl_interp_type_exponential || type == nsl_interp_type_pch) {
-			while (b-a > 1) {
-				j=floor((a+b)/2.);
-				if (xdata[j] > x)
-					b=j;
-				else
-					a=j;
-			}
-		}
-
-		// evaluate interpolation
-		double t;
-		switch (type) {
-		case nsl_interp_type_linear:
-		case nsl_interp_type_polynomial:
-		case nsl_interp_type_cspline:
-		case nsl_interp_type_cspline_periodic:
-		case nsl_interp_type_akima:
-		case nsl_interp_type_akima_periodic:
-		case nsl_interp_type_steffen:
-			switch (evaluate) {
-			case nsl_interp_evaluate_function:
-				(*yVector)[i] = gsl_spline_eval(spline, x, acc);
-				break;
-			case nsl_interp_evaluate_derivative:
-				(*yVector)[i] = gsl_spline_eval_deriv(spline, x, acc);
-				break;
-			case nsl_interp_evaluate_second_derivative:
-				(*yVector)[i] = gsl_spline_eval_deriv2(spline, x, acc);
-				break;
-			case nsl_interp_evaluate_integral:
-				(*yVector)[i] = gsl_spline_eval_integ(spline, xmin, x, acc);
-				break;
-			}
-			break;
-		case nsl_interp_type_cosine:
-			t = (x-xdata[a])/(xdata[b]-xdata[a]);
-			t = (1.-cos(M_PI*t))/2.;
-			(*yVector)[i] =  ydata[a] + t*(ydata[b]-ydata[a]);
-			break;
-		case nsl_interp_type_exponential:
-			t = (x-xdata[a])/(xdata[b]-xdata[a]);
-			(*yVector)[i] = ydata[a]*pow(ydata[b]/ydata[a],t);
-			break;
-		case nsl_interp_type_pch: {
-			t = (x-xdata[a])/(xdata[b]-xdata[a]);
-			double t2=t*t, t3=t2*t;
-			double h1=2.*t3-3.*t2+1, h2=-2.*t3+3.*t2, h3=t3-2*t2+t, h4=t3-t2;
-			double m1=0.,m2=0.;
-			switch (variant) {
-			case nsl_interp_pch_variant_finite_difference:
-				if (a==0)
-					m1=(ydata[b]-ydata[a])/(xdata[b]-xdata[a]);
-				else
-					m1=( (ydata[b]-ydata[a])/(xdata[b]-xdata[a]) + (ydata[a]-ydata[a-1])/(xdata[a]-xdata[a-1]) )/2.;
-				if (b==n-1)
-					m2=(ydata[b]-ydata[a])/(xdata[b]-xdata[a]);
-				else
-					m2=( (ydata[b+1]-ydata[b])/(xdata[b+1]-xdata[b]) + (ydata[b]-ydata[a])/(xdata[b]-xdata[a]) )/2.;
-
-				break;
-			case nsl_interp_pch_variant_catmull_rom:
-				if (a==0)
-					m1=(ydata[b]-ydata[a])/(xdata[b]-xdata[a]);
-				else
-					m1=(ydata[b]-ydata[a-1])/(xdata[b]-xdata[a-1]);
-				if (b==n-1)
-					m2=(ydata[b]-ydata[a])/(xdata[b]-xdata[a]);
-				else
-					m2=(ydata[b+1]-ydata[a])/(xdata[b+1]-xdata[a]);
-
-				break;
-			case nsl_interp_pch_variant_cardinal:
-				if (a==0)
-					m1=(ydata[b]-ydata[a])/(xdata[b]-xdata[a]);
-				else
-					m1=(ydata[b]-ydata[a-1])/(xdata[b]-xdata[a-1]);
-				m1 *= (1.-tension);
-				if (b==n-1)
-					m2=(ydata[b]-ydata[a])/(xdata[b]-xdata[a]);
-				else
-					m2=(ydata[b+1]-ydata[a])/(xdata[b+1]-xdata[a]);
-				m2 *= (1.-tension);
-
-				break;
-			case nsl_interp_pch_variant_kochanek_bartels:
-				if (a==0)
-					m1=(1.+continuity)*(1.-bias)*(ydata[b]-ydata[a])/(xdata[b]-xdata[a]);
-				else
-					m1=( (1.-continuity)*(1.+bias)*(ydata[a]-ydata[a-1])/(xdata[a]-xdata[a-1]) 
-						+ (1.+continuity)*(1.-bias)*(ydata[b]-ydata[a])/(xdata[b]-xdata[a]) )/2.;
-				m1 *= (1.-tension);
-				if (b==n-1)
-					m2=(1.+continuity)*(1.+bias)*(ydata[b]-ydata[a])/(xdata[b]-xdata[a]);
-				else
-					m2=( (1.+continuity)*(1.+bias)*(ydata[b]-ydata[a])/(xdata[b]-xdata[a]) 
-						+ (1.-continuity)*(1.-bias)*(ydata[b+1]-ydata[b])/(xdata[b+1]-xdata[b]) )/2.;
-				m2 *= (1.-tension);
-				
-				break;
-			}	
-
-			// Hermite polynomial
-			(*yVector)[i] = ydata[a]*h1+ydata[b]*h2+(xdata[b]-xdata[a])*(m1*h3+m2*h4);
-		}
-			break;
-		case nsl_interp_type_rational: {
-			double v,dv;
-			nsl_interp_ratint(xdata, ydata, n, x, &v, &dv);
-			(*yVector)[i] = v;
-			//TODO: use error dv
-			break;
-		}
-		}
-	}
-
-	// calculate "evaluate" option for own types
-	if (type == nsl_interp_type_cosine || type == nsl_interp_type_exponential || type == nsl_interp_type_pch || type == nsl_interp_type_rational) {
-		switch (evaluate) {
-		case nsl_interp_evaluate_function:
-			break;
-		case nsl_interp_evaluate_derivative:
-			nsl_diff_first_deriv_second_order(xVector->data(), yVector->data(), npoints);
-			break;
-		case nsl_interp_evaluate_second_derivative:
-			nsl_diff_second_deriv_second_order(xVector->data(), yVector->data(), npoints);
-			break;
-		case nsl_interp_evaluate_integral:
-			nsl_int_trapezoid(xVector->data(), yVector->data(), npoints, 0);
-			break;
-		}
-	}
-
-	// check values
-	for (unsigned int i = 0; i < npoints; i++) {
-		if ((*yVector)[i] > CartesianScale::LIMIT_MAX)
-			(*yVector)[i] = CartesianScale::LIMIT_MAX;
-		else if ((*yVector)[i] < CartesianScale::LIMIT_MIN)
-			(*yVector)[i] = CartesianScale::LIMIT_MIN;
-	}
-
-	gsl_spline_free(spline);
-	gsl_interp_accel_free(acc);
-
-///////////////////////////////////////////////////////////
-
-	//write the result
-	interpolationResult.available = true;
-	interpolationResult.valid = true;
-	interpolationResult.status = QString(gsl_strerror(status));;
-	interpolationResult.elapsedTime = timer.elapsed();
-
-	//redraw the curve
-	emit (q->dataChanged());
+	//interpolate in the worker thread, the result is published in InterpolationJob::publish()
+	job->xmin = xmin;
+	job->xmax = xmax;
+	scheduler.start(job);
 	sourceDataChangedSinceLastRecalc = false;
 }
 
@@ -490,6 +524,9 @@ void XYInterpolationCurvePrivate::recalculate() {
 void XYInterpolationCurve::save(QXmlStreamWriter* writer) const{
 	Q_D(const XYInterpolationCurve);
 
+	//save the result of a running interpolation
+	const_cast<XYInterpolationCurvePrivate*>(d)->scheduler.waitForDone();
+
 	writer->writeStartElement("xyInterpolationCurve");
 
 	//write xy-curve information
@@ -31,6 +31,7 @@
 
 #include "backend/worksheet/plots/cartesian/XYCurvePrivate.h"
 #include "backend/worksheet/plots/cartesian/XYInterpolationCurve.h"
+#include "backend/worksheet/plots/cartesian/XYAnalysisJob.h"
 
 class XYInterpolationCurve;
 class Column;
@@ -54,6 +55,7 @@ class XYInterpolationCurvePrivate: public XYCurvePrivate {
 		Column* yColumn; //<! column used internally for storing the y-values of the result interpolation curve
 		QVector<double>* xVector;
 		QVector<double>* yVector;
+		XYAnalysisScheduler scheduler; //<! runs the interpolation in the worker thread
 
 		XYInterpolationCurve* const q;
 };
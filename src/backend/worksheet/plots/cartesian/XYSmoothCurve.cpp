@@ -39,10 +39,11 @@
 #include "backend/core/column/Column.h"
 #include "backend/lib/commandtemplates.h"
 #include "backend/lib/macros.h"
+#include "backend/worksheet/plots/cartesian/XYAnalysisJob.h"
+#include "backend/worksheet/plots/cartesian/XYAnalysisDataCache.h"
 
 #include <KLocale>
 #include <QIcon>
-#include <QElapsedTimer>
 #include <QThreadPool>
 
 extern "C" {
@@ -140,6 +141,82 @@ void XYSmoothCurve::setSmoothData(const XYSmoothCurve::SmoothData& smoothData) {
 //##############################################################################
 //######################### Private implementation #############################
 //##############################################################################
+/* smooth of the copied source data in the worker thread */
+class SmoothJob : public XYAnalysisJob {
+public:
+	SmoothJob(XYSmoothCurvePrivate* curve) : m_curve(curve), m_smoothData(curve->smoothData), m_status(0) {
+	}
+
+	QVector<double> xdataVector;
+	QVector<double> ydataVector;
+
+protected:
+	void compute() {
+		const unsigned int n = ydataVector.size();
+
+		double* y = ydataVector.data();
+
+		// smooth settings
+		const nsl_smooth_type type = m_smoothData.type;
+		const unsigned int points = m_smoothData.points;
+		const nsl_smooth_weight_type weight = m_smoothData.weight;
+		const double percentile = m_smoothData.percentile;
+		const unsigned int order = m_smoothData.order;
+		const nsl_smooth_pad_mode mode = m_smoothData.mode;
+		const double lvalue = m_smoothData.lvalue;
+		const double rvalue = m_smoothData.rvalue;
+
+		DEBUG("type:"<<nsl_smooth_type_name[type]);
+		DEBUG("points ="<<points);
+		DEBUG("weight:"<<nsl_smooth_weight_type_name[weight]);
+		DEBUG("percentile ="<<percentile);
+		DEBUG("order ="<<order);
+		DEBUG("mode ="<<nsl_smooth_pad_mode_name[mode]);
+		DEBUG("const. values ="<<lvalue<<rvalue);
+
+		switch (type) {
+		case nsl_smooth_type_moving_average:
+			m_status = nsl_smooth_moving_average(y, n, points, weight, mode);
+			break;
+		case nsl_smooth_type_moving_average_lagged:
+			m_status = nsl_smooth_moving_average_lagged(y, n, points, weight, mode);
+			break;
+		case nsl_smooth_type_percentile:
+			if (mode == nsl_smooth_pad_constant)
+				nsl_smooth_pad_constant_set(lvalue, rvalue);
+			m_status = nsl_smooth_percentile(y, n, points, percentile, mode);
+			break;
+		case nsl_smooth_type_savitzky_golay:
+			if (mode == nsl_smooth_pad_constant)
+				nsl_smooth_pad_constant_set(lvalue, rvalue);
+			m_status = nsl_smooth_savgol(y, n, points, order, mode);
+			break;
+		}
+	}
+
+	void publish() {
+		m_curve->xVector->swap(xdataVector);
+		m_curve->yVector->swap(ydataVector);
+
+		//write the result
+		XYSmoothCurve::SmoothResult& smoothResult = m_curve->smoothResult;
+		smoothResult.available = true;
+		smoothResult.valid = true;
+		smoothResult.status = QString::number(m_status);
+		smoothResult.elapsedTime = elapsedTime();
+
+		//redraw the curve
+		m_curve->xColumn->invalidateProperties();
+		m_curve->yColumn->invalidateProperties();
+		emit (m_curve->q->dataChanged());
+	}
+
+private:
+	XYSmoothCurvePrivate* m_curve;
+	const XYSmoothCurve::SmoothData m_smoothData;
+	int m_status;
+};
+
 XYSmoothCurvePrivate::XYSmoothCurvePrivate(XYSmoothCurve* owner) : XYCurvePrivate(owner),
 	xDataColumn(0), yDataColumn(0), 
 	xColumn(0), yColumn(0), 
@@ -157,10 +234,10 @@ XYSmoothCurvePrivate::~XYSmoothCurvePrivate() {
 // see XYFitCurvePrivate
 
 void XYSmoothCurvePrivate::recalculate() {
-	QElapsedTimer timer;
-	timer.start();
+	//a running smooth is not needed anymore
+	scheduler.cancel();
 
-	//create smooth result columns if not available yet, clear them otherwise
+	//create smooth result columns if not available yet, the previous result is kept until the new one is available
 	if (!xColumn) {
 		xColumn = new Column("x", AbstractColumn::Numeric);
 		yColumn = new Column("y", AbstractColumn::Numeric);
@@ -176,9 +253,6 @@ void XYSmoothCurvePrivate::recalculate() {
 		q->setXColumn(xColumn);
 		q->setYColumn(yColumn);
 		q->setUndoAware(true);
-	} else {
-		xVector->clear();
-		yVector->clear();
 	}
 
 	// clear the previous result
@@ -198,6 +272,10 @@ void XYSmoothCurvePrivate::recalculate() {
 	}
 
 	if (!tmpXDataColumn || !tmpYDataColumn) {
+		xVector->clear();
+		yVector->clear();
+		xColumn->invalidateProperties();
+		yColumn->invalidateProperties();
 		emit (q->dataChanged());
 		sourceDataChangedSinceLastRecalc = false;
 		return;
@@ -208,14 +286,19 @@ void XYSmoothCurvePrivate::recalculate() {
 		smoothResult.available = true;
 		smoothResult.valid = false;
 		smoothResult.status = i18n("Number of x and y data points must be equal.");
+		xVector->clear();
+		yVector->clear();
+		xColumn->invalidateProperties();
+		yColumn->invalidateProperties();
 		emit (q->dataChanged());
 		sourceDataChangedSinceLastRecalc = false;
 		return;
 	}
 
-	//copy all valid data point for the smooth to temporary vectors
-	QVector<double> xdataVector;
-	QVector<double> ydataVector;
+	//copy all valid data point for the smooth into the job
+	SmoothJob* job = new SmoothJob(this);
+	QVector<double>& xdataVector = job->xdataVector;
+	QVector<double>& ydataVector = job->ydataVector;
 
 	double xmin;
 	double xmax;
@@ -227,85 +310,26 @@ void XYSmoothCurvePrivate::recalculate() {
 		xmax = smoothData.xRange.last();
 	}
 
-	for (int row=0; row<tmpXDataColumn->rowCount(); ++row) {
-		//only copy those data where _all_ values (for x and y, if given) are valid
-		if (!std::isnan(tmpXDataColumn->valueAt(row)) && !std::isnan(tmpYDataColumn->valueAt(row))
-			&& !tmpXDataColumn->isMasked(row) && !tmpYDataColumn->isMasked(row)) {
-
-			// only when inside given range
-			if (tmpXDataColumn->valueAt(row) >= xmin && tmpXDataColumn->valueAt(row) <= xmax) {
-				xdataVector.append(tmpXDataColumn->valueAt(row));
-				ydataVector.append(tmpYDataColumn->valueAt(row));
-			}
-		}
-	}
+	XYAnalysisDataCache::instance()->validData(tmpXDataColumn, tmpYDataColumn, xmin, xmax, xdataVector, ydataVector);
 
 	//number of data points to smooth
 	const unsigned int n = xdataVector.size();
 	if (n < 2) {
+		delete job;
 		smoothResult.available = true;
 		smoothResult.valid = false;
 		smoothResult.status = i18n("Not enough data points available.");
+		xVector->clear();
+		yVector->clear();
+		xColumn->invalidateProperties();
+		yColumn->invalidateProperties();
 		emit (q->dataChanged());
 		sourceDataChangedSinceLastRecalc = false;
 		return;
 	}
 
-	double* xdata = xdataVector.data();
-	double* ydata = ydataVector.data();
-
-	// smooth settings
-	const nsl_smooth_type type = smoothData.type;
-	const unsigned int points = smoothData.points;
-	const nsl_smooth_weight_type weight = smoothData.weight;
-	const double percentile = smoothData.percentile;
-	const unsigned int order = smoothData.order;
-	const nsl_smooth_pad_mode mode = smoothData.mode;
-	const double lvalue = smoothData.lvalue;
-	const double rvalue = smoothData.rvalue;
-
-	DEBUG("type:"<<nsl_smooth_type_name[type]);
-	DEBUG("points ="<<points);
-	DEBUG("weight:"<<nsl_smooth_weight_type_name[weight]);
-	DEBUG("percentile ="<<percentile);
-	DEBUG("order ="<<order);
-	DEBUG("mode ="<<nsl_smooth_pad_mode_name[mode]);
-	DEBUG("const. values ="<<lvalue<<rvalue);
-
-///////////////////////////////////////////////////////////
-	int status=0;
-
-	switch (type) {
-	case nsl_smooth_type_moving_average:
-		status = nsl_smooth_moving_average(ydata, n, points, weight, mode);
-		break;
-	case nsl_smooth_type_moving_average_lagged:
-		status = nsl_smooth_moving_average_lagged(ydata, n, points, weight, mode);
-		break;
-	case nsl_smooth_type_percentile:
-		status = nsl_smooth_percentile(ydata, n, points, percentile, mode);
-		break;
-	case nsl_smooth_type_savitzky_golay:
-		if (mode == nsl_smooth_pad_constant)
-			nsl_smooth_pad_constant_set(lvalue, rvalue);
-		status = nsl_smooth_savgol(ydata, n, points, order, mode);
-		break;
-	}
-
-	xVector->resize(n);
-	yVector->resize(n);
-	memcpy(xVector->data(), xdata, n*sizeof(double));
-	memcpy(yVector->data(), ydata, n*sizeof(double));
-///////////////////////////////////////////////////////////
-
-	//write the result
-	smoothResult.available = true;
-	smoothResult.valid = true;
-	smoothResult.status = QString::number(status);
-	smoothResult.elapsedTime = timer.elapsed();
-
-	//redraw the curve
-	emit (q->dataChanged());
+	//smooth in the worker thread, the result is published in SmoothJob::publish()
+	scheduler.start(job);
 	sourceDataChangedSinceLastRecalc = false;
 }
 
@@ -316,6 +340,9 @@ void XYSmoothCurvePrivate::recalculate() {
 void XYSmoothCurve::save(QXmlStreamWriter* writer) const{
 	Q_D(const XYSmoothCurve);
 
+	//save the result of a running smooth
+	const_cast<XYSmoothCurvePrivate*>(d)->scheduler.waitForDone();
+
 	writer->writeStartElement("xySmoothCurve");
 
 	//write xy-curve information
@@ -0,0 +1,135 @@
+/***************************************************************************
+    File                 : xycurve_decimation_test.cpp
+    Project              : LabPlot
+    Description          : comparison of the decimated line of a curve with the exact line
+    --------------------------------------------------------------------
+    Copyright            : (C) 2017 Alexander Semke (alexander.semke@web.de)
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "backend/core/Project.h"
+#include "backend/core/column/Column.h"
+#include "backend/worksheet/Worksheet.h"
+#include "backend/worksheet/plots/cartesian/CartesianPlot.h"
+#include "backend/worksheet/plots/cartesian/XYCurve.h"
+
+#include <KConfigGroup>
+#include <KSharedConfig>
+#include <QtTest>
+#include <cmath>
+
+class XYCurveDecimationTest : public QObject {
+	Q_OBJECT
+
+	private slots:
+		void initTestCase();
+		void decimatedLineMatchesExactLine();
+
+	private:
+		QImage render(QGraphicsItem*, const QRectF&);
+};
+
+void XYCurveDecimationTest::initTestCase() {
+	//draw the paths directly and not the cached pixmaps
+	QStandardPaths::setTestModeEnabled(true);
+	KSharedConfig::openConfig()->group("Settings_Worksheet").writeEntry("DoubleBuffering", false);
+}
+
+QImage XYCurveDecimationTest::render(QGraphicsItem* item, const QRectF& rect) {
+	QImage image(ceil(rect.width()), ceil(rect.height()), QImage::Format_ARGB32_Premultiplied);
+	image.fill(Qt::transparent);
+	QPainter painter(&image);
+	painter.setRenderHint(QPainter::Antialiasing, true);
+	painter.translate(-rect.topLeft());
+	QStyleOptionGraphicsItem option;
+	item->paint(&painter, &option, 0);
+	painter.end();
+	return image;
+}
+
+/*!
+  a noisy signal with many points per pixel column is drawn once decimated and once with all points
+  (the curve is printed). Both lines have to cover the same pixels up to the antialiasing of single pixels.
+*/
+void XYCurveDecimationTest::decimatedLineMatchesExactLine() {
+	Project project;
+	Worksheet* worksheet = new Worksheet(0, "worksheet");
+	project.addChild(worksheet);
+
+	CartesianPlot* plot = new CartesianPlot("plot");
+	plot->initDefault(CartesianPlot::FourAxes);
+	worksheet->addChild(plot);
+	plot->setAutoScaleX(false);
+	plot->setAutoScaleY(false);
+	plot->setXMin(0);
+	plot->setXMax(1);
+	plot->setYMin(-2);
+	plot->setYMax(2);
+
+	const int rows = 200000;
+	QVector<double> x(rows), y(rows);
+	qsrand(1);
+	for (int i = 0; i < rows; ++i) {
+		x[i] = (double)i/(rows - 1);
+		y[i] = sin(100*M_PI*x[i]) + 0.5*((double)qrand()/RAND_MAX - 0.5);
+	}
+	Column* xColumn = new Column("x", x);
+	Column* yColumn = new Column("y", y);
+	project.addChild(xColumn);
+	project.addChild(yColumn);
+
+	XYCurve* curve = new XYCurve("curve");
+	plot->addChild(curve);
+	curve->setXColumn(xColumn);
+	curve->setYColumn(yColumn);
+	curve->setLineType(XYCurve::Line);
+	curve->setSymbolsStyle(Symbol::NoSymbols);
+	curve->retransform();
+
+	QGraphicsItem* item = curve->graphicsItem();
+	curve->setPrinting(true);
+	const QRectF rect = item->boundingRect();
+	QVERIFY(rect.width() > 0 && rect.height() > 0);
+	const QImage exact = render(item, rect);
+
+	curve->setPrinting(false);
+	const QImage decimated = render(item, rect);
+
+	int painted = 0;
+	int different = 0;
+	for (int row = 0; row < exact.height(); ++row) {
+		const QRgb* exactLine = reinterpret_cast<const QRgb*>(exact.constScanLine(row));
+		const QRgb* decimatedLine = reinterpret_cast<const QRgb*>(decimated.constScanLine(row));
+		for (int col = 0; col < exact.width(); ++col) {
+			if (qAlpha(exactLine[col]) > 0)
+				++painted;
+			if (qAbs(qAlpha(exactLine[col]) - qAlpha(decimatedLine[col])) > 127)
+				++different;
+		}
+	}
+
+	QVERIFY(painted > 0);
+	QVERIFY2(different < painted/100, qPrintable(QString("%1 of %2 pixels differ").arg(different).arg(painted)));
+}
+
+QTEST_MAIN(XYCurveDecimationTest)
+#include "xycurve_decimation_test.moc"
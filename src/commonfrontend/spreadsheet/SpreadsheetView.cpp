@@ -1926,14 +1926,39 @@ void SpreadsheetView::exportToFile(const QString& path, const bool exportHeader,
 		out << '\n';
 	}
 
-	//export values
-	for (int i=0; i<m_spreadsheet->rowCount(); ++i) {
-		for (int j=0; j<cols; ++j) {
-			out << m_spreadsheet->column(j)->asStringColumn()->textAt(i);
-			if (j!=cols-1)
-				out<<sep;
+	//numeric columns are converted directly from their data with the format of their output filter,
+	//all other columns via their string representation
+	QVector<Column*> columns(cols);
+	QVector<const Double2StringFilter*> numericFilters(cols);
+	for (int j=0; j<cols; ++j) {
+		columns[j] = m_spreadsheet->column(j);
+		numericFilters[j] = 0;
+		if (columns[j]->columnMode() == AbstractColumn::Numeric)
+			numericFilters[j] = dynamic_cast<const Double2StringFilter*>(columns[j]->outputFilter());
+	}
+	const QLocale locale;
+
+	//export values, blockwise to access the numeric data in contiguous spans
+	const int rows = m_spreadsheet->rowCount();
+	QVector<const double*> values(cols);
+	for (int first=0; first<rows; first+=AbstractColumn::SpanReader::chunkSize) {
+		const int count = qMin(AbstractColumn::SpanReader::chunkSize, rows - first);
+		for (int j=0; j<cols; ++j)
+			values[j] = numericFilters[j] ? columns[j]->valueData(first, count) : 0;
+
+		for (int i=0; i<count; ++i) {
+			for (int j=0; j<cols; ++j) {
+				if (values[j]) {
+					const double value = values[j][i];
+					if (!std::isnan(value))
+						out << locale.toString(value, numericFilters[j]->numericFormat(), numericFilters[j]->numDigits());
+				} else
+					out << columns[j]->asStringColumn()->textAt(first + i);
+				if (j!=cols-1)
+					out<<sep;
+			}
+			out << '\n';
 		}
-		out << '\n';
 	}
 }
 
@@ -834,7 +834,7 @@ void WorksheetView::mousePressEvent(QMouseEvent* event) {
 		if (!dynamic_cast<XYCurvePrivate*>(item))
 			continue;
 
-		if ( item->shape().contains(item->mapFromScene(mapToScene(event->pos()))) ) {
+		if ( item->contains(item->mapFromScene(mapToScene(event->pos()))) ) {
 			//deselect currently selected items
 			QList<QGraphicsItem*> selectedItems = scene()->selectedItems();
 			foreach(QGraphicsItem* selectedItem, selectedItems)
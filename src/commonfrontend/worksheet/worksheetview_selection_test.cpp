@@ -0,0 +1,120 @@
+/***************************************************************************
+    File                 : worksheetview_selection_test.cpp
+    Project              : LabPlot
+    Description          : test of the selection of curves by mouse clicks in the worksheet view
+    --------------------------------------------------------------------
+    Copyright            : (C) 2017 LabPlot developers
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "backend/core/Project.h"
+#include "backend/core/column/Column.h"
+#include "backend/worksheet/Worksheet.h"
+#include "backend/worksheet/WorksheetUpdateScheduler.h"
+#include "backend/worksheet/plots/cartesian/CartesianPlot.h"
+#include "backend/worksheet/plots/cartesian/CartesianCoordinateSystem.h"
+#include "backend/worksheet/plots/cartesian/XYCurve.h"
+#include "commonfrontend/worksheet/WorksheetView.h"
+
+#include <QtTest>
+
+class WorksheetViewSelectionTest : public QObject {
+	Q_OBJECT
+
+	private slots:
+		void markerSelectsItsCurve();
+
+	private:
+		XYCurve* addCurve(const QString& name, const QVector<double>& x, const QVector<double>& y);
+
+		Project* m_project;
+		CartesianPlot* m_plot;
+};
+
+XYCurve* WorksheetViewSelectionTest::addCurve(const QString& name, const QVector<double>& x, const QVector<double>& y) {
+	Column* xColumn = new Column(name + "_x", x);
+	Column* yColumn = new Column(name + "_y", y);
+	m_project->addChild(xColumn);
+	m_project->addChild(yColumn);
+
+	XYCurve* curve = new XYCurve(name);
+	m_plot->addChild(curve);
+	curve->setXColumn(xColumn);
+	curve->setYColumn(yColumn);
+	return curve;
+}
+
+/*!
+  a symbols-only curve is placed above a line curve crossing its marker.
+  Clicking the marker has to select the symbols curve and not the line below it.
+*/
+void WorksheetViewSelectionTest::markerSelectsItsCurve() {
+	Project project;
+	m_project = &project;
+	Worksheet* worksheet = new Worksheet(0, "worksheet");
+	project.addChild(worksheet);
+
+	m_plot = new CartesianPlot("plot");
+	m_plot->initDefault(CartesianPlot::FourAxes);
+	worksheet->addChild(m_plot);
+	m_plot->setAutoScaleX(false);
+	m_plot->setAutoScaleY(false);
+	m_plot->setXMin(0);
+	m_plot->setXMax(4);
+	m_plot->setYMin(0);
+	m_plot->setYMax(4);
+
+	QVector<double> x, y;
+	x << 1 << 3;
+	y << 3 << 1;
+	XYCurve* lineCurve = addCurve("line", x, y);
+	lineCurve->setLineType(XYCurve::Line);
+	lineCurve->setSymbolsStyle(Symbol::NoSymbols);
+
+	x.clear();
+	y.clear();
+	x << 1 << 2 << 3;
+	y << 1 << 2 << 3;
+	XYCurve* symbolsCurve = addCurve("symbols", x, y);
+	symbolsCurve->setLineType(XYCurve::NoLine);
+	symbolsCurve->setSymbolsStyle(Symbol::Circle);
+	symbolsCurve->setSymbolsSize(Worksheet::convertToSceneUnits(10, Worksheet::Point));
+
+	WorksheetView* view = static_cast<WorksheetView*>(worksheet->view());
+	view->resize(800, 600);
+	view->show();
+	QVERIFY(QTest::qWaitForWindowExposed(view));
+	worksheet->updateScheduler()->process();
+	QCoreApplication::processEvents();
+
+	//click on the marker at (2,2), the line of the other curve crosses it there
+	const CartesianCoordinateSystem* cSystem = dynamic_cast<const CartesianCoordinateSystem*>(m_plot->coordinateSystem());
+	QVERIFY(cSystem);
+	const QPointF scenePos = cSystem->mapLogicalToScene(QPointF(2, 2));
+	QTest::mouseClick(view->viewport(), Qt::LeftButton, Qt::NoModifier, view->mapFromScene(scenePos));
+
+	QVERIFY(symbolsCurve->graphicsItem()->isSelected());
+	QVERIFY(!lineCurve->graphicsItem()->isSelected());
+}
+
+QTEST_MAIN(WorksheetViewSelectionTest)
+#include "worksheetview_selection_test.moc"
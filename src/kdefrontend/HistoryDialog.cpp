@@ -26,26 +26,117 @@
  *                                                                         *
  ***************************************************************************/
 #include "HistoryDialog.h"
+#include "backend/lib/UndoMemoryBudget.h"
 #include <kmessagebox.h>
 #include <klocale.h>
 #include <QUndoStack>
 #include <QUndoView>
+#include <QStyledItemDelegate>
+#include <QLabel>
+#include <QMouseEvent>
+#include <QVBoxLayout>
+#include <KGlobal>
 #include <KWindowConfig>
 
+/*!
+	shows the memory kept by the commands next to their texts.
+*/
+class HistoryItemDelegate : public QStyledItemDelegate {
+public:
+	HistoryItemDelegate(QUndoStack* stack, UndoMemoryBudget* budget, QObject* parent)
+		: QStyledItemDelegate(parent), m_stack(stack), m_budget(budget) {}
+
+protected:
+	virtual void initStyleOption(QStyleOptionViewItem* option, const QModelIndex& index) const {
+		QStyledItemDelegate::initStyleOption(option, index);
+
+		//the first row is the empty state before the first command
+		const int command = index.row() - 1;
+		if (command < 0 || command >= m_stack->count())
+			return;
+
+		if (command < m_budget->firstUndoableIndex()) {
+			option->text += QLatin1String(" (") + i18n("released, can't be undone") + QLatin1Char(')');
+			option->state &= ~QStyle::State_Enabled;
+			return;
+		}
+
+		const qint64 cost = BudgetedUndoCommand::totalMemoryCost(m_stack->command(command));
+		if (cost > 0)
+			option->text += QLatin1String(" (") + KGlobal::locale()->formatByteSize(cost) + QLatin1Char(')');
+	}
+
+private:
+	QUndoStack* m_stack;
+	UndoMemoryBudget* m_budget;
+};
+
+/*!
+	doesn't allow to navigate to the states before the released commands, they can't be undone.
+*/
+class HistoryView : public QUndoView {
+public:
+	HistoryView(QUndoStack* stack, UndoMemoryBudget* budget, QWidget* parent)
+		: QUndoView(stack, parent), m_budget(budget) {}
+
+protected:
+	virtual void mousePressEvent(QMouseEvent* event) {
+		if (isReachable(indexAt(event->pos())))
+			QUndoView::mousePressEvent(event);
+	}
+
+	virtual void mouseMoveEvent(QMouseEvent* event) {
+		if (isReachable(indexAt(event->pos())))
+			QUndoView::mouseMoveEvent(event);
+	}
+
+	virtual void mouseDoubleClickEvent(QMouseEvent* event) {
+		if (isReachable(indexAt(event->pos())))
+			QUndoView::mouseDoubleClickEvent(event);
+	}
+
+	virtual QModelIndex moveCursor(CursorAction action, Qt::KeyboardModifiers modifiers) {
+		const QModelIndex index = QUndoView::moveCursor(action, modifiers);
+		if (index.isValid() && !isReachable(index))
+			return model()->index(m_budget->firstUndoableIndex(), 0);
+		return index;
+	}
+
+private:
+	//row i is the state after the first i commands
+	bool isReachable(const QModelIndex& index) const {
+		return !index.isValid() || index.row() >= m_budget->firstUndoableIndex();
+	}
+
+	UndoMemoryBudget* m_budget;
+};
+
 /*!
 	\class HistoryDialog
 	\brief Display the content of project's undo stack.
 
 	\ingroup kdefrontend
  */
-HistoryDialog::HistoryDialog(QWidget* parent, QUndoStack* stack, const QString& emptyLabel) : KDialog(parent), m_undoStack(stack) {
-	QUndoView* undoView = new QUndoView(stack, this);
+HistoryDialog::HistoryDialog(QWidget* parent, QUndoStack* stack, UndoMemoryBudget* budget, const QString& emptyLabel) : KDialog(parent), m_undoStack(stack) {
+	QWidget* mainWidget = new QWidget(this);
+	QVBoxLayout* layout = new QVBoxLayout(mainWidget);
+	layout->setContentsMargins(0, 0, 0, 0);
+
+	QUndoView* undoView = new HistoryView(stack, budget, mainWidget);
 	undoView->setCleanIcon( QIcon::fromTheme("edit-clear-history") );
 	undoView->setEmptyLabel(emptyLabel);
 	undoView->setMinimumWidth(350);
+	undoView->setItemDelegate(new HistoryItemDelegate(stack, budget, undoView));
 	undoView->setWhatsThis(i18n("List of all performed steps/actions.\n"
 	                            "Select an item in the list to navigate to the corresponding step."));
-	setMainWidget(undoView);
+	layout->addWidget(undoView);
+
+	QString memory = i18n("Memory used by the history: %1", KGlobal::locale()->formatByteSize(budget->usage()));
+	if (budget->limit() > 0)
+		memory = i18n("Memory used by the history: %1 of %2", KGlobal::locale()->formatByteSize(budget->usage()),
+		              KGlobal::locale()->formatByteSize(budget->limit()));
+	layout->addWidget(new QLabel(memory, mainWidget));
+	setMainWidget(mainWidget);
 
 	setWindowIcon( QIcon::fromTheme("view-history") );
 	setWindowTitle(i18n("Undo/Redo History"));
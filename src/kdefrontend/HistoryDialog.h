@@ -32,12 +32,13 @@
 
 #include <KDialog>
 class QUndoStack;
+class UndoMemoryBudget;
 
 class HistoryDialog: public KDialog {
 	Q_OBJECT
 
 public:
-	HistoryDialog(QWidget*, QUndoStack*, const QString&);
+	HistoryDialog(QWidget*, QUndoStack*, UndoMemoryBudget*, const QString&);
 	~HistoryDialog();
 
 private:
@@ -30,12 +30,14 @@
 #include "MainWin.h"
 
 #include "backend/core/Project.h"
+#include "backend/lib/UndoMemoryBudget.h"
 #include "backend/core/Folder.h"
 #include "backend/core/AspectTreeModel.h"
 #include "backend/core/Workbook.h"
 #include "backend/spreadsheet/Spreadsheet.h"
 #include "backend/matrix/Matrix.h"
 #include "backend/worksheet/Worksheet.h"
+#include "backend/worksheet/plots/cartesian/XYAnalysisDataCache.h"
 #include "backend/datasources/FileDataSource.h"
 #ifdef HAVE_CANTOR_LIBS
 #include "backend/cantorWorksheet/CantorWorksheet.h"
@@ -43,6 +45,7 @@
 #include "backend/datapicker/Datapicker.h"
 #include "backend/note/Note.h"
 #include "backend/lib/macros.h"
+#include "backend/lib/BinaryProjectFile.h"
 
 #include "commonfrontend/ProjectExplorer.h"
 #include "commonfrontend/matrix/MatrixView.h"
@@ -64,6 +67,9 @@
 #include "kdefrontend/widgets/FITSHeaderEditDialog.h"
 
 #include <QMdiArea>
+#include <QThreadPool>
+#include <QStandardPaths>
+#include <QDir>
 #include <QMenu>
 #include <QDockWidget>
 #include <QStackedWidget>
@@ -85,6 +91,11 @@
 #include <KLocalizedString>
 #include <KFilterDev>
 
+extern "C" {
+#include "backend/nsl/nsl_fft.h"
+#include "backend/nsl/nsl_smooth.h"
+}
+
 #ifdef HAVE_CANTOR_LIBS
 #include <cantor/backend.h>
 #endif
@@ -153,10 +164,20 @@ MainWin::~MainWin() {
 
 	KSharedConfig::openConfig()->sync();
 
+	//keep the FFTW wisdom accumulated in this session for the next one
+	if (KSharedConfig::openConfig()->group("Settings_General").readEntry("FFTWisdom", false)) {
+		const QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+		if (QDir().mkpath(dir))
+			nsl_fft_wisdom_export(QFile::encodeName(dir + QLatin1String("/fftw_wisdom")).constData());
+	}
+	nsl_fft_cache_clear();
+	nsl_smooth_savgol_cache_clear();
+
 	if (m_project != 0) {
 		m_mdiArea->closeAllSubWindows();
 		disconnect(m_project, 0, this, 0);
 		delete m_project;
+		XYAnalysisDataCache::instance()->clear();
 	}
 
 	if (m_aspectTreeModel)
@@ -229,6 +250,14 @@ void MainWin::initGUI(const QString& fileName) {
 	m_autoSaveTimer.setInterval(interval);
 	connect(&m_autoSaveTimer, SIGNAL(timeout()), this, SLOT(autoSaveProject()));
 
+	//FFT plans: plan with FFTW_MEASURE and reuse the wisdom of the previous sessions
+	if (group.readEntry("FFTWisdom", false)) {
+		nsl_fft_set_measure(1);
+		const QString file = QStandardPaths::locate(QStandardPaths::AppDataLocation, QLatin1String("fftw_wisdom"));
+		if (!file.isEmpty())
+			nsl_fft_wisdom_import(QFile::encodeName(file).constData());
+	}
+
 	if (!fileName.isEmpty())
 		openProject(fileName);
 	else {
@@ -817,7 +846,7 @@ void MainWin::openProject() {
 	KConfigGroup conf(KSharedConfig::openConfig(), "MainWin");
 	QString dir = conf.readEntry("LastOpenDir", "");
 	QString path = QFileDialog::getOpenFileName(this,i18n("Open project"), dir,
-	               i18n("LabPlot Projects (*.lml *.lml.gz *.lml.bz2 *.lml.xz *.LML *.LML.GZ *.LML.BZ2 *.LML.XZ)"));
+	               i18n("LabPlot Projects (*.lml *.lml.gz *.lml.bz2 *.lml.xz *.lmlb *.LML *.LML.GZ *.LML.BZ2 *.LML.XZ *.LMLB)"));
 
 	if (!path.isEmpty()) {
 		this->openProject(path);
@@ -838,8 +867,17 @@ void MainWin::openProject(const QString& filename) {
 	}
 
 	QIODevice *file;
-	// first try gzip compression, because projects can be gzipped and end with .lml
-	if (filename.endsWith(QLatin1String(".lml"), Qt::CaseInsensitive))
+	if (BinaryProjectFile::isBinaryProjectFile(filename)) {
+		//binary project file, the XML document is read from the memory-mapped file
+		BinaryProjectFile* binaryFile = new BinaryProjectFile();
+		if (!binaryFile->load(filename)) {
+			KMessageBox::error(this, binaryFile->lastError(), i18n("Error opening project"));
+			delete binaryFile;
+			return;
+		}
+		file = binaryFile;
+	} else if (filename.endsWith(QLatin1String(".lml"), Qt::CaseInsensitive))
+		// first try gzip compression, because projects can be gzipped and end with .lml
 		file = new KCompressionDevice(filename,KFilterDev::compressionTypeForMimeType("application/x-gzip"));
 	else	// opens filename using file ending
 		file = new KFilterDev(filename);
@@ -872,6 +910,8 @@ void MainWin::openProject(const QString& filename) {
 	QElapsedTimer timer;
 	timer.start();
 	rc = openXML(file);
+	//the columns read their data from the file in separate threads
+	QThreadPool::globalInstance()->waitForDone();
 	file->close();
 	delete file;
 	if (!rc) {
@@ -943,6 +983,7 @@ bool MainWin::closeProject() {
 	m_aspectTreeModel = 0;
 	delete m_project;
 	m_project = 0;
+	XYAnalysisDataCache::instance()->clear();
 	m_currentFileName = "";
 
 	//update the UI if we're just closing a project
@@ -973,7 +1014,7 @@ bool MainWin::saveProjectAs() {
 	KConfigGroup conf(KSharedConfig::openConfig(), "MainWin");
 	QString dir = conf.readEntry("LastOpenDir", "");
 	QString fileName = QFileDialog::getSaveFileName(this, i18n("Save project as"), dir,
-		i18n("LabPlot Projects (*.lml *.lml.gz *.lml.bz2 *.lml.xz *.LML *.LML.GZ *.LML.BZ2 *.LML.XZ)"));
+		i18n("LabPlot Projects (*.lml *.lml.gz *.lml.bz2 *.lml.xz *.lmlb *.LML *.LML.GZ *.LML.BZ2 *.LML.XZ *.LMLB)"));
 
 	if (fileName.isEmpty())// "Cancel" was clicked
 		return false;
@@ -991,8 +1032,16 @@ bool MainWin::save(const QString& fileName) {
 	WAIT_CURSOR;
 	// use file ending to find out how to compress file
 	QIODevice* file;
+	BinaryProjectFile* binaryFile = 0;
+	// if ending is .lmlb, save the column data in binary sections
+	if (fileName.endsWith(QLatin1String(".lmlb"), Qt::CaseInsensitive)) {
+		binaryFile = new BinaryProjectFile();
+		const KConfigGroup group = KSharedConfig::openConfig()->group("Settings_General");
+		binaryFile->setCompressionEnabled(group.readEntry("CompressBinaryProjects", false));
+		file = binaryFile;
+	}
 	// if ending is .lml, do gzip compression anyway
-	if (fileName.endsWith(QLatin1String(".lml")))
+	else if (fileName.endsWith(QLatin1String(".lml")))
 		file = new KCompressionDevice(fileName, KCompressionDevice::GZip);
 	else
 		file = new KFilterDev(fileName);
@@ -1000,15 +1049,25 @@ bool MainWin::save(const QString& fileName) {
 	if (file == 0)
 		file = new QFile(fileName);
 
-	bool ok;
-	if (file->open(QIODevice::WriteOnly)) {
+	bool ok = file->open(QIODevice::WriteOnly);
+	if (ok) {
 		m_project->setFileName(fileName);
 
 		QXmlStreamWriter writer(file);
 		m_project->save(&writer);
+		file->close();
+
+		//write the document together with the column data into the file
+		if (binaryFile && !binaryFile->save(fileName)) {
+			KMessageBox::error(this, binaryFile->lastError());
+			ok = false;
+		}
+	} else
+		KMessageBox::error(this, i18n("Sorry. Could not open file for writing."));
+
+	if (ok) {
 		m_project->undoStack()->clear();
 		m_project->setChanged(false);
-		file->close();
 
 		setCaption(m_project->name());
 		statusBar()->showMessage(i18n("Project saved"));
@@ -1025,9 +1084,6 @@ bool MainWin::save(const QString& fileName) {
 		// -> auto save can be activated now if not happened yet
 		if (m_autoSaveActive && !m_autoSaveTimer.isActive())
 			m_autoSaveTimer.start();
-	} else {
-		KMessageBox::error(this, i18n("Sorry. Could not open file for writing."));
-		ok = false;
 	}
 
 	delete file;
@@ -1465,6 +1521,10 @@ void MainWin::createFolderContextMenu(const Folder* folder, QMenu* menu) const {
 }
 
 void MainWin::undo() {
+	//the older commands were released because of the memory limit and can't be undone
+	if (m_project->undoStack()->index() <= m_project->undoMemoryBudget()->firstUndoableIndex())
+		return;
+
 	WAIT_CURSOR;
 	m_project->undoStack()->undo();
 	if (m_project->undoStack()->index()==0) {
@@ -1472,6 +1532,9 @@ void MainWin::undo() {
 		m_saveAction->setEnabled(false);
 		m_undoAction->setEnabled(false);
 		m_project->setChanged(false);
+	} else if (m_project->undoStack()->index() <= m_project->undoMemoryBudget()->firstUndoableIndex()) {
+		//the older commands were released because of the memory limit
+		m_undoAction->setEnabled(false);
 	}
 	m_redoAction->setEnabled(true);
 	RESET_CURSOR;
@@ -1606,6 +1669,10 @@ void MainWin::handleSettingsChanges() {
 	interval *= 60*1000;
 	if (interval != m_autoSaveTimer.interval())
 		m_autoSaveTimer.setInterval(interval);
+
+	//memory limit of the undo history
+	if (m_project)
+		m_project->undoMemoryBudget()->setLimit(group.readEntry("UndoMemoryLimit", 1024)*(qint64)1024*1024);
 }
 
 /***************************************************************************************/
@@ -1618,11 +1685,12 @@ void MainWin::historyDialog() {
 	if (!m_project->undoStack())
 		return;
 
-	HistoryDialog* dialog = new HistoryDialog(this, m_project->undoStack(), m_undoViewEmptyLabel);
+	HistoryDialog* dialog = new HistoryDialog(this, m_project->undoStack(), m_project->undoMemoryBudget(), m_undoViewEmptyLabel);
 	int index = m_project->undoStack()->index();
 	if (dialog->exec() != QDialog::Accepted) {
+		//commands redone in the dialog may have released older commands, don't go back behind them
 		if (m_project->undoStack()->count() != 0)
-			m_project->undoStack()->setIndex(index);
+			m_project->undoStack()->setIndex(qMax(index, m_project->undoMemoryBudget()->firstUndoableIndex()));
 	}
 
 	//disable undo/redo-actions if the history was cleared
@@ -1630,6 +1698,11 @@ void MainWin::historyDialog() {
 	if (m_project->undoStack()->count() == 0) {
 		m_undoAction->setEnabled(false);
 		m_redoAction->setEnabled(false);
+	} else {
+		//the history can't be moved behind the released commands, \sa UndoMemoryBudget
+		const int current = m_project->undoStack()->index();
+		m_undoAction->setEnabled(current > m_project->undoMemoryBudget()->firstUndoableIndex());
+		m_redoAction->setEnabled(current < m_project->undoStack()->count());
 	}
 }
 
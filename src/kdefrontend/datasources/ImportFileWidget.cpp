@@ -200,6 +200,7 @@ void ImportFileWidget::loadSettings() {
 	asciiOptionsWidget.chbSkipEmptyParts->setChecked(conf.readEntry("SkipEmptyParts", false));
 	asciiOptionsWidget.chbHeader->setChecked(conf.readEntry("UseFirstRow", true));
 	asciiOptionsWidget.kleVectorNames->setText(conf.readEntry("Names", ""));
+	asciiOptionsWidget.sbThreads->setValue(conf.readEntry("ThreadCount", 0));
 
 	// binary data
 	binaryOptionsWidget.niVectors->setValue(conf.readEntry("Vectors", "2").toInt());
@@ -238,6 +239,7 @@ ImportFileWidget::~ImportFileWidget() {
 	conf.writeEntry("SkipEmptyParts", asciiOptionsWidget.chbSkipEmptyParts->isChecked());
 	conf.writeEntry("UseFirstRow", asciiOptionsWidget.chbHeader->isChecked());
 	conf.writeEntry("Names", asciiOptionsWidget.kleVectorNames->text());
+	conf.writeEntry("ThreadCount", asciiOptionsWidget.sbThreads->value());
 
 	// binary data
 	conf.writeEntry("Vectors", binaryOptionsWidget.niVectors->value());
@@ -338,6 +340,7 @@ AbstractFileFilter* ImportFileWidget::currentFileFilter() const {
 			filter->setEndRow( ui.sbEndRow->value() );
 			filter->setStartColumn( ui.sbStartColumn->value());
 			filter->setEndColumn( ui.sbEndColumn->value());
+			filter->setThreadCount( asciiOptionsWidget.sbThreads->value() );
 
 			return filter;
 		}
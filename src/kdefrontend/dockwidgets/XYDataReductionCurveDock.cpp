@@ -170,6 +170,7 @@ void XYDataReductionCurveDock::initGeneralTab() {
 	connect(m_dataReductionCurve, SIGNAL(yDataColumnChanged(const AbstractColumn*)), this, SLOT(curveYDataColumnChanged(const AbstractColumn*)));
 	connect(m_dataReductionCurve, SIGNAL(dataReductionDataChanged(XYDataReductionCurve::DataReductionData)), this, SLOT(curveDataReductionDataChanged(XYDataReductionCurve::DataReductionData)));
 	connect(m_dataReductionCurve, SIGNAL(sourceDataChangedSinceLastDataReduction()), this, SLOT(enableRecalculate()));
+	connect(m_dataReductionCurve, SIGNAL(dataChanged()), this, SLOT(dataChanged()));
 }
 
 void XYDataReductionCurveDock::setModel() {
@@ -516,6 +517,8 @@ void XYDataReductionCurveDock::recalculateClicked() {
         progressBar->setMinimum(0);
         progressBar->setMaximum(100);
 	connect(m_curve, SIGNAL(completed(int)), progressBar, SLOT(setValue(int)));
+	//the data reduction runs in the background, the progress bar is removed when the result is available
+	connect(m_curve, SIGNAL(dataChanged()), progressBar, SLOT(deleteLater()));
         statusBar->clearMessage();
         statusBar->addWidget(progressBar, 1);
 	QApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
@@ -524,7 +527,6 @@ void XYDataReductionCurveDock::recalculateClicked() {
 		dynamic_cast<XYDataReductionCurve*>(curve)->setDataReductionData(m_dataReductionData);
 
         QApplication::restoreOverrideCursor();
-        statusBar->removeWidget(progressBar);
 
 	uiGeneralTab.pbRecalculate->setEnabled(false);
 }
@@ -613,5 +615,5 @@ void XYDataReductionCurveDock::curveDataReductionDataChanged(const XYDataReducti
 }
 
 void XYDataReductionCurveDock::dataChanged() {
-	this->enableRecalculate();
+	this->showDataReductionResult();
 }
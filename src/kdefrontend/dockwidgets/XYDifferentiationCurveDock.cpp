@@ -170,6 +170,7 @@ void XYDifferentiationCurveDock::initGeneralTab() {
 	connect(m_differentiationCurve, SIGNAL(yDataColumnChanged(const AbstractColumn*)), this, SLOT(curveYDataColumnChanged(const AbstractColumn*)));
 	connect(m_differentiationCurve, SIGNAL(differentiationDataChanged(XYDifferentiationCurve::DifferentiationData)), this, SLOT(curveDifferentiationDataChanged(XYDifferentiationCurve::DifferentiationData)));
 	connect(m_differentiationCurve, SIGNAL(sourceDataChanged()), this, SLOT(enableRecalculate()));
+	connect(m_differentiationCurve, SIGNAL(dataChanged()), this, SLOT(dataChanged()));
 }
 
 void XYDifferentiationCurveDock::setModel() {
@@ -593,5 +594,5 @@ void XYDifferentiationCurveDock::curveDifferentiationDataChanged(const XYDiffere
 }
 
 void XYDifferentiationCurveDock::dataChanged() {
-	this->enableRecalculate();
+	this->showDifferentiationResult();
 }
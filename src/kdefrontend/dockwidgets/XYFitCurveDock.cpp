@@ -237,6 +237,7 @@ void XYFitCurveDock::initGeneralTab() {
 	connect(m_fitCurve, SIGNAL(yErrorColumnChanged(const AbstractColumn*)), this, SLOT(curveYErrorColumnChanged(const AbstractColumn*)));
 	connect(m_fitCurve, SIGNAL(fitDataChanged(XYFitCurve::FitData)), this, SLOT(curveFitDataChanged(XYFitCurve::FitData)));
 	connect(m_fitCurve, SIGNAL(sourceDataChanged()), this, SLOT(enableRecalculate()));
+	connect(m_fitCurve, SIGNAL(dataChanged()), this, SLOT(dataChanged()));
 }
 
 void XYFitCurveDock::setModel() {
@@ -1486,5 +1487,5 @@ void XYFitCurveDock::curveFitDataChanged(const XYFitCurve::FitData& data) {
 }
 
 void XYFitCurveDock::dataChanged() {
-	this->enableRecalculate();
+	this->showFitResult();
 }
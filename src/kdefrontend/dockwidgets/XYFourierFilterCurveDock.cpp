@@ -172,6 +172,7 @@ void XYFourierFilterCurveDock::initGeneralTab() {
 	connect(m_filterCurve, SIGNAL(yDataColumnChanged(const AbstractColumn*)), this, SLOT(curveYDataColumnChanged(const AbstractColumn*)));
 	connect(m_filterCurve, SIGNAL(filterDataChanged(XYFourierFilterCurve::FilterData)), this, SLOT(curveFilterDataChanged(XYFourierFilterCurve::FilterData)));
 	connect(m_filterCurve, SIGNAL(sourceDataChangedSinceLastFilter()), this, SLOT(enableRecalculate()));
+	connect(m_filterCurve, SIGNAL(dataChanged()), this, SLOT(dataChanged()));
 }
 
 void XYFourierFilterCurveDock::setModel() {
@@ -602,5 +603,5 @@ void XYFourierFilterCurveDock::curveFilterDataChanged(const XYFourierFilterCurve
 }
 
 void XYFourierFilterCurveDock::dataChanged() {
-	this->enableRecalculate();
+	this->showFilterResult();
 }
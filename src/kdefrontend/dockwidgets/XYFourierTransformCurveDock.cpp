@@ -158,6 +158,7 @@ void XYFourierTransformCurveDock::initGeneralTab() {
 	connect(m_transformCurve, SIGNAL(yDataColumnChanged(const AbstractColumn*)), this, SLOT(curveYDataColumnChanged(const AbstractColumn*)));
 	connect(m_transformCurve, SIGNAL(transformDataChanged(XYFourierTransformCurve::TransformData)), this, SLOT(curveTransformDataChanged(XYFourierTransformCurve::TransformData)));
 	connect(m_transformCurve, SIGNAL(sourceDataChangedSinceLastTransform()), this, SLOT(enableRecalculate()));
+	connect(m_transformCurve, SIGNAL(dataChanged()), this, SLOT(dataChanged()));
 }
 
 void XYFourierTransformCurveDock::setModel() {
@@ -415,5 +416,5 @@ void XYFourierTransformCurveDock::curveTransformDataChanged(const XYFourierTrans
 }
 
 void XYFourierTransformCurveDock::dataChanged() {
-	this->enableRecalculate();
+	this->showTransformResult();
 }
@@ -171,6 +171,7 @@ void XYIntegrationCurveDock::initGeneralTab() {
 	connect(m_integrationCurve, SIGNAL(yDataColumnChanged(const AbstractColumn*)), this, SLOT(curveYDataColumnChanged(const AbstractColumn*)));
 	connect(m_integrationCurve, SIGNAL(integrationDataChanged(XYIntegrationCurve::IntegrationData)), this, SLOT(curveIntegrationDataChanged(XYIntegrationCurve::IntegrationData)));
 	connect(m_integrationCurve, SIGNAL(sourceDataChanged()), this, SLOT(enableRecalculate()));
+	connect(m_integrationCurve, SIGNAL(dataChanged()), this, SLOT(dataChanged()));
 }
 
 void XYIntegrationCurveDock::setModel() {
@@ -507,5 +508,5 @@ void XYIntegrationCurveDock::curveIntegrationDataChanged(const XYIntegrationCurv
 }
 
 void XYIntegrationCurveDock::dataChanged() {
-	this->enableRecalculate();
+	this->showIntegrationResult();
 }
@@ -202,6 +202,7 @@ void XYInterpolationCurveDock::initGeneralTab() {
 	connect(m_interpolationCurve, SIGNAL(yDataColumnChanged(const AbstractColumn*)), this, SLOT(curveYDataColumnChanged(const AbstractColumn*)));
 	connect(m_interpolationCurve, SIGNAL(interpolationDataChanged(XYInterpolationCurve::InterpolationData)), this, SLOT(curveInterpolationDataChanged(XYInterpolationCurve::InterpolationData)));
 	connect(m_interpolationCurve, SIGNAL(sourceDataChanged()), this, SLOT(enableRecalculate()));
+	connect(m_interpolationCurve, SIGNAL(dataChanged()), this, SLOT(dataChanged()));
 }
 
 void XYInterpolationCurveDock::setModel() {
@@ -724,5 +725,5 @@ void XYInterpolationCurveDock::curveInterpolationDataChanged(const XYInterpolati
 }
 
 void XYInterpolationCurveDock::dataChanged() {
-	this->enableRecalculate();
+	this->showInterpolationResult();
 }
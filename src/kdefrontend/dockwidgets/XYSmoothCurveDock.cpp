@@ -200,6 +200,7 @@ void XYSmoothCurveDock::initGeneralTab() {
 	connect(m_smoothCurve, SIGNAL(yDataColumnChanged(const AbstractColumn*)), this, SLOT(curveYDataColumnChanged(const AbstractColumn*)));
 	connect(m_smoothCurve, SIGNAL(smoothDataChanged(XYSmoothCurve::SmoothData)), this, SLOT(curveSmoothDataChanged(XYSmoothCurve::SmoothData)));
 	connect(m_smoothCurve, SIGNAL(sourceDataChanged()), this, SLOT(enableRecalculate()));
+	connect(m_smoothCurve, SIGNAL(dataChanged()), this, SLOT(dataChanged()));
 }
 
 void XYSmoothCurveDock::setModel() {
@@ -609,5 +610,5 @@ void XYSmoothCurveDock::curveSmoothDataChanged(const XYSmoothCurve::SmoothData&
 }
 
 void XYSmoothCurveDock::dataChanged() {
-	this->enableRecalculate();
+	this->showSmoothResult();
 }
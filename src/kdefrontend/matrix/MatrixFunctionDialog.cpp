@@ -32,9 +32,7 @@
 #include "kdefrontend/widgets/ConstantsWidget.h"
 #include "kdefrontend/widgets/FunctionsWidget.h"
 
-extern "C" {
-#include "backend/gsl/parser.h"
-}
+#include "backend/gsl/ExpressionParser.h"
 #include <cmath>
 
 #include <QMenu>
@@ -136,46 +134,35 @@ void MatrixFunctionDialog::insertConstant(const QString& str) {
 	ui.teEquation->insertPlainText(str);
 }
 
-/* task class for parallel fill (not used) */
+/* task class for parallel fill */
 class GenerateValueTask : public QRunnable {
 public:
-	GenerateValueTask(int startCol, int endCol, QVector<QVector<double>>& matrixData, double xStart, double yStart,
-		double xStep, double yStep, char* func): m_startCol(startCol), m_endCol(endCol), m_matrixData(matrixData),
-		m_xStart(xStart), m_yStart(yStart), m_xStep(xStep), m_yStep(yStep), m_func(func) {
+	GenerateValueTask(int startCol, int endCol, const QVector<double*>& columns, double xStart, const QVector<double>& yValues,
+		double xStep, const CompiledExpression& program): m_startCol(startCol), m_endCol(endCol), m_columns(columns),
+		m_xStart(xStart), m_yValues(yValues), m_xStep(xStep), m_program(program) {
 	};
 
 	void run() {
-		const int rows = m_matrixData[m_startCol].size();
-		double x = m_xStart;
-		double y = m_yStart;
+		const int rows = m_yValues.size();
 #ifndef NDEBUG
-		qDebug()<<"FILL col"<<m_startCol<<"-"<<m_endCol<<" x/y ="<<x<<'/'<<y<<" steps ="<<m_xStep<<'/'<<m_yStep<<" rows ="<<rows;
+		qDebug()<<"FILL col"<<m_startCol<<"-"<<m_endCol<<" x ="<<m_xStart<<" step ="<<m_xStep<<" rows ="<<rows;
 #endif
-		parser_var vars[] = { {"x", x}, {"y", y}};
+		QVector<int> strides;
+		strides << 0 << 1;
 		for (int col = m_startCol; col < m_endCol; ++col) {
-			vars[0].value = x;
-			for (int row = 0; row < rows; row++) {
-				vars[1].value = y;
-				double z = parse_with_vars(m_func, vars, 2);
-				//qDebug()<<" z ="<<z;
-				m_matrixData[col][row] = z;
-				y += m_yStep;
-			}
-
-			y = m_yStart;
-			x += m_xStep;
+			const double x = m_xStart + m_xStep*(col - m_startCol);
+			m_program.evaluate(QVector<const double*>() << &x << m_yValues.constData(), strides, m_columns.at(col), rows);
 		}
 	}
 
 private:
 	int m_startCol;
 	int m_endCol;
-	QVector<QVector<double>>& m_matrixData;
+	const QVector<double*>& m_columns;
 	double m_xStart;
-	double m_yStart;
+	const QVector<double>& m_yValues;
 	double m_xStep;
-	double m_yStep;
-	char* m_func;
+	const CompiledExpression& m_program;
 };
 
 void MatrixFunctionDialog::generate() {
@@ -185,8 +172,8 @@ void MatrixFunctionDialog::generate() {
 
 	QVector<QVector<double> > new_data = m_matrix->data();
 
-	QByteArray funcba = ui.teEquation->toPlainText().toLocal8Bit();
-	char* func = funcba.data();
+	//the expression is parsed only once, the compiled expression is evaluated in all threads
+	const CompiledExpression program(ui.teEquation->toPlainText(), QStringList() << "x" << "y");
 
 	// check if rows or cols == 1
 	double diff = m_matrix->xEnd() - m_matrix->xStart();
@@ -199,44 +186,40 @@ void MatrixFunctionDialog::generate() {
 	if (m_matrix->rowCount() > 1)
 		yStep = diff/double(m_matrix->rowCount() - 1);
 
+	//y-values are the same for all columns
+	const int rows = m_matrix->rowCount();
+	QVector<double> yValues(rows);
+	for (int row = 0; row < rows; row++)
+		yValues[row] = m_matrix->yStart() + yStep*row;
+
+	//detach the data from the matrix here, the tasks only write to the columns
+	const int cols = m_matrix->columnCount();
+	QVector<double*> columns(cols);
+	for (int col = 0; col < cols; ++col)
+		columns[col] = new_data[col].data();
+
 #ifndef NDEBUG
 	QElapsedTimer timer;
 	timer.start();
 #endif
 
-	//TODO: too slow because every parser thread needs an own symbol_table
-	// idea: use pool->maxThreadCount() symbol tables and reuse them?
-/*	double yStart = m_matrix->yStart();
-	const int cols = m_matrix->columnCount();
-	QThreadPool* pool = QThreadPool::globalInstance();
-	int range = ceil(double(cols)/pool->maxThreadCount());
+	//every thread fills a range of columns. A local pool is used to wait for these tasks only,
+	//not for unrelated tasks in the global pool
+	QThreadPool pool;
+	const int range = ceil(double(cols)/pool.maxThreadCount());
 #ifndef NDEBUG
-	qDebug() << "Starting" << pool->maxThreadCount() << "threads. cols =" << cols << ": range =" << range;
+	qDebug() << "Starting" << pool.maxThreadCount() << "threads. cols =" << cols << ": range =" << range;
 #endif
-	for (int i = 0; i < pool->maxThreadCount(); ++i) {
+	for (int i = 0; i < pool.maxThreadCount(); ++i) {
 		const int start = i*range;
 		int end = (i+1)*range;
 		if (end > cols) end = cols;
-		qDebug() << "start/end: " << start << end;
+		if (start >= end) break;
 		const double xStart = m_matrix->xStart() + xStep*start;
-		GenerateValueTask* task = new GenerateValueTask(start, end, new_data, xStart, yStart, xStep, yStep, func);
-		task->setAutoDelete(false);
-		pool->start(task);
-	}
-	pool->waitForDone();
-*/
-	double x = 0, y = 0;
-	parser_var vars[] = {{"x", x}, {"y", y}};
-	for (int col = 0; col < m_matrix->columnCount(); col++) {
-		vars[0].value = x;
-		for (int row = 0; row < m_matrix->rowCount(); row++) {
-			vars[1].value = y;
-			new_data[col][row] = parse_with_vars(func, vars, 2);
-			y += yStep;
-		}
-		y = m_matrix->yStart();
-		x += xStep;
+		GenerateValueTask* task = new GenerateValueTask(start, end, columns, xStart, yValues, xStep, program);
+		pool.start(task);
 	}
+	pool.waitForDone();
 
 	// Timing
 #ifndef NDEBUG